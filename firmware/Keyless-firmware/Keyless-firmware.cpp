@@ -1,13 +1,17 @@
 #include <stdio.h>
 #include "pico/stdlib.h"
 #include "hardware/spi.h"
-#include "hardware/watchdog.h"
-#include "iostream"
 #include "hardware/irq.h"
 #include "core1.h"
 #include "pico/multicore.h"
 #include "input.h"
 #include "output.h"
+#include "trace.h"
+#include "telemetry.h"
+#include "deadline.h"
+#include "vmon.h"
+#include "entry.h"
+#include "settings.h"
 //#define CATCH_CONFIG_MAIN
 #include "catch2.h"
 
@@ -20,6 +24,22 @@
 #define PIN_SCK  18
 #define PIN_MOSI 19
 
+//longest the car loop may go between input scans or output commits, a pass can sleep twice for 1s
+#define LOOP_DEADLINE_US (3000 * 1000)
+
+//voltage gates on the start sequence, only applied while vmon has valid readings
+#define START_MIN_BATT_MV 11800 //resting battery, below this it will not turn the engine over
+#define START_MIN_IGN_MV 9000 //ignition feed has to be up before the pump primes
+#define CRANK_ABORT_MV 8000 //the ecu and this board brown out not far below
+#define CRANK_ABORT_MS 250 //sag below CRANK_ABORT_MV this long drops the starter
+#define CRANK_BASE_MS 4000 //crank limit
+#define CRANK_MAX_MS 8000 //limit when the battery held above CRANK_GOOD_MV for the whole of CRANK_BASE_MS
+#define CRANK_GOOD_MV 9600
+#define CRANK_INRUSH_MS 300 //the starter's inrush dip, not counted in the sag that earns the longer limit
+
+//the loop's idle time is spent in steps this long so a range reaches the door logic without waiting out a pass
+#define ENTRY_POLL_MS 10
+
 
 
 
@@ -29,50 +49,158 @@ int started;
 
 bool start_button_enable;
 bool kill_switch_enable;
-input core1_obj;
+input in_obj;
 output out_obj;
+passive_entry entry;
+uint8_t engine_state = TELEM_ENGINE_OFF;
+uint16_t crank_sag_mv; //lowest filtered battery of the last crank after the inrush
+void set_engine_state(uint8_t to, uint8_t reason = TELEM_REASON_NONE){ //reports the change, or a refusal with its reason
+	if (to != engine_state || reason != TELEM_REASON_NONE){
+		telem_state(TELEM_SM_ENGINE, engine_state, to, reason);
+		engine_state = to;
+	}
+}
+
+uint8_t start_refused(){ //why the start sequence may not begin, TELEM_REASON_NONE when it may
+	vmon_reading batt = vmon_read(VMON_BATT);
+	vmon_reading ign = vmon_read(VMON_IGN);
+	if (!vmon_valid(batt)){
+		return TELEM_REASON_NONE; //no divider or no readings, the sequence runs as it did before
+	}
+	if (batt.mv < START_MIN_BATT_MV){
+		return TELEM_REASON_LOW_BATT;
+	}
+	if (ign.mv < START_MIN_IGN_MV){
+		return TELEM_REASON_NO_IGN;
+	}
+	return TELEM_REASON_NONE;
+}
+
+//the start button is still held after a refusal or an abort, without this the next pass would start over
+void wait_start_release(){
+	while (in_obj.get_start_status() == 1){
+		sleep_ms(50);
+		in_obj.poll();
+		deadline_checkin(DL_INPUTS);
+		deadline_checkin(DL_OUTPUTS);
+	}
+}
+
+struct crank_profile {
+	uint32_t start_us;
+	uint32_t low_us; //when the battery went below CRANK_ABORT_MV, 0 while it is above
+	uint32_t limit_ms;
+	bool settled; //past the inrush, the sag from here on is what the battery holds under load
+};
+
+//called each pass of the crank loop, the reason to let go of the starter or TELEM_REASON_NONE to keep going
+uint8_t crank_check(crank_profile &p){
+	vmon_reading batt = vmon_read(VMON_BATT);
+	uint32_t now = time_us_32();
+	uint32_t ms = (now - p.start_us) / 1000;
+	if (!vmon_valid(batt)){
+		return TELEM_REASON_NONE;
+	}
+	if (batt.mv >= CRANK_ABORT_MV){
+		p.low_us = 0;
+	}
+	else if (!p.low_us){
+		p.low_us = now | 1; //0 means not low
+	}
+	else if (now - p.low_us >= CRANK_ABORT_MS * 1000){
+		return TELEM_REASON_CRANK_SAG;
+	}
+	if (!p.settled && ms >= CRANK_INRUSH_MS){
+		vmon_sag_reset(VMON_BATT);
+		p.settled = true;
+	}
+	if (ms >= p.limit_ms && p.limit_ms < CRANK_MAX_MS && batt.sag_mv >= CRANK_GOOD_MV){
+		p.limit_ms = CRANK_MAX_MS; //the battery is keeping up, give it longer
+	}
+	if (ms >= p.limit_ms){
+		return TELEM_REASON_CRANK_TIME;
+	}
+	return TELEM_REASON_NONE;
+}
+
 int start_engine() { //this function solely handles starting the engine
-	if (core1_obj.get_run_status() == 0){ //add dwb_ky_connected_function once it's complete
+	int ret = 0;
+	TRACE_BEGIN(TRACE_START_SEQ, primed);
+	uint8_t refused = TELEM_REASON_NONE;
+	if (in_obj.get_run_status() == 0){ //a running engine is not held to the start gates
+		refused = start_refused();
+	}
+	if (refused != TELEM_REASON_NONE){
+		set_engine_state(TELEM_ENGINE_OFF, refused);
+		wait_start_release();
+		ret = 1;
+	}
+	else if (in_obj.get_run_status() == 0){ //add dwb_ky_connected_function once it's complete
 		if (primed == 0){ //if primed is 0 then the fuel pump will prime for 3 seconds and set the flag primed
+			TRACE_BEGIN(TRACE_PRIME, 0);
+			set_engine_state(TELEM_ENGINE_PRIMING);
 			out_obj.set_prime_status(true);
-			sleep_ms(3000);
+			for (int i = 0; i < 30; i++){ //3s, in steps so the deadlines keep being met
+				sleep_ms(100);
+				in_obj.poll();
+				deadline_checkin(DL_INPUTS);
+				deadline_checkin(DL_OUTPUTS);
+			}
 			out_obj.set_prime_status(false);
+			TRACE_END(TRACE_PRIME, 0);
 			primed = 1;
 		}
+		TRACE_BEGIN(TRACE_CRANK, 0);
+		set_engine_state(TELEM_ENGINE_CRANKING);
+		crank_profile crank = {time_us_32(), 0, CRANK_BASE_MS, false};
+		uint8_t stopped = TELEM_REASON_NONE;
 		do { //if primed is 1 then the engine will begin the start sequence
 			out_obj.set_bendix_status(true);
 			out_obj.set_engine_start_status(true);
 			out_obj.set_fuel_status(true);
-			core1_obj.get_start_status();
+			in_obj.poll(); //the inputs are read here on core0, core1 is busy with the radio
+			deadline_checkin(DL_INPUTS);
+			deadline_checkin(DL_OUTPUTS);
+			stopped = crank_check(crank);
 		}
-		while (core1_obj.get_start_status() == 1);
-		//as long as the start button is held the engine will turn over, afterwards if will disengage the starter
+		while (in_obj.get_start_status() == 1 && stopped == TELEM_REASON_NONE);
+		//as long as the start button is held the engine will turn over, unless the battery says otherwise
+		//afterwards if will disengage the starter
 		out_obj.set_bendix_status(false);
 		out_obj.set_engine_start_status(false);
-		if (core1_obj.get_run_status() == 1) {
+		TRACE_END(TRACE_CRANK, in_obj.get_run_status());
+		crank_sag_mv = vmon_read(VMON_BATT).sag_mv;
+		set_engine_state(in_obj.get_run_status() ? TELEM_ENGINE_RUNNING : TELEM_ENGINE_OFF, stopped);
+		if (stopped != TELEM_REASON_NONE){
+			wait_start_release();
+		}
+		if (in_obj.get_run_status() == 1) {
 			//if the is_running pin goes high then the function will return 2 indicating the engine has started
 			started = 1;
-			return 2;
+			ret = 2;
 		}
 	}
 	//if the status returns true then started will be set to 1 indicating the engine is already running and it will return 2
 	else{
-		if (core1_obj.get_run_status() == 0) {
+		if (in_obj.get_run_status() == 0) {
 			started = 1;
-			return 2;
+			ret = 2;
 		}
 		else{
 			//if run_status returns 0 then the engine failed to start and the function will return 1 after setting started to 0
 			started = 0;
-			return 1;
+			ret = 1;
 		}
 	}
-	return 0;
+	TRACE_END(TRACE_START_SEQ, ret); //the arg is what the sequence returned
+	return ret;
 }
 
 
 bool engine_kill(){
-	if (core1_obj.get_kill_status() == true){
+	if (in_obj.get_kill_status() == true){
+		TRACE_INSTANT(TRACE_KILL, primed);
+		set_engine_state(TELEM_ENGINE_KILLED);
 		out_obj.set_fuel_status(false);
 		out_obj.set_pwr_status(false);
 		primed = 0;
@@ -82,6 +210,94 @@ bool engine_kill(){
 }
 
 bool key_connected = true;
+void uwb_update(){ //takes what core1 published since the last pass, never waits on it
+	uwb_msg msg;
+	bool was_connected = key_connected;
+	while (uwb_poll(msg)){
+		TRACE_INSTANT(TRACE_UWB_RECV, msg.type << 8 | msg.ok);
+		if (msg.type == UWB_MSG_LINK && !msg.ok){
+			key_connected = false; //no radio, no key
+		}
+		else if (msg.type == UWB_MSG_AUTH){
+			key_connected = msg.ok;
+		}
+		if (msg.type == UWB_MSG_LINK){
+			entry.link(msg.time_us, msg.ok);
+		}
+		else if (msg.type == UWB_MSG_AUTH){
+			entry.auth(msg.key_id, msg.ok); //the doors only follow a key core1 authenticated
+		}
+		else if (msg.type == UWB_MSG_RANGE && msg.ok){
+			entry.range(msg.time_us, msg.key_id, msg.value);
+		}
+	}
+	if (key_connected != was_connected){
+		telem_state(TELEM_SM_KEY, was_connected, key_connected, 0);
+	}
+}
+
+volatile bool door_pulsing; //a lock or unlock relay is on
+int64_t door_pulse_end(alarm_id_t id, void *data){ //alarm interrupt on core0
+	out_obj.set_lock_status(false);
+	out_obj.set_unlock_status(false);
+	door_pulsing = false;
+	return 0;
+}
+
+void door_update(){ //after uwb_update, the range times have to be older than now
+	entry_doors was = entry.get_doors();
+	entry_action act = entry.update(time_us_32());
+	if (act == ENTRY_NONE){
+		return;
+	}
+	TRACE_INSTANT(TRACE_DOOR, act);
+	door_pulsing = true;
+	out_obj.set_lock_status(act == ENTRY_LOCK);
+	out_obj.set_unlock_status(act == ENTRY_UNLOCK);
+	if (add_alarm_in_ms(ENTRY_PULSE_MS, door_pulse_end, nullptr, true) < 0){
+		sleep_ms(ENTRY_PULSE_MS); //no alarm free, the pulse is still bounded
+		door_pulse_end(0, nullptr);
+	}
+	telem_state(TELEM_SM_DOOR, was, entry.get_doors(), 0);
+}
+
+void idle_ms(uint32_t ms){ //sleeps out the pass but keeps the doors following the key
+	absolute_time_t until = make_timeout_time_ms(ms);
+	do {
+		uwb_update();
+		door_update();
+		sleep_ms(ENTRY_POLL_MS);
+	} while (!time_reached(until));
+}
+
+uint32_t stats_time;
+void send_stats(){ //every 10s, the counters only ever go up so the host can diff them
+	if (time_us_32() - stats_time < 10 * 1000 * 1000){
+		return;
+	}
+	stats_time = time_us_32();
+	uint32_t val[2] = {uwb_dropped(), telem_dropped()};
+	telem_stats(TELEM_GROUP_LINK, val, 2);
+	uint32_t dl[2 * DL_NUM_TASKS];
+	for (int i = 0; i < DL_NUM_TASKS; i++){
+		deadline_stats st = deadline_get_stats((deadline_task)i);
+		dl[i] = st.worst_us;
+		dl[DL_NUM_TASKS + i] = st.mean_us;
+	}
+	telem_stats(TELEM_GROUP_DEADLINE, dl, 2 * DL_NUM_TASKS);
+	vmon_reading batt = vmon_read(VMON_BATT);
+	uint32_t pwr[4] = {batt.mv, batt.min_mv, vmon_read(VMON_IGN).mv, crank_sag_mv};
+	telem_stats(TELEM_GROUP_POWER, pwr, 4);
+	entry_stats es = entry.get_stats();
+	uint32_t ent[6] = {es.unlocks, es.locks, es.limited, es.late, es.last_us, es.worst_us};
+	telem_stats(TELEM_GROUP_ENTRY, ent, 6);
+}
+
+//engine off, nobody on the start button and no door relay on, nothing the car loop does is timed
+bool car_idle(){
+	return !started && !in_obj.get_start_status() && !door_pulsing;
+}
+
 bool security_check(){
 	//key hash goes here
 	/*
@@ -96,18 +312,33 @@ bool security_check(){
 void main_car_logic() {
 	while (true) {
 		while (true) {
+			in_obj.poll();
+			deadline_checkin(DL_INPUTS);
+			uwb_update();
+			door_update();
+			send_stats();
+			if (getchar_timeout_us(0) == 'T'){ //trace2json.py --port sends this, the dump stalls the loop for its length
+				telem_pause(); //same uart, a frame going out in the middle of the dump would break both crcs
+				trace_dump();
+				telem_resume();
+			}
+			if (car_idle()){
+				settings_sync(); //a flash write parks core1 and masks interrupts, so only while the car is idle
+			}
 			if (key_connected) {
-				if (core1_obj.get_start_status()) {
+				if (in_obj.get_start_status()) {
 					start_engine();
 				} else {
-					sleep_ms(500);
+					idle_ms(500);
 				}
 			} else {
-				sleep_ms(1000);
+				idle_ms(1000);
 			}
-			if (engine_kill() == true) {
+			bool killed = engine_kill();
+			deadline_checkin(DL_OUTPUTS); //the pass has written whatever outputs it was going to
+			if (killed == true) {
 				started = 0;
-				sleep_ms(1000);
+				idle_ms(1000);
 				break;
 			}
 		}
@@ -116,10 +347,17 @@ void main_car_logic() {
 }
 
 int main() {
+#ifdef KEYLESS_UWB
+	set_sys_clock_khz(120000, true); //clk_peri / 6 gives the dw1000 exactly 20MHz spi
+#endif
 	stdio_init_all();
-	multicore_launch_core1(core1_entry);
-	uint32_t get_pin_array = core1_obj.get_input_array();
-	multicore_fifo_push_blocking(get_pin_array);
+	telem_init(); //before core1 so the radio can report from the start, the uart dma interrupt stays on core0
+	deadline_init(); //the watchdog runs from here, its tick interrupt is on core0 as well
+	deadline_reset rst = deadline_last_reset();
+	uint32_t rst_val[4] = {rst.reason, rst.task, rst.late_us, rst.uptime_ms};
+	telem_stats(TELEM_GROUP_RESET, rst_val, 4);
+	vmon_init(); //shares dma irq 1 with the telemetry uart, both on core0
+	settings_init(); //may erase a sector, before core1 runs from flash and with the watchdog fed around it
 
 	//set GPIO signal directions
 	gpio_set_dir(IN_START, GPIO_IN);
@@ -132,6 +370,9 @@ int main() {
 	gpio_set_dir(OUT_LOCK, GPIO_OUT);
 	gpio_set_dir(OUT_UNLOCK, GPIO_OUT);
 
+	// core1 brings up the radio and keeps it, core0 is left with the car
+	multicore_launch_core1(core1_entry);
+#ifndef KEYLESS_UWB
 	// SPI initialisation. This example will use SPI at 1MHz.
 	spi_init(SPI_PORT, 1000 * 1000);
 	gpio_set_function(PIN_MISO, GPIO_FUNC_SPI);
@@ -142,6 +383,9 @@ int main() {
 	// Chip select is active-low, so we'll initialise it to a driven-high state
 	gpio_set_dir(PIN_CS, GPIO_OUT);
 	gpio_put(PIN_CS, 1);
+#endif
 
+	deadline_register(DL_INPUTS, LOOP_DEADLINE_US);
+	deadline_register(DL_OUTPUTS, LOOP_DEADLINE_US);
 	main_car_logic();
 }
\ No newline at end of file
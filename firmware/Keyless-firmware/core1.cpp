@@ -7,43 +7,89 @@
 #include <vector>
 #include "pico/stdlib.h"
 #include "hardware/spi.h"
-#include "hardware/watchdog.h"
-#include "iostream"
 #include "hardware/irq.h"
 #include "pico/multicore.h"
 #include "keyless-firmware.h"
 #include "pico/stdio.h"
 #include "input.h"
 #include "output.h"
+#include "spsc_channel.h"
+#include "trace.h"
+#include "telemetry.h"
+#include "deadline.h"
+#include "settings.h"
+#ifdef KEYLESS_UWB
+#include <dpl/dpl.h>
+#include <bsp/bsp.h>
+extern "C" void dw1000_pkg_init(void);
+#endif
 using namespace std;
-bool pin_data[3];
-//input core1_obj;
-extern input core1_obj;
-
-void core1_interrupt_handler(){
-	while (multicore_fifo_rvalid()){
-		core1_obj.set_kill_status();
-		core1_obj.set_run_status();
-		core1_obj.set_start_status();
-		sleep_ms(500);
-	}
-	multicore_fifo_clear_irq();
-}
 
-void core1_entry(){
-	core1_obj.write_input_array(core1_obj.get_kill_status(), 0); //gets kill_switch status from class and adds it to vector
-	core1_obj.write_input_array(core1_obj.get_run_status(), 1); //same thing but for run_status
-	core1_obj.write_input_array(core1_obj.get_start_status(), 2); //again but with start button
+//core1 owns the dw1000 and everything on it, core0 only sees what is published here
+static spsc_channel<uwb_msg, 32> uwb_results;
+
+//longest between two ranging rounds, watched from the first round on. no RANGE producer yet, so not armed
+#define RANGING_DEADLINE_US (1000 * 1000)
+static bool ranging_watched;
 
-	multicore_fifo_clear_irq();
-	irq_set_exclusive_handler(SIO_IRQ_PROC1, core1_interrupt_handler);
-	irq_set_enabled(SIO_IRQ_PROC1, true);
+void core1_entry(){
+	//everything the radio sets up from here takes its interrupts on this core, so relay and input handling on
+	//core0 cannot push out a delayed tx, and nothing on core0 waits on the radio
+	multicore_lockout_victim_init(); //core0 parks this core in ram while it writes the settings flash
+	uwb_init();
+	settings_apply_uwb();
+	uwb_msg link = {time_us_32(), UWB_MSG_LINK, uwb_connected(), 0, 0};
+	uwb_publish(link);
+	//follow-up: the ranging and key check services start here and publish RANGE and AUTH from their callbacks
+	//on this core, see core1.h. this link message is the only thing published until then
+#ifdef KEYLESS_UWB
+	dpl_pico_task_run(); //runs the uwb interrupt task, never returns
+#endif
 	while (1){
 		tight_loop_contents();
 	}
 }
 
+void uwb_init(){
+#ifdef KEYLESS_UWB
+	hal_bsp_init(); //owns the dw1000 pins, spi, alarms and dma interrupts from here
+	dw1000_pkg_init(); //registers the interrupt task core1 runs
+#if MYNEWT_VAL(DPL_PICO_SPI_BENCH)
+	hal_bsp_spi_bench();
+#endif
+#endif
+}
+
 bool uwb_connected(){
-	//dw_main();
+#ifdef KEYLESS_UWB
+	return dpl_task_count() != 0; //the task is only registered once the dw1000 answered
+#else
 	return true;
+#endif
+}
+
+bool uwb_publish(const uwb_msg &msg){
+	TRACE_INSTANT(TRACE_UWB_PUB, msg.type << 8 | msg.ok);
+	if (msg.type == UWB_MSG_RANGE){
+		telem_range(msg.key_id, msg.value, 0);
+		if (ranging_watched){
+			deadline_checkin(DL_RANGING);
+		}
+		else {
+			deadline_register(DL_RANGING, RANGING_DEADLINE_US);
+			ranging_watched = true;
+		}
+	}
+	else if (msg.type == UWB_MSG_LINK){
+		telem_state(TELEM_SM_LINK, !msg.ok, msg.ok, 0);
+	}
+	return uwb_results.push(msg);
+}
+
+bool uwb_poll(uwb_msg &msg){
+	return uwb_results.pop(msg);
+}
+
+uint32_t uwb_dropped(){
+	return uwb_results.get_dropped();
 }
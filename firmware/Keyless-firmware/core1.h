@@ -5,7 +5,32 @@
 #ifndef KEYLESS_FIRMWARE_CORE1_H
 #include "input.h"
 using namespace std;
+
+//what core1 reports to the car logic on core0
+//follow-up work: only LINK has a producer. the RANGE and AUTH producers, a ranging service on uwb_rng (not in the
+//pico build yet) and a key check (no key material yet), are still to be written, and with them the entry
+//integration. until then the channel, uwb_update and the entry controller are wired but only see LINK, entry
+//never has an authenticated key in range so the doors stay locked, and DL_RANGING is never armed
+enum uwb_msg_type : uint8_t {
+	UWB_MSG_LINK, //ok set once the dw1000 answered, cleared if it stops
+	UWB_MSG_RANGE, //value is the distance to key_id in mm
+	UWB_MSG_AUTH, //ok is the result of authenticating key_id
+};
+
+struct uwb_msg {
+	uint32_t time_us; //when core1 had the result
+	uwb_msg_type type;
+	bool ok;
+	uint16_t key_id;
+	int32_t value;
+};
+
 void core1_entry();
+void uwb_init();
+bool uwb_connected();
+bool uwb_publish(const uwb_msg &msg); //core1 only
+bool uwb_poll(uwb_msg &msg); //core0 only
+uint32_t uwb_dropped();
 
 
 #define KEYLESS_FIRMWARE_CORE1_H
@@ -0,0 +1,134 @@
+//
+// Created by Jeremy King on 10/18/21.
+//
+
+#include "deadline.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "hardware/watchdog.h"
+#include "hardware/structs/watchdog.h"
+
+//scratch 0 holds magic | reason << 8 | task, 1 the lateness, 2 the uptime. 4-7 belong to the bootrom
+#define DEADLINE_MAGIC 0x444c0000u
+#define DEADLINE_MAGIC_MASK 0xffff0000u
+
+struct deadline_slot {
+	volatile uint32_t period_us;
+	volatile uint32_t last_us; //written by the task's core, read by the tick on core0
+	volatile uint32_t seq; //odd while stats is being written, readers on the other core retry over it
+	deadline_stats stats; //only written by the task's core
+};
+
+static void stats_write_begin(deadline_slot &s){
+	s.seq = s.seq + 1;
+	__dmb();
+}
+
+static void stats_write_end(deadline_slot &s){
+	__dmb();
+	s.seq = s.seq + 1;
+}
+
+static deadline_slot slots[DL_NUM_TASKS];
+static repeating_timer_t deadline_timer;
+static deadline_reset last_reset;
+
+//runs from the alarm interrupt on core0, so it still gets to run when the car loop is stuck
+static bool deadline_tick(repeating_timer_t *rt){
+	uint32_t now = time_us_32();
+	uint32_t uptime = to_ms_since_boot(get_absolute_time());
+
+	for (int i = 0; i < DL_NUM_TASKS; i++){
+		uint32_t period = slots[i].period_us;
+		//signed, a check in on core1 after now was read would otherwise look 71 minutes late
+		int32_t late = (int32_t)(now - slots[i].last_us) - (int32_t)period;
+		if (period && late > 0){
+			watchdog_hw->scratch[0] = DEADLINE_MAGIC | DL_RESET_DEADLINE << 8 | i;
+			watchdog_hw->scratch[1] = late;
+			watchdog_hw->scratch[2] = uptime;
+			watchdog_reboot(0, 0, 0);
+			while (1){
+				tight_loop_contents();
+			}
+		}
+	}
+	watchdog_hw->scratch[2] = uptime; //so a reset by the backstop still says how long the boot ran
+	watchdog_update();
+	return true;
+}
+
+void deadline_init(){
+	uint32_t tag = watchdog_hw->scratch[0];
+
+	if (!watchdog_caused_reboot()){
+		last_reset = {DL_RESET_POWER, 0, 0, 0};
+	}
+	else if ((tag & DEADLINE_MAGIC_MASK) == DEADLINE_MAGIC){
+		last_reset = {(deadline_reason)((tag >> 8) & 0xff), (uint8_t)(tag & 0xff), watchdog_hw->scratch[1],
+			watchdog_hw->scratch[2]};
+	}
+	else {
+		last_reset = {DL_RESET_WATCHDOG, 0, 0, watchdog_hw->scratch[2]};
+	}
+	watchdog_hw->scratch[0] = 0;
+	watchdog_hw->scratch[2] = 0;
+
+	//negative, the tick is every 50ms from start to start however long the last one took
+	add_repeating_timer_ms(-DEADLINE_TICK_MS, deadline_tick, nullptr, &deadline_timer);
+	watchdog_enable(DEADLINE_WATCHDOG_MS, true); //paused while a debugger holds the cores
+}
+
+void deadline_register(deadline_task task, uint32_t period_us){
+	deadline_slot &s = slots[task];
+	s.period_us = 0; //not looked at while it is being set up
+	stats_write_begin(s);
+	s.stats = {period_us, 0, 0, 0};
+	stats_write_end(s);
+	s.last_us = time_us_32();
+	s.period_us = period_us;
+}
+
+void deadline_checkin(deadline_task task){
+	deadline_slot &s = slots[task];
+	uint32_t now = time_us_32();
+	uint32_t gap = now - s.last_us;
+
+	s.last_us = now;
+	if (!s.period_us){
+		return;
+	}
+	stats_write_begin(s);
+	if (s.stats.count++ == 0){
+		s.stats.mean_us = gap;
+	}
+	else {
+		s.stats.mean_us += ((int32_t)gap - (int32_t)s.stats.mean_us) / 16;
+	}
+	if (gap > s.stats.worst_us){
+		s.stats.worst_us = gap;
+	}
+	stats_write_end(s);
+}
+
+//a copy the task's core did not write into halfway, the check in is a few words so the retry is short
+//not from an interrupt that can land inside a check in on the same core, it would wait on itself
+deadline_stats deadline_get_stats(deadline_task task){
+	deadline_slot &s = slots[task];
+	deadline_stats st;
+	uint32_t seq;
+
+	do {
+		while ((seq = s.seq) & 1){
+			tight_loop_contents();
+		}
+		__dmb();
+		st = s.stats;
+		__dmb();
+	} while (s.seq != seq);
+	st.period_us = s.period_us;
+	return st;
+}
+
+deadline_reset deadline_last_reset(){
+	return last_reset;
+}
@@ -0,0 +1,51 @@
+//
+// Created by Jeremy King on 10/18/21.
+//
+
+#ifndef KEYLESS_FIRMWARE_DEADLINE_H
+#define KEYLESS_FIRMWARE_DEADLINE_H
+//deadline monitor on the hardware watchdog. each periodic task registers how long it may go between check ins,
+//a timer interrupt on core0 looks at all of them every DEADLINE_TICK_MS and only feeds the watchdog while none is
+//late. a late task gets its id and lateness written to the watchdog scratch registers and the chip rebooted, if
+//the timer interrupt itself stops the watchdog runs out on its own
+#include <stdint.h>
+
+#define DEADLINE_TICK_MS 50
+#define DEADLINE_WATCHDOG_MS 500 //backstop when the tick stops, interrupts masked for good or a hard fault
+
+enum deadline_task : uint8_t {
+	DL_INPUTS, //input scan on core0
+	DL_RANGING, //ranging round on core1, a round checks in whether or not the key answered
+	DL_OUTPUTS, //output commit on core0
+	DL_NUM_TASKS,
+};
+
+//why the last reset happened, kept over the reboot in watchdog scratch 0-3
+enum deadline_reason : uint8_t {
+	DL_RESET_POWER, //power on or the run pin, not the watchdog
+	DL_RESET_DEADLINE, //a task missed its deadline, task and late_us say which and by how much
+	DL_RESET_WATCHDOG, //the watchdog ran out without the monitor asking for it
+};
+
+struct deadline_reset {
+	deadline_reason reason;
+	uint8_t task;
+	uint32_t late_us; //time past the deadline when it was caught
+	uint32_t uptime_ms; //how long the previous boot ran
+};
+
+struct deadline_stats {
+	uint32_t period_us; //0 while the task is not watched
+	uint32_t count; //check ins since it was registered
+	uint32_t worst_us; //longest time between two check ins
+	uint32_t mean_us; //running mean of it, 1/16 weight per check in
+};
+
+void deadline_init(); //arms the watchdog, call once on core0 before registering
+void deadline_register(deadline_task task, uint32_t period_us); //0 stops watching the task
+void deadline_checkin(deadline_task task); //from the core the task runs on
+deadline_stats deadline_get_stats(deadline_task task);
+deadline_reset deadline_last_reset();
+
+
+#endif //KEYLESS_FIRMWARE_DEADLINE_H
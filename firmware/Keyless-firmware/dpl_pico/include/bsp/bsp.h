@@ -0,0 +1,52 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/**
+ * @file bsp.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief Keyless board support for the uwb stack
+ *
+ * @details hal_bsp_init sets up the dpl alarms and the DW1000 SPI and creates the dw1000_0 device with the pins from
+ * dpl_pico/syscfg.yml, the mynewt BSPs do the same from their hal_bsp_init. dw1000_pkg_init configures it after.
+ * With DPL_PICO_LAT_REPORT_MS the event latencies of dw1000_0 go out as telemetry periodically. hal_bsp_spi_bench
+ * compares polled and DMA reads once the device is configured.
+ */
+
+#ifndef _BSP_BSP_H_
+#define _BSP_BSP_H_
+
+#include <stdint.h>
+#include <syscfg/syscfg.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void hal_bsp_init(void);
+#if MYNEWT_VAL(DPL_PICO_SPI_BENCH)
+void hal_bsp_spi_bench(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _BSP_BSP_H_ */
@@ -0,0 +1,39 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/**
+ * @file dpl.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief Default porting layer of the pico port
+ *
+ * @details Everything the drivers include through dpl/dpl.h on the other platforms.
+ */
+
+#ifndef _DPL_H_
+#define _DPL_H_
+
+#include <syscfg/syscfg.h>
+#include <dpl/dpl_types.h>
+#include <dpl/dpl_os.h>
+#include <dpl/dpl_cputime.h>
+#include <os/os_dev.h>
+
+#endif /* _DPL_H_ */
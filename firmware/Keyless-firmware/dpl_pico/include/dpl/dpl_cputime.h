@@ -0,0 +1,91 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/**
+ * @file dpl_cputime.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief cputime of the pico port
+ *
+ * @details cputime is the low 32 bits of the 1MHz timer, so ticks and usecs are the same. Timers are pico
+ * alarms from the default alarm pool, their callbacks run in interrupt context like the mynewt hal timers.
+ */
+
+#ifndef _DPL_CPUTIME_H_
+#define _DPL_CPUTIME_H_
+
+#include <syscfg/syscfg.h>
+#include <dpl/dpl_types.h>
+#include <hal/hal_timer.h>
+#include "hardware/timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if MYNEWT_VAL(OS_CPUTIME_FREQ) != 1000000
+#error "OS_CPUTIME_FREQ must be 1000000, cputime is read from the 1MHz timer"
+#endif
+
+#define CPUTIME_LT(__t1, __t2) ((int32_t)((__t1) - (__t2)) < 0)
+#define CPUTIME_GT(__t1, __t2) ((int32_t)((__t1) - (__t2)) > 0)
+#define CPUTIME_GEQ(__t1, __t2) ((int32_t)((__t1) - (__t2)) >= 0)
+#define CPUTIME_LEQ(__t1, __t2) ((int32_t)((__t1) - (__t2)) <= 0)
+
+static inline uint32_t
+dpl_cputime_get32(void)
+{
+    return time_us_32();
+}
+
+static inline uint32_t
+dpl_cputime_usecs_to_ticks(uint32_t usecs)
+{
+    return usecs;
+}
+
+static inline uint32_t
+dpl_cputime_ticks_to_usecs(uint32_t ticks)
+{
+    return ticks;
+}
+
+static inline void
+dpl_cputime_delay_ticks(uint32_t ticks)
+{
+    busy_wait_us_32(ticks);
+}
+
+static inline void
+dpl_cputime_delay_usecs(uint32_t usecs)
+{
+    busy_wait_us_32(usecs);
+}
+
+void dpl_cputime_timer_init(struct hal_timer *timer, hal_timer_cb fp, void *arg);
+int dpl_cputime_timer_start(struct hal_timer *timer, uint32_t cputime);
+int dpl_cputime_timer_relative(struct hal_timer *timer, uint32_t usecs);
+void dpl_cputime_timer_stop(struct hal_timer *timer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DPL_CPUTIME_H_ */
@@ -0,0 +1,249 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/**
+ * @file dpl_os.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief OS abstraction of the pico port
+ *
+ * @details Semaphores and mutexes are the pico-sdk ones. Critical sections disable interrupts on the calling
+ * core and hold a spinlock against the other, they nest per core. Event queues are lists under the critical
+ * section, a put sends an event to wake a core waiting in dpl_eventq_get. Callouts fire from pico alarms and put
+ * their event on the queue they were initialised with. Tasks registered with dpl_task_init run on core1, one
+ * after the other from dpl_pico_task_run, so the uwb interrupt task gets a core of its own. dpl_pico_init gives
+ * the callouts and cputime timers an alarm pool whose interrupt is taken by the core that calls it.
+ */
+
+#ifndef _DPL_OS_H_
+#define _DPL_OS_H_
+
+#include <sys/queue.h>
+#include <syscfg/syscfg.h>
+#include <dpl/dpl_types.h>
+#include "pico/sem.h"
+#include "pico/mutex.h"
+#include "pico/time.h"
+#include "trace.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef ARRAY_SIZE
+#define ARRAY_SIZE(array) (sizeof(array) / sizeof((array)[0]))
+#endif
+
+#define DPL_ENTER_CRITICAL(_sr) ((_sr) = dpl_pico_enter_critical())
+#define DPL_EXIT_CRITICAL(_sr) (dpl_pico_exit_critical(_sr))
+
+os_sr_t dpl_pico_enter_critical(void);
+void dpl_pico_exit_critical(os_sr_t sr);
+void dpl_pico_init(void);
+alarm_pool_t *dpl_pico_alarm_pool(void);
+
+/*
+ * Semaphores and mutexes
+ */
+struct dpl_sem {
+    semaphore_t sem;
+};
+
+struct dpl_mutex {
+    recursive_mutex_t mu;
+};
+
+dpl_error_t dpl_sem_init(struct dpl_sem *sem, uint16_t tokens);
+dpl_error_t dpl_sem_pend(struct dpl_sem *sem, dpl_time_t timeout);
+dpl_error_t dpl_sem_release(struct dpl_sem *sem);
+uint16_t dpl_sem_get_count(struct dpl_sem *sem);
+
+dpl_error_t dpl_mutex_init(struct dpl_mutex *mu);
+dpl_error_t dpl_mutex_pend(struct dpl_mutex *mu, dpl_time_t timeout);
+dpl_error_t dpl_mutex_release(struct dpl_mutex *mu);
+
+/*
+ * Events and event queues
+ */
+struct dpl_event;
+typedef void dpl_event_fn(struct dpl_event *ev);
+
+struct dpl_event {
+    dpl_event_fn *ev_cb;
+    void *ev_arg;
+    bool ev_queued;
+    uint32_t ev_put;                    //!< cputime of the put, for the queue latency
+    struct dpl_event *ev_next;
+};
+
+//! Event put to handler latency, bin n counts latencies below 2^n us
+struct dpl_eventq_lat {
+    uint32_t n;
+    uint32_t max;
+    uint32_t bin[MYNEWT_VAL(DPL_PICO_EVENTQ_LAT_BINS)];
+};
+
+struct dpl_eventq {
+    struct dpl_event *evq_head;
+    struct dpl_event *evq_tail;
+    bool evq_inited;
+    struct dpl_eventq_lat lat;
+};
+
+static inline void
+dpl_event_init(struct dpl_event *ev, dpl_event_fn *fn, void *arg)
+{
+    ev->ev_cb = fn;
+    ev->ev_arg = arg;
+    ev->ev_queued = false;
+    ev->ev_next = NULL;
+}
+
+static inline bool
+dpl_event_is_queued(struct dpl_event *ev)
+{
+    return ev->ev_queued;
+}
+
+static inline void *
+dpl_event_get_arg(struct dpl_event *ev)
+{
+    return ev->ev_arg;
+}
+
+static inline void
+dpl_event_set_arg(struct dpl_event *ev, void *arg)
+{
+    ev->ev_arg = arg;
+}
+
+static inline void
+dpl_event_run(struct dpl_event *ev)
+{
+    TRACE_BEGIN(TRACE_DPL_EVENT, (uintptr_t)ev->ev_cb); /* low half of the handler address */
+    ev->ev_cb(ev);
+    TRACE_END(TRACE_DPL_EVENT, (uintptr_t)ev->ev_cb);
+}
+
+static inline bool
+dpl_eventq_inited(struct dpl_eventq *evq)
+{
+    return evq->evq_inited;
+}
+
+void dpl_eventq_init(struct dpl_eventq *evq);
+void dpl_eventq_deinit(struct dpl_eventq *evq);
+void dpl_eventq_put(struct dpl_eventq *evq, struct dpl_event *ev);
+void dpl_eventq_remove(struct dpl_eventq *evq, struct dpl_event *ev);
+struct dpl_event *dpl_eventq_get(struct dpl_eventq *evq);
+struct dpl_event *dpl_eventq_get_no_wait(struct dpl_eventq *evq);
+void dpl_eventq_run(struct dpl_eventq *evq);
+bool dpl_eventq_is_empty(struct dpl_eventq *evq);
+struct dpl_eventq *dpl_eventq_dflt_get(void);
+void dpl_eventq_lat_clear(struct dpl_eventq *evq);
+
+/*
+ * Callouts
+ */
+struct dpl_callout {
+    struct dpl_event c_ev;
+    struct dpl_eventq *c_evq;
+    alarm_id_t c_alarm;                 //!< Pending alarm, 0 when not armed
+    uint32_t c_ticks;                   //!< Expiry in dpl ticks
+};
+
+void dpl_callout_init(struct dpl_callout *co, struct dpl_eventq *evq, dpl_event_fn *ev_cb, void *ev_arg);
+dpl_error_t dpl_callout_reset(struct dpl_callout *co, dpl_time_t ticks);
+void dpl_callout_stop(struct dpl_callout *co);
+bool dpl_callout_is_active(struct dpl_callout *co);
+dpl_time_t dpl_callout_get_ticks(struct dpl_callout *co);
+dpl_time_t dpl_callout_remaining_ticks(struct dpl_callout *co, dpl_time_t time);
+
+static inline void
+dpl_callout_set_arg(struct dpl_callout *co, void *arg)
+{
+    co->c_ev.ev_arg = arg;
+}
+
+/*
+ * Tasks
+ */
+typedef void *(*dpl_task_func_t)(void *);
+
+struct dpl_task {
+    const char *t_name;
+    dpl_task_func_t t_func;
+    void *t_arg;
+    uint8_t t_prio;
+};
+
+int dpl_task_init(struct dpl_task *t, const char *name, dpl_task_func_t func, void *arg, uint8_t prio,
+                  dpl_time_t sanity_itvl, dpl_stack_t *stack_bottom, uint16_t stack_size);
+int dpl_task_remove(struct dpl_task *t);
+uint8_t dpl_task_count(void);
+void *dpl_get_current_task_id(void);
+void dpl_pico_task_run(void);
+
+/*
+ * Time
+ */
+static inline dpl_time_t
+dpl_time_get(void)
+{
+    return to_ms_since_boot(get_absolute_time());
+}
+
+static inline dpl_error_t
+dpl_time_ms_to_ticks(uint32_t ms, dpl_time_t *out_ticks)
+{
+    *out_ticks = ms;
+    return DPL_OK;
+}
+
+static inline dpl_error_t
+dpl_time_ticks_to_ms(dpl_time_t ticks, uint32_t *out_ms)
+{
+    *out_ms = ticks;
+    return DPL_OK;
+}
+
+static inline dpl_time_t
+dpl_time_ms_to_ticks32(uint32_t ms)
+{
+    return ms;
+}
+
+static inline uint32_t
+dpl_time_ticks_to_ms32(dpl_time_t ticks)
+{
+    return ticks;
+}
+
+static inline void
+dpl_time_delay(dpl_time_t ticks)
+{
+    sleep_ms(ticks);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DPL_OS_H_ */
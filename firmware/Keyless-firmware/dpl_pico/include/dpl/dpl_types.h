@@ -0,0 +1,111 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dpl_types.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief DPL types for the pico port
+ *
+ * @details Error codes follow the mynewt OS_ codes. Time is kept in ms ticks, cputime in us from the 1MHz timer.
+ */
+
+#ifndef _DPL_TYPES_H_
+#define _DPL_TYPES_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum dpl_error {
+    DPL_OK = 0,
+    DPL_ENOMEM = 1,
+    DPL_EINVAL = 2,
+    DPL_INVALID_PARAM = 3,
+    DPL_MEM_NOT_ALIGNED = 4,
+    DPL_BAD_MUTEX = 5,
+    DPL_TIMEOUT = 6,
+    DPL_ERR_IN_ISR = 7,
+    DPL_ERR_PRIV = 8,
+    DPL_OS_NOT_STARTED = 9,
+    DPL_ENOENT = 10,
+    DPL_EBUSY = 11,
+    DPL_ERROR = 12,
+} dpl_error_t;
+
+typedef uint32_t dpl_time_t;        //!< ms
+typedef int32_t dpl_stime_t;
+typedef uint32_t dpl_stack_t;
+typedef uint32_t os_sr_t;
+
+#define DPL_TICKS_PER_SEC       (1000)
+#define DPL_TIMEOUT_NEVER       (UINT32_MAX)
+#define DPL_WAIT_FOREVER        (DPL_TIMEOUT_NEVER)
+
+typedef float dpl_float32_t;
+typedef double dpl_float64_t;
+
+#define DPL_FLOAT32_INIT(__X) ((float)__X)
+#define DPL_FLOAT64_INIT(__X) ((double)__X)
+#define DPL_FLOAT64TO32(__X) (float)(__X)
+#define DPL_FLOAT32_I32_TO_F32(__X) (float)(__X)
+#define DPL_FLOAT64_I32_TO_F64(__X) ((double)(__X))
+#define DPL_FLOAT64_I64_TO_F64(__X) ((double)(__X))
+#define DPL_FLOAT64_U64_TO_F64(__X) ((double)(__X))
+#define DPL_FLOAT64_F64_TO_U64(__X) ((uint64_t)(__X))
+#define DPL_FLOAT32_INT(__X) ((int)__X)
+#define DPL_FLOAT64_INT(__X) ((int64_t)__X)
+#define DPL_FLOAT64_FROM_F32(__X) (double)(__X)
+#define DPL_FLOAT32_FROM_F64(__X) (float)(__X)
+#define DPL_FLOAT32_CEIL(__X) (ceilf(__X))
+#define DPL_FLOAT64_CEIL(__X) (ceil(__X))
+#define DPL_FLOAT32_FABS(__X) fabsf(__X)
+#define DPL_FLOAT64_FABS(__X) fabs(__X)
+#define DPL_FLOAT32_FMOD(__X, __Y) fmodf(__X, __Y)
+#define DPL_FLOAT64_FMOD(__X, __Y) fmod(__X, __Y)
+#define DPL_FLOAT32_NAN() nanf("")
+#define DPL_FLOAT64_NAN() nan("")
+#define DPL_FLOAT32_ISNAN(__X) isnan(__X)
+#define DPL_FLOAT64_ISNAN(__X) isnan(__X)
+#define DPL_FLOAT64_LOG10(__X) (log10(__X))
+#define DPL_FLOAT64_ASIN(__X) asin(__X)
+#define DPL_FLOAT64_ATAN(__X) atan(__X)
+#define DPL_FLOAT32_SUB(__X, __Y) ((__X)-(__Y))
+#define DPL_FLOAT64_SUB(__X, __Y) ((__X)-(__Y))
+#define DPL_FLOAT32_ADD(__X, __Y) ((__X)+(__Y))
+#define DPL_FLOAT64_ADD(__X, __Y) ((__X)+(__Y))
+#define DPL_FLOAT32_MUL(__X, __Y) ((__X)*(__Y))
+#define DPL_FLOAT64_MUL(__X, __Y) ((__X)*(__Y))
+#define DPL_FLOAT32_DIV(__X, __Y) ((__X)/(__Y))
+#define DPL_FLOAT64_DIV(__X, __Y) ((__X)/(__Y))
+#define DPL_FLOAT32_PRINTF_PRIM "%s%d.%03d"
+#define DPL_FLOAT32_PRINTF_VALS(__X) (__X)<0?"-":"", (int)(fabsf(__X)), (int)(fabsf((__X)-(int)(__X))*1000)
+#define DPL_FLOAT64_PRINTF_PRIM "%s%d.%06d"
+#define DPL_FLOAT64_PRINTF_VALS(__X) (__X)<0?"-":"", (int)(fabs(__X)), (int)(fabs((__X)-(int)(__X))*1000000)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DPL_TYPES_H_ */
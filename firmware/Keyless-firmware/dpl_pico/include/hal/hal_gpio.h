@@ -0,0 +1,72 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/**
+ * @file hal_gpio.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief GPIO hal of the pico port
+ *
+ * @details Pin interrupts share the one pico-sdk gpio callback of the core that enables them first, handlers are
+ * looked up per pin from there.
+ */
+
+#ifndef _HAL_HAL_GPIO_H_
+#define _HAL_HAL_GPIO_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum hal_gpio_pull {
+    HAL_GPIO_PULL_NONE = 0,
+    HAL_GPIO_PULL_UP = 1,
+    HAL_GPIO_PULL_DOWN = 2
+};
+typedef enum hal_gpio_pull hal_gpio_pull_t;
+
+enum hal_gpio_irq_trigger {
+    HAL_GPIO_TRIG_NONE = 0,
+    HAL_GPIO_TRIG_RISING = 1,
+    HAL_GPIO_TRIG_FALLING = 2,
+    HAL_GPIO_TRIG_BOTH = 3,
+    HAL_GPIO_TRIG_LOW = 4,
+    HAL_GPIO_TRIG_HIGH = 5
+};
+typedef enum hal_gpio_irq_trigger hal_gpio_irq_trig_t;
+
+typedef void (*hal_gpio_irq_handler_t)(void *arg);
+
+int hal_gpio_init_in(int pin, hal_gpio_pull_t pull);
+int hal_gpio_init_out(int pin, int val);
+void hal_gpio_write(int pin, int val);
+int hal_gpio_read(int pin);
+int hal_gpio_toggle(int pin);
+int hal_gpio_irq_init(int pin, hal_gpio_irq_handler_t handler, void *arg, hal_gpio_irq_trig_t trig,
+                      hal_gpio_pull_t pull);
+void hal_gpio_irq_release(int pin);
+void hal_gpio_irq_enable(int pin);
+void hal_gpio_irq_disable(int pin);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HAL_HAL_GPIO_H_ */
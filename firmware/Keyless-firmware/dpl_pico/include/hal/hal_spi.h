@@ -0,0 +1,87 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/**
+ * @file hal_spi.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief SPI hal of the pico port
+ *
+ * @details The mynewt SPI hal on the pico-sdk hardware_spi, master only. Blocking transfers are polled,
+ * nonblocking ones run on a pair of DMA channels and call the txrx callback from the DMA interrupt.
+ * The chip select is left to the caller as a gpio. With DPL_PICO_DW1000_PIO the same calls run on a PIO
+ * state machine instead, which drives the chip select around every transfer.
+ */
+
+#ifndef _HAL_HAL_SPI_H_
+#define _HAL_HAL_SPI_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HAL_SPI_TYPE_MASTER         (0)
+#define HAL_SPI_TYPE_SLAVE          (1)
+
+#define HAL_SPI_MODE0               (0)
+#define HAL_SPI_MODE1               (1)
+#define HAL_SPI_MODE2               (2)
+#define HAL_SPI_MODE3               (3)
+
+#define HAL_SPI_MSB_FIRST           (0)
+#define HAL_SPI_LSB_FIRST           (1)
+
+#define HAL_SPI_WORD_SIZE_8BIT      (0)
+#define HAL_SPI_WORD_SIZE_9BIT      (1)
+
+typedef void (*hal_spi_txrx_cb)(void *arg, int len);
+
+struct hal_spi_settings {
+    uint8_t data_mode;
+    uint8_t data_order;
+    uint8_t word_size;
+    uint32_t baudrate;                  //!< kHz
+};
+
+//! Pins of an SPI block, passed to hal_spi_init
+struct hal_spi_pico_cfg {
+    uint8_t pin_miso;
+    uint8_t pin_sck;
+    uint8_t pin_mosi;
+    uint8_t pin_ss;                     //!< Only used on PIO, where it has to be pin_sck - 1
+};
+
+int hal_spi_init(int spi_num, void *cfg, uint8_t spi_type);
+int hal_spi_config(int spi_num, struct hal_spi_settings *psettings);
+int hal_spi_set_txrx_cb(int spi_num, hal_spi_txrx_cb txrx_cb, void *arg);
+int hal_spi_enable(int spi_num);
+int hal_spi_disable(int spi_num);
+uint16_t hal_spi_tx_val(int spi_num, uint16_t val);
+int hal_spi_txrx(int spi_num, void *txbuf, void *rxbuf, int cnt);
+int hal_spi_txrx_noblock(int spi_num, void *txbuf, void *rxbuf, int cnt);
+int hal_spi_abort(int spi_num);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HAL_HAL_SPI_H_ */
@@ -0,0 +1,53 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/**
+ * @file hal_timer.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief hal timer of the pico port
+ *
+ * @details Only the timer structure, started and stopped through dpl_cputime_timer_*.
+ */
+
+#ifndef _HAL_HAL_TIMER_H_
+#define _HAL_HAL_TIMER_H_
+
+#include <stdint.h>
+#include "pico/time.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*hal_timer_cb)(void *arg);
+
+struct hal_timer {
+    hal_timer_cb cb_func;
+    void *cb_arg;
+    alarm_id_t alarm;                   //!< Pending alarm, 0 when stopped
+    uint32_t expiry;                    //!< cputime
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HAL_HAL_TIMER_H_ */
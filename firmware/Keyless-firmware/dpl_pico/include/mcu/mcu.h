@@ -0,0 +1,34 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file mcu.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief RP2040 mcu header
+ *
+ * @details Present for the drivers that include it, the pico-sdk headers are used directly.
+ */
+
+#ifndef _MCU_MCU_H_
+#define _MCU_MCU_H_
+
+#include "hardware/regs/addressmap.h"
+
+#endif /* _MCU_MCU_H_ */
@@ -0,0 +1,40 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/**
+ * @file os.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief mynewt os names of the pico port
+ *
+ * @details For the code that uses the os_ names directly.
+ */
+
+#ifndef _OS_OS_H_
+#define _OS_OS_H_
+
+#include <dpl/dpl.h>
+
+#define OS_ENTER_CRITICAL(_sr) DPL_ENTER_CRITICAL(_sr)
+#define OS_EXIT_CRITICAL(_sr) DPL_EXIT_CRITICAL(_sr)
+#define OS_TICKS_PER_SEC DPL_TICKS_PER_SEC
+#define OS_OK DPL_OK
+
+#endif /* _OS_OS_H_ */
@@ -0,0 +1,86 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/**
+ * @file os_dev.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief Device registry of the pico port
+ *
+ * @details There are no init stages without the mynewt sysinit, os_dev_create runs the init function straight
+ * away and only registers the device when it succeeds.
+ */
+
+#ifndef _OS_OS_DEV_H_
+#define _OS_OS_DEV_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OS_DEV_INIT_PRIMARY         (1)
+#define OS_DEV_INIT_SECONDARY       (2)
+#define OS_DEV_INIT_KERNEL          (3)
+
+#define OS_DEV_INIT_PRIO_DEFAULT    (0xff)
+
+#define OS_DEV_F_STATUS_READY       (1 << 0)
+#define OS_DEV_F_STATUS_OPEN        (1 << 1)
+
+struct os_dev;
+
+typedef int (*os_dev_init_func_t)(struct os_dev *, void *);
+typedef int (*os_dev_open_func_t)(struct os_dev *, uint32_t, void *);
+typedef int (*os_dev_close_func_t)(struct os_dev *);
+
+struct os_dev_handlers {
+    os_dev_open_func_t od_open;
+    os_dev_close_func_t od_close;
+};
+
+struct os_dev {
+    struct os_dev_handlers od_handlers;
+    os_dev_init_func_t od_init;
+    void *od_init_arg;
+    uint8_t od_stage;
+    uint8_t od_priority;
+    uint8_t od_open_ref;
+    uint8_t od_flags;
+    const char *od_name;
+    struct os_dev *od_next;
+};
+
+#define OS_DEV_SETHANDLERS(__dev, __open, __close)          \
+    (__dev)->od_handlers.od_open = (__open);                \
+    (__dev)->od_handlers.od_close = (__close);
+
+int os_dev_create(struct os_dev *dev, const char *name, uint8_t stage, uint8_t priority,
+                  os_dev_init_func_t od_init, void *arg);
+struct os_dev *os_dev_lookup(const char *name);
+struct os_dev *os_dev_open(const char *devname, uint32_t timo, void *arg);
+int os_dev_close(struct os_dev *dev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _OS_OS_DEV_H_ */
@@ -0,0 +1,97 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/**
+ * @file stats.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief Statistics of the pico port
+ *
+ * @details The mynewt stats macros. Sections are plain structs of 32 bit counters with a header, registered by
+ * name so they can be found and printed, names are always kept.
+ */
+
+#ifndef _STATS_STATS_H_
+#define _STATS_STATS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct stats_name_map {
+    uint16_t snm_off;
+    const char *snm_name;
+};
+
+struct stats_hdr {
+    const char *s_name;
+    uint8_t s_size;
+    uint8_t s_cnt;
+    uint16_t s_pad1;
+    const struct stats_name_map *s_map;
+    int s_map_cnt;
+    struct stats_hdr *s_next;
+};
+
+#define STATS_SECT_DECL(__name) struct stats_ ## __name
+#define STATS_SECT_START(__name) STATS_SECT_DECL(__name) { struct stats_hdr s_hdr;
+#define STATS_SECT_END };
+#define STATS_SECT_ENTRY(__var) uint32_t __var;
+#define STATS_SECT_ENTRY32(__var) uint32_t __var;
+#define STATS_SECT_VAR(__var) __var
+
+#define STATS_HDR(__sectname) &(__sectname).s_hdr
+
+#define STATS_SIZE_32 (sizeof(uint32_t))
+#define STATS_SIZE_INIT_PARMS(__sectvarname, __size)                        \
+    (__size), ((sizeof(__sectvarname)) - sizeof((__sectvarname).s_hdr)) / (__size)
+
+#define STATS_INCN(__sectvarname, __var, __n) ((__sectvarname).STATS_SECT_VAR(__var) += (__n))
+#define STATS_INC(__sectvarname, __var) STATS_INCN(__sectvarname, __var, 1)
+#define STATS_SET(__sectvarname, __var, __val) ((__sectvarname).STATS_SECT_VAR(__var) = (__val))
+#define STATS_CLEAR(__sectvarname, __var) ((__sectvarname).STATS_SECT_VAR(__var) = 0)
+
+#define STATS_NAME_START(__name) static const struct stats_name_map g_stats_map_ ## __name[] = {
+#define STATS_NAME(__name, __entry) { offsetof(STATS_SECT_DECL(__name), __entry), #__entry },
+#define STATS_NAME_END(__name) };
+#define STATS_NAME_INIT_PARMS(__name)                                       \
+    &(g_stats_map_ ## __name[0]),                                           \
+    (sizeof(g_stats_map_ ## __name) / sizeof(struct stats_name_map))
+
+int stats_init(struct stats_hdr *shdr, uint8_t size, uint8_t cnt, const struct stats_name_map *map,
+               uint8_t map_cnt);
+int stats_register(const char *name, struct stats_hdr *shdr);
+int stats_init_and_reg(struct stats_hdr *shdr, uint8_t size, uint8_t cnt, const struct stats_name_map *map,
+                       uint8_t map_cnt, const char *name);
+int stats_deregister(struct stats_hdr *shdr);
+void stats_reset(struct stats_hdr *shdr);
+struct stats_hdr *stats_group_find(const char *name);
+
+typedef int (*stats_walk_func_t)(struct stats_hdr *, void *, const char *, uint16_t);
+int stats_walk(struct stats_hdr *shdr, stats_walk_func_t walk_cb, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _STATS_STATS_H_ */
@@ -0,0 +1,37 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file syscfg.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief Syscfg values for the pico build
+ *
+ * @details Settings come from syscfg_gen.h, which CMake generates from the syscfg.yml files of the packages in
+ * the build and dpl_pico/syscfg.yml.
+ */
+
+#ifndef _SYSCFG_SYSCFG_H_
+#define _SYSCFG_SYSCFG_H_
+
+#include "syscfg/syscfg_gen.h"
+
+#define MYNEWT_VAL(_name) MYNEWT_VAL_ ## _name
+
+#endif /* _SYSCFG_SYSCFG_H_ */
@@ -0,0 +1,248 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/**
+ * @file bsp_pico.c
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief Keyless board support for the uwb stack
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include <dpl/dpl.h>
+#include <hal/hal_spi.h>
+#include <bsp/bsp.h>
+#include <hal/hal_gpio.h>
+#include <dw1000/dw1000_dev.h>
+#include <dw1000/dw1000_hal.h>
+#if MYNEWT_VAL(DPL_PICO_SPI_BENCH)
+#include "telemetry.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+#endif
+
+static struct dpl_sem g_spi_sem;
+
+static struct hal_spi_pico_cfg g_spi_cfg = {
+    .pin_miso = MYNEWT_VAL(DPL_PICO_DW1000_PIN_MISO),
+    .pin_sck = MYNEWT_VAL(DPL_PICO_DW1000_PIN_SCK),
+    .pin_mosi = MYNEWT_VAL(DPL_PICO_DW1000_PIN_MOSI),
+    .pin_ss = MYNEWT_VAL(DPL_PICO_DW1000_PIN_SS),
+};
+
+static struct dw1000_dev_cfg dw1000_0_cfg = {
+    .spi_sem = &g_spi_sem,
+    .spi_baudrate = MYNEWT_VAL(DPL_PICO_DW1000_BAUDRATE),
+    .spi_baudrate_low = MYNEWT_VAL(DPL_PICO_DW1000_BAUDRATE_LOW),
+    .spi_num = MYNEWT_VAL(DPL_PICO_DW1000_SPI),
+    .rst_pin = MYNEWT_VAL(DPL_PICO_DW1000_PIN_RST),
+    .irq_pin = MYNEWT_VAL(DPL_PICO_DW1000_PIN_IRQ),
+    .ss_pin = MYNEWT_VAL(DPL_PICO_DW1000_PIN_SS),
+    .rx_antenna_delay = MYNEWT_VAL(DW1000_DEVICE_0_RX_ANT_DLY),
+    .tx_antenna_delay = MYNEWT_VAL(DW1000_DEVICE_0_TX_ANT_DLY),
+    .ext_clock_delay = 0,
+};
+
+#if MYNEWT_VAL(DPL_PICO_LAT_REPORT_MS)
+static struct dpl_callout g_lat_callout;
+
+#define LAT_HIST_BINS   (TELEM_STATS_MAX - 3)
+
+/* One TELEM_GROUP_LATENCY record per LAT_HIST_BINS bins, the uart is fed by dma so nothing here waits on it */
+static void
+lat_hist_send(uint32_t id, uint32_t n, uint32_t max, const uint32_t *bin, int nbins)
+{
+    uint32_t val[TELEM_STATS_MAX];
+    int i, k;
+
+    for (i = 0; i < nbins; i += LAT_HIST_BINS) {
+        val[0] = id | (uint32_t)i << 8;
+        val[1] = n;
+        val[2] = max;
+        for (k = 0; k < LAT_HIST_BINS && i + k < nbins; k++) {
+            val[3 + k] = bin[i + k];
+        }
+        telem_stats(TELEM_GROUP_LATENCY, val, 3 + k);
+    }
+}
+
+/* Runs from the default queue, so on core1 between the uwb events */
+static void
+lat_report_cb(struct dpl_event *ev)
+{
+    dw1000_dev_instance_t *inst = hal_dw1000_inst(0);
+    struct dpl_eventq *evq = &inst->uwb_dev.eventq;
+
+    (void)ev;
+    lat_hist_send(0, evq->lat.n, evq->lat.max, evq->lat.bin, MYNEWT_VAL(DPL_PICO_EVENTQ_LAT_BINS));
+#if MYNEWT_VAL(DW1000_MAC_LATENCY)
+    {
+        int i;
+        lat_hist_send(1, inst->lat.irq.n, inst->lat.irq.max, inst->lat.irq.bin, DW1000_MAC_LAT_BINS);
+        for (i = 0; i < DW1000_MAC_LAT_EVENTS; i++) {
+            if (inst->lat.ev[i].n) {
+                lat_hist_send(2 + i, inst->lat.ev[i].n, inst->lat.ev[i].max,
+                              inst->lat.ev[i].bin, DW1000_MAC_LAT_BINS);
+            }
+        }
+    }
+#endif
+    dpl_callout_reset(&g_lat_callout, dpl_time_ms_to_ticks32(MYNEWT_VAL(DPL_PICO_LAT_REPORT_MS)));
+}
+#endif
+
+#if MYNEWT_VAL(DPL_PICO_SPI_BENCH)
+#define BENCH_ROUNDS    (32)
+#define BENCH_CAL_ITERS (100000)
+
+#if MYNEWT_VAL(DW1000_HAL_SPI_CS_AUTO)
+#define BENCH_CS(_pin, _v) (void)(_pin)
+#else
+#define BENCH_CS(_pin, _v) hal_gpio_write((_pin), (_v))
+#endif
+
+static volatile bool g_bench_done;
+static uint8_t g_bench_buf[1 + 1016];
+
+static void
+bench_txrx_cb(void *arg, int len)
+{
+    (void)arg;
+    (void)len;
+    g_bench_done = true;
+}
+
+/* SysTick counts clk_sys cycles down from 2^24 */
+static inline uint32_t
+bench_cycles_since(uint32_t t0)
+{
+    return (t0 - systick_hw->cvr) & 0xffffff;
+}
+
+/* The idle loop of the DMA rounds, limit 0 runs until the transfer is done */
+static uint32_t
+bench_idle(uint32_t limit)
+{
+    uint32_t idle = 0;
+
+    while (!g_bench_done && ++idle != limit);
+    return idle;
+}
+
+/**
+ * Reads the DW1000 rx buffer polled and as a chained DMA transfer and prints bytes/s and the share of the CPU
+ * each takes. Polled reads hold the CPU for the whole transfer. For DMA, what the CPU could not spend in an
+ * idle loop while the transfer ran counts as occupied, setup and the completion interrupt.
+ *
+ * @return void
+ */
+void
+hal_bsp_spi_bench(void)
+{
+    static const uint16_t lens[] = {4, 16, 127, 1016};
+    struct hal_dw1000_spi_seg seg[2] = {
+        {.tx = g_bench_buf, .rx = NULL, .len = 1},
+        {.tx = NULL, .rx = g_bench_buf + 1, .len = 0}
+    };
+    int spi_num = dw1000_0_cfg.spi_num;
+    int ss = dw1000_0_cfg.ss_pin;
+    uint32_t hz = clock_get_hz(clk_sys);
+    uint32_t t0, cyc, poll, dma, busy, cal;
+    uint64_t idle;
+    int i, k, rc;
+
+    rc = dpl_sem_pend(&g_spi_sem, DPL_TIMEOUT_NEVER);
+    assert(rc == DPL_OK);
+    systick_hw->rvr = 0xffffff;
+    systick_hw->csr = 0x5;              /* enabled, clk_sys */
+    hal_spi_disable(spi_num);
+    hal_spi_set_txrx_cb(spi_num, bench_txrx_cb, NULL);
+    hal_spi_enable(spi_num);
+
+    /* Cycles per idle loop iteration */
+    g_bench_done = false;
+    t0 = systick_hw->cvr;
+    bench_idle(BENCH_CAL_ITERS);
+    cal = bench_cycles_since(t0);
+
+    printf("spi bench, %" PRIu32 "Hz clk_sys, %" PRIu32 "kHz spi\n", hz, (uint32_t)dw1000_0_cfg.spi_baudrate);
+    printf("%6s %12s %12s %8s\n", "len", "poll B/s", "dma B/s", "dma cpu");
+    for (i = 0; i < (int)ARRAY_SIZE(lens); i++) {
+        poll = dma = busy = 0;
+        for (k = 0; k < BENCH_ROUNDS; k++) {
+            g_bench_buf[0] = 0x11;      /* RX_BUFFER_ID, read */
+            t0 = systick_hw->cvr;
+            BENCH_CS(ss, 0);
+            hal_spi_txrx(spi_num, g_bench_buf, g_bench_buf, 1 + lens[i]);
+            BENCH_CS(ss, 1);
+            poll += bench_cycles_since(t0);
+
+            g_bench_done = false;
+            seg[1].len = lens[i];
+            t0 = systick_hw->cvr;
+            BENCH_CS(ss, 0);
+            hal_spi_txrx_sg_noblock(spi_num, seg, 2);
+            idle = bench_idle(0);
+            BENCH_CS(ss, 1);
+            cyc = bench_cycles_since(t0);
+            dma += cyc;
+            idle = idle * cal / BENCH_CAL_ITERS;
+            busy += (idle < cyc) ? cyc - (uint32_t)idle : 0;
+        }
+        printf("%6u %12" PRIu32 " %12" PRIu32 " %7" PRIu32 "%%\n", lens[i],
+               (uint32_t)((uint64_t)lens[i] * BENCH_ROUNDS * hz / poll),
+               (uint32_t)((uint64_t)lens[i] * BENCH_ROUNDS * hz / dma),
+               (uint32_t)((uint64_t)busy * 100 / dma));
+    }
+
+    hal_spi_disable(spi_num);
+    hal_spi_set_txrx_cb(spi_num, NULL, NULL);
+    hal_spi_enable(spi_num);
+    dpl_sem_release(&g_spi_sem);
+}
+#endif
+
+/**
+ * Brings up the dpl alarm pool and the DW1000 SPI and creates dw1000_0. Call on the radio core, core1, before
+ * dw1000_pkg_init. The alarm, pin and DMA interrupts are taken by the core that sets them up.
+ *
+ * @return void
+ */
+void
+hal_bsp_init(void)
+{
+    int rc;
+
+    dpl_pico_init();
+    rc = hal_spi_init(dw1000_0_cfg.spi_num, &g_spi_cfg, HAL_SPI_TYPE_MASTER);
+    assert(rc == DPL_OK);
+    rc = dpl_sem_init(&g_spi_sem, 1);
+    assert(rc == DPL_OK);
+    rc = os_dev_create((struct os_dev *)hal_dw1000_inst(0), "dw1000_0",
+                       OS_DEV_INIT_PRIMARY, 0, dw1000_dev_init, (void *)&dw1000_0_cfg);
+    assert(rc == DPL_OK);
+    (void)rc;
+#if MYNEWT_VAL(DPL_PICO_LAT_REPORT_MS)
+    dpl_callout_init(&g_lat_callout, dpl_eventq_dflt_get(), lat_report_cb, NULL);
+    dpl_callout_reset(&g_lat_callout, dpl_time_ms_to_ticks32(MYNEWT_VAL(DPL_PICO_LAT_REPORT_MS)));
+#endif
+}
@@ -0,0 +1,108 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/**
+ * @file dpl_cputime_pico.c
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief cputime timers of the pico port
+ *
+ * @details cputime wraps every 71 minutes, expiries are taken relative to now the way the mynewt cputime does.
+ */
+
+#include <string.h>
+#include <dpl/dpl.h>
+
+static int64_t
+timer_alarm_cb(alarm_id_t id, void *arg)
+{
+    struct hal_timer *timer = (struct hal_timer *)arg;
+    bool fire = false;
+    os_sr_t sr;
+
+    DPL_ENTER_CRITICAL(sr);
+    if (timer->alarm == id) {
+        timer->alarm = 0;
+        fire = true;
+    }
+    DPL_EXIT_CRITICAL(sr);
+    if (fire) {
+        timer->cb_func(timer->cb_arg);
+    }
+    return 0;
+}
+
+void
+dpl_cputime_timer_init(struct hal_timer *timer, hal_timer_cb fp, void *arg)
+{
+    memset(timer, 0, sizeof(*timer));
+    timer->cb_func = fp;
+    timer->cb_arg = arg;
+}
+
+/**
+ * Starts a timer at an absolute cputime, one already in the past fires right away.
+ *
+ * @param timer    Timer.
+ * @param cputime  Expiry.
+ * @return int     DPL_OK, DPL_ENOMEM if the alarm pool is full.
+ */
+int
+dpl_cputime_timer_start(struct hal_timer *timer, uint32_t cputime)
+{
+    int32_t delta = (int32_t)(cputime - dpl_cputime_get32());
+    int rc = DPL_OK;
+    alarm_id_t id;
+    os_sr_t sr;
+
+    DPL_ENTER_CRITICAL(sr);
+    if (timer->alarm > 0) {
+        alarm_pool_cancel_alarm(dpl_pico_alarm_pool(), timer->alarm);
+    }
+    timer->alarm = 0;
+    timer->expiry = cputime;
+    id = alarm_pool_add_alarm_in_us(dpl_pico_alarm_pool(), delta > 0 ? delta : 0, timer_alarm_cb, timer, true);
+    if (id > 0) {
+        timer->alarm = id;
+    } else if (id < 0) {
+        rc = DPL_ENOMEM;
+    }
+    DPL_EXIT_CRITICAL(sr);
+    return rc;
+}
+
+int
+dpl_cputime_timer_relative(struct hal_timer *timer, uint32_t usecs)
+{
+    return dpl_cputime_timer_start(timer, dpl_cputime_get32() + usecs);
+}
+
+void
+dpl_cputime_timer_stop(struct hal_timer *timer)
+{
+    os_sr_t sr;
+
+    DPL_ENTER_CRITICAL(sr);
+    if (timer->alarm > 0) {
+        alarm_pool_cancel_alarm(dpl_pico_alarm_pool(), timer->alarm);
+    }
+    timer->alarm = 0;
+    DPL_EXIT_CRITICAL(sr);
+}
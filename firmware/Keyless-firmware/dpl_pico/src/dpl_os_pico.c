@@ -0,0 +1,513 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/**
+ * @file dpl_os_pico.c
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief OS abstraction of the pico port
+ *
+ * @details Core0 runs the application, core1 runs the task registered with dpl_task_init, which for the uwb
+ * stack is the interrupt task that services dw1000_interrupt_ev_cb. While core1 waits on its queue it also runs
+ * the events put on the default queue, as there is no other task. Callouts and cputime timers use an alarm pool
+ * of their own once dpl_pico_init has run, so their interrupts stay on the core that set up the radio.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <dpl/dpl.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+static uint8_t g_crit_depth[2];
+static struct dpl_eventq g_dflt_evq = {.evq_inited = true};
+static struct dpl_task g_core_task[2] = {{.t_name = "core0"}, {.t_name = "core1"}};
+static struct dpl_task * volatile g_task;
+static struct dpl_task * volatile g_task_running;
+static alarm_pool_t *g_alarm_pool;
+
+/**
+ * Creates the alarm pool of the callouts and cputime timers on DPL_PICO_ALARM_NUM, its interrupt is taken on the
+ * calling core. Call before anything is armed, until then the sdk default pool of core0 is used.
+ *
+ * @return void
+ */
+void
+dpl_pico_init(void)
+{
+    if (!g_alarm_pool) {
+        g_alarm_pool = alarm_pool_create(MYNEWT_VAL(DPL_PICO_ALARM_NUM), MYNEWT_VAL(DPL_PICO_ALARM_MAX));
+    }
+}
+
+alarm_pool_t *
+dpl_pico_alarm_pool(void)
+{
+    return g_alarm_pool ? g_alarm_pool : alarm_pool_get_default();
+}
+
+/**
+ * Disables interrupts on this core and locks out the other one. Nests on the same core, only the outermost
+ * call takes the spinlock.
+ *
+ * @return os_sr_t  Interrupt state to hand to dpl_pico_exit_critical.
+ */
+os_sr_t
+dpl_pico_enter_critical(void)
+{
+    os_sr_t sr = save_and_disable_interrupts();
+    uint core = get_core_num();
+
+    if (g_crit_depth[core]++ == 0) {
+        spin_lock_unsafe_blocking(spin_lock_instance(PICO_SPINLOCK_ID_OS1));
+    }
+    return sr;
+}
+
+void
+dpl_pico_exit_critical(os_sr_t sr)
+{
+    uint core = get_core_num();
+
+    assert(g_crit_depth[core]);
+    if (--g_crit_depth[core] == 0) {
+        spin_unlock_unsafe(spin_lock_instance(PICO_SPINLOCK_ID_OS1));
+    }
+    restore_interrupts(sr);
+}
+
+dpl_error_t
+dpl_sem_init(struct dpl_sem *sem, uint16_t tokens)
+{
+    if (!sem) {
+        return DPL_INVALID_PARAM;
+    }
+    sem_init(&sem->sem, tokens, INT16_MAX);
+    return DPL_OK;
+}
+
+dpl_error_t
+dpl_sem_pend(struct dpl_sem *sem, dpl_time_t timeout)
+{
+    if (timeout == DPL_TIMEOUT_NEVER) {
+        sem_acquire_blocking(&sem->sem);
+        return DPL_OK;
+    }
+    return sem_acquire_timeout_ms(&sem->sem, timeout) ? DPL_OK : DPL_TIMEOUT;
+}
+
+dpl_error_t
+dpl_sem_release(struct dpl_sem *sem)
+{
+    sem_release(&sem->sem);
+    return DPL_OK;
+}
+
+uint16_t
+dpl_sem_get_count(struct dpl_sem *sem)
+{
+    return sem_available(&sem->sem);
+}
+
+/* Mutex ownership is per core, which is the same as per task here */
+dpl_error_t
+dpl_mutex_init(struct dpl_mutex *mu)
+{
+    if (!mu) {
+        return DPL_INVALID_PARAM;
+    }
+    recursive_mutex_init(&mu->mu);
+    return DPL_OK;
+}
+
+dpl_error_t
+dpl_mutex_pend(struct dpl_mutex *mu, dpl_time_t timeout)
+{
+    if (timeout == DPL_TIMEOUT_NEVER) {
+        recursive_mutex_enter_blocking(&mu->mu);
+        return DPL_OK;
+    }
+    return recursive_mutex_enter_timeout_ms(&mu->mu, timeout) ? DPL_OK : DPL_TIMEOUT;
+}
+
+dpl_error_t
+dpl_mutex_release(struct dpl_mutex *mu)
+{
+    recursive_mutex_exit(&mu->mu);
+    return DPL_OK;
+}
+
+void
+dpl_eventq_init(struct dpl_eventq *evq)
+{
+    memset(evq, 0, sizeof(*evq));
+    evq->evq_inited = true;
+}
+
+void
+dpl_eventq_deinit(struct dpl_eventq *evq)
+{
+    os_sr_t sr;
+    struct dpl_event *ev;
+
+    DPL_ENTER_CRITICAL(sr);
+    for (ev = evq->evq_head; ev; ev = ev->ev_next) {
+        ev->ev_queued = false;
+    }
+    evq->evq_head = evq->evq_tail = NULL;
+    evq->evq_inited = false;
+    DPL_EXIT_CRITICAL(sr);
+}
+
+struct dpl_eventq *
+dpl_eventq_dflt_get(void)
+{
+    return &g_dflt_evq;
+}
+
+/**
+ * Puts an event on a queue unless it is already on one, from task or interrupt context on either core.
+ *
+ * @param evq  Queue.
+ * @param ev   Event.
+ * @return void
+ */
+void
+dpl_eventq_put(struct dpl_eventq *evq, struct dpl_event *ev)
+{
+    os_sr_t sr;
+
+    DPL_ENTER_CRITICAL(sr);
+    if (ev->ev_queued) {
+        DPL_EXIT_CRITICAL(sr);
+        return;
+    }
+    ev->ev_queued = true;
+    ev->ev_put = time_us_32();
+    ev->ev_next = NULL;
+    if (evq->evq_tail) {
+        evq->evq_tail->ev_next = ev;
+    } else {
+        evq->evq_head = ev;
+    }
+    evq->evq_tail = ev;
+    DPL_EXIT_CRITICAL(sr);
+    /* Wake the core waiting in dpl_eventq_get */
+    __sev();
+}
+
+void
+dpl_eventq_remove(struct dpl_eventq *evq, struct dpl_event *ev)
+{
+    os_sr_t sr;
+    struct dpl_event **pp, *prev = NULL;
+
+    DPL_ENTER_CRITICAL(sr);
+    for (pp = &evq->evq_head; *pp; prev = *pp, pp = &(*pp)->ev_next) {
+        if (*pp == ev) {
+            *pp = ev->ev_next;
+            if (evq->evq_tail == ev) {
+                evq->evq_tail = prev;
+            }
+            ev->ev_queued = false;
+            ev->ev_next = NULL;
+            break;
+        }
+    }
+    DPL_EXIT_CRITICAL(sr);
+}
+
+bool
+dpl_eventq_is_empty(struct dpl_eventq *evq)
+{
+    return evq->evq_head == NULL;
+}
+
+static void
+eventq_lat_add(struct dpl_eventq *evq, uint32_t usec)
+{
+    uint32_t bin = usec ? 32 - __builtin_clz(usec) : 0;
+
+    if (bin >= MYNEWT_VAL(DPL_PICO_EVENTQ_LAT_BINS)) {
+        bin = MYNEWT_VAL(DPL_PICO_EVENTQ_LAT_BINS) - 1;
+    }
+    evq->lat.bin[bin]++;
+    evq->lat.n++;
+    if (usec > evq->lat.max) {
+        evq->lat.max = usec;
+    }
+}
+
+/* Pops the head of the queue and records how long it waited, the caller holds the critical section */
+static struct dpl_event *
+eventq_pop(struct dpl_eventq *evq)
+{
+    struct dpl_event *ev = evq->evq_head;
+
+    if (ev) {
+        evq->evq_head = ev->ev_next;
+        if (!evq->evq_head) {
+            evq->evq_tail = NULL;
+        }
+        ev->ev_queued = false;
+        ev->ev_next = NULL;
+        eventq_lat_add(evq, time_us_32() - ev->ev_put);
+    }
+    return ev;
+}
+
+struct dpl_event *
+dpl_eventq_get_no_wait(struct dpl_eventq *evq)
+{
+    os_sr_t sr;
+    struct dpl_event *ev;
+
+    DPL_ENTER_CRITICAL(sr);
+    ev = eventq_pop(evq);
+    DPL_EXIT_CRITICAL(sr);
+    return ev;
+}
+
+/**
+ * Waits for an event. On core1 the events of the default queue are returned as well, after those of evq.
+ *
+ * @param evq  Queue.
+ * @return struct dpl_event*  The event, off the queue.
+ */
+struct dpl_event *
+dpl_eventq_get(struct dpl_eventq *evq)
+{
+    os_sr_t sr;
+    struct dpl_event *ev;
+    bool dflt = get_core_num() == 1 && evq != &g_dflt_evq;
+
+    while (1) {
+        DPL_ENTER_CRITICAL(sr);
+        ev = eventq_pop(evq);
+        if (!ev && dflt) {
+            ev = eventq_pop(&g_dflt_evq);
+        }
+        DPL_EXIT_CRITICAL(sr);
+        if (ev) {
+            return ev;
+        }
+        /* A put on the other core between the check and here leaves the event flag set, no wakeup is lost */
+        __wfe();
+    }
+}
+
+void
+dpl_eventq_run(struct dpl_eventq *evq)
+{
+    dpl_event_run(dpl_eventq_get(evq));
+}
+
+void
+dpl_eventq_lat_clear(struct dpl_eventq *evq)
+{
+    os_sr_t sr;
+
+    DPL_ENTER_CRITICAL(sr);
+    memset(&evq->lat, 0, sizeof(evq->lat));
+    DPL_EXIT_CRITICAL(sr);
+}
+
+/* Alarm callback, in interrupt context on the core of the pool. Only puts the event if the callout was not stopped or reset */
+static int64_t
+callout_alarm_cb(alarm_id_t id, void *arg)
+{
+    struct dpl_callout *co = (struct dpl_callout *)arg;
+    bool fire = false;
+    os_sr_t sr;
+
+    DPL_ENTER_CRITICAL(sr);
+    if (co->c_alarm == id) {
+        co->c_alarm = 0;
+        fire = true;
+    }
+    DPL_EXIT_CRITICAL(sr);
+    if (fire && co->c_evq) {
+        dpl_eventq_put(co->c_evq, &co->c_ev);
+    }
+    return 0;
+}
+
+void
+dpl_callout_init(struct dpl_callout *co, struct dpl_eventq *evq, dpl_event_fn *ev_cb, void *ev_arg)
+{
+    memset(co, 0, sizeof(*co));
+    dpl_event_init(&co->c_ev, ev_cb, ev_arg);
+    co->c_evq = evq;
+}
+
+/**
+ * Arms the callout, replacing a pending expiry. The alarm is added inside the critical section so the callback,
+ * which needs it too, sees the new id.
+ *
+ * @param co     Callout.
+ * @param ticks  Ticks (ms) from now, 0 puts the event straight away.
+ * @return dpl_error_t  DPL_OK, DPL_ENOMEM if the alarm pool is full.
+ */
+dpl_error_t
+dpl_callout_reset(struct dpl_callout *co, dpl_time_t ticks)
+{
+    dpl_error_t rc = DPL_OK;
+    alarm_id_t id;
+    os_sr_t sr;
+
+    DPL_ENTER_CRITICAL(sr);
+    if (co->c_alarm > 0) {
+        alarm_pool_cancel_alarm(dpl_pico_alarm_pool(), co->c_alarm);
+    }
+    co->c_alarm = 0;
+    co->c_ticks = dpl_time_get() + ticks;
+    if (ticks == 0) {
+        DPL_EXIT_CRITICAL(sr);
+        dpl_eventq_put(co->c_evq, &co->c_ev);
+        return DPL_OK;
+    }
+    id = alarm_pool_add_alarm_in_ms(dpl_pico_alarm_pool(), ticks, callout_alarm_cb, co, true);
+    if (id > 0) {
+        co->c_alarm = id;
+    } else if (id < 0) {
+        rc = DPL_ENOMEM;
+    }
+    DPL_EXIT_CRITICAL(sr);
+    return rc;
+}
+
+void
+dpl_callout_stop(struct dpl_callout *co)
+{
+    os_sr_t sr;
+
+    DPL_ENTER_CRITICAL(sr);
+    if (co->c_alarm > 0) {
+        alarm_pool_cancel_alarm(dpl_pico_alarm_pool(), co->c_alarm);
+    }
+    co->c_alarm = 0;
+    DPL_EXIT_CRITICAL(sr);
+    if (co->c_evq) {
+        dpl_eventq_remove(co->c_evq, &co->c_ev);
+    }
+}
+
+bool
+dpl_callout_is_active(struct dpl_callout *co)
+{
+    return co->c_alarm > 0 || co->c_ev.ev_queued;
+}
+
+dpl_time_t
+dpl_callout_get_ticks(struct dpl_callout *co)
+{
+    return co->c_ticks;
+}
+
+dpl_time_t
+dpl_callout_remaining_ticks(struct dpl_callout *co, dpl_time_t now)
+{
+    int32_t rt = (int32_t)(co->c_ticks - now);
+
+    return (co->c_alarm > 0 && rt > 0) ? rt : 0;
+}
+
+/**
+ * Registers the task core1 runs. Core1 has a stack of its own from multicore_launch_core1, so the stack
+ * passed in is not used. Task functions do not return, so there is room for one.
+ *
+ * @return int  DPL_OK, DPL_ENOMEM if a task is already registered.
+ */
+int
+dpl_task_init(struct dpl_task *t, const char *name, dpl_task_func_t func, void *arg, uint8_t prio,
+              dpl_time_t sanity_itvl, dpl_stack_t *stack_bottom, uint16_t stack_size)
+{
+    (void)sanity_itvl;
+    (void)stack_bottom;
+    (void)stack_size;
+
+    if (g_task) {
+        return DPL_ENOMEM;
+    }
+    t->t_name = name;
+    t->t_func = func;
+    t->t_arg = arg;
+    t->t_prio = prio;
+    g_task = t;
+    __sev();
+    return DPL_OK;
+}
+
+int
+dpl_task_remove(struct dpl_task *t)
+{
+    if (g_task != t) {
+        return DPL_ENOENT;
+    }
+    g_task = NULL;
+    return DPL_OK;
+}
+
+uint8_t
+dpl_task_count(void)
+{
+    return g_task ? 1 : 0;
+}
+
+void *
+dpl_get_current_task_id(void)
+{
+    uint core = get_core_num();
+
+    if (core == 1 && g_task_running) {
+        return g_task_running;
+    }
+    return &g_core_task[core];
+}
+
+/**
+ * Entry of core1, waits for a task to be registered and runs it. In between the default queue is serviced.
+ *
+ * @return void
+ */
+void
+dpl_pico_task_run(void)
+{
+    struct dpl_event *ev;
+
+    assert(get_core_num() == 1);
+    while (1) {
+        if (g_task) {
+            g_task_running = g_task;
+            g_task_running->t_func(g_task_running->t_arg);
+            if (g_task == g_task_running) {
+                g_task = NULL;
+            }
+            g_task_running = NULL;
+            continue;
+        }
+        ev = dpl_eventq_get_no_wait(&g_dflt_evq);
+        if (ev) {
+            dpl_event_run(ev);
+        } else {
+            __wfe();
+        }
+    }
+}
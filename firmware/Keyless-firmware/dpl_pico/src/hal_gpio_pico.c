@@ -0,0 +1,151 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/**
+ * @file hal_gpio_pico.c
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief GPIO hal of the pico port
+ */
+
+#include <dpl/dpl.h>
+#include <hal/hal_gpio.h>
+#include "hardware/gpio.h"
+
+struct hal_gpio_irq {
+    hal_gpio_irq_handler_t handler;
+    void *arg;
+    uint32_t events;
+};
+
+static struct hal_gpio_irq g_gpio_irq[NUM_BANK0_GPIOS];
+
+static void
+gpio_pull(int pin, hal_gpio_pull_t pull)
+{
+    gpio_set_pulls(pin, pull == HAL_GPIO_PULL_UP, pull == HAL_GPIO_PULL_DOWN);
+}
+
+int
+hal_gpio_init_in(int pin, hal_gpio_pull_t pull)
+{
+    if (pin < 0 || pin >= NUM_BANK0_GPIOS) {
+        return DPL_EINVAL;
+    }
+    gpio_init(pin);
+    gpio_set_dir(pin, GPIO_IN);
+    gpio_pull(pin, pull);
+    return DPL_OK;
+}
+
+int
+hal_gpio_init_out(int pin, int val)
+{
+    if (pin < 0 || pin >= NUM_BANK0_GPIOS) {
+        return DPL_EINVAL;
+    }
+    gpio_init(pin);
+    gpio_put(pin, val != 0);
+    gpio_set_dir(pin, GPIO_OUT);
+    return DPL_OK;
+}
+
+void
+hal_gpio_write(int pin, int val)
+{
+    gpio_put(pin, val != 0);
+}
+
+int
+hal_gpio_read(int pin)
+{
+    return gpio_get(pin);
+}
+
+int
+hal_gpio_toggle(int pin)
+{
+    int val = !gpio_get_out_level(pin);
+
+    gpio_put(pin, val);
+    return val;
+}
+
+/* The one sdk callback, level triggers stay asserted until the handler has cleared the source */
+static void
+gpio_irq_cb(uint gpio, uint32_t events)
+{
+    struct hal_gpio_irq *irq = &g_gpio_irq[gpio];
+
+    TRACE_INSTANT(TRACE_GPIO_IRQ, gpio);
+    if (irq->handler && (events & irq->events)) {
+        irq->handler(irq->arg);
+    }
+}
+
+/**
+ * Sets the handler of a pin interrupt, enabled with hal_gpio_irq_enable. The interrupt is taken on the core
+ * that enables it.
+ *
+ * @return int  DPL_OK, DPL_EINVAL for a bad pin or trigger.
+ */
+int
+hal_gpio_irq_init(int pin, hal_gpio_irq_handler_t handler, void *arg, hal_gpio_irq_trig_t trig,
+                  hal_gpio_pull_t pull)
+{
+    static const uint32_t events[] = {
+        [HAL_GPIO_TRIG_RISING] = GPIO_IRQ_EDGE_RISE,
+        [HAL_GPIO_TRIG_FALLING] = GPIO_IRQ_EDGE_FALL,
+        [HAL_GPIO_TRIG_BOTH] = GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL,
+        [HAL_GPIO_TRIG_LOW] = GPIO_IRQ_LEVEL_LOW,
+        [HAL_GPIO_TRIG_HIGH] = GPIO_IRQ_LEVEL_HIGH,
+    };
+
+    if (pin < 0 || pin >= NUM_BANK0_GPIOS || trig == HAL_GPIO_TRIG_NONE || trig > HAL_GPIO_TRIG_HIGH) {
+        return DPL_EINVAL;
+    }
+    hal_gpio_init_in(pin, pull);
+    g_gpio_irq[pin].handler = handler;
+    g_gpio_irq[pin].arg = arg;
+    g_gpio_irq[pin].events = events[trig];
+    return DPL_OK;
+}
+
+void
+hal_gpio_irq_release(int pin)
+{
+    hal_gpio_irq_disable(pin);
+    g_gpio_irq[pin].handler = NULL;
+    g_gpio_irq[pin].events = 0;
+}
+
+void
+hal_gpio_irq_enable(int pin)
+{
+    if (g_gpio_irq[pin].handler) {
+        gpio_set_irq_enabled_with_callback(pin, g_gpio_irq[pin].events, true, gpio_irq_cb);
+    }
+}
+
+void
+hal_gpio_irq_disable(int pin)
+{
+    gpio_set_irq_enabled(pin, g_gpio_irq[pin].events, false);
+}
@@ -0,0 +1,470 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/**
+ * @file hal_spi_pico.c
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief SPI hal of the pico port
+ *
+ * @details The block is brought up once in hal_spi_init. The drivers disable and enable it around every
+ * callback and speed change, so enable only touches the hardware when the settings changed. Nonblocking
+ * transfers start a tx and an rx DMA channel together and complete on the rx channel, which only finishes once
+ * the last byte is clocked in. A NULL rxbuf is drained into a scratch byte.
+ *
+ * Segment lists for the DW1000 run as one DMA chain: a control channel per direction loads the next segment
+ * into its data channel each time the data channel finishes, and a last block with a zero count ends the chain
+ * with an interrupt from the rx side. Header and payload then go out back to back with no CPU in between.
+ * Short blocking lists are polled as the DMA setup would cost more than it saves.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <dpl/dpl.h>
+#include <hal/hal_spi.h>
+#include "hardware/spi.h"
+#include "hardware/gpio.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#if MYNEWT_VAL(DW1000_HAL_SPI_SG)
+#include <dw1000/dw1000_hal.h>
+#include "spi_dma_pico.h"
+#endif
+
+/* With DPL_PICO_DW1000_PIO the DW1000 is on hal_spi_pio_pico.c and the SPI blocks are left to the application */
+#if !MYNEWT_VAL(DPL_PICO_DW1000_PIO)
+
+#define SPI_SG_BLOCKS (MYNEWT_VAL(DPL_PICO_SPI_SG_MAX) + 1)
+
+struct hal_spi_pico {
+    spi_inst_t *spi;
+    bool inited;
+    bool enabled;
+    bool dirty;                         //!< settings changed since the hardware was configured
+    struct hal_spi_settings settings;
+    hal_spi_txrx_cb txrx_cb;
+    void *txrx_cb_arg;
+    int tx_dma;
+    int rx_dma;
+    int len;                            //!< Length of the transfer in flight, 0 when idle
+#if MYNEWT_VAL(DW1000_HAL_SPI_SG)
+    int tx_ctrl_dma;
+    int rx_ctrl_dma;
+    volatile bool blocking;             //!< A blocking chain is waiting, no callback
+    struct spi_dma_cb tx_cb[SPI_SG_BLOCKS];
+    struct spi_dma_cb rx_cb[SPI_SG_BLOCKS];
+#endif
+};
+
+static struct hal_spi_pico g_spi[2];
+static uint8_t g_spi_scratch;
+static const uint8_t g_spi_zero;
+
+static struct hal_spi_pico *
+spi_get(int spi_num)
+{
+    if (spi_num < 0 || spi_num >= (int)ARRAY_SIZE(g_spi) || !g_spi[spi_num].inited) {
+        return NULL;
+    }
+    return &g_spi[spi_num];
+}
+
+static void
+spi_dma_irq(void)
+{
+    struct hal_spi_pico *s;
+    int i, len;
+
+    for (i = 0; i < (int)ARRAY_SIZE(g_spi); i++) {
+        s = &g_spi[i];
+        if (!s->inited || !dma_channel_get_irq0_status(s->rx_dma)) {
+            continue;
+        }
+        dma_channel_acknowledge_irq0(s->rx_dma);
+        len = s->len;
+        s->len = 0;
+        TRACE_END(TRACE_SPI, len);
+#if MYNEWT_VAL(DW1000_HAL_SPI_SG)
+        if (s->blocking) {
+            s->blocking = false;
+            /* The waiter may be on the other core */
+            __sev();
+            continue;
+        }
+#endif
+        if (s->txrx_cb) {
+            s->txrx_cb(s->txrx_cb_arg, len);
+        }
+    }
+}
+
+/**
+ * Sets up an SPI block as master on the pins in cfg and claims its DMA channels.
+ *
+ * @param spi_num   0 or 1.
+ * @param cfg       Pointer to struct hal_spi_pico_cfg.
+ * @param spi_type  HAL_SPI_TYPE_MASTER.
+ * @return int      DPL_OK, DPL_EINVAL otherwise.
+ */
+int
+hal_spi_init(int spi_num, void *cfg, uint8_t spi_type)
+{
+    struct hal_spi_pico_cfg *pins = (struct hal_spi_pico_cfg *)cfg;
+    struct hal_spi_pico *s;
+    static bool dma_irq_added;
+
+    if (spi_num < 0 || spi_num >= (int)ARRAY_SIZE(g_spi) || !pins || spi_type != HAL_SPI_TYPE_MASTER) {
+        return DPL_EINVAL;
+    }
+    s = &g_spi[spi_num];
+    if (s->inited) {
+        return DPL_OK;
+    }
+    memset(s, 0, sizeof(*s));
+    s->spi = spi_num ? spi1 : spi0;
+    s->settings.data_mode = HAL_SPI_MODE0;
+    s->settings.data_order = HAL_SPI_MSB_FIRST;
+    s->settings.word_size = HAL_SPI_WORD_SIZE_8BIT;
+    s->settings.baudrate = 1000;
+    spi_init(s->spi, s->settings.baudrate * 1000);
+    gpio_set_function(pins->pin_miso, GPIO_FUNC_SPI);
+    gpio_set_function(pins->pin_sck, GPIO_FUNC_SPI);
+    gpio_set_function(pins->pin_mosi, GPIO_FUNC_SPI);
+
+    s->tx_dma = dma_claim_unused_channel(true);
+    s->rx_dma = dma_claim_unused_channel(true);
+#if MYNEWT_VAL(DW1000_HAL_SPI_SG)
+    s->tx_ctrl_dma = dma_claim_unused_channel(true);
+    s->rx_ctrl_dma = dma_claim_unused_channel(true);
+#endif
+    dma_channel_set_irq0_enabled(s->rx_dma, true);
+    if (!dma_irq_added) {
+        irq_add_shared_handler(DMA_IRQ_0, spi_dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_0, true);
+        dma_irq_added = true;
+    }
+    s->inited = true;
+    return DPL_OK;
+}
+
+int
+hal_spi_config(int spi_num, struct hal_spi_settings *psettings)
+{
+    struct hal_spi_pico *s = spi_get(spi_num);
+
+    if (!s || !psettings || s->enabled) {
+        return DPL_EINVAL;
+    }
+    /* The PL022 only shifts msb first, DMA is set up for bytes */
+    if (psettings->data_order != HAL_SPI_MSB_FIRST || psettings->word_size != HAL_SPI_WORD_SIZE_8BIT ||
+        psettings->data_mode > HAL_SPI_MODE3 || !psettings->baudrate) {
+        return DPL_EINVAL;
+    }
+    if (s->settings.baudrate != psettings->baudrate || s->settings.data_mode != psettings->data_mode) {
+        s->settings = *psettings;
+        s->dirty = true;
+    }
+    return DPL_OK;
+}
+
+int
+hal_spi_set_txrx_cb(int spi_num, hal_spi_txrx_cb txrx_cb, void *arg)
+{
+    struct hal_spi_pico *s = spi_get(spi_num);
+
+    if (!s || s->enabled) {
+        return DPL_EINVAL;
+    }
+    s->txrx_cb = txrx_cb;
+    s->txrx_cb_arg = arg;
+    return DPL_OK;
+}
+
+int
+hal_spi_enable(int spi_num)
+{
+    struct hal_spi_pico *s = spi_get(spi_num);
+
+    if (!s) {
+        return DPL_EINVAL;
+    }
+    if (s->dirty) {
+        spi_set_baudrate(s->spi, s->settings.baudrate * 1000);
+        spi_set_format(s->spi, 8,
+                       (s->settings.data_mode & 2) ? SPI_CPOL_1 : SPI_CPOL_0,
+                       (s->settings.data_mode & 1) ? SPI_CPHA_1 : SPI_CPHA_0,
+                       SPI_MSB_FIRST);
+        s->dirty = false;
+    }
+    s->enabled = true;
+    return DPL_OK;
+}
+
+int
+hal_spi_disable(int spi_num)
+{
+    struct hal_spi_pico *s = spi_get(spi_num);
+
+    if (!s) {
+        return DPL_EINVAL;
+    }
+    s->enabled = false;
+    return DPL_OK;
+}
+
+uint16_t
+hal_spi_tx_val(int spi_num, uint16_t val)
+{
+    struct hal_spi_pico *s = spi_get(spi_num);
+    uint8_t tx = val, rx = 0xff;
+
+    if (!s || !s->enabled) {
+        return 0xffff;
+    }
+    spi_write_read_blocking(s->spi, &tx, &rx, 1);
+    return rx;
+}
+
+int
+hal_spi_txrx(int spi_num, void *txbuf, void *rxbuf, int cnt)
+{
+    struct hal_spi_pico *s = spi_get(spi_num);
+
+    if (!s || !s->enabled || !txbuf || cnt <= 0 || s->len) {
+        return DPL_EINVAL;
+    }
+    if (rxbuf) {
+        spi_write_read_blocking(s->spi, (const uint8_t *)txbuf, (uint8_t *)rxbuf, cnt);
+    } else {
+        spi_write_blocking(s->spi, (const uint8_t *)txbuf, cnt);
+    }
+    return DPL_OK;
+}
+
+/**
+ * Starts a transfer on the DMA channels of the block, the txrx callback is called from the DMA interrupt with
+ * the length when the last byte is in.
+ *
+ * @param spi_num  0 or 1.
+ * @param txbuf    Bytes to send.
+ * @param rxbuf    Received bytes, or NULL.
+ * @param cnt      Length.
+ * @return int     DPL_OK, DPL_EBUSY with a transfer in flight, DPL_EINVAL otherwise.
+ */
+int
+hal_spi_txrx_noblock(int spi_num, void *txbuf, void *rxbuf, int cnt)
+{
+    struct hal_spi_pico *s = spi_get(spi_num);
+    dma_channel_config c;
+
+    if (!s || !s->enabled || !txbuf || cnt <= 0) {
+        return DPL_EINVAL;
+    }
+    if (s->len) {
+        return DPL_EBUSY;
+    }
+    s->len = cnt;
+    TRACE_BEGIN(TRACE_SPI, cnt);
+
+    c = dma_channel_get_default_config(s->tx_dma);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_dreq(&c, spi_get_dreq(s->spi, true));
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    dma_channel_configure(s->tx_dma, &c, &spi_get_hw(s->spi)->dr, txbuf, cnt, false);
+
+    c = dma_channel_get_default_config(s->rx_dma);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_dreq(&c, spi_get_dreq(s->spi, false));
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, rxbuf != NULL);
+    dma_channel_configure(s->rx_dma, &c, rxbuf ? rxbuf : &g_spi_scratch, &spi_get_hw(s->spi)->dr, cnt, false);
+
+    dma_start_channel_mask((1u << s->tx_dma) | (1u << s->rx_dma));
+    return DPL_OK;
+}
+
+#if MYNEWT_VAL(DW1000_HAL_SPI_SG)
+/* Control value of a data channel in a chain, quiet so only the zero count at the end interrupts */
+static uint32_t
+spi_sg_ctrl(struct hal_spi_pico *s, int dma, int ctrl_dma, bool is_tx, bool incr)
+{
+    dma_channel_config c = dma_channel_get_default_config(dma);
+
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_dreq(&c, spi_get_dreq(s->spi, is_tx));
+    channel_config_set_read_increment(&c, is_tx && incr);
+    channel_config_set_write_increment(&c, !is_tx && incr);
+    channel_config_set_chain_to(&c, ctrl_dma);
+    channel_config_set_irq_quiet(&c, true);
+    return channel_config_get_ctrl_value(&c);
+}
+
+/* Builds the two block lists and starts both control channels, the rx data channel interrupts at the end */
+static int
+spi_sg_start(struct hal_spi_pico *s, const struct hal_dw1000_spi_seg *seg, int nseg, bool blocking)
+{
+    volatile void *dr = &spi_get_hw(s->spi)->dr;
+    int i, n = 0, len = 0;
+
+    if (!s->enabled || nseg <= 0) {
+        return DPL_EINVAL;
+    }
+    if (s->len) {
+        return DPL_EBUSY;
+    }
+    for (i = 0; i < nseg; i++) {
+        /* A zero count would end the chain early */
+        if (!seg[i].len) {
+            continue;
+        }
+        if (n == SPI_SG_BLOCKS - 1) {
+            return DPL_EINVAL;
+        }
+        s->tx_cb[n] = (struct spi_dma_cb){
+            .ctrl = spi_sg_ctrl(s, s->tx_dma, s->tx_ctrl_dma, true, seg[i].tx != NULL),
+            .read_addr = seg[i].tx ? seg[i].tx : &g_spi_zero,
+            .write_addr = dr,
+            .count = seg[i].len
+        };
+        s->rx_cb[n] = (struct spi_dma_cb){
+            .ctrl = spi_sg_ctrl(s, s->rx_dma, s->rx_ctrl_dma, false, seg[i].rx != NULL),
+            .read_addr = dr,
+            .write_addr = seg[i].rx ? seg[i].rx : &g_spi_scratch,
+            .count = seg[i].len
+        };
+        len += seg[i].len;
+        n++;
+    }
+    if (!n) {
+        return DPL_EINVAL;
+    }
+    s->tx_cb[n] = (struct spi_dma_cb){.ctrl = s->tx_cb[0].ctrl};
+    s->rx_cb[n] = (struct spi_dma_cb){.ctrl = s->rx_cb[0].ctrl};
+
+    s->len = len;
+    s->blocking = blocking;
+    TRACE_BEGIN(TRACE_SPI, len);
+    spi_dma_ctrl_channel(s->tx_ctrl_dma, s->tx_dma, s->tx_cb);
+    spi_dma_ctrl_channel(s->rx_ctrl_dma, s->rx_dma, s->rx_cb);
+    dma_start_channel_mask((1u << s->rx_ctrl_dma) | (1u << s->tx_ctrl_dma));
+    return DPL_OK;
+}
+
+/**
+ * Clocks a list of segments in one go. Lists shorter than DPL_PICO_SPI_DMA_MIN are polled, longer ones run as
+ * a DMA chain and the caller sleeps until its interrupt.
+ *
+ * @param spi_num  0 or 1.
+ * @param seg      Segments, tx or rx may be NULL.
+ * @param nseg     Number of segments, at most DPL_PICO_SPI_SG_MAX of them non empty.
+ * @return int     DPL_OK, DPL_EBUSY with a transfer in flight, DPL_EINVAL otherwise.
+ */
+int
+hal_spi_txrx_sg(int spi_num, const struct hal_dw1000_spi_seg *seg, int nseg)
+{
+    struct hal_spi_pico *s = spi_get(spi_num);
+    int i, k, total = 0;
+    int rc;
+
+    if (!s) {
+        return DPL_EINVAL;
+    }
+    for (i = 0; i < nseg; i++) {
+        total += seg[i].len;
+    }
+    if (total < MYNEWT_VAL(DPL_PICO_SPI_DMA_MIN)) {
+        if (!s->enabled || s->len) {
+            return DPL_EINVAL;
+        }
+        for (i = 0; i < nseg; i++) {
+            if (seg[i].tx && seg[i].rx) {
+                spi_write_read_blocking(s->spi, seg[i].tx, seg[i].rx, seg[i].len);
+            } else if (seg[i].tx) {
+                spi_write_blocking(s->spi, seg[i].tx, seg[i].len);
+            } else if (seg[i].rx) {
+                spi_read_blocking(s->spi, 0, seg[i].rx, seg[i].len);
+            } else {
+                for (k = 0; k < seg[i].len; k++) {
+                    spi_write_blocking(s->spi, &g_spi_zero, 1);
+                }
+            }
+        }
+        return DPL_OK;
+    }
+    rc = spi_sg_start(s, seg, nseg, true);
+    if (rc != DPL_OK) {
+        return rc;
+    }
+    while (s->blocking) {
+        __wfe();
+    }
+    return DPL_OK;
+}
+
+/**
+ * Starts a list of segments as one DMA chain, the txrx callback is called with the total length from the DMA
+ * interrupt when the last byte is in.
+ *
+ * @param spi_num  0 or 1.
+ * @param seg      Segments, tx or rx may be NULL. The segment array may go once this returns, the buffers
+ *                 have to stay until the callback.
+ * @param nseg     Number of segments, at most DPL_PICO_SPI_SG_MAX of them non empty.
+ * @return int     DPL_OK, DPL_EBUSY with a transfer in flight, DPL_EINVAL otherwise.
+ */
+int
+hal_spi_txrx_sg_noblock(int spi_num, const struct hal_dw1000_spi_seg *seg, int nseg)
+{
+    struct hal_spi_pico *s = spi_get(spi_num);
+
+    if (!s) {
+        return DPL_EINVAL;
+    }
+    return spi_sg_start(s, seg, nseg, false);
+}
+#endif
+
+int
+hal_spi_abort(int spi_num)
+{
+    struct hal_spi_pico *s = spi_get(spi_num);
+
+    if (!s) {
+        return DPL_EINVAL;
+    }
+    if (s->len) {
+#if MYNEWT_VAL(DW1000_HAL_SPI_SG)
+        dma_channel_abort(s->tx_ctrl_dma);
+        dma_channel_abort(s->rx_ctrl_dma);
+        s->blocking = false;
+#endif
+        dma_channel_abort(s->tx_dma);
+        dma_channel_abort(s->rx_dma);
+        dma_channel_acknowledge_irq0(s->rx_dma);
+        /* Leave nothing of the aborted transfer in the rx fifo */
+        while (spi_is_readable(s->spi)) {
+            (void)spi_get_hw(s->spi)->dr;
+        }
+        s->len = 0;
+    }
+    return DPL_OK;
+}
+#endif
@@ -0,0 +1,483 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/**
+ * @file hal_spi_pio_pico.c
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief SPI hal of the pico port on a PIO state machine
+ *
+ * @details Selected with DPL_PICO_DW1000_PIO. The dw1000_spi program clocks the DW1000 transaction format and
+ * drives the chip select itself, so the hardware SPI blocks stay free and the driver is built with
+ * DW1000_HAL_SPI_CS_AUTO. Every transfer is a header word with the length followed by the payload.
+ *
+ * All transfers run as DMA chains like the segment lists of hal_spi_pico.c: the tx chain is the 32 bit header
+ * then a byte block per segment, the rx chain a byte block per segment, each ended by a zero count block. Header
+ * and payload go out without a gap and without the CPU touching a byte. Nonblocking chains complete through the
+ * rx interrupt. Blocking ones mask it and poll its raw status, so they also work with interrupts off.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <dpl/dpl.h>
+#include <hal/hal_spi.h>
+
+#if MYNEWT_VAL(DPL_PICO_DW1000_PIO)
+#include <dw1000/dw1000_hal.h>
+#include "hardware/pio.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "spi_dma_pico.h"
+#include "dw1000_spi.pio.h"
+
+//! Header, segments and the end block
+#define SPI_PIO_BLOCKS      (MYNEWT_VAL(DPL_PICO_SPI_SG_MAX) + 2)
+//! State machine cycles per SPI bit and per wake loop of dw1000_spi
+#define SPI_PIO_BIT_CYCLES  (6)
+#define SPI_PIO_WAKE_CYCLES (8)
+#define SPI_PIO_HDR_WAKE    (1u << 31)
+
+struct hal_spi_pio {
+    PIO pio;
+    uint sm;
+    bool inited;
+    bool enabled;
+    bool dirty;                         //!< settings changed since the divider was set
+    struct hal_spi_settings settings;
+    uint32_t clkdiv;
+    hal_spi_txrx_cb txrx_cb;
+    void *txrx_cb_arg;
+    int tx_dma;
+    int rx_dma;
+    int tx_ctrl_dma;
+    int rx_ctrl_dma;
+    int len;                            //!< Length of the transfer in flight, 0 when idle
+    uint32_t hdr;                       //!< Header word of the transfer in flight
+    struct spi_dma_cb tx_cb[SPI_PIO_BLOCKS];
+    struct spi_dma_cb rx_cb[SPI_PIO_BLOCKS];
+};
+
+static struct hal_spi_pio g_spi[2];
+static uint g_spi_pio_offset;
+static bool g_spi_pio_loaded;
+static uint8_t g_spi_scratch;
+static const uint8_t g_spi_zero;
+
+static struct hal_spi_pio *
+spi_get(int spi_num)
+{
+    if (spi_num < 0 || spi_num >= (int)ARRAY_SIZE(g_spi) || !g_spi[spi_num].inited) {
+        return NULL;
+    }
+    return &g_spi[spi_num];
+}
+
+/* Smallest integer divider that keeps SCK at or below the baudrate, a fractional one would jitter the clock */
+static uint32_t
+spi_pio_clkdiv(uint32_t baudrate)
+{
+    uint32_t sm_khz = baudrate * SPI_PIO_BIT_CYCLES;
+    uint32_t div = (clock_get_hz(clk_sys) / 1000 + sm_khz - 1) / sm_khz;
+
+    return (div < 1) ? 1 : (div > 0xffff) ? 0xffff : div;
+}
+
+static void
+spi_dma_irq(void)
+{
+    struct hal_spi_pio *s;
+    int i, len;
+
+    for (i = 0; i < (int)ARRAY_SIZE(g_spi); i++) {
+        s = &g_spi[i];
+        if (!s->inited || !dma_channel_get_irq0_status(s->rx_dma)) {
+            continue;
+        }
+        dma_channel_acknowledge_irq0(s->rx_dma);
+        len = s->len;
+        s->len = 0;
+        TRACE_END(TRACE_SPI, len);
+        if (s->txrx_cb) {
+            s->txrx_cb(s->txrx_cb_arg, len);
+        }
+    }
+}
+
+/**
+ * Loads dw1000_spi into pio0 if it is not there yet, starts it on a free state machine and claims the DMA channels.
+ *
+ * @param spi_num   0 or 1, a state machine each.
+ * @param cfg       Pointer to struct hal_spi_pico_cfg, pin_sck has to be pin_ss + 1.
+ * @param spi_type  HAL_SPI_TYPE_MASTER.
+ * @return int      DPL_OK, DPL_ENOMEM without room for the program, DPL_EINVAL otherwise.
+ */
+int
+hal_spi_init(int spi_num, void *cfg, uint8_t spi_type)
+{
+    struct hal_spi_pico_cfg *pins = (struct hal_spi_pico_cfg *)cfg;
+    struct hal_spi_pio *s;
+    static bool dma_irq_added;
+
+    if (spi_num < 0 || spi_num >= (int)ARRAY_SIZE(g_spi) || !pins || spi_type != HAL_SPI_TYPE_MASTER ||
+        pins->pin_sck != pins->pin_ss + 1) {
+        return DPL_EINVAL;
+    }
+    s = &g_spi[spi_num];
+    if (s->inited) {
+        return DPL_OK;
+    }
+    if (!g_spi_pio_loaded) {
+        if (!pio_can_add_program(pio0, &dw1000_spi_program)) {
+            return DPL_ENOMEM;
+        }
+        g_spi_pio_offset = pio_add_program(pio0, &dw1000_spi_program);
+        g_spi_pio_loaded = true;
+    }
+    memset(s, 0, sizeof(*s));
+    s->pio = pio0;
+    s->sm = pio_claim_unused_sm(s->pio, true);
+    s->settings.data_mode = HAL_SPI_MODE0;
+    s->settings.data_order = HAL_SPI_MSB_FIRST;
+    s->settings.word_size = HAL_SPI_WORD_SIZE_8BIT;
+    s->settings.baudrate = 1000;
+    s->clkdiv = spi_pio_clkdiv(s->settings.baudrate);
+    dw1000_spi_program_init(s->pio, s->sm, g_spi_pio_offset, pins->pin_miso, pins->pin_ss, pins->pin_mosi);
+    pio_sm_set_clkdiv_int_frac(s->pio, s->sm, s->clkdiv, 0);
+
+    s->tx_dma = dma_claim_unused_channel(true);
+    s->rx_dma = dma_claim_unused_channel(true);
+    s->tx_ctrl_dma = dma_claim_unused_channel(true);
+    s->rx_ctrl_dma = dma_claim_unused_channel(true);
+    dma_channel_set_irq0_enabled(s->rx_dma, true);
+    if (!dma_irq_added) {
+        irq_add_shared_handler(DMA_IRQ_0, spi_dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_0, true);
+        dma_irq_added = true;
+    }
+    s->inited = true;
+    return DPL_OK;
+}
+
+int
+hal_spi_config(int spi_num, struct hal_spi_settings *psettings)
+{
+    struct hal_spi_pio *s = spi_get(spi_num);
+
+    if (!s || !psettings || s->enabled) {
+        return DPL_EINVAL;
+    }
+    /* dw1000_spi only knows the DW1000 format */
+    if (psettings->data_order != HAL_SPI_MSB_FIRST || psettings->word_size != HAL_SPI_WORD_SIZE_8BIT ||
+        psettings->data_mode != HAL_SPI_MODE0 || !psettings->baudrate) {
+        return DPL_EINVAL;
+    }
+    if (s->settings.baudrate != psettings->baudrate) {
+        s->settings = *psettings;
+        s->dirty = true;
+    }
+    return DPL_OK;
+}
+
+int
+hal_spi_set_txrx_cb(int spi_num, hal_spi_txrx_cb txrx_cb, void *arg)
+{
+    struct hal_spi_pio *s = spi_get(spi_num);
+
+    if (!s || s->enabled) {
+        return DPL_EINVAL;
+    }
+    s->txrx_cb = txrx_cb;
+    s->txrx_cb_arg = arg;
+    return DPL_OK;
+}
+
+int
+hal_spi_enable(int spi_num)
+{
+    struct hal_spi_pio *s = spi_get(spi_num);
+
+    if (!s) {
+        return DPL_EINVAL;
+    }
+    /* Only between transfers, the state machine waits on the header pull */
+    if (s->dirty && !s->len) {
+        s->clkdiv = spi_pio_clkdiv(s->settings.baudrate);
+        pio_sm_set_clkdiv_int_frac(s->pio, s->sm, s->clkdiv, 0);
+        s->dirty = false;
+    }
+    s->enabled = true;
+    return DPL_OK;
+}
+
+int
+hal_spi_disable(int spi_num)
+{
+    struct hal_spi_pio *s = spi_get(spi_num);
+
+    if (!s) {
+        return DPL_EINVAL;
+    }
+    s->enabled = false;
+    return DPL_OK;
+}
+
+/* Control value of a data channel in a chain, quiet so only the zero count at the end interrupts */
+static uint32_t
+spi_pio_ctrl(struct hal_spi_pio *s, int dma, int ctrl_dma, bool is_tx, bool incr, enum dma_channel_transfer_size size)
+{
+    dma_channel_config c = dma_channel_get_default_config(dma);
+
+    channel_config_set_transfer_data_size(&c, size);
+    channel_config_set_dreq(&c, pio_get_dreq(s->pio, s->sm, is_tx));
+    channel_config_set_read_increment(&c, is_tx && incr);
+    channel_config_set_write_increment(&c, !is_tx && incr);
+    channel_config_set_chain_to(&c, ctrl_dma);
+    channel_config_set_irq_quiet(&c, true);
+    return channel_config_get_ctrl_value(&c);
+}
+
+/* Builds the header and the two block lists and starts both control channels */
+static int
+spi_pio_start(struct hal_spi_pio *s, const struct hal_dw1000_spi_seg *seg, int nseg, bool blocking)
+{
+    volatile void *txf = &s->pio->txf[s->sm];
+    const volatile void *rxf = &s->pio->rxf[s->sm];
+    uint32_t tx_ctrl = spi_pio_ctrl(s, s->tx_dma, s->tx_ctrl_dma, true, true, DMA_SIZE_8);
+    int i, n = 0, len = 0;
+
+    if (!s->enabled || nseg <= 0) {
+        return DPL_EINVAL;
+    }
+    if (s->len) {
+        return DPL_EBUSY;
+    }
+    for (i = 0; i < nseg; i++) {
+        /* A zero count would end the chain early */
+        if (!seg[i].len) {
+            continue;
+        }
+        if (n == SPI_PIO_BLOCKS - 2) {
+            return DPL_EINVAL;
+        }
+        s->tx_cb[n + 1] = (struct spi_dma_cb){
+            .ctrl = seg[i].tx ? tx_ctrl : spi_pio_ctrl(s, s->tx_dma, s->tx_ctrl_dma, true, false, DMA_SIZE_8),
+            .read_addr = seg[i].tx ? seg[i].tx : &g_spi_zero,
+            .write_addr = txf,
+            .count = seg[i].len
+        };
+        s->rx_cb[n] = (struct spi_dma_cb){
+            .ctrl = spi_pio_ctrl(s, s->rx_dma, s->rx_ctrl_dma, false, seg[i].rx != NULL, DMA_SIZE_8),
+            .read_addr = rxf,
+            .write_addr = seg[i].rx ? seg[i].rx : &g_spi_scratch,
+            .count = seg[i].len
+        };
+        len += seg[i].len;
+        n++;
+    }
+    if (!n) {
+        return DPL_EINVAL;
+    }
+    s->hdr = len - 1;
+    s->tx_cb[0] = (struct spi_dma_cb){
+        .ctrl = spi_pio_ctrl(s, s->tx_dma, s->tx_ctrl_dma, true, false, DMA_SIZE_32),
+        .read_addr = &s->hdr,
+        .write_addr = txf,
+        .count = 1
+    };
+    s->tx_cb[n + 1] = (struct spi_dma_cb){.ctrl = tx_ctrl};
+    s->rx_cb[n] = (struct spi_dma_cb){.ctrl = s->rx_cb[0].ctrl};
+
+    s->len = len;
+    TRACE_BEGIN(TRACE_SPI, len);
+    dma_channel_set_irq0_enabled(s->rx_dma, !blocking);
+    spi_dma_ctrl_channel(s->tx_ctrl_dma, s->tx_dma, s->tx_cb);
+    spi_dma_ctrl_channel(s->rx_ctrl_dma, s->rx_dma, s->rx_cb);
+    dma_start_channel_mask((1u << s->rx_ctrl_dma) | (1u << s->tx_ctrl_dma));
+    return DPL_OK;
+}
+
+/* Waits for a chain started with the interrupt masked, the raw status still shows the end block */
+static void
+spi_pio_wait(struct hal_spi_pio *s)
+{
+    uint32_t mask = 1u << s->rx_dma;
+
+    while (!(dma_hw->intr & mask)) {
+        tight_loop_contents();
+    }
+    dma_hw->ints0 = mask;
+    TRACE_END(TRACE_SPI, s->len);
+    s->len = 0;
+    dma_channel_set_irq0_enabled(s->rx_dma, true);
+}
+
+uint16_t
+hal_spi_tx_val(int spi_num, uint16_t val)
+{
+    struct hal_spi_pio *s = spi_get(spi_num);
+    uint8_t tx = val, rx = 0xff;
+    const struct hal_dw1000_spi_seg seg = {.tx = &tx, .rx = &rx, .len = 1};
+
+    if (!s || spi_pio_start(s, &seg, 1, true) != DPL_OK) {
+        return 0xffff;
+    }
+    spi_pio_wait(s);
+    return rx;
+}
+
+int
+hal_spi_txrx(int spi_num, void *txbuf, void *rxbuf, int cnt)
+{
+    const struct hal_dw1000_spi_seg seg = {.tx = txbuf, .rx = rxbuf, .len = cnt};
+
+    if (!txbuf || cnt <= 0) {
+        return DPL_EINVAL;
+    }
+    return hal_spi_txrx_sg(spi_num, &seg, 1);
+}
+
+/**
+ * Starts a transfer as a DMA chain, the txrx callback is called from the DMA interrupt with the length when the
+ * last byte is in.
+ *
+ * @param spi_num  0 or 1.
+ * @param txbuf    Bytes to send.
+ * @param rxbuf    Received bytes, or NULL.
+ * @param cnt      Length.
+ * @return int     DPL_OK, DPL_EBUSY with a transfer in flight, DPL_EINVAL otherwise.
+ */
+int
+hal_spi_txrx_noblock(int spi_num, void *txbuf, void *rxbuf, int cnt)
+{
+    const struct hal_dw1000_spi_seg seg = {.tx = txbuf, .rx = rxbuf, .len = cnt};
+
+    if (!txbuf || cnt <= 0) {
+        return DPL_EINVAL;
+    }
+    return hal_spi_txrx_sg_noblock(spi_num, &seg, 1);
+}
+
+/**
+ * Clocks a list of segments in one chip select and spins until the last byte is in.
+ *
+ * @param spi_num  0 or 1.
+ * @param seg      Segments, tx or rx may be NULL.
+ * @param nseg     Number of segments, at most DPL_PICO_SPI_SG_MAX of them non empty.
+ * @return int     DPL_OK, DPL_EBUSY with a transfer in flight, DPL_EINVAL otherwise.
+ */
+int
+hal_spi_txrx_sg(int spi_num, const struct hal_dw1000_spi_seg *seg, int nseg)
+{
+    struct hal_spi_pio *s = spi_get(spi_num);
+    int rc;
+
+    if (!s) {
+        return DPL_EINVAL;
+    }
+    rc = spi_pio_start(s, seg, nseg, true);
+    if (rc != DPL_OK) {
+        return rc;
+    }
+    spi_pio_wait(s);
+    return DPL_OK;
+}
+
+/**
+ * Starts a list of segments in one chip select, the txrx callback is called with the total length from the DMA
+ * interrupt when the last byte is in.
+ *
+ * @param spi_num  0 or 1.
+ * @param seg      Segments, tx or rx may be NULL. The segment array may go once this returns, the buffers
+ *                 have to stay until the callback.
+ * @param nseg     Number of segments, at most DPL_PICO_SPI_SG_MAX of them non empty.
+ * @return int     DPL_OK, DPL_EBUSY with a transfer in flight, DPL_EINVAL otherwise.
+ */
+int
+hal_spi_txrx_sg_noblock(int spi_num, const struct hal_dw1000_spi_seg *seg, int nseg)
+{
+    struct hal_spi_pio *s = spi_get(spi_num);
+
+    if (!s) {
+        return DPL_EINVAL;
+    }
+    return spi_pio_start(s, seg, nseg, false);
+}
+
+/**
+ * Holds the chip select low with SCK idle for usecs, rounded down to whole wake loops of the state machine.
+ * Returns once the chip select is back up.
+ *
+ * @param spi_num  0 or 1.
+ * @param usecs    Time to hold the chip select.
+ * @return int     DPL_OK, DPL_EBUSY with a transfer in flight, DPL_EINVAL otherwise.
+ */
+int
+hal_spi_cs_wake(int spi_num, uint32_t usecs)
+{
+    struct hal_spi_pio *s = spi_get(spi_num);
+    uint64_t loops;
+
+    if (!s) {
+        return DPL_EINVAL;
+    }
+    if (s->len) {
+        return DPL_EBUSY;
+    }
+    loops = (uint64_t)usecs * (clock_get_hz(clk_sys) / s->clkdiv) / (1000000ull * SPI_PIO_WAKE_CYCLES);
+    loops = (loops < 1) ? 1 : (loops > ~SPI_PIO_HDR_WAKE) ? ~SPI_PIO_HDR_WAKE : loops;
+    pio_sm_put_blocking(s->pio, s->sm, SPI_PIO_HDR_WAKE | (uint32_t)(loops - 1));
+    while (!pio_sm_is_tx_fifo_empty(s->pio, s->sm)) {
+        tight_loop_contents();
+    }
+    dpl_cputime_delay_usecs(usecs);
+    while (pio_sm_get_pc(s->pio, s->sm) != g_spi_pio_offset + dw1000_spi_offset_start) {
+        tight_loop_contents();
+    }
+    return DPL_OK;
+}
+
+int
+hal_spi_abort(int spi_num)
+{
+    struct hal_spi_pio *s = spi_get(spi_num);
+
+    if (!s) {
+        return DPL_EINVAL;
+    }
+    if (s->len) {
+        dma_channel_abort(s->tx_ctrl_dma);
+        dma_channel_abort(s->rx_ctrl_dma);
+        dma_channel_abort(s->tx_dma);
+        dma_channel_abort(s->rx_dma);
+        dma_channel_acknowledge_irq0(s->rx_dma);
+        dma_channel_set_irq0_enabled(s->rx_dma, true);
+        /* Back to the header pull with the chip select up and nothing left in the fifos */
+        pio_sm_set_enabled(s->pio, s->sm, false);
+        pio_sm_clear_fifos(s->pio, s->sm);
+        pio_sm_restart(s->pio, s->sm);
+        pio_sm_exec(s->pio, s->sm, pio_encode_jmp(g_spi_pio_offset + dw1000_spi_offset_start) |
+                    pio_encode_sideset(2, 0b01));
+        pio_sm_set_enabled(s->pio, s->sm, true);
+        s->len = 0;
+    }
+    return DPL_OK;
+}
+#endif
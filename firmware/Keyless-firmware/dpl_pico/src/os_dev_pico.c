@@ -0,0 +1,100 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/**
+ * @file os_dev_pico.c
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief Device registry of the pico port
+ */
+
+#include <string.h>
+#include <dpl/dpl.h>
+
+static struct os_dev *g_os_devs;
+
+int
+os_dev_create(struct os_dev *dev, const char *name, uint8_t stage, uint8_t priority,
+              os_dev_init_func_t od_init, void *arg)
+{
+    int rc;
+
+    memset(dev, 0, sizeof(*dev));
+    dev->od_name = name;
+    dev->od_stage = stage;
+    dev->od_priority = priority;
+    dev->od_init = od_init;
+    dev->od_init_arg = arg;
+
+    rc = od_init(dev, arg);
+    if (rc != DPL_OK) {
+        return rc;
+    }
+    dev->od_flags |= OS_DEV_F_STATUS_READY;
+    dev->od_next = g_os_devs;
+    g_os_devs = dev;
+    return DPL_OK;
+}
+
+struct os_dev *
+os_dev_lookup(const char *name)
+{
+    struct os_dev *dev;
+
+    for (dev = g_os_devs; dev; dev = dev->od_next) {
+        if (!strcmp(dev->od_name, name)) {
+            return dev;
+        }
+    }
+    return NULL;
+}
+
+struct os_dev *
+os_dev_open(const char *devname, uint32_t timo, void *arg)
+{
+    struct os_dev *dev = os_dev_lookup(devname);
+
+    if (!dev) {
+        return NULL;
+    }
+    if (dev->od_handlers.od_open && dev->od_handlers.od_open(dev, timo, arg) != DPL_OK) {
+        return NULL;
+    }
+    dev->od_open_ref++;
+    dev->od_flags |= OS_DEV_F_STATUS_OPEN;
+    return dev;
+}
+
+int
+os_dev_close(struct os_dev *dev)
+{
+    int rc;
+
+    if (dev->od_handlers.od_close) {
+        rc = dev->od_handlers.od_close(dev);
+        if (rc != DPL_OK) {
+            return rc;
+        }
+    }
+    if (dev->od_open_ref && --dev->od_open_ref == 0) {
+        dev->od_flags &= ~OS_DEV_F_STATUS_OPEN;
+    }
+    return DPL_OK;
+}
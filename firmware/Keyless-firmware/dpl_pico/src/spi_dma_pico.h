@@ -0,0 +1,59 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/**
+ * @file spi_dma_pico.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief DMA chains of the SPI hals of the pico port
+ *
+ * @details A chain is a list of control blocks per direction. A control channel writes the next block into the al1
+ * registers of its data channel, the count write triggers the data channel, which chains back to the control
+ * channel when done. A block with a zero count ends the chain, a quiet data channel interrupts on it.
+ */
+
+#ifndef _SPI_DMA_PICO_H_
+#define _SPI_DMA_PICO_H_
+
+#include <stdint.h>
+#include "hardware/dma.h"
+
+//! DMA control block, written to the al1 registers of a data channel, the count write triggers it
+struct spi_dma_cb {
+    uint32_t ctrl;
+    const volatile void *read_addr;
+    volatile void *write_addr;
+    uint32_t count;
+};
+
+/* Points a control channel at its block list, four words into the al1 registers of the data channel */
+static inline void
+spi_dma_ctrl_channel(int ctrl_dma, int dma, const struct spi_dma_cb *cb)
+{
+    dma_channel_config c = dma_channel_get_default_config(ctrl_dma);
+
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, 4);
+    dma_channel_configure(ctrl_dma, &c, &dma_hw->ch[dma].al1_ctrl, cb, 4, false);
+}
+
+#endif /* _SPI_DMA_PICO_H_ */
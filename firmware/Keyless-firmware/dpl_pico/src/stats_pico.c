@@ -0,0 +1,124 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/**
+ * @file stats_pico.c
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief Statistics of the pico port
+ */
+
+#include <string.h>
+#include <dpl/dpl.h>
+#include <stats/stats.h>
+
+static struct stats_hdr *g_stats;
+
+int
+stats_init(struct stats_hdr *shdr, uint8_t size, uint8_t cnt, const struct stats_name_map *map,
+           uint8_t map_cnt)
+{
+    memset((uint8_t *)shdr + sizeof(*shdr), 0, size * cnt);
+    shdr->s_size = size;
+    shdr->s_cnt = cnt;
+    shdr->s_map = map;
+    shdr->s_map_cnt = map_cnt;
+    return DPL_OK;
+}
+
+int
+stats_register(const char *name, struct stats_hdr *shdr)
+{
+    struct stats_hdr *cur;
+
+    for (cur = g_stats; cur; cur = cur->s_next) {
+        if (cur == shdr || !strcmp(cur->s_name, name)) {
+            return DPL_EINVAL;
+        }
+    }
+    shdr->s_name = name;
+    shdr->s_next = g_stats;
+    g_stats = shdr;
+    return DPL_OK;
+}
+
+int
+stats_init_and_reg(struct stats_hdr *shdr, uint8_t size, uint8_t cnt, const struct stats_name_map *map,
+                   uint8_t map_cnt, const char *name)
+{
+    int rc = stats_init(shdr, size, cnt, map, map_cnt);
+
+    if (rc != DPL_OK) {
+        return rc;
+    }
+    return stats_register(name, shdr);
+}
+
+int
+stats_deregister(struct stats_hdr *shdr)
+{
+    struct stats_hdr **pp;
+
+    for (pp = &g_stats; *pp; pp = &(*pp)->s_next) {
+        if (*pp == shdr) {
+            *pp = shdr->s_next;
+            return DPL_OK;
+        }
+    }
+    return DPL_ENOENT;
+}
+
+void
+stats_reset(struct stats_hdr *shdr)
+{
+    memset((uint8_t *)shdr + sizeof(*shdr), 0, shdr->s_size * shdr->s_cnt);
+}
+
+struct stats_hdr *
+stats_group_find(const char *name)
+{
+    struct stats_hdr *cur;
+
+    for (cur = g_stats; cur; cur = cur->s_next) {
+        if (!strcmp(cur->s_name, name)) {
+            return cur;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Calls walk_cb with the name and offset of every counter of a section.
+ *
+ * @return int  0, or the first nonzero return of walk_cb.
+ */
+int
+stats_walk(struct stats_hdr *shdr, stats_walk_func_t walk_cb, void *arg)
+{
+    int i, rc;
+
+    for (i = 0; i < shdr->s_map_cnt; i++) {
+        rc = walk_cb(shdr, arg, shdr->s_map[i].snm_name, shdr->s_map[i].snm_off);
+        if (rc) {
+            return rc;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+#
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#  http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+#
+"""
+Generate syscfg/syscfg_gen.h from mynewt syscfg.yml files for the pico build, where newt is not
+available. Only the subset of the format used by the uwb packages is understood: syscfg.defs with a
+value per setting, and syscfg.vals / syscfg.vals.<SETTING> overrides. Definitions are taken in the
+order the files are given, the first one wins; overrides are applied afterwards in file order.
+
+  syscfg_gen.py -o syscfg_gen.h a/syscfg.yml b/syscfg.yml ...
+"""
+
+import re
+import sys
+
+SECTION = re.compile(r'^(syscfg\.(?:defs|vals)(?:\.([A-Za-z0-9_]+))?):\s*$')
+SETTING = re.compile(r'^    ([A-Za-z0-9_]+):\s*(.*?)\s*$')
+VALUE = re.compile(r'^        value:\s*(.*?)\s*$')
+
+
+def clean(v):
+    v = v.split(' #')[0].strip()
+    if len(v) >= 2 and v[0] == v[-1] and v[0] in "'":
+        v = v[1:-1]
+    return v
+
+
+def parse(path, defs, vals):
+    section = cond = name = None
+    with open(path) as f:
+        for line in f:
+            line = line.rstrip('\n')
+            if not line.strip() or line.lstrip().startswith('#'):
+                continue
+            m = SECTION.match(line)
+            if m:
+                section, cond, name = m.group(1).split('.')[1], m.group(2), None
+                continue
+            if not line.startswith(' '):
+                section = None
+                continue
+            m = SETTING.match(line)
+            if m and section == 'defs':
+                name = m.group(1)
+                continue
+            if m and section == 'vals':
+                vals.append((cond, m.group(1), clean(m.group(2))))
+                continue
+            m = VALUE.match(line)
+            if m and section == 'defs' and name and name not in defs:
+                defs[name] = clean(m.group(1))
+
+
+def truthy(v):
+    try:
+        return int(v, 0) != 0
+    except ValueError:
+        return v not in ('', '0')
+
+
+def main(argv):
+    if len(argv) < 3 or argv[0] != '-o':
+        sys.stderr.write(__doc__)
+        return 1
+    defs, vals = {}, []
+    for path in argv[2:]:
+        parse(path, defs, vals)
+    for cond, name, v in vals:
+        if cond is None or truthy(defs.get(cond, '0')):
+            defs[name] = v
+
+    with open(argv[1], 'w') as out:
+        out.write('/* Generated by syscfg_gen.py, do not edit */\n\n')
+        out.write('#ifndef H_SYSCFG_GEN_\n#define H_SYSCFG_GEN_\n\n')
+        for name, v in defs.items():
+            if v != '':
+                out.write('#ifndef MYNEWT_VAL_%s\n#define MYNEWT_VAL_%s (%s)\n#endif\n\n' % (name, name, v))
+        out.write('#endif\n')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
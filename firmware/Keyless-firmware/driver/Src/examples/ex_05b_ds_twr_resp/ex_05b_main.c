@@ -26,6 +26,7 @@
 #include "stdio.h"
 #include "deca_spi.h"
 #include "port.h"
+#include "telemetry.h"
 
 /* Example application name and version to display. */
 #define APP_NAME "DS TWR RESP v1.2\r\n"
@@ -101,9 +102,6 @@ static uint64 final_rx_ts;
 static double tof;
 static double distance;
 
-/* String used to display measured distance on UART. */
-char dist_str[16] = {0};
-
 /* Declaration of static functions. */
 static uint64 get_tx_timestamp_u64(void);
 static uint64 get_rx_timestamp_u64(void);
@@ -122,7 +120,6 @@ int dw_main(void)
 {
     /* Display application name. */
     stdio_write(APP_NAME);
-    stdio_write("\033[s"); // Save cursor position
 
     /* Reset and initialise DW1000.
      * For initialisation, DW1000 clocks must be temporarily set to crystal speed. After initialisation SPI rate can be increased for optimum
@@ -256,10 +253,8 @@ int dw_main(void)
                         tof = tof_dtu * DWT_TIME_UNITS;
                         distance = tof * SPEED_OF_LIGHT;
 
-                        /* Display computed distance. */
-                        sprintf(dist_str, "DIST: %3.2f m", distance);
-                        stdio_write("\033[u"); // Restore last cursor position
-                        stdio_write(dist_str);
+                        /* Report computed distance, in mm as a range record so no float formatting is linked in. */
+                        telem_range(0, (int32_t)(distance * 1000), 0);
                     }
                 }
                 else
@@ -25,6 +25,7 @@
 #include "stdio.h"
 #include "deca_spi.h"
 #include "port.h"
+#include "telemetry.h"
 
 /* Example application name and version to display. */
 #define APP_NAME "SS TWR INIT v1.3\r\n"
@@ -87,9 +88,6 @@ static uint32 status_reg = 0;
 static double tof;
 static double distance;
 
-/* String used to display measured distance over UART. */
-char dist_str[16] = {0};
-
 /* Declaration of static functions. */
 static void resp_msg_get_ts(uint8 *ts_field, uint32 *ts);
 
@@ -106,7 +104,6 @@ int dw_main(void)
 {
     /* Display application name. */
     stdio_write(APP_NAME);
-    stdio_write("\033[s"); // Save cursor position
 
     /* Reset and initialise DW1000.
      * For initialisation, DW1000 clocks must be temporarily set to crystal speed. After initialisation SPI rate can be increased for optimum
@@ -194,10 +191,8 @@ int dw_main(void)
                 tof = ((rtd_init - rtd_resp * (1 - clockOffsetRatio)) / 2.0) * DWT_TIME_UNITS;
                 distance = tof * SPEED_OF_LIGHT;
 
-                /* Display computed distance. */
-                sprintf(dist_str, "DIST: %3.2f m", distance);
-                stdio_write(dist_str);
-                stdio_write("\033[u"); // Restore last cursor position
+                /* Report computed distance, in mm as a range record so no float formatting is linked in. */
+                telem_range(0, (int32_t)(distance * 1000), 0);
             }
         }
         else
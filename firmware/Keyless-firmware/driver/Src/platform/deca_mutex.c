@@ -76,6 +76,6 @@ decaIrqStatus_t decamutexon(void)
 void decamutexoff(decaIrqStatus_t s)        // put a function here that re-enables the interrupt at the end of the critical section
 {
 	if(s) { //need to check the port state as we can't use level sensitive interrupt on the STM ARM
-		port_EnableEXT_IRQ();
+		port_RestoreEXT_IRQ(); //an edge while masked is not taken, this raises the line again if it is still high
 	}
 }
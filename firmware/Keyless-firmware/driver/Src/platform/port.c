@@ -15,6 +15,7 @@
 
 #include "port.h"
 #include "deca_device_api.h"
+#include "deca_regs.h"
 #include "stm32f4xx_hal_conf.h"
 #include "main.h"
 
@@ -32,6 +33,11 @@ extern SPI_HandleTypeDef hspi1;
  *******************************************************************************/
 static volatile uint32_t signalResetDone;
 
+#if DECA_IRQ_DEFERRED
+static volatile uint8_t  deca_irq_pending;      /* set by the top half, cleared by the bottom half */
+static volatile uint32_t deca_irq_count;        /* top halves taken */
+#endif
+
 /****************************************************************************//**
  *
  *                              Time section
@@ -318,7 +324,11 @@ void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
     }
     else if (GPIO_Pin == DW_IRQn_Pin)
     {
+#if DECA_IRQ_DEFERRED
+        process_deca_irq_top();
+#else
         process_deca_irq();
+#endif
     }
     else
     {
@@ -341,22 +351,92 @@ __INLINE void process_deca_irq(void)
 }
 
 
+#if DECA_IRQ_DEFERRED
+/* @fn      process_deca_irq_top
+ * @brief   top half of the DW1000 IRQ, runs in EXTI context.
+ *          Masks the DW_IRQ line and leaves the rest to
+ *          process_deca_irq_bottom, which reads SYS_STATUS itself in
+ *          dwt_isr. No SPI access here: the line stays masked until the
+ *          bottom half has run, so the DW1000 is never touched from
+ *          interrupt context.
+ * */
+void process_deca_irq_top(void)
+{
+    port_DisableEXT_IRQ();
+    deca_irq_count++;
+    deca_irq_pending = 1;
+}
+
+/* @fn      process_deca_irq_bottom
+ * @brief   bottom half of the DW1000 IRQ, call from the main loop (and
+ *          from any loop waiting on a DW1000 callback).
+ *          Runs port_deca_isr while the IRQ line is active, then unmasks
+ *          the line with port_RestoreEXT_IRQ, which catches a line that
+ *          rose again before the unmask.
+ * @return  1 if an IRQ was processed, 0 if none was pending
+ * */
+int process_deca_irq_bottom(void)
+{
+    if (!deca_irq_pending)
+    {
+        return 0;
+    }
+    deca_irq_pending = 0;
+    process_deca_irq();
+    port_RestoreEXT_IRQ();
+    return 1;
+}
+
+/* @fn      port_deca_irq_count
+ * @brief   number of DW1000 IRQs taken by the top half
+ * */
+uint32_t port_deca_irq_count(void)
+{
+    return deca_irq_count;
+}
+#endif
+
+
 /* @fn      port_DisableEXT_IRQ
  * @brief   wrapper to disable DW_IRQ pin IRQ
- *          in current implementation it disables all IRQ from lines 5:9
+ *          masks the DW_IRQ line in EXTI, other lines sharing the
+ *          EXTI15_10 vector (DW_RESET, user button) are left enabled
  * */
 __INLINE void port_DisableEXT_IRQ(void)
 {
-    NVIC_DisableIRQ(DECAIRQ_EXTI_IRQn);
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();    /* IMR is shared with the other lines, keep the read-modify-write whole */
+    EXTI->IMR &= ~DW_IRQn_Pin;
+    __set_PRIMASK(primask);
 }
 
 /* @fn      port_EnableEXT_IRQ
  * @brief   wrapper to enable DW_IRQ pin IRQ
- *          in current implementation it enables all IRQ from lines 5:9
  * */
 __INLINE void port_EnableEXT_IRQ(void)
 {
-    NVIC_EnableIRQ(DECAIRQ_EXTI_IRQn);
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    EXTI->IMR |= DW_IRQn_Pin;
+    __set_PRIMASK(primask);
+}
+
+
+/* @fn      port_RestoreEXT_IRQ
+ * @brief   enables the DW_IRQ pin IRQ after a masked section.
+ *          An edge that came while the line was masked is not taken on
+ *          unmask, and the DW1000 holds the line high until its events
+ *          are cleared, so no further edge comes either. The pin is read
+ *          after the unmask and a line still high is raised again through
+ *          EXTI->SWIER.
+ * */
+void port_RestoreEXT_IRQ(void)
+{
+    port_EnableEXT_IRQ();
+    if (port_CheckEXT_IRQ() != 0)
+    {
+        EXTI->SWIER = DW_IRQn_Pin;
+    }
 }
 
 
@@ -365,7 +445,7 @@ __INLINE void port_EnableEXT_IRQ(void)
  * */
 __INLINE uint32_t port_GetEXT_IRQStatus(void)
 {
-    return EXTI_GetITEnStatus(DECAIRQ_EXTI_IRQn);
+    return (EXTI->IMR & DW_IRQn_Pin) ? SET : RESET;
 }
 
 
@@ -54,6 +54,14 @@ void port_set_deca_isr(port_deca_isr_t deca_isr);
 
 #define USB_SUPPORT
 
+/* Split DW1000 IRQ handling. When set, the EXTI callback only masks the DW_IRQ
+ * line and does no SPI; dwt_isr and the application callbacks run from
+ * process_deca_irq_bottom(), which the application must call from its main
+ * loop and from any loop that waits on a DW1000 callback. */
+#ifndef DECA_IRQ_DEFERRED
+#define DECA_IRQ_DEFERRED   (0)
+#endif
+
 typedef struct
 {
     uint16_t        usblen;                 /**< for RX from USB */
@@ -178,6 +186,11 @@ void port_set_dw1000_fastrate(void);
 
 void process_dwRSTn_irq(void);
 void process_deca_irq(void);
+#if DECA_IRQ_DEFERRED
+void process_deca_irq_top(void);
+int  process_deca_irq_bottom(void);
+uint32_t port_deca_irq_count(void);
+#endif
 
 void led_on(led_t led);
 void led_off(led_t led);
@@ -195,6 +208,7 @@ uint32_t port_GetEXT_IRQStatus(void);
 uint32_t port_CheckEXT_IRQ(void);
 void port_DisableEXT_IRQ(void);
 void port_EnableEXT_IRQ(void);
+void port_RestoreEXT_IRQ(void);
 extern uint32_t     HAL_GetTick(void);
 HAL_StatusTypeDef   flush_report_buff(void);
 
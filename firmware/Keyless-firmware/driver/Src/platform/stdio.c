@@ -12,12 +12,16 @@
 * production test program for reading from the standard input and writing to the
 * standard output. This standard I/O can be a UART peripheral, Segger RTT,
 * semihosting, an LCD, ... As long a it can handle sending a data .
+*
+* Output goes out as telemetry records (../telemetry/telemetry.h), queued in
+* a ring that the UART TX DMA drains, so writing never waits on the UART.
 */
 
 #include <stdint.h>
 #include <string.h>
 
 #include "stdio.h"
+#include "telemetry.h"
 
 /* Platform specific includes */
 #include "main.h"
@@ -32,21 +36,77 @@ static UART_HandleTypeDef* uart = NULL;
  */
 void stdio_init(UART_HandleTypeDef* huart) {
     uart = huart;
+    telem_init();
 }
 
 /*! ----------------------------------------------------------------------------
  * @fn stdio_write
- * @brief Transmit/write data to standard output
+ * @brief Queue data for standard output as text records, does not wait for
+ *        the UART
  *
  * @param[in] data Pointer to null terminated string
- * @return Number of bytes transmitted or -1 if an error occurred
+ * @return Number of bytes queued or -1 if the queue was full
  */
-inline int stdio_write(const char *data)
+int stdio_write(const char *data)
 {
     uint16_t len = strlen(data);
-    if (HAL_UART_Transmit(uart, (uint8_t*) data, len, HAL_MAX_DELAY) == HAL_OK) {
-        return len;
+    uint16_t pos, n;
+
+    for (pos = 0; pos < len; pos += n) {
+        n = (len - pos > TELEM_MAX_PAYLOAD) ? TELEM_MAX_PAYLOAD : len - pos;
+        if (telem_send(TELEM_TEXT, data + pos, n) != 0) {
+            return -1;
+        }
+    }
+    return len;
+}
+
+/*! ----------------------------------------------------------------------------
+ * Telemetry port: interrupts masked for the lock, 1 ms time stamps from the
+ * HAL tick and the ring drained by HAL_UART_Transmit_DMA.
+ */
+uint32_t telem_port_lock(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    return primask;
+}
+
+void telem_port_unlock(uint32_t state)
+{
+    __set_PRIMASK(state);
+}
+
+uint32_t telem_port_time_us(void)
+{
+    return HAL_GetTick() * 1000;
+}
+
+void telem_port_init(void)
+{
+}
+
+int telem_port_start(const uint8_t *buf, uint32_t len)
+{
+    return (HAL_UART_Transmit_DMA(uart, (uint8_t*) buf, len) == HAL_OK) ? 0 : -1;
+}
+
+/*! ----------------------------------------------------------------------------
+ * @fn HAL_UART_TxCpltCallback
+ * @brief Called by the HAL once the DMA transfer left the UART, starts the
+ *        next part of the ring
+ */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart == uart) {
+        telem_tx_done();
+    }
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    if (huart == uart && huart->gState == HAL_UART_STATE_READY) {
+        telem_tx_done();
     }
-    return -1;
 }
 
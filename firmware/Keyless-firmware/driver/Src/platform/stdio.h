@@ -31,10 +31,11 @@ void stdio_init(UART_HandleTypeDef* huart);
 
 /*! ----------------------------------------------------------------------------
  * @fn stdio_write
- * @brief Transmit/write data to standard output
+ * @brief Queue data for standard output as text records, does not wait for
+ *        the UART
  *
  * @param[in] data Pointer to null terminated string
- * @return Number of bytes transmitted or -1 if an error occured
+ * @return Number of bytes queued or -1 if the queue was full
  */
 int stdio_write(const char *data);
 
@@ -0,0 +1,152 @@
+//
+// Created by Jeremy King on 10/18/21.
+//
+
+#include "entry.h"
+
+static int32_t median3(int32_t a, int32_t b, int32_t c){
+	if (a > b){
+		int32_t t = a;
+		a = b;
+		b = t;
+	}
+	return c < a ? a : (c > b ? b : c);
+}
+
+void passive_entry::range(uint32_t time_us, uint16_t key_id, int32_t dist_mm){
+	int32_t m;
+
+	if (authed && key_id != key){
+		return; //another key in range, not the one that may open the car
+	}
+	last[next] = dist_mm;
+	next = (next + 1) % 3;
+	if (count < 3){
+		count++;
+	}
+	range_us = time_us;
+	ranged = true;
+	if (count >= 3){
+		m = median3(last[0], last[1], last[2]);
+	}
+	else if (count == 2){
+		m = last[0] > last[1] ? last[0] : last[1]; //both have to be near
+	}
+	else {
+		m = dist_mm;
+	}
+
+	if (dist_mm > ENTRY_UNLOCK_MM && in != ZONE_NEAR){
+		near_seen = false; //the latency counts from the first of an unbroken run of near ranges
+	}
+	else if (dist_mm <= ENTRY_UNLOCK_MM && !near_seen){
+		near_us = time_us;
+		near_seen = true;
+	}
+
+	zone z = in;
+	if (m <= ENTRY_UNLOCK_MM){
+		z = ZONE_NEAR;
+	}
+	else if (m >= ENTRY_LOCK_MM){
+		z = ZONE_AWAY;
+	}
+	if (z != in){
+		in = z;
+		zone_us = time_us;
+	}
+}
+
+void passive_entry::auth(uint16_t key_id, bool ok){
+	if (ok && (!authed || key_id != key)){
+		count = 0; //the median may hold another key's ranges
+		next = 0;
+		key = key_id;
+		authed = true;
+	}
+	else if (!ok && key_id == key){
+		authed = false;
+	}
+}
+
+void passive_entry::link(uint32_t time_us, bool up){
+	link_up = up;
+	range_us = time_us; //the lost timer starts over with the radio
+	if (!up){
+		count = 0;
+		next = 0;
+		authed = false; //a key has to authenticate again on the new link
+	}
+}
+
+//spends a pulse if the gap since the last one and the burst allow it
+bool passive_entry::allowed(uint32_t now_us){
+	while (tokens < ENTRY_BURST && now_us - refill_us >= ENTRY_REFILL_MS * 1000){
+		tokens++;
+		refill_us += ENTRY_REFILL_MS * 1000;
+	}
+	if (pulsed && now_us - pulse_us < ENTRY_MIN_GAP_MS * 1000){
+		return false;
+	}
+	if (!tokens){
+		return false;
+	}
+	if (tokens == ENTRY_BURST){
+		refill_us = now_us; //the refill clock runs from the first pulse out of a full bucket
+	}
+	tokens--;
+	pulse_us = now_us;
+	pulsed = true;
+	return true;
+}
+
+entry_action passive_entry::update(uint32_t now_us){
+	entry_action want = ENTRY_NONE;
+
+	//only once the key has been heard, a car nobody walked up to keeps its doors as they are
+	if (link_up && ranged && in != ZONE_AWAY && now_us - range_us >= ENTRY_LOST_MS * 1000){
+		in = ZONE_AWAY;
+		zone_us = now_us;
+		count = 0;
+		next = 0;
+		near_seen = false;
+	}
+
+	uint32_t dwell_ms = (now_us - zone_us) / 1000;
+	if (in == ZONE_NEAR && authed && doors != ENTRY_UNLOCKED && dwell_ms >= ENTRY_UNLOCK_DWELL_MS){
+		want = ENTRY_UNLOCK;
+	}
+	else if (in == ZONE_AWAY && doors != ENTRY_LOCKED && dwell_ms >= ENTRY_LOCK_DWELL_MS){
+		want = ENTRY_LOCK;
+	}
+	if (want == ENTRY_NONE){
+		held = false;
+		return ENTRY_NONE;
+	}
+	if (!allowed(now_us)){
+		if (!held){
+			st.limited++;
+			held = true;
+		}
+		return ENTRY_NONE;
+	}
+	held = false;
+
+	if (want == ENTRY_UNLOCK){
+		uint32_t lat = now_us - (near_seen ? near_us : zone_us);
+		doors = ENTRY_UNLOCKED;
+		st.unlocks++;
+		st.last_us = lat;
+		if (lat > st.worst_us){
+			st.worst_us = lat;
+		}
+		if (lat > ENTRY_UNLOCK_TARGET_US){
+			st.late++;
+		}
+	}
+	else {
+		doors = ENTRY_LOCKED;
+		st.locks++;
+	}
+	return want;
+}
@@ -0,0 +1,90 @@
+//
+// Created by Jeremy King on 10/18/21.
+//
+
+#ifndef KEYLESS_FIRMWARE_ENTRY_H
+#define KEYLESS_FIRMWARE_ENTRY_H
+//passive entry, unlocks when the key comes up to the car and locks once it has walked away
+//ranges go through a median of 3 and then a zone with a hysteresis band between the unlock and lock radius.
+//a zone has to be held for its dwell before the doors follow it, and the relays are rate limited so a key
+//hanging around the edge cannot wear them out. only a key that passed authentication unlocks, once one has its
+//ranges are the only ones taken. no pico calls in here, times come in from the caller, test/entry_test.cpp
+//drives it on the host
+#include <stdint.h>
+
+#define ENTRY_UNLOCK_MM 1500 //closer than this is near
+#define ENTRY_LOCK_MM 3000 //further than this is away, in between keeps whatever zone it was in
+#define ENTRY_UNLOCK_DWELL_MS 100
+#define ENTRY_LOCK_DWELL_MS 5000
+#define ENTRY_LOST_MS 3000 //radio up but no range from the key this long counts as away
+#define ENTRY_PULSE_MS 300 //relay on time, ended by a timer so a busy car loop cannot stretch it
+#define ENTRY_MIN_GAP_MS 2000 //between two pulses
+#define ENTRY_BURST 4 //pulses that may go back to back, one more is allowed every ENTRY_REFILL_MS
+#define ENTRY_REFILL_MS 15000
+//key crossing the unlock radius to the unlock relay. at 10 ranges a second the median, the dwell and the
+//range noise at the edge come to around 280ms typical and 450ms at the 95th percentile, see test/entry_test.cpp
+#define ENTRY_UNLOCK_TARGET_US (500 * 1000)
+
+enum entry_action : uint8_t {
+	ENTRY_NONE,
+	ENTRY_UNLOCK,
+	ENTRY_LOCK,
+};
+
+//what the doors were last told, same values as the door TELEM_STATE
+enum entry_doors : uint8_t {
+	ENTRY_LOCKED,
+	ENTRY_UNLOCKED,
+	ENTRY_UNKNOWN, //nothing pulsed since boot
+};
+
+struct entry_stats {
+	uint32_t unlocks;
+	uint32_t locks;
+	uint32_t limited; //pulses held back by the rate limit
+	uint32_t late; //unlocks over ENTRY_UNLOCK_TARGET_US
+	uint32_t last_us; //first in zone range to unlock relay
+	uint32_t worst_us;
+};
+
+class passive_entry {
+private:
+	enum zone : uint8_t {ZONE_NONE, ZONE_NEAR, ZONE_AWAY};
+	int32_t last[3]{}; //ranges for the median
+	uint8_t next = 0;
+	uint8_t count = 0; //how many of last are filled
+	zone in = ZONE_NONE;
+	uint32_t zone_us = 0; //when the median entered the zone
+	uint32_t near_us = 0; //first raw range inside the unlock radius of this approach, for the latency
+	bool near_seen = false;
+	uint32_t range_us = 0; //last range from the key
+	bool ranged = false; //heard the key since boot
+	bool link_up = false;
+	uint16_t key = 0; //the authenticated key
+	bool authed = false;
+	entry_doors doors = ENTRY_UNKNOWN;
+	uint32_t pulse_us = 0;
+	bool pulsed = false;
+	uint32_t tokens = ENTRY_BURST;
+	uint32_t refill_us = 0;
+	bool held = false; //the pending pulse was already counted as limited
+	entry_stats st = {};
+	bool allowed(uint32_t now_us);
+public:
+	void range(uint32_t time_us, uint16_t key_id, int32_t dist_mm); //every range of a key
+	void auth(uint16_t key_id, bool ok); //result of authenticating a key, nothing unlocks before an ok one
+	void link(uint32_t time_us, bool up); //down forgets the key and its authentication
+	entry_action update(uint32_t now_us); //the pulse to start now, the caller does it at once
+	bool authenticated(){
+		return authed;
+	};
+	entry_doors get_doors(){
+		return doors;
+	};
+	entry_stats get_stats(){
+		return st;
+	};
+};
+
+
+#endif //KEYLESS_FIRMWARE_ENTRY_H
@@ -9,6 +9,7 @@
 #define IN_KILL 9 //Engine Kill
 #define IN_START 10 //engine start button
 #include "hardware/gpio.h"
+#include "trace.h"
 #include <vector>
 #include <array>
 using namespace std;
@@ -19,6 +20,7 @@ private:
 	uint32_t is_running;
 	uint32_t kill_switch;
 	uint32_t input_array[3] = {};
+	uint32_t traced = ~0u; //inputs at the last trace point, only changes are traced
 public:
 	void set_run_status() {
 		if (gpio_get(IN_RUN)){
@@ -47,6 +49,16 @@ public:
 	void write_input_array(uint32_t setter, int pos){
 		input_array[pos] = setter;
 	};
+	void poll(){
+		set_kill_status();
+		set_run_status();
+		set_start_status();
+		uint32_t bits = kill_switch | is_running << 1 | start_button << 2;
+		if (bits != traced){
+			traced = bits;
+			TRACE_INSTANT(TRACE_INPUTS, bits);
+		}
+	};
 	uint32_t get_run_status(){
 		return is_running;
 	};
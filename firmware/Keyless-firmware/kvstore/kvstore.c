@@ -0,0 +1,291 @@
+//
+// Created by Jeremy King on 10/18/21.
+//
+
+#include "kvstore.h"
+#include <string.h>
+#include <stdbool.h>
+
+#if KV_SECTORS < 2
+#error "KV_SECTORS has to be at least 2"
+#endif
+
+#define KV_MAGIC 0x3153564bu //"KVS1"
+#define KV_HDR 12 //sector stamp
+#define KV_REC_HDR 8
+#define KV_KEY_FREE 0xffff //erased flash
+#define KV_KEY_SEAL 0xfffe //ends the copy a roll starts with
+#define KV_ALIGN(n) (((n) + 3u) & ~3u)
+
+struct kv_sector {
+	uint32_t magic;
+	uint32_t seq;
+	uint32_t seq_inv; //a stamp cut short by a reset does not match
+};
+
+struct kv_rec {
+	uint16_t key;
+	uint16_t len;
+	uint32_t crc;
+};
+
+struct kv_entry {
+	uint16_t key;
+	uint16_t len;
+	uint32_t off; //of the record from the start of the region
+};
+
+static struct kv_entry kv_index[KV_MAX_KEYS];
+static uint32_t kv_nkeys;
+static uint32_t kv_live; //bytes the live records would take in a fresh sector
+static uint32_t kv_head; //sector the next record goes to
+static uint32_t kv_head_seq; //newest stamp in the region, a copy cut short may have used it
+static uint32_t kv_sealed; //newest sealed sector, the only one the index points into
+static uint32_t kv_pos; //first free byte in the head sector
+static uint8_t kv_buf[KV_REC_HDR + KV_MAX_VALUE]; //records are put together here, the port wants ram
+
+//crc32 (zlib) a nibble at a time
+static const uint32_t kv_crc_nib[16] = {
+	0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+	0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+};
+
+static uint32_t kv_crc(const struct kv_rec *r, const uint8_t *val){
+	const uint8_t *p = (const uint8_t *)r;
+	uint32_t crc = 0xffffffff;
+
+	for (uint32_t i = 0; i < 4u + r->len; i++){ //key and len, then the value
+		crc ^= i < 4 ? p[i] : val[i - 4];
+		crc = (crc >> 4) ^ kv_crc_nib[crc & 0xf];
+		crc = (crc >> 4) ^ kv_crc_nib[crc & 0xf];
+	}
+	return ~crc;
+}
+
+static const uint8_t *kv_at(uint32_t off){
+	return kv_port_base() + off;
+}
+
+static bool kv_stamped(uint32_t s){
+	const struct kv_sector *h = (const struct kv_sector *)kv_at(s * KV_SECTOR_SIZE);
+	return h->magic == KV_MAGIC && h->seq_inv == ~h->seq;
+}
+
+static bool kv_blank(uint32_t s){
+	const uint32_t *w = (const uint32_t *)kv_at(s * KV_SECTOR_SIZE);
+
+	for (uint32_t i = 0; i < KV_SECTOR_SIZE / 4; i++){
+		if (w[i] != 0xffffffff){
+			return false;
+		}
+	}
+	return true;
+}
+
+static struct kv_entry *kv_find(uint16_t key){
+	for (uint32_t i = 0; i < kv_nkeys; i++){
+		if (kv_index[i].key == key){
+			return &kv_index[i];
+		}
+	}
+	return NULL;
+}
+
+//points the key at the record at off, len 0 takes it out
+static void kv_index_put(uint16_t key, uint16_t len, uint32_t off){
+	struct kv_entry *e = kv_find(key);
+
+	if (e){
+		kv_live -= KV_REC_HDR + KV_ALIGN(e->len);
+		if (!len){
+			*e = kv_index[--kv_nkeys];
+			return;
+		}
+	}
+	else if (!len || kv_nkeys == KV_MAX_KEYS){
+		return; //a full index only happens with a log from a build with more keys
+	}
+	else {
+		e = &kv_index[kv_nkeys++];
+	}
+	*e = (struct kv_entry){key, len, off};
+	kv_live += KV_REC_HDR + KV_ALIGN(len);
+}
+
+//replays one sector into the index, returns where its free space starts
+static uint32_t kv_walk(uint32_t s, bool *sealed){
+	uint32_t pos = KV_HDR;
+
+	*sealed = false;
+	while (pos + KV_REC_HDR <= KV_SECTOR_SIZE){
+		const struct kv_rec *r = (const struct kv_rec *)kv_at(s * KV_SECTOR_SIZE + pos);
+		if (r->key == KV_KEY_FREE && r->len == 0xffff && r->crc == 0xffffffff){
+			return pos;
+		}
+		if (r->len > KV_MAX_VALUE || pos + KV_REC_HDR + KV_ALIGN(r->len) > KV_SECTOR_SIZE){
+			return KV_SECTOR_SIZE; //a header cut short, nothing behind it can be found so the sector is full
+		}
+		if (r->crc == kv_crc(r, (const uint8_t *)(r + 1))){
+			if (r->key == KV_KEY_SEAL){
+				*sealed = true;
+			}
+			else if (r->key != 0){
+				kv_index_put(r->key, r->len, s * KV_SECTOR_SIZE + pos);
+			}
+		}
+		pos += KV_REC_HDR + KV_ALIGN(r->len);
+	}
+	return pos;
+}
+
+//rebuilds the index from one sector, left empty unless the sector is sealed
+static uint32_t kv_load(uint32_t s, bool *sealed){
+	uint32_t pos;
+
+	kv_nkeys = 0;
+	kv_live = 0;
+	pos = kv_walk(s, sealed);
+	if (!*sealed){
+		kv_nkeys = 0;
+		kv_live = 0;
+	}
+	return pos;
+}
+
+//writes a record at the head, the caller has made sure it fits. val may point into the store itself
+static int kv_append(uint16_t key, const void *val, uint16_t len){
+	struct kv_rec r = {key, len, 0};
+	uint32_t n = KV_REC_HDR + KV_ALIGN(len);
+	uint32_t off = kv_head * KV_SECTOR_SIZE + kv_pos;
+
+	memset(&kv_buf[KV_REC_HDR + len], 0xff, n - KV_REC_HDR - len); //padding stays erased
+	if (len){
+		memcpy(&kv_buf[KV_REC_HDR], val, len);
+	}
+	r.crc = kv_crc(&r, &kv_buf[KV_REC_HDR]);
+	memcpy(kv_buf, &r, KV_REC_HDR);
+	kv_pos += n; //used whatever happens next
+	if (kv_port_program(off, kv_buf, n) != 0 || memcmp(kv_at(off), kv_buf, n) != 0){
+		return -1;
+	}
+	if (key != KV_KEY_SEAL){
+		kv_index_put(key, len, off);
+	}
+	return 0;
+}
+
+//copies every live value into the sector after the sealed one, then seals it
+//the index only points into the sealed sector, so the one after it is free to erase whatever a cut short roll
+//left in it, and the sealed sector stays until the copy is sealed
+static int kv_roll(void){
+	uint32_t s = (kv_sealed + 1) % KV_SECTORS;
+	struct kv_sector h = {KV_MAGIC, kv_head_seq + 1, ~(kv_head_seq + 1)};
+	uint32_t i = 0;
+	bool sealed;
+
+	kv_head_seq = h.seq; //used once it may have reached the flash
+	if ((kv_blank(s) || kv_port_erase(s) == 0) && kv_port_program(s * KV_SECTOR_SIZE, &h, sizeof(h)) == 0){
+		kv_head = s;
+		kv_pos = KV_HDR;
+		for (; i < kv_nkeys; i++){ //an entry is updated in place, the order does not change
+			struct kv_entry e = kv_index[i];
+			if (kv_append(e.key, kv_at(e.off + KV_REC_HDR), e.len) != 0){
+				break;
+			}
+		}
+		if (i == kv_nkeys && kv_append(KV_KEY_SEAL, NULL, 0) == 0){
+			kv_sealed = s;
+			return 0;
+		}
+	}
+	//back on the sealed sector, it is full so the next update rolls into s again
+	kv_head = kv_sealed;
+	kv_load(kv_sealed, &sealed);
+	kv_pos = KV_SECTOR_SIZE;
+	return -1;
+}
+
+//a sealed sector holds every value that was live when it was rolled into and every update after that, so the
+//index comes from the newest one alone. stamped sectors after it are copies cut short and anything unstamped is a
+//stamp or an erase cut short, the roll that gets to them erases them, boot does not
+int kv_init(void){
+	uint32_t order[KV_SECTORS];
+	uint32_t n = 0;
+	bool sealed = false;
+
+	kv_nkeys = 0;
+	kv_live = 0;
+	for (uint32_t s = 0; s < KV_SECTORS; s++){
+		if (kv_stamped(s)){
+			uint32_t seq = ((const struct kv_sector *)kv_at(s * KV_SECTOR_SIZE))->seq;
+			uint32_t i = n++;
+			for (; i > 0 && ((const struct kv_sector *)kv_at(order[i - 1] * KV_SECTOR_SIZE))->seq > seq; i--){
+				order[i] = order[i - 1];
+			}
+			order[i] = s;
+		}
+	}
+	kv_head_seq = n ? ((const struct kv_sector *)kv_at(order[n - 1] * KV_SECTOR_SIZE))->seq : 0;
+	for (uint32_t i = n; i-- > 0 && !sealed;){
+		kv_head = kv_sealed = order[i];
+		kv_pos = kv_load(order[i], &sealed);
+	}
+	if (!sealed){ //first boot or its first roll cut short, nothing was ever stored
+		kv_head = kv_sealed = KV_SECTORS - 1;
+		if (kv_roll() != 0){
+			return -1;
+		}
+	}
+	return kv_nkeys;
+}
+
+int kv_prepare(void){
+	uint32_t s = (kv_sealed + 1) % KV_SECTORS;
+
+	return kv_blank(s) ? 0 : kv_port_erase(s);
+}
+
+const void *kv_get(uint16_t key, uint16_t *len){
+	struct kv_entry *e = kv_find(key);
+
+	if (!e){
+		return NULL;
+	}
+	if (len){
+		*len = e->len;
+	}
+	return kv_at(e->off + KV_REC_HDR);
+}
+
+int kv_set(uint16_t key, const void *val, uint16_t len){
+	struct kv_entry *e = kv_find(key);
+	uint32_t need = KV_REC_HDR + KV_ALIGN(len);
+
+	if (key < KV_KEY_MIN || key > KV_KEY_MAX || len > KV_MAX_VALUE){
+		return -1;
+	}
+	if (len){
+		uint32_t old = e ? KV_REC_HDR + KV_ALIGN(e->len) : 0;
+		if ((!e && kv_nkeys == KV_MAX_KEYS) || kv_live - old + need > KV_LIVE_MAX){
+			return -1;
+		}
+		if (e && e->len == len && memcmp(kv_at(e->off + KV_REC_HDR), val, len) == 0){
+			return 0; //already there, no flash used
+		}
+	}
+	else if (!e){
+		return 0;
+	}
+	if (kv_pos + need > KV_SECTOR_SIZE && kv_roll() != 0){
+		return -1;
+	}
+	return kv_append(key, val, len);
+}
+
+int kv_delete(uint16_t key){
+	return kv_set(key, NULL, 0);
+}
+
+uint32_t kv_seq(void){
+	return kv_head_seq;
+}
@@ -0,0 +1,58 @@
+//
+// Created by Jeremy King on 10/18/21.
+//
+
+#ifndef KEYLESS_FIRMWARE_KVSTORE_H
+#define KEYLESS_FIRMWARE_KVSTORE_H
+//key/value store kept as an append only log in the last KV_SECTORS sectors of flash
+//a value is read where it sits in memory mapped flash, kv_get hands out a pointer to it and boot casts that to
+//the struct it stored, nothing is parsed or copied. an update appends a new record with a crc32 and moves the
+//key's index entry onto it, the old record stays until its sector is reused
+//
+//sectors are used round robin. when the head sector is full the next one is erased, stamped with the next
+//sequence number and every live value is copied into it before the update goes in, then a seal record closes
+//the copy. the index only ever points into the newest sealed sector, kv_init rebuilds it from that sector alone
+//and a copy cut short by a reset is done again into the sector after it, so the sealed sector is never erased
+//before another one is sealed. every sector gets erased once per KV_SECTORS rolls, by the roll itself unless
+//kv_prepare got to it first. an erase stops everything running from flash for up to a few hundred ms, so a
+//caller with time critical work calls kv_prepare when there is none and its rolls only program
+//
+//sector: magic u32, seq u32, ~seq u32, then records
+//record: key u16, len u16, crc32 u32 over key, len and value, value padded to 4 bytes. len 0 deletes the key
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef KV_SECTORS
+#define KV_SECTORS 4 //at least 2, more spreads the erases
+#endif
+#define KV_SECTOR_SIZE 4096
+#define KV_MAX_KEYS 32
+#define KV_MAX_VALUE 512
+//live records are held to half a sector less its stamp and seal, so a roll always has room for the copy and
+//then the update
+#define KV_LIVE_MAX ((KV_SECTOR_SIZE - 20) / 2)
+
+//0, 0xfffe and 0xffff are taken by the log
+#define KV_KEY_MIN 1
+#define KV_KEY_MAX 0xfffd
+
+int kv_init(void); //scans the log, the number of live keys or -1 when the flash could not be set up
+int kv_prepare(void); //erases the sector the next roll goes into unless it is blank, 0 once it is
+const void *kv_get(uint16_t key, uint16_t *len); //the value in flash or NULL, len may be NULL
+int kv_set(uint16_t key, const void *val, uint16_t len); //0 when it is in flash, -1 when it did not fit or failed
+int kv_delete(uint16_t key);
+uint32_t kv_seq(void); //sequence number of the head sector, how many rolls the store has been through
+
+//implemented by the platform port, kvstore_pico.c
+const uint8_t *kv_port_base(void); //the KV_SECTORS sectors as mapped for reading
+int kv_port_erase(uint32_t sector); //0 when it worked
+int kv_port_program(uint32_t off, const void *data, uint32_t len); //data in ram, bits only go from 1 to 0
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //KEYLESS_FIRMWARE_KVSTORE_H
@@ -0,0 +1,74 @@
+//
+// Created by Jeremy King on 10/18/21.
+//
+
+//rp2040 port of the store, the last KV_SECTORS sectors of the qspi flash read through xip
+//while the flash is erased or programmed nothing may run from it: the other core is parked in ram with the
+//multicore lockout and this one has its interrupts masked. an erase can take a few hundred ms so the watchdog
+//is fed on both sides of every flash operation, and an erase is one sector so the feeds fall between sectors.
+//boot only erases on the very first roll, after that settings_sync is the only caller and keeps to the car
+//loop's idle pass
+#include "kvstore.h"
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "hardware/watchdog.h"
+
+#define KV_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - KV_SECTORS * KV_SECTOR_SIZE)
+#if KV_SECTOR_SIZE != FLASH_SECTOR_SIZE
+#error "the store's sectors have to be flash sectors"
+#endif
+
+static uint8_t kv_page[FLASH_PAGE_SIZE]; //programming goes a whole page at a time
+
+static uint32_t kv_flash_begin(void){
+	watchdog_update();
+	//before core1 is launched there is nobody to park
+	if (multicore_lockout_victim_is_initialized(get_core_num() ^ 1)){
+		multicore_lockout_start_blocking();
+	}
+	return save_and_disable_interrupts();
+}
+
+static void kv_flash_end(uint32_t irq){
+	restore_interrupts(irq);
+	if (multicore_lockout_victim_is_initialized(get_core_num() ^ 1)){
+		multicore_lockout_end_blocking();
+	}
+	watchdog_update();
+}
+
+const uint8_t *kv_port_base(void){
+	return (const uint8_t *)(XIP_BASE + KV_FLASH_OFFSET);
+}
+
+int kv_port_erase(uint32_t sector){
+	uint32_t irq = kv_flash_begin();
+	flash_range_erase(KV_FLASH_OFFSET + sector * FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE);
+	kv_flash_end(irq);
+	return 0;
+}
+
+//the rest of the page is programmed with 0xff, which leaves whatever is already there alone
+int kv_port_program(uint32_t off, const void *data, uint32_t len){
+	const uint8_t *p = (const uint8_t *)data;
+
+	while (len){
+		uint32_t page = off & ~(FLASH_PAGE_SIZE - 1);
+		uint32_t in = off - page;
+		uint32_t n = FLASH_PAGE_SIZE - in < len ? FLASH_PAGE_SIZE - in : len;
+		uint32_t irq;
+
+		memset(kv_page, 0xff, sizeof(kv_page));
+		memcpy(&kv_page[in], p, n);
+		irq = kv_flash_begin();
+		flash_range_program(KV_FLASH_OFFSET + page, kv_page, FLASH_PAGE_SIZE);
+		kv_flash_end(irq);
+		off += n;
+		p += n;
+		len -= n;
+	}
+	return 0;
+}
@@ -0,0 +1,134 @@
+//
+// Created by Jeremy King on 10/18/21.
+//
+
+#include "settings.h"
+#include <string.h>
+#include "kvstore.h"
+#include "spsc_channel.h"
+#ifdef KEYLESS_UWB
+#include <dpl/dpl.h>
+#include <dw1000/dw1000_dev.h>
+#include <dw1000/dw1000_hal.h>
+#include <dw1000/dw1000_phy.h>
+#include <dw1000/dw1000_tempcomp.h>
+#endif
+
+void settings_init(){
+	kv_init();
+}
+
+const void *settings_get(settings_key key, uint16_t size){
+	uint16_t len;
+	const void *p = kv_get(key, &len);
+	return p && len == size ? p : nullptr; //a record from a build with another layout is left alone
+}
+
+#ifdef KEYLESS_UWB
+#define SETTINGS_POLL_MS 1000 //how often core1 looks at its calibration
+
+//the radio's calibration as core1 sees it, taken on core1 and handed to core0 through the channel
+struct settings_radio {
+	settings_antdly antdly;
+	settings_xtal xtal;
+	settings_tx_ref tx_ref;
+	uint32_t changed; //1 << settings_key for each one that moved since the last push
+};
+
+static spsc_channel<settings_radio, 4> radio_changes;
+static settings_radio radio_last; //core1, what the last push or the boot's apply saw
+static struct dpl_callout radio_poll; //on core1's event queue
+static settings_radio radio_want; //core0, the newest value of each key
+static uint32_t radio_pending; //core0, keys in radio_want that are not in flash yet
+
+static settings_radio settings_read_radio(struct _dw1000_dev_instance_t *inst){
+	settings_radio r = {};
+	r.antdly = {inst->uwb_dev.rx_antenna_delay, inst->uwb_dev.tx_antenna_delay};
+	r.xtal = {inst->uwb_dev.config.rx.xtalTrim, {0, 0, 0}};
+#if MYNEWT_VAL(DW1000_TEMPCOMP_ENABLED)
+	const struct dw1000_tempcomp_ref &ref = dw1000_tempcomp_get(inst)->ref;
+	r.tx_ref = {ref.temp_raw, ref.pgdly, ref.pg_count, ref.power};
+#endif
+	return r;
+}
+
+//core1, the calibration and trim steps run on this core so reading the fields here needs nothing
+static void settings_poll_cb(struct dpl_event *ev){
+	settings_radio r = settings_read_radio(hal_dw1000_inst(0));
+
+	r.changed = (memcmp(&r.antdly, &radio_last.antdly, sizeof(r.antdly)) != 0) << SET_ANTDLY |
+		(memcmp(&r.xtal, &radio_last.xtal, sizeof(r.xtal)) != 0) << SET_XTAL_TRIM |
+		(memcmp(&r.tx_ref, &radio_last.tx_ref, sizeof(r.tx_ref)) != 0) << SET_TX_REF;
+	if (r.changed && radio_changes.push(r)){
+		radio_last = r; //a full channel is tried again on the next poll
+	}
+	dpl_callout_reset(&radio_poll, dpl_time_ms_to_ticks32(SETTINGS_POLL_MS));
+}
+
+void settings_apply_uwb(){
+	struct _dw1000_dev_instance_t *inst = hal_dw1000_inst(0);
+	auto ad = (const settings_antdly *)settings_get(SET_ANTDLY, sizeof(settings_antdly));
+	auto xt = (const settings_xtal *)settings_get(SET_XTAL_TRIM, sizeof(settings_xtal));
+
+	if (ad){
+		inst->uwb_dev.rx_antenna_delay = ad->rx; //kept in uwb_dev so the wakeup reload uses them too
+		inst->uwb_dev.tx_antenna_delay = ad->tx;
+		dw1000_phy_set_rx_antennadelay(inst, ad->rx);
+		dw1000_phy_set_tx_antennadelay(inst, ad->tx);
+	}
+	if (xt){
+		dw1000_phy_set_xtal_trim(inst, xt->trim);
+	}
+#if MYNEWT_VAL(DW1000_TEMPCOMP_ENABLED)
+	auto tr = (const settings_tx_ref *)settings_get(SET_TX_REF, sizeof(settings_tx_ref));
+	struct dw1000_tempcomp_ref ref;
+	if (tr){
+		ref = {tr->temp_raw, tr->pgdly, tr->pg_count, tr->power};
+	}
+	//without one the reference is measured now and stored by the next sync, so it stays the first boot's
+	dw1000_tempcomp_start(dw1000_tempcomp_init(inst, tr ? &ref : nullptr));
+#endif
+	radio_last = settings_read_radio(inst);
+#if MYNEWT_VAL(DW1000_TEMPCOMP_ENABLED)
+	if (!tr){
+		radio_last.tx_ref = {}; //the first poll sees the measured reference as a change
+	}
+#endif
+	dpl_callout_init(&radio_poll, dpl_eventq_dflt_get(), settings_poll_cb, nullptr);
+	dpl_callout_reset(&radio_poll, dpl_time_ms_to_ticks32(SETTINGS_POLL_MS));
+}
+
+//only takes what core1 pushed, never the radio's fields themselves. a key that failed to go in is tried again
+void settings_sync(){
+	settings_radio r;
+
+	while (radio_changes.pop(r)){
+		if (r.changed & 1 << SET_ANTDLY){
+			radio_want.antdly = r.antdly;
+		}
+		if (r.changed & 1 << SET_XTAL_TRIM){
+			radio_want.xtal = r.xtal;
+		}
+		if (r.changed & 1 << SET_TX_REF){
+			radio_want.tx_ref = r.tx_ref;
+		}
+		radio_pending |= r.changed;
+	}
+	if (radio_pending & 1 << SET_ANTDLY && kv_set(SET_ANTDLY, &radio_want.antdly, sizeof(settings_antdly)) == 0){
+		radio_pending &= ~(1 << SET_ANTDLY);
+	}
+	if (radio_pending & 1 << SET_XTAL_TRIM && kv_set(SET_XTAL_TRIM, &radio_want.xtal, sizeof(settings_xtal)) == 0){
+		radio_pending &= ~(1 << SET_XTAL_TRIM);
+	}
+	if (radio_pending & 1 << SET_TX_REF && kv_set(SET_TX_REF, &radio_want.tx_ref, sizeof(settings_tx_ref)) == 0){
+		radio_pending &= ~(1 << SET_TX_REF);
+	}
+	kv_prepare(); //erases ahead, the roll one of the next writes needs then only programs
+}
+#else
+void settings_apply_uwb(){
+}
+
+void settings_sync(){
+}
+#endif
@@ -0,0 +1,44 @@
+//
+// Created by Jeremy King on 10/18/21.
+//
+
+#ifndef KEYLESS_FIRMWARE_SETTINGS_H
+#define KEYLESS_FIRMWARE_SETTINGS_H
+//calibration kept in the flash key/value store over the compile time defaults
+//the structs here are the records as they sit in flash, boot reads them in place through xip
+#include <stdint.h>
+
+enum settings_key : uint16_t {
+	SET_ANTDLY = 1, //settings_antdly
+	SET_XTAL_TRIM, //settings_xtal
+	SET_TX_REF, //settings_tx_ref
+	SET_FOBS, //kept free for the enrolled keys, security_check has no key material yet
+};
+
+struct settings_antdly {
+	uint16_t rx;
+	uint16_t tx;
+};
+
+struct settings_xtal {
+	uint8_t trim;
+	uint8_t pad[3];
+};
+
+//temperature and the tx power and pulse settings taken at it, what tx power is compensated against
+struct settings_tx_ref {
+	uint8_t temp_raw;
+	uint8_t pgdly;
+	uint16_t pg_count;
+	uint32_t power;
+};
+
+void settings_init(); //core0 before core1 is launched, opens the store
+const void *settings_get(settings_key key, uint16_t size); //the record in flash, NULL unless it is size long
+void settings_apply_uwb(); //core1 once the dw1000 is up, stored calibration over the syscfg values, then watches it
+//core0, stores calibration core1 reported as changed and erases ahead for the next roll. parks core1 and masks
+//interrupts while it writes, so only when nothing time critical runs on either core
+void settings_sync();
+
+
+#endif //KEYLESS_FIRMWARE_SETTINGS_H
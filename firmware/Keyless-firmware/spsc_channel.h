@@ -0,0 +1,49 @@
+//
+// Created by Jeremy King on 10/18/21.
+//
+
+#ifndef KEYLESS_FIRMWARE_SPSC_CHANNEL_H
+#define KEYLESS_FIRMWARE_SPSC_CHANNEL_H
+#include <atomic>
+#include <stdint.h>
+
+//single producer single consumer ring between the two cores, no locks and no interrupts masked
+//the producer only writes head and the consumer only writes tail, both are plain 32 bit loads and stores
+//which the m0+ does atomically, the acquire/release order makes the slot contents visible before the index
+template <typename T, uint32_t N>
+class spsc_channel {
+	static_assert(N && (N & (N - 1)) == 0, "size has to be a power of two");
+private:
+	T slot[N];
+	std::atomic<uint32_t> head{0}; //next slot the producer writes
+	std::atomic<uint32_t> tail{0}; //next slot the consumer reads
+	std::atomic<uint32_t> dropped{0}; //pushes lost to a full ring, only written by the producer
+public:
+	//producer side, never waits, a full ring drops the message and counts it
+	bool push(const T &msg){
+		uint32_t h = head.load(std::memory_order_relaxed);
+		if (h - tail.load(std::memory_order_acquire) == N){
+			dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			return false;
+		}
+		slot[h & (N - 1)] = msg;
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	};
+	//consumer side, false when there is nothing new
+	bool pop(T &msg){
+		uint32_t t = tail.load(std::memory_order_relaxed);
+		if (head.load(std::memory_order_acquire) == t){
+			return false;
+		}
+		msg = slot[t & (N - 1)];
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	};
+	uint32_t get_dropped(){
+		return dropped.load(std::memory_order_relaxed);
+	};
+};
+
+
+#endif //KEYLESS_FIRMWARE_SPSC_CHANNEL_H
@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""
+Decode the binary telemetry of the Keyless firmware (telemetry.h) from a serial port, a capture file or stdin.
+
+Frames are COBS encoded and end in a 0 byte. Inside: type u8, time_us u32, payload, seq u8, crc16 ccitt (init
+0xffff) over the rest, all little endian. A gap in seq means records were dropped, on the device when its ring
+was full or on the line when a frame failed its crc. Plain console text between the frames is passed through.
+
+  telemdec.py --port /dev/ttyACM0
+  telemdec.py capture.bin --json > records.jsonl
+"""
+
+import argparse
+import binascii
+import json
+import struct
+import sys
+
+TEXT, RANGE, RSSI, STATE, STATS = range(1, 6)
+MACHINES = ['link', 'key', 'engine', 'door']
+STATES = {
+    'link': ['down', 'up'],
+    'key': ['absent', 'authenticated'],
+    'engine': ['off', 'priming', 'cranking', 'running', 'killed'],
+    'door': ['locked', 'unlocked', 'unknown'],
+}
+DEADLINE_TASKS = ['inputs', 'ranging', 'outputs']
+RESET_REASONS = ['power', 'deadline', 'watchdog']
+ENGINE_REASONS = ['', 'low_batt', 'no_ign', 'crank_sag', 'crank_time']
+# histogram ids of TELEM_GROUP_LATENCY, the events in the order of dw1000_mac_lat_event_names
+LAT_HISTS = ['eventq', 'irq', 'rx_good', 'tx_begins', 'tx_done', 'txbuf_err', 'lde_err',
+             'rx_timeout', 'rx_error', 'status_clr', 'clkpll_ll', 'wakeup']
+GROUPS = {
+    0: ('link', ['uwb_dropped', 'telem_dropped']),
+    1: ('deadline', ['%s_%s_us' % (t, k) for k in ('worst', 'mean') for t in DEADLINE_TASKS]),
+    2: ('reset', ['reason', 'task', 'late_us', 'uptime_ms']),
+    3: ('power', ['batt_mv', 'batt_min_mv', 'ign_mv', 'crank_sag_mv']),
+    4: ('entry', ['unlocks', 'locks', 'limited', 'late', 'last_us', 'worst_us']),
+    5: ('latency', ['hist', 'n', 'max_us']),
+}
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            raise ValueError('cobs')
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xff and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def name_of(table, i):
+    return table[i] if i < len(table) else str(i)
+
+
+def parse(raw):
+    """One decoded frame to a dict, raises ValueError on a bad frame."""
+    if len(raw) < 8:
+        raise ValueError('short')
+    if binascii.crc_hqx(raw[:-2], 0xffff) != struct.unpack_from('<H', raw, len(raw) - 2)[0]:
+        raise ValueError('crc')
+    kind, t = struct.unpack_from('<BI', raw)
+    seq = raw[-3]
+    p = raw[5:-3]
+    rec = {'t_us': t, 'seq': seq}
+    if kind == TEXT:
+        rec.update(type='text', text=p.decode('utf-8', 'replace'))
+    elif kind == RANGE:
+        node, flags, mm = struct.unpack('<HHi', p)
+        rec.update(type='range', node=node, flags=flags, dist_mm=mm)
+    elif kind == RSSI:
+        node, rssi, fp = struct.unpack('<Hhh', p)
+        rec.update(type='rssi', node=node, rssi_dbm=rssi / 100, fp_dbm=fp / 100)
+    elif kind == STATE:
+        machine, frm, to, reason = struct.unpack('<BBBB', p)
+        m = name_of(MACHINES, machine)
+        states = STATES.get(m, [])
+        if m == 'engine':
+            reason = name_of(ENGINE_REASONS, reason)
+        rec.update(type='state', machine=m, frm=name_of(states, frm), to=name_of(states, to), reason=reason)
+    elif kind == STATS:
+        group, n = struct.unpack_from('<HH', p)
+        vals = list(struct.unpack_from('<%dI' % n, p, 4))
+        gname, names = GROUPS.get(group, (str(group), []))
+        values = {name_of(names, i): v for i, v in enumerate(vals)}
+        if gname == 'reset' and len(vals) >= 2:
+            values['reason'] = name_of(RESET_REASONS, vals[0])
+            values['task'] = name_of(DEADLINE_TASKS, vals[1])
+        if gname == 'latency' and len(vals) >= 3:
+            first = vals[0] >> 8
+            values = {'hist': name_of(LAT_HISTS, vals[0] & 0xff), 'n': vals[1], 'max_us': vals[2]}
+            values.update(('bin%d' % (first + i), v) for i, v in enumerate(vals[3:]))
+        rec.update(type='stats', group=gname, values=values)
+    else:
+        rec.update(type=kind, payload=p.hex())
+    return rec
+
+
+def show(rec):
+    t = '%10.6f' % (rec['t_us'] / 1e6)
+    kind = rec['type']
+    if kind == 'text':
+        return '%s %s' % (t, rec['text'].rstrip('\r\n'))
+    if kind == 'range':
+        return '%s range  node %d %.3f m' % (t, rec['node'], rec['dist_mm'] / 1000)
+    if kind == 'rssi':
+        return '%s rssi   node %d %.2f dBm fp %.2f dBm' % (t, rec['node'], rec['rssi_dbm'], rec['fp_dbm'])
+    if kind == 'state':
+        why = ' (%s)' % rec['reason'] if rec['reason'] else ''
+        return '%s state  %s %s -> %s%s' % (t, rec['machine'], rec['frm'], rec['to'], why)
+    if kind == 'stats':
+        return '%s stats  %s %s' % (t, rec['group'], ' '.join('%s=%s' % kv for kv in rec['values'].items()))
+    return '%s type %s %s' % (t, kind, rec['payload'])
+
+
+class Decoder:
+    def __init__(self, out, as_json):
+        self.out = out
+        self.as_json = as_json
+        self.buf = bytearray()
+        self.seq = None
+        self.t_last = None
+        self.t_wrap = 0
+        self.lost = 0
+        self.bad = 0
+
+    def feed(self, data):
+        self.buf += data
+        while True:
+            end = self.buf.find(0)
+            if end < 0:
+                return
+            chunk = bytes(self.buf[:end])
+            del self.buf[:end + 1]
+            if chunk:
+                self.frame(chunk)
+
+    def frame(self, chunk):
+        try:
+            rec = parse(cobs_decode(chunk))
+        except (ValueError, struct.error):
+            # console text from printf lands here, passed on if it looks like text
+            text = chunk.decode('ascii', 'replace')
+            if all(c.isprintable() or c in '\r\n\t' for c in text):
+                self.out.write('# %s\n' % text.strip('\r\n'))
+            else:
+                self.bad += 1
+            return
+        if self.seq is not None:
+            gap = (rec['seq'] - self.seq - 1) & 0xff
+            if gap:
+                self.lost += gap
+                rec['lost'] = gap
+        self.seq = rec['seq']
+        if self.t_last is not None and rec['t_us'] < self.t_last:
+            self.t_wrap += 1 << 32  # the device time is 32 bit, 71 minutes round
+        self.t_last = rec['t_us']
+        rec['t_us'] += self.t_wrap
+        if self.as_json:
+            self.out.write(json.dumps(rec) + '\n')
+        else:
+            if rec.get('lost'):
+                self.out.write('           -- %d records lost\n' % rec['lost'])
+            self.out.write(show(rec) + '\n')
+        self.out.flush()
+
+
+def main(argv):
+    ap = argparse.ArgumentParser(description=__doc__.strip().split('\n')[0])
+    ap.add_argument('capture', nargs='?', help='capture file, stdin if neither this nor --port is given')
+    ap.add_argument('--port', help='serial port to read until interrupted')
+    ap.add_argument('--baud', type=int, default=115200)
+    ap.add_argument('--json', action='store_true', help='one json object per record')
+    args = ap.parse_args(argv)
+
+    dec = Decoder(sys.stdout, args.json)
+    try:
+        if args.port:
+            import serial
+            with serial.Serial(args.port, args.baud, timeout=0.1) as s:
+                while True:
+                    dec.feed(s.read(4096))
+        else:
+            f = open(args.capture, 'rb') if args.capture else sys.stdin.buffer
+            while True:
+                data = f.read(4096)
+                if not data:
+                    break
+                dec.feed(data)
+    except KeyboardInterrupt:
+        pass
+    sys.stderr.write('%d records lost, %d bad frames\n' % (dec.lost, dec.bad))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,183 @@
+//
+// Created by Jeremy King on 10/18/21.
+//
+
+#include "telemetry.h"
+#include <string.h>
+#include <stdbool.h>
+
+#define TELEM_MASK (TELEM_RING_SIZE - 1)
+#define TELEM_RAW_MAX (TELEM_HDR_LEN + TELEM_MAX_PAYLOAD + 3)
+
+static uint8_t telem_ring[TELEM_RING_SIZE];
+static uint32_t telem_head; //bytes queued so far, moved under the lock
+static uint32_t telem_tail; //bytes the uart has taken
+static uint32_t telem_busy; //length of the dma in flight, 0 when the uart is idle
+static uint32_t telem_lost;
+static uint8_t telem_seq;
+static bool telem_paused; //under the lock
+static volatile bool telem_ready;
+
+//crc16 ccitt a nibble at a time, 32 bytes of table instead of 512
+static const uint16_t telem_crc_nib[16] = {
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+	0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+};
+
+static uint16_t telem_crc(uint16_t crc, const uint8_t *p, uint32_t len){
+	while (len--){
+		crc = (crc << 4) ^ telem_crc_nib[(crc >> 12) ^ (*p >> 4)];
+		crc = (crc << 4) ^ telem_crc_nib[(crc >> 12) ^ (*p++ & 0xf)];
+	}
+	return crc;
+}
+
+//cobs encodes len bytes into the ring from pos and appends the delimiter, returns the new head
+//frames are shorter than 254 bytes so there is never a full 0xff block
+static uint32_t telem_cobs(uint32_t pos, const uint8_t *src, uint32_t len){
+	uint32_t code_pos = pos++;
+	uint8_t code = 1;
+
+	for (uint32_t i = 0; i < len; i++){
+		if (src[i]){
+			telem_ring[pos++ & TELEM_MASK] = src[i];
+			code++;
+		}
+		else {
+			telem_ring[code_pos & TELEM_MASK] = code;
+			code_pos = pos++;
+			code = 1;
+		}
+	}
+	telem_ring[code_pos & TELEM_MASK] = code;
+	telem_ring[pos++ & TELEM_MASK] = 0;
+	return pos;
+}
+
+//hands the oldest contiguous run of the ring to the dma, called with the lock held
+static void telem_kick(void){
+	uint32_t start = telem_tail & TELEM_MASK;
+	uint32_t n = telem_head - telem_tail;
+
+	if (!n || telem_paused){
+		return;
+	}
+	if (n > TELEM_RING_SIZE - start){
+		n = TELEM_RING_SIZE - start; //the rest goes once this run is out
+	}
+	telem_busy = n;
+	if (telem_port_start(&telem_ring[start], n) != 0){
+		telem_busy = 0; //left queued, the next record tries again
+	}
+}
+
+void telem_init(void){
+	telem_port_init();
+	telem_ready = true;
+}
+
+void telem_tx_done(void){
+	uint32_t s = telem_port_lock();
+	telem_tail += telem_busy;
+	telem_busy = 0;
+	telem_kick();
+	telem_port_unlock(s);
+}
+
+//queues one record, 0 when it is in the ring and -1 when it was dropped
+//the header, payload and their crc are done before the lock, the sequence byte, the crc over it and the cobs
+//copy into the ring under it
+int telem_send(uint8_t type, const void *payload, uint32_t len){
+	uint8_t raw[TELEM_RAW_MAX];
+	uint32_t now, n, s;
+	uint16_t crc;
+
+	if (!telem_ready || len > TELEM_MAX_PAYLOAD){
+		return -1;
+	}
+	now = telem_port_time_us();
+	raw[0] = type;
+	memcpy(&raw[1], &now, sizeof(now));
+	memcpy(&raw[TELEM_HDR_LEN], payload, len);
+	n = TELEM_HDR_LEN + len;
+	crc = telem_crc(0xffff, raw, n);
+
+	s = telem_port_lock();
+	if (TELEM_RING_SIZE - (telem_head - telem_tail) < n + 6){ //seq, crc, cobs code and both delimiters
+		telem_seq++; //the host sees the gap
+		telem_lost++;
+		telem_port_unlock(s);
+		return -1;
+	}
+	raw[n] = telem_seq++;
+	crc = telem_crc(crc, &raw[n], 1);
+	raw[n + 1] = crc & 0xff;
+	raw[n + 2] = crc >> 8;
+	if (telem_head == telem_tail){
+		telem_ring[telem_head++ & TELEM_MASK] = 0; //the uart was idle and may have carried console text since
+	}
+	telem_head = telem_cobs(telem_head, raw, n + 3);
+	if (!telem_busy){
+		telem_kick();
+	}
+	telem_port_unlock(s);
+	return 0;
+}
+
+int telem_text(const char *s){
+	size_t len = strlen(s);
+	return telem_send(TELEM_TEXT, s, len > TELEM_MAX_PAYLOAD ? TELEM_MAX_PAYLOAD : len);
+}
+
+int telem_range(uint16_t node, int32_t dist_mm, uint16_t flags){
+	struct telem_range r = {node, flags, dist_mm};
+	return telem_send(TELEM_RANGE, &r, sizeof(r));
+}
+
+int telem_rssi(uint16_t node, int16_t rssi_cdbm, int16_t fp_cdbm){
+	struct telem_rssi r = {node, rssi_cdbm, fp_cdbm};
+	return telem_send(TELEM_RSSI, &r, sizeof(r));
+}
+
+int telem_state(uint8_t machine, uint8_t from, uint8_t to, uint8_t reason){
+	struct telem_state r = {machine, from, to, reason};
+	return telem_send(TELEM_STATE, &r, sizeof(r));
+}
+
+int telem_stats(uint16_t group, const uint32_t *val, uint16_t n){
+	struct telem_stats r;
+	if (n > TELEM_STATS_MAX){
+		n = TELEM_STATS_MAX;
+	}
+	r.group = group;
+	r.n = n;
+	memcpy(r.val, val, n * sizeof(uint32_t));
+	return telem_send(TELEM_STATS, &r, 4 + n * sizeof(uint32_t));
+}
+
+uint32_t telem_dropped(void){
+	return telem_lost;
+}
+
+void telem_pause(void){
+	uint32_t s = telem_port_lock();
+	uint32_t busy;
+
+	telem_paused = true;
+	telem_port_unlock(s);
+	do { //the dma interrupt has to get in between
+		s = telem_port_lock();
+		busy = telem_busy;
+		telem_port_unlock(s);
+	} while (busy);
+}
+
+void telem_resume(void){
+	uint32_t s = telem_port_lock();
+
+	telem_paused = false;
+	if (!telem_busy){
+		telem_kick();
+	}
+	telem_port_unlock(s);
+}
@@ -0,0 +1,123 @@
+//
+// Created by Jeremy King on 10/18/21.
+//
+
+#ifndef KEYLESS_FIRMWARE_TELEMETRY_H
+#define KEYLESS_FIRMWARE_TELEMETRY_H
+//binary telemetry, typed records framed with cobs and a crc16 and queued for a dma driven uart
+//sending encodes into the tx ring and returns, it never waits on the uart. a full ring drops the record,
+//the sequence number in every frame shows the gap on the host. telemdec.py decodes the stream on linux
+//
+//frame on the wire: cobs(type u8, time_us u32, payload, seq u8, crc16) then a 0 byte, and a 0 before it
+//when the uart was idle
+//crc16 is ccitt with init 0xffff over everything before it, all fields are little endian. seq sits last so
+//the crc of the rest can be done before the lock
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef TELEM_RING_SIZE
+#define TELEM_RING_SIZE 1024 //encoded bytes waiting for the uart, a power of two
+#endif
+#define TELEM_MAX_PAYLOAD 48
+#define TELEM_HDR_LEN 5 //type and time
+
+enum telem_type {
+	TELEM_TEXT = 1, //payload is the text, no terminator
+	TELEM_RANGE, //struct telem_range
+	TELEM_RSSI, //struct telem_rssi
+	TELEM_STATE, //struct telem_state
+	TELEM_STATS, //struct telem_stats
+};
+
+//state machines reported with TELEM_STATE
+enum telem_machine {
+	TELEM_SM_LINK, //0 down, 1 up
+	TELEM_SM_KEY, //0 absent, 1 authenticated
+	TELEM_SM_ENGINE, //enum telem_engine
+	TELEM_SM_DOOR, //0 locked, 1 unlocked, 2 not pulsed since boot
+};
+
+enum telem_engine {
+	TELEM_ENGINE_OFF,
+	TELEM_ENGINE_PRIMING,
+	TELEM_ENGINE_CRANKING,
+	TELEM_ENGINE_RUNNING,
+	TELEM_ENGINE_KILLED,
+};
+
+//reason byte of an engine TELEM_STATE
+enum telem_engine_reason {
+	TELEM_REASON_NONE,
+	TELEM_REASON_LOW_BATT, //battery too low to prime, the start was refused
+	TELEM_REASON_NO_IGN, //no ignition feed, the start was refused
+	TELEM_REASON_CRANK_SAG, //battery sagged too deep for too long while cranking
+	TELEM_REASON_CRANK_TIME, //cranked for as long as the sag profile allowed
+};
+
+//counter groups reported with TELEM_STATS
+enum telem_group {
+	TELEM_GROUP_LINK, //uwb_dropped, telem_dropped
+	TELEM_GROUP_DEADLINE, //worst then mean gap between check ins per deadline task, us
+	TELEM_GROUP_RESET, //reason, task, late_us, uptime_ms of the previous boot, sent once at start
+	TELEM_GROUP_POWER, //battery mV filtered and lowest sample, ignition mV, lowest battery mV of the last crank
+	TELEM_GROUP_ENTRY, //unlocks, locks, rate limited, over target, last and worst unlock latency us
+	TELEM_GROUP_LATENCY, //histogram id | first bin << 8, n, max us, then log2 us bins from that one, bsp_pico.c
+};
+
+struct telem_range {
+	uint16_t node;
+	uint16_t flags;
+	int32_t dist_mm;
+};
+
+struct telem_rssi {
+	uint16_t node;
+	int16_t rssi_cdbm; //received power, 0.01 dBm
+	int16_t fp_cdbm; //first path power, 0.01 dBm
+};
+
+struct telem_state {
+	uint8_t machine;
+	uint8_t from;
+	uint8_t to;
+	uint8_t reason;
+};
+
+#define TELEM_STATS_MAX ((TELEM_MAX_PAYLOAD - 4) / 4)
+struct telem_stats {
+	uint16_t group;
+	uint16_t n;
+	uint32_t val[TELEM_STATS_MAX]; //only the first n go out
+};
+
+void telem_init(void);
+int telem_send(uint8_t type, const void *payload, uint32_t len);
+int telem_text(const char *s);
+int telem_range(uint16_t node, int32_t dist_mm, uint16_t flags);
+int telem_rssi(uint16_t node, int16_t rssi_cdbm, int16_t fp_cdbm);
+int telem_state(uint8_t machine, uint8_t from, uint8_t to, uint8_t reason);
+int telem_stats(uint16_t group, const uint32_t *val, uint16_t n);
+uint32_t telem_dropped(void);
+//hold the uart for something else: waits for the dma run in flight, records are queued but not sent until resume
+//a record queued before the pause goes out with no delimiter after the other output and is lost, seq shows it
+void telem_pause(void);
+void telem_resume(void);
+
+//implemented by the platform port, telemetry_pico.c or driver/Src/platform/stdio.c on the stm32
+uint32_t telem_port_lock(void); //masks interrupts and excludes the other core
+void telem_port_unlock(uint32_t state);
+uint32_t telem_port_time_us(void);
+void telem_port_init(void);
+int telem_port_start(const uint8_t *buf, uint32_t len); //starts the dma with the lock held, 0 when it runs
+//the port calls this from its dma complete interrupt
+void telem_tx_done(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //KEYLESS_FIRMWARE_TELEMETRY_H
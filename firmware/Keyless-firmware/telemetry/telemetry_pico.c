@@ -0,0 +1,60 @@
+//
+// Created by Jeremy King on 10/18/21.
+//
+
+//rp2040 port of the telemetry ring, one dma channel paced by the uart tx dreq
+//the records share the stdio uart, printf output landing inside a frame only costs that frame its crc
+#include "telemetry.h"
+#include "pico/stdlib.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/uart.h"
+#include "hardware/structs/timer.h"
+
+#define TELEM_UART uart_default
+
+static spin_lock_t *telem_spin;
+static int telem_dma = -1;
+
+//dma irq 1, the dw1000 spi has irq 0 to itself
+static void telem_dma_irq(void){
+	if (dma_channel_get_irq1_status(telem_dma)){
+		dma_channel_acknowledge_irq1(telem_dma);
+		telem_tx_done();
+	}
+}
+
+uint32_t telem_port_lock(void){
+	return spin_lock_blocking(telem_spin);
+}
+
+void telem_port_unlock(uint32_t state){
+	spin_unlock(telem_spin, state);
+}
+
+uint32_t telem_port_time_us(void){
+	return timer_hw->timerawl;
+}
+
+//the interrupt is taken on the core that calls telem_init
+void telem_port_init(void){
+	dma_channel_config c;
+
+	telem_spin = spin_lock_init(spin_lock_claim_unused(true));
+	telem_dma = dma_claim_unused_channel(true);
+	c = dma_channel_get_default_config(telem_dma);
+	channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+	channel_config_set_read_increment(&c, true);
+	channel_config_set_write_increment(&c, false);
+	channel_config_set_dreq(&c, uart_get_dreq(TELEM_UART, true));
+	dma_channel_configure(telem_dma, &c, &uart_get_hw(TELEM_UART)->dr, NULL, 0, false);
+	dma_channel_set_irq1_enabled(telem_dma, true);
+	irq_add_shared_handler(DMA_IRQ_1, telem_dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+	irq_set_enabled(DMA_IRQ_1, true);
+}
+
+int telem_port_start(const uint8_t *buf, uint32_t len){
+	dma_channel_transfer_from_buffer_now(telem_dma, buf, len);
+	return 0;
+}
@@ -0,0 +1,162 @@
+//
+// Created by Jeremy King on 10/18/21.
+//
+
+#include "catch2.h"
+#include "entry.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#define KEY 7
+
+//steps the controller like the car loop does, every 10ms, returns the first action
+static entry_action run(passive_entry &e, uint32_t &t, uint32_t until, int32_t dist_mm, uint16_t key = KEY){
+	entry_action a = ENTRY_NONE;
+	for (; t < until; t += 10000){
+		if (t % 100000 == 0){
+			e.range(t, key, dist_mm);
+		}
+		entry_action got = e.update(t);
+		if (a == ENTRY_NONE){
+			a = got;
+		}
+	}
+	return a;
+}
+
+TEST_CASE("entry unlocks only for an authenticated key", "[entry]"){
+	passive_entry e;
+	uint32_t t = 1000000;
+
+	e.link(t, true);
+	REQUIRE(run(e, t, t + 2000000, 500) == ENTRY_NONE);
+	e.auth(KEY, true);
+	REQUIRE(run(e, t, t + 2000000, 500) == ENTRY_UNLOCK);
+	REQUIRE(e.get_doors() == ENTRY_UNLOCKED);
+}
+
+TEST_CASE("entry ignores other keys once one is authenticated", "[entry]"){
+	passive_entry e;
+	uint32_t t = 1000000;
+
+	e.link(t, true);
+	e.auth(KEY, true);
+	REQUIRE(run(e, t, t + 2000000, 500, KEY + 1) == ENTRY_NONE);
+	REQUIRE(e.get_doors() == ENTRY_UNKNOWN);
+}
+
+TEST_CASE("entry forgets the authentication with the link", "[entry]"){
+	passive_entry e;
+	uint32_t t = 1000000;
+
+	e.link(t, true);
+	e.auth(KEY, true);
+	e.link(t, false);
+	e.link(t, true);
+	REQUIRE_FALSE(e.authenticated());
+	REQUIRE(run(e, t, t + 2000000, 500) == ENTRY_NONE);
+}
+
+TEST_CASE("entry locks once the key has walked away", "[entry]"){
+	passive_entry e;
+	uint32_t t = 1000000;
+
+	e.link(t, true);
+	e.auth(KEY, true);
+	REQUIRE(run(e, t, t + 2000000, 500) == ENTRY_UNLOCK);
+	REQUIRE(run(e, t, t + (ENTRY_LOCK_DWELL_MS - 500) * 1000, 5000) == ENTRY_NONE);
+	REQUIRE(run(e, t, t + 1500000, 5000) == ENTRY_LOCK);
+}
+
+TEST_CASE("entry rate limits the relays", "[entry]"){
+	passive_entry e;
+	uint32_t t = 1000000;
+	int pulses = 0;
+
+	e.link(t, true);
+	e.auth(KEY, true);
+	//a key going back and forth over both radii would pulse twice every 6s without the limit
+	for (int i = 0; i < 60; i++){
+		pulses += run(e, t, t + 500000, 500) != ENTRY_NONE;
+		pulses += run(e, t, t + 5500000, 5000) != ENTRY_NONE;
+	}
+	//60 rounds of 6s: the burst and one more per refill
+	REQUIRE(pulses > ENTRY_BURST);
+	REQUIRE(pulses <= ENTRY_BURST + 60 * 6000 / ENTRY_REFILL_MS);
+	REQUIRE(e.get_stats().limited > 0);
+}
+
+//walk up at 0.8-1.8 m/s from 15-20m, stand for 10s and walk away with 80mm of range noise, 5% of the ranges
+//2-5m long from a reflection, 0.2% short and 10% of the rounds missed. the car loop runs every 10ms
+static std::vector<double> walk_ups(int rate_hz, int &bad){
+	std::mt19937 rng(1);
+	std::normal_distribution<double> noise(0, 80);
+	std::uniform_real_distribution<double> u(0, 1);
+	std::vector<double> lat;
+	uint32_t period = 1000000 / rate_hz;
+
+	bad = 0;
+	for (int trial = 0; trial < 500; trial++){
+		passive_entry e;
+		uint32_t t0 = 1000 + trial * 7;
+		double speed = 0.8 + u(rng) * 1.0;
+		double start = 15000 + u(rng) * 5000;
+		double walk_in = start / 1000 / speed;
+		uint32_t next_range = t0 + (uint32_t)(u(rng) * period);
+		double cross_us = -1;
+		bool unlocked = false, locked = false;
+
+		e.link(t0, true);
+		e.auth(KEY, true);
+		for (uint32_t t = t0; t < t0 + 60000000; t += 1000){
+			double s = (t - t0) / 1e6;
+			double d = s < walk_in ? start - s * speed * 1000 : s < walk_in + 10 ? 0 : (s - walk_in - 10) * speed * 1000;
+			d = std::max(d, 300.0);
+			if (cross_us < 0 && d <= ENTRY_UNLOCK_MM){
+				cross_us = t;
+			}
+			if (t >= next_range){
+				double m = d + noise(rng);
+				next_range += period;
+				if (u(rng) < 0.05){
+					m += 2000 + u(rng) * 3000;
+				}
+				if (u(rng) < 0.002){
+					m = 400;
+				}
+				if (u(rng) > 0.1){
+					e.range(t, KEY, (int32_t)m);
+				}
+			}
+			if ((t - t0) % 10000 == 0){
+				entry_action a = e.update(t);
+				if (a == ENTRY_UNLOCK && !unlocked){
+					unlocked = true;
+					lat.push_back((t - cross_us) / 1000.0);
+				}
+				else if (a == ENTRY_LOCK && unlocked){
+					locked = s > walk_in + 10;
+					bad += !locked; //locked with the key standing at the car
+				}
+				else if (a == ENTRY_UNLOCK){
+					bad++;
+				}
+			}
+		}
+		bad += !unlocked || !locked;
+	}
+	std::sort(lat.begin(), lat.end());
+	return lat;
+}
+
+TEST_CASE("entry unlock latency at 10Hz ranging", "[entry][sim]"){
+	int bad;
+	std::vector<double> lat = walk_ups(10, bad);
+
+	REQUIRE(bad == 0);
+	REQUIRE(lat.size() == 500);
+	INFO("p50 " << lat[lat.size() / 2] << "ms p95 " << lat[lat.size() * 95 / 100] << "ms max " << lat.back() << "ms");
+	CHECK(lat[lat.size() / 2] < 300);
+	CHECK(lat[lat.size() * 95 / 100] < ENTRY_UNLOCK_TARGET_US / 1000);
+}
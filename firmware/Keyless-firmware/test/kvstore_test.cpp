@@ -0,0 +1,185 @@
+//
+// Created by Jeremy King on 10/18/21.
+//
+
+#include "catch2.h"
+#include "kvstore.h"
+#include <setjmp.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NK 12
+
+//the flash as ram, a program only clears bits like the real one. ops_left counts flash operations down to a
+//power cut, which leaves the one it lands on half done and jumps back out of the store
+static uint8_t flash[KV_SECTORS * KV_SECTOR_SIZE];
+static long ops_left = -1;
+static jmp_buf cut;
+static int erases;
+
+const uint8_t *kv_port_base(void){
+	return flash;
+}
+
+int kv_port_erase(uint32_t sector){
+	uint8_t *p = &flash[sector * KV_SECTOR_SIZE];
+	if (ops_left == 0){
+		memset(p, 0xff, KV_SECTOR_SIZE / 2 + rand() % 100);
+		longjmp(cut, 1);
+	}
+	if (ops_left > 0){
+		ops_left--;
+	}
+	memset(p, 0xff, KV_SECTOR_SIZE);
+	erases++;
+	return 0;
+}
+
+int kv_port_program(uint32_t off, const void *data, uint32_t len){
+	const uint8_t *p = (const uint8_t *)data;
+	uint32_t n = ops_left == 0 ? rand() % (len + 1) : len;
+	for (uint32_t i = 0; i < n; i++){
+		flash[off + i] &= p[i];
+	}
+	if (ops_left == 0){
+		longjmp(cut, 1);
+	}
+	if (ops_left > 0){
+		ops_left--;
+	}
+	return 0;
+}
+
+//what the store should hold, a set that was cut short may or may not have gone in
+struct kv_model {
+	uint8_t val[NK + 1][64];
+	uint16_t len[NK + 1];
+	int pending_key = -1;
+	uint8_t pending[64];
+	uint16_t pending_len;
+
+	void set(int k, const uint8_t *v, uint16_t n){
+		memcpy(val[k], v, n);
+		len[k] = n;
+	}
+	bool matches(){
+		for (int k = 1; k <= NK; k++){
+			uint16_t n;
+			const uint8_t *v = (const uint8_t *)kv_get(k, &n);
+			bool was = len[k] ? v && n == len[k] && !memcmp(v, val[k], n) : !v;
+			bool now = k == pending_key && (pending_len ? v && n == pending_len && !memcmp(v, pending, n) : !v);
+			if (!was && !now){
+				return false;
+			}
+			if (now){
+				set(k, pending, pending_len);
+			}
+		}
+		pending_key = -1;
+		return true;
+	}
+};
+
+//false when the power was cut in the middle of it, boot runs kv_init under the same countdown first
+static bool try_set(kv_model &m, int k, const uint8_t *v, uint16_t n, long ops, bool boot = false){
+	m.pending_key = k;
+	memcpy(m.pending, v, n);
+	m.pending_len = n;
+	ops_left = ops;
+	if (setjmp(cut)){
+		ops_left = -1;
+		return false;
+	}
+	if (boot && kv_init() < 0){
+		ops_left = -1;
+		return false;
+	}
+	int rc = kv_set(k, n ? v : nullptr, n);
+	ops_left = -1;
+	if (rc == 0){
+		m.set(k, v, n);
+	}
+	m.pending_key = -1;
+	return true;
+}
+
+static void fresh(kv_model &m){
+	memset(flash, 0xff, sizeof(flash));
+	memset(m.len, 0, sizeof(m.len));
+	srand(7);
+	REQUIRE(kv_init() == 0);
+}
+
+TEST_CASE("kvstore keeps every value across repeated cuts in a roll", "[kvstore]"){
+	kv_model m;
+	uint8_t v[64];
+	int cuts;
+
+	fresh(m);
+	for (int k = 1; k <= 8; k++){
+		memset(v, k, 40);
+		REQUIRE(try_set(m, k, v, 40, -1));
+	}
+	//an update on its own is one program, only a roll gets far enough for the cut, which lands in the copy.
+	//after the first the sealed sector is full and the next boot or update rolls again, into the same cut
+	for (int i = 0; try_set(m, 1, v, 40, 3); i++){
+		memset(v, i, 40);
+	}
+	for (cuts = 1; cuts < 2 * KV_SECTORS; cuts++){
+		REQUIRE_FALSE(try_set(m, 1, v, 40, 3, true));
+	}
+	REQUIRE(kv_init() == 8);
+	REQUIRE(m.matches());
+	memset(v, 0x5a, 40);
+	REQUIRE(try_set(m, 2, v, 40, -1));
+	REQUIRE(kv_init() == 8);
+	REQUIRE(m.matches());
+}
+
+TEST_CASE("kvstore survives power cuts at random", "[kvstore]"){
+	kv_model m;
+	uint8_t v[64];
+	int cuts = 0;
+
+	fresh(m);
+	for (int it = 0; it < 50000; it++){
+		int k = 1 + rand() % NK;
+		uint16_t n = rand() % 8 == 0 ? 0 : 1 + rand() % 60;
+		for (int i = 0; i < n; i++){
+			v[i] = rand();
+		}
+		if (!try_set(m, k, v, n, rand() % 200 == 0 ? rand() % 3 : -1)){
+			cuts++;
+			REQUIRE(kv_init() >= 0);
+		}
+		else if (it % 1000 == 0){
+			REQUIRE(kv_init() >= 0);
+		}
+		else if (it % 100 == 0){
+			REQUIRE(kv_prepare() == 0);
+		}
+		REQUIRE(m.matches());
+	}
+	REQUIRE(cuts > 50);
+	REQUIRE(kv_seq() > 100);
+}
+
+TEST_CASE("kvstore rolls without an erase after kv_prepare", "[kvstore]"){
+	kv_model m;
+	uint8_t v[64];
+	uint32_t seq;
+
+	fresh(m);
+	for (int i = 0; i < 4 * KV_SECTORS; i++){
+		REQUIRE(kv_prepare() == 0);
+		erases = 0;
+		seq = kv_seq();
+		for (int n = 0; kv_seq() == seq; n++){
+			memset(v, n, 60);
+			REQUIRE(try_set(m, 1 + n % NK, v, 60, -1));
+		}
+		REQUIRE(erases == 0);
+	}
+	REQUIRE(kv_init() == NK);
+	REQUIRE(m.matches());
+}
@@ -0,0 +1,6 @@
+//
+// Created by Jeremy King on 10/18/21.
+//
+
+#define CATCH_CONFIG_MAIN
+#include "catch2.h"
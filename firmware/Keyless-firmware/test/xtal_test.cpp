@@ -0,0 +1,40 @@
+//
+// Created by Jeremy King on 10/18/21.
+//
+
+#include "catch2.h"
+#include "dw1000/dw1000_xtal.h"
+#include <stdint.h>
+
+//one clock offset as both registers would report it, from the driver's own ratio conversions:
+//dw1000_calc_clock_offset_ratio takes ci counts of 1/(k * 2^27) and dw1000_calc_clock_offset_ratio_ttco -ttcko/denom
+static int32_t ci_for(double ratio, int k, bool rate_110k){
+	return (int32_t)(ratio * k * (1 << 27) * (rate_110k ? 8 : 1));
+}
+
+static int32_t ttcko_for(double ratio, bool prf_16m){
+	return (int32_t)(-ratio * (prf_16m ? 0x01F00000 : 0x01FC0000));
+}
+
+TEST_CASE("xtal tracking sees the same offset from the carrier integrator and the time tracking offset", "[xtal]"){
+	static const struct {
+		uint8_t channel;
+		int k;
+	} chans[] = {{1, 7}, {2, 8}, {3, 9}, {4, 8}, {5, 13}, {7, 13}};
+	static const double ratios[] = {-20e-6, -5e-6, -1e-6, 1e-6, 5e-6, 20e-6};
+
+	for (auto c : chans){
+		for (double r : ratios){
+			for (int rate_110k = 0; rate_110k < 2; rate_110k++){
+				for (int prf_16m = 0; prf_16m < 2; prf_16m++){
+					int32_t ci = dw1000_xtal_ci_ppb(c.channel, rate_110k, ci_for(r, c.k, rate_110k));
+					int32_t tt = dw1000_xtal_ttcko_ppb(prf_16m, ttcko_for(r, prf_16m));
+					INFO("channel " << (int)c.channel << " ratio " << r << " ci " << ci << " ttcko " << tt);
+					REQUIRE((ci > 0) == (tt > 0));
+					REQUIRE(ci - tt < 40); //one ttcko count is about 31ppb
+					REQUIRE(tt - ci < 40);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,85 @@
+//
+// Created by Jeremy King on 10/18/21.
+//
+
+#include "trace.h"
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/uart.h"
+
+struct trace_ring trace_rings[2];
+volatile bool trace_frozen;
+
+static const char *const trace_names[TRACE_NUM_IDS] = {
+#define TRACE_NAME(_id, _name) _name,
+	TRACE_EVENTS(TRACE_NAME)
+#undef TRACE_NAME
+};
+
+//crc32 as zlib.crc32 computes it, bitwise as dumps are rare and the table would cost 1KB
+static uint32_t trace_crc(uint32_t crc, const void *buf, uint32_t len){
+	const uint8_t *p = (const uint8_t *)buf;
+	crc = ~crc;
+	while (len--){
+		crc ^= *p++;
+		for (int k = 0; k < 8; k++){
+			crc = (crc >> 1) ^ (0xedb88320u & -(crc & 1));
+		}
+	}
+	return ~crc;
+}
+
+//raw bytes to the stdio uart, stdio itself would turn \n into \r\n
+static uint32_t trace_out(uint32_t crc, const void *buf, uint32_t len){
+	uart_write_blocking(uart_default, (const uint8_t *)buf, len);
+	return trace_crc(crc, buf, len);
+}
+
+/*
+ * Frame, little endian:
+ *   "KTRC", u8 version, u8 cores, u16 ids, u32 ring length, u64 time_us_64 at the dump,
+ *   per id u8 length and the name, per core u32 head and the kept records oldest first,
+ *   u32 crc32 of everything after the magic
+ * Anything the other core prints meanwhile can land in between, the host tool checks the crc
+ */
+void trace_dump(void){
+	const uint8_t hdr[4] = {TRACE_VERSION, 2, TRACE_NUM_IDS & 0xff, TRACE_NUM_IDS >> 8};
+	const uint32_t len = TRACE_RING_LEN;
+	uint64_t now = time_us_64();
+	uint32_t crc = 0;
+
+	trace_frozen = true;
+	__dmb(); //a record in progress on the other core finishes within a few cycles
+	busy_wait_us_32(1);
+	uart_write_blocking(uart_default, (const uint8_t *)"KTRC", 4);
+	crc = trace_out(crc, hdr, sizeof(hdr));
+	crc = trace_out(crc, &len, sizeof(len));
+	crc = trace_out(crc, &now, sizeof(now));
+	for (int i = 0; i < TRACE_NUM_IDS; i++){
+		uint8_t n = strlen(trace_names[i]);
+		crc = trace_out(crc, &n, 1);
+		crc = trace_out(crc, trace_names[i], n);
+	}
+	for (int core = 0; core < 2; core++){
+		struct trace_ring *r = &trace_rings[core];
+		uint32_t head = r->head;
+		uint32_t first = head > TRACE_RING_LEN ? head - TRACE_RING_LEN : 0;
+		crc = trace_out(crc, &head, sizeof(head));
+		for (uint32_t i = first; i != head; i++){
+			crc = trace_out(crc, &r->rec[i & (TRACE_RING_LEN - 1)], sizeof(struct trace_rec));
+		}
+	}
+	uart_write_blocking(uart_default, (const uint8_t *)&crc, sizeof(crc));
+	uart_tx_wait_blocking(uart_default);
+	trace_frozen = false;
+}
+
+void trace_clear(void){
+	trace_frozen = true;
+	__dmb();
+	busy_wait_us_32(1);
+	trace_rings[0].head = 0;
+	trace_rings[1].head = 0;
+	__dmb();
+	trace_frozen = false;
+}
@@ -0,0 +1,107 @@
+//
+// Created by Jeremy King on 10/18/21.
+//
+
+#ifndef KEYLESS_FIRMWARE_TRACE_H
+#define KEYLESS_FIRMWARE_TRACE_H
+//per core trace rings, a trace point is a timer read and an 8 byte store with interrupts off on its own core
+//no lock between the cores, each only writes its own ring. trace_dump sends both as one binary frame over the
+//stdio uart and trace2json.py turns that into chrome trace json for chrome://tracing or ui.perfetto.dev
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/structs/timer.h"
+#include "hardware/structs/sio.h"
+#include "hardware/sync.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef KEYLESS_TRACE
+#define TRACE_RING_LEN 512 //records kept per core, a power of two
+#else
+#define TRACE_RING_LEN 1
+#endif
+#define TRACE_VERSION 1
+
+//trace point ids, the names go out with every dump so the host tool needs no copy of this list
+#define TRACE_EVENTS(X) \
+	X(TRACE_START_SEQ, "start_sequence") \
+	X(TRACE_PRIME, "fuel_prime") \
+	X(TRACE_CRANK, "crank") \
+	X(TRACE_KILL, "engine_kill") \
+	X(TRACE_INPUTS, "inputs") \
+	X(TRACE_UWB_PUB, "uwb_publish") \
+	X(TRACE_UWB_RECV, "uwb_receive") \
+	X(TRACE_GPIO_IRQ, "gpio_irq") \
+	X(TRACE_SPI, "spi") \
+	X(TRACE_DPL_EVENT, "dpl_event") \
+	X(TRACE_DOOR, "door_pulse")
+
+enum trace_id {
+#define TRACE_ENUM(_id, _name) _id,
+	TRACE_EVENTS(TRACE_ENUM)
+#undef TRACE_ENUM
+	TRACE_NUM_IDS
+};
+
+//chrome trace phases i, B, E and C
+enum trace_ph {
+	TRACE_PH_INSTANT,
+	TRACE_PH_BEGIN,
+	TRACE_PH_END,
+	TRACE_PH_COUNTER,
+};
+
+struct trace_rec {
+	uint32_t ts; //low word of the 1MHz timer, time_us_32
+	uint8_t id;
+	uint8_t ph;
+	uint16_t arg;
+};
+
+struct trace_ring {
+	uint32_t head; //records written since the last clear, the next goes to head % TRACE_RING_LEN
+	struct trace_rec rec[TRACE_RING_LEN];
+};
+
+extern struct trace_ring trace_rings[2];
+extern volatile bool trace_frozen; //set while dumping so the rings hold still
+
+static inline void trace_put(uint8_t id, uint8_t ph, uint16_t arg){
+	struct trace_ring *r = &trace_rings[sio_hw->cpuid];
+	struct trace_rec *e;
+	uint32_t s;
+
+	if (trace_frozen){
+		return;
+	}
+	s = save_and_disable_interrupts(); //an interrupt tracing in between would take the same slot
+	e = &r->rec[r->head++ & (TRACE_RING_LEN - 1)];
+	e->ts = timer_hw->timerawl;
+	e->id = id;
+	e->ph = ph;
+	e->arg = arg;
+	restore_interrupts(s);
+}
+
+void trace_dump(void);
+void trace_clear(void);
+
+#ifdef KEYLESS_TRACE
+#define TRACE_INSTANT(_id, _arg) trace_put((_id), TRACE_PH_INSTANT, (uint16_t)(_arg))
+#define TRACE_BEGIN(_id, _arg) trace_put((_id), TRACE_PH_BEGIN, (uint16_t)(_arg))
+#define TRACE_END(_id, _arg) trace_put((_id), TRACE_PH_END, (uint16_t)(_arg))
+#define TRACE_COUNTER(_id, _val) trace_put((_id), TRACE_PH_COUNTER, (uint16_t)(_val))
+#else
+#define TRACE_INSTANT(_id, _arg) ((void)0)
+#define TRACE_BEGIN(_id, _arg) ((void)0)
+#define TRACE_END(_id, _arg) ((void)0)
+#define TRACE_COUNTER(_id, _val) ((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //KEYLESS_FIRMWARE_TRACE_H
@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+"""
+Convert the binary trace dumps of the Keyless firmware (trace_dump in trace.c) into Chrome trace JSON,
+which chrome://tracing and ui.perfetto.dev open. Core 0 and core 1 become two threads of one process.
+
+The input is a capture of the stdio uart, which may hold console text around the frames. Every frame with a
+good crc is converted, the last one unless --all is given. --port reads straight from a serial port (pyserial),
+sending the dump request first.
+
+  trace2json.py capture.bin -o trace.json
+  trace2json.py --port /dev/ttyUSB0 -o trace.json
+
+Records hold the low 32 bits of the microsecond timer. They are placed relative to the 64 bit time the frame
+was sent at, so anything older than 71 minutes at the dump comes out wrapped.
+"""
+
+import argparse
+import json
+import struct
+import sys
+import zlib
+
+MAGIC = b'KTRC'
+VERSION = 1
+REC = struct.Struct('<IBBH')
+PHASES = {0: 'i', 1: 'B', 2: 'E', 3: 'C'}
+DUMP_REQUEST = b'T'
+
+
+class Truncated(Exception):
+    pass
+
+
+def take(buf, pos, n):
+    if pos + n > len(buf):
+        raise Truncated()
+    return buf[pos:pos + n], pos + n
+
+
+def parse_frame(buf, start):
+    """Parse the frame whose magic is at start, returns (frame, end) or raises Truncated/ValueError."""
+    pos = start + len(MAGIC)
+    hdr, pos = take(buf, pos, 16)
+    version, ncores, nids, ring_len, now = struct.unpack('<BBHIQ', hdr)
+    if version != VERSION:
+        raise ValueError('version %d' % version)
+    names = []
+    for _ in range(nids):
+        n, pos = take(buf, pos, 1)
+        name, pos = take(buf, pos, n[0])
+        names.append(name.decode('ascii', 'replace'))
+    cores = []
+    for _ in range(ncores):
+        raw, pos = take(buf, pos, 4)
+        head = struct.unpack('<I', raw)[0]
+        count = min(head, ring_len)
+        raw, pos = take(buf, pos, count * REC.size)
+        cores.append((head, [REC.unpack_from(raw, i * REC.size) for i in range(count)]))
+    raw, end = take(buf, pos, 4)
+    if struct.unpack('<I', raw)[0] != zlib.crc32(buf[start + len(MAGIC):pos]):
+        raise ValueError('crc')
+    return {'now': now, 'ring_len': ring_len, 'names': names, 'cores': cores}, end
+
+
+def find_frames(buf):
+    frames = []
+    pos = buf.find(MAGIC)
+    while pos >= 0:
+        try:
+            frame, end = parse_frame(buf, pos)
+            frames.append(frame)
+            pos = buf.find(MAGIC, end)
+            continue
+        except Truncated:
+            sys.stderr.write('frame at %d is cut short\n' % pos)
+        except ValueError as e:
+            sys.stderr.write('frame at %d dropped, bad %s\n' % (pos, e))
+        pos = buf.find(MAGIC, pos + 1)
+    return frames
+
+
+def to_events(frame, pid):
+    now = frame['now']
+    names = frame['names']
+    events = []
+    for core, (head, recs) in enumerate(frame['cores']):
+        events.append({'name': 'thread_name', 'ph': 'M', 'pid': pid, 'tid': core,
+                       'args': {'name': 'core%d' % core}})
+        if head > frame['ring_len']:
+            sys.stderr.write('core%d: %d older records were overwritten\n' % (core, head - frame['ring_len']))
+        for ts, ident, ph, arg in recs:
+            t = now - ((now - ts) & 0xffffffff)
+            name = names[ident] if ident < len(names) else 'id%d' % ident
+            ev = {'name': name, 'ph': PHASES.get(ph, 'i'), 'ts': t, 'pid': pid, 'tid': core}
+            if ph == 3:
+                ev['args'] = {name: arg}
+            else:
+                ev['args'] = {'arg': arg}
+                if ph == 0:
+                    ev['s'] = 't'
+            events.append(ev)
+    return events
+
+
+def read_port(port, baud, timeout):
+    import serial
+    with serial.Serial(port, baud, timeout=timeout) as s:
+        s.reset_input_buffer()
+        s.write(DUMP_REQUEST)
+        buf = bytearray()
+        while True:
+            chunk = s.read(4096)
+            if not chunk:
+                return bytes(buf)
+            buf += chunk
+
+
+def main(argv):
+    ap = argparse.ArgumentParser(description=__doc__.strip().split('\n')[0])
+    ap.add_argument('capture', nargs='?', help='uart capture holding one or more dumps')
+    ap.add_argument('-o', '--output', help='json file, stdout if not given')
+    ap.add_argument('--all', action='store_true', help='convert every dump, one process each')
+    ap.add_argument('--port', help='read a dump from this serial port instead of a capture')
+    ap.add_argument('--baud', type=int, default=115200)
+    ap.add_argument('--timeout', type=float, default=2.0, help='seconds of silence that end a --port read')
+    args = ap.parse_args(argv)
+
+    if args.port:
+        buf = read_port(args.port, args.baud, args.timeout)
+    elif args.capture:
+        with open(args.capture, 'rb') as f:
+            buf = f.read()
+    else:
+        ap.error('give a capture or --port')
+    frames = find_frames(buf)
+    if not frames:
+        sys.stderr.write('no trace dump found\n')
+        return 1
+    if not args.all:
+        frames = frames[-1:]
+    events = []
+    for pid, frame in enumerate(frames):
+        events += to_events(frame, pid)
+    out = open(args.output, 'w') if args.output else sys.stdout
+    json.dump({'traceEvents': events, 'displayTimeUnit': 'ms'}, out)
+    if args.output:
+        out.close()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
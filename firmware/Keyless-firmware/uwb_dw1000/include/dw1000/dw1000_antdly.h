@@ -0,0 +1,84 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw1000_antdly.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief Antenna delay calibration
+ *
+ * @details This is the antenna delay class which solves for the tx and rx antenna delays of a device from
+ * DS-TWR exchanges against a calibrated reference at a known distance, and keeps the result in flash.
+ */
+
+#ifndef _DW1000_ANTDLY_H_
+#define _DW1000_ANTDLY_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <dw1000/dw1000_regs.h>
+#include <dw1000/dw1000_dev.h>
+
+#define DW1000_ANTDLY_DTU_PER_SEC   (63897600000LL)     //!< Device time units per second, 499.2MHz * 128
+#define DW1000_ANTDLY_C_MM_PER_SEC  (299702547000LL)    //!< Speed of light in air (mm/s)
+
+//! Calibration state
+typedef enum _dw1000_antdly_state_t {
+    DW1000_ANTDLY_IDLE,             //!< No calibration run
+    DW1000_ANTDLY_RUNNING,          //!< Collecting exchanges
+    DW1000_ANTDLY_DONE,             //!< Solved and applied
+    DW1000_ANTDLY_FAILED            //!< Spread too large, nothing applied
+} dw1000_antdly_state_t;
+
+//! Result of the last calibration
+struct dw1000_antdly_result {
+    int32_t bias_dtu;               //!< Median ToF error, added to each of the tx and rx delay
+    uint32_t spread_dtu;            //!< Median absolute deviation of the ToF error
+    uint16_t rx_antenna_delay;      //!< Solved rx antenna delay
+    uint16_t tx_antenna_delay;      //!< Solved tx antenna delay
+};
+
+//! Antenna delay calibration instance
+struct dw1000_antdly_instance {
+    struct _dw1000_dev_instance_t * dev_inst;   //!< Pointer to the DW1000 instance
+    dw1000_antdly_state_t state;                //!< Calibration state
+    int32_t tof_true_dtu;                       //!< Expected ToF at the reference distance
+    uint16_t nsamples;                          //!< Exchanges wanted
+    uint16_t idx;                               //!< Exchanges collected
+    int32_t err_dtu[MYNEWT_VAL(DW1000_ANTDLY_CAL_MAX_SAMPLES)];    //!< ToF error of each exchange
+    struct dw1000_antdly_result result;         //!< Result of the last calibration
+};
+
+struct dw1000_antdly_instance * dw1000_antdly_get(struct _dw1000_dev_instance_t * inst);
+int dw1000_antdly_cal_start(struct _dw1000_dev_instance_t * inst, uint32_t distance_mm, uint16_t nsamples);
+dw1000_antdly_state_t dw1000_antdly_cal_add(struct _dw1000_dev_instance_t * inst, int32_t tof_dtu);
+void dw1000_antdly_set(struct _dw1000_dev_instance_t * inst, uint16_t rx_delay, uint16_t tx_delay);
+int dw1000_antdly_save(struct _dw1000_dev_instance_t * inst);
+int dw1000_antdly_pkg_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DW1000_ANTDLY_H_ */
@@ -0,0 +1,107 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw1000_cirstream.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief CIR streaming
+ *
+ * @details This is the cir stream class which captures the accumulator around the first path of every
+ * received frame, compresses it and queues it for an application supplied output such as the console
+ * uart or usb cdc. tools/dw1000_cirstream_decode.c decodes the stream on the host.
+ */
+
+#ifndef _DW1000_CIRSTREAM_H_
+#define _DW1000_CIRSTREAM_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <dw1000/dw1000_regs.h>
+#include <dw1000/dw1000_dev.h>
+
+/*
+ * Frame layout, little endian:
+ *   u16 magic, u8 version, u8 ntaps, u16 seq, u16 fp_idx (10.6 fixed point), u16 first tap, u16 payload length,
+ *   payload, u16 crc16-ccitt (0x1021, init 0xffff) over everything before it.
+ * The payload holds the taps as real, imag int16 pairs, each component delta coded against the same
+ * component of the previous tap and zigzag mapped. Every DW1000_CIRSTREAM_BLOCK taps start with a 5 bit
+ * width w followed by the block's components in w bits each, bits packed lsb first.
+ */
+#define DW1000_CIRSTREAM_MAGIC      (0xC1D1)
+#define DW1000_CIRSTREAM_VERSION    (1)
+#define DW1000_CIRSTREAM_HDR_LEN    (12)
+#define DW1000_CIRSTREAM_BLOCK      (8)     //!< Taps sharing a bit width
+#define DW1000_CIRSTREAM_WBITS      (5)     //!< Bits of the width field
+//! Largest payload, 17 bits per component and a width field per block
+#define DW1000_CIRSTREAM_PAYLOAD_MAX ((MYNEWT_VAL(DW1000_CIRSTREAM_TAPS) * 2 * 17 + \
+    (MYNEWT_VAL(DW1000_CIRSTREAM_TAPS) + DW1000_CIRSTREAM_BLOCK - 1) / DW1000_CIRSTREAM_BLOCK * DW1000_CIRSTREAM_WBITS + 7) / 8)
+#define DW1000_CIRSTREAM_FRAME_MAX  (DW1000_CIRSTREAM_HDR_LEN + DW1000_CIRSTREAM_PAYLOAD_MAX + 2)
+
+//! Output function, returns the number of bytes taken
+typedef int (*dw1000_cirstream_write_t)(void * arg, const uint8_t * buf, uint16_t len);
+
+//! Stream statistics
+struct dw1000_cirstream_stats {
+    uint32_t frames;                //!< Captures queued
+    uint32_t dropped;               //!< Captures dropped for lack of queue space
+    uint32_t skipped;               //!< Frames not captured, LDE error
+    uint32_t limited;               //!< Frames not captured, within DW1000_CIRSTREAM_INTERVAL of the last
+    uint32_t raw_bytes;             //!< Accumulator bytes read
+    uint32_t bytes;                 //!< Encoded bytes queued
+};
+
+//! CIR stream instance
+struct dw1000_cirstream_instance {
+    struct _dw1000_dev_instance_t * dev_inst;       //!< Pointer to the DW1000 instance
+    bool enabled;                                   //!< Capture received frames
+    uint16_t seq;                                   //!< Sequence number of the next capture
+    bool acc_valid;                                 //!< acc holds the accumulator of the frame just received
+    uint16_t acc_start;                             //!< First tap in acc
+    uint32_t capture_ticks;                         //!< cputime of the last capture
+    dw1000_cirstream_write_t write;                 //!< Output
+    void * write_arg;                               //!< Argument of write
+    struct dpl_callout drain;                       //!< Drains the queue from the default event queue
+    volatile uint32_t head;                         //!< Queue write position, free running
+    volatile uint32_t tail;                         //!< Queue read position, free running
+    uint8_t queue[MYNEWT_VAL(DW1000_CIRSTREAM_QUEUE)];                  //!< Encoded frames
+    uint8_t acc[1 + MYNEWT_VAL(DW1000_CIRSTREAM_TAPS) * 4];             //!< Dummy byte and raw taps
+    int16_t taps[2 * MYNEWT_VAL(DW1000_CIRSTREAM_TAPS)];                //!< Taps being encoded
+    uint8_t frame[DW1000_CIRSTREAM_FRAME_MAX];                          //!< Frame being encoded
+    struct dw1000_cirstream_stats stats;            //!< Statistics
+};
+
+struct dw1000_cirstream_instance * dw1000_cirstream_init(struct _dw1000_dev_instance_t * inst);
+struct dw1000_cirstream_instance * dw1000_cirstream_get(struct _dw1000_dev_instance_t * inst);
+void dw1000_cirstream_set_output(struct _dw1000_dev_instance_t * inst, dw1000_cirstream_write_t write, void * arg);
+void dw1000_cirstream_enable(struct _dw1000_dev_instance_t * inst, bool enable);
+void dw1000_cirstream_capture(struct _dw1000_dev_instance_t * inst);
+const uint8_t * dw1000_cirstream_window(struct _dw1000_dev_instance_t * inst, uint16_t start, uint16_t ntaps);
+uint16_t dw1000_cirstream_encode(uint8_t * out, const int16_t * taps, uint16_t ntaps);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DW1000_CIRSTREAM_H_ */
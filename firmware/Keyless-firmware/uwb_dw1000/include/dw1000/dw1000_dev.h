@@ -54,6 +54,7 @@ extern "C" {
 #define DWT_SUCCESS (0)              //!< DWT Success
 #define DWT_ERROR   (-1)             //!< DWT Error
 #define DWT_TIME_UNITS          (1.0/499.2e6/128.0) //!< DWT time units calculation
+#define DW1000_SPI_HEADROOM     (3)                 //!< Longest SPI command header, room needed by dw1000_read_inplace
 
 //! Device control status bits.
 typedef struct _dw1000_dev_control_t{
@@ -69,6 +70,8 @@ typedef struct _dw1000_dev_control_t{
     uint32_t cir_enable:1;                  //!< Enables reading CIR on this operation
     uint32_t rxauto_disable:1;              //!< Disable auto receive parameter
     uint32_t abs_timeout:1;                 //!< RX absolute timeout active
+    uint32_t lpl_enabled:1;                 //!< Low-power listening armed
+    uint32_t xtal_track_enabled:1;          //!< Crystal trim tracking active
 }dw1000_dev_control_t;
 
 
@@ -147,6 +150,72 @@ struct dw1000_spi_backtrace {
 
 
 
+//! Phy register values written by dw1000_mac_config, see dw1000_mac_build_regimage.
+struct dw1000_mac_regimage {
+    uint32_t sys_cfg;               //!< SYS_CFG
+    uint16_t lde_repc;              //!< LDE_REPC, replica coefficient
+    uint16_t lde_cfg2;              //!< LDE_CFG2
+    uint32_t pll_cfg;               //!< FS_PLLCFG
+    uint8_t pll_tune;               //!< FS_PLLTUNE
+    uint8_t rxctrlh;                //!< RF_RXCTRLH
+    uint32_t txctrl;                //!< RF_TXCTRL
+    uint16_t dtune0b;               //!< DRX_TUNE0b
+    uint16_t dtune1a;               //!< DRX_TUNE1a
+    uint16_t dtune1b;               //!< DRX_TUNE1b
+    uint16_t dtune4h;               //!< DRX_TUNE4H
+    uint32_t dtune2;                //!< DRX_TUNE2
+    uint16_t sfdtoc;                //!< DRX_SFDTOC
+    uint16_t agc_tune1;             //!< AGC_TUNE1
+    uint8_t usr_sfd;                //!< USR_SFD length
+    uint8_t dtune4h_valid:1;        //!< DRX_TUNE4H is set by this configuration
+    uint8_t usr_sfd_valid:1;        //!< USR_SFD is set by this configuration
+    uint32_t chan_ctrl;             //!< CHAN_CTRL
+    uint32_t tx_fctrl;              //!< TX_FCTRL
+};
+
+#if MYNEWT_VAL(DW1000_CBS_TABLE_ENABLED)
+//! Interface callback events dispatched through the callback table.
+typedef enum _dw1000_cbs_event_t {
+    DW1000_CBS_RX_COMPLETE,         //!< rx_complete_cb
+    DW1000_CBS_TX_BEGINS,           //!< tx_begins_cb
+    DW1000_CBS_TX_COMPLETE,         //!< tx_complete_cb
+    DW1000_CBS_RX_TIMEOUT,          //!< rx_timeout_cb
+    DW1000_CBS_RX_ERROR,            //!< rx_error_cb
+    DW1000_CBS_RESET,               //!< reset_cb
+    DW1000_CBS_SLEEP,               //!< sleep_cb
+    DW1000_CBS_CIR_COMPLETE,        //!< cir_complete_cb
+    DW1000_CBS_NUM
+} dw1000_cbs_event_t;
+
+//! Callback table entry, a non-NULL handler and the interface it belongs to.
+struct dw1000_cbs_entry {
+    bool (* cb)(struct uwb_dev *, struct uwb_mac_interface *);  //!< Handler
+    struct uwb_mac_interface * cbs;                             //!< Interface passed to the handler
+};
+
+//! Per event arrays of the interface callbacks, in list order.
+struct dw1000_cbs_table {
+    volatile uint32_t gen;              //!< Bumped by every change to interface_cbs
+    uint32_t built;                     //!< gen the table was built at
+    uint8_t nifaces;                    //!< Interfaces in the table
+    uint8_t overflow:1;                 //!< More interfaces than the table holds, dispatch walks the list
+    uint8_t num[DW1000_CBS_NUM];        //!< Handlers per event
+    struct dw1000_cbs_entry ent[DW1000_CBS_NUM][MYNEWT_VAL(DW1000_CBS_TABLE_MAX)];  //!< Handlers
+};
+#endif
+
+#define DW1000_SPI_XOVER_NSIZES (9)  //!< Transfer lengths measured by the spi crossover calibration, 2 to 512
+
+//! Payload lengths from which spi transfers are nonblocking, and what they were chosen from.
+struct dw1000_spi_xover {
+    uint16_t rd_min;                //!< Reads of this many bytes or more are nonblocking
+    uint16_t wr_min;                //!< Writes of this many bytes or more are nonblocking
+#if MYNEWT_VAL(DW1000_SPI_XOVER_CAL)
+    uint32_t rd_ticks[2][DW1000_SPI_XOVER_NSIZES];  //!< Blocking and nonblocking read time per length, all rounds
+    uint32_t wr_ticks[2][DW1000_SPI_XOVER_NSIZES];  //!< Blocking and nonblocking write time per length, all rounds
+#endif
+};
+
 struct _dw1000_dev_instance_t;
 
 //! Device instance parameters.
@@ -173,15 +242,20 @@ typedef struct _dw1000_dev_instance_t{
     uint8_t otp_xtal_trim;         //!< OTP Crystal trim
     uint32_t sys_cfg_reg;          //!< System config register
     uint32_t tx_fctrl;             //!< Transmit frame control register parameter
+    struct dw1000_mac_regimage mac_regimage;    //!< Phy registers as last written by dw1000_mac_config
     uint32_t sys_status;           //!< SYS_STATUS_ID for current event
     uint8_t  sys_status_hi;        //!< SYS_STATUS_ID+4 for current event
 
     struct hal_spi_settings spi_settings;  //!< Structure of SPI settings in hal layer
+    struct dw1000_spi_xover spi_xover;     //!< Blocking vs nonblocking transfer thresholds
 #if MYNEWT_VAL(CIR_ENABLED)
     struct cir_dw1000_instance * cir;           //!< CIR instance (duplicate of uwb_dev->cir)
 #endif
     dw1000_dev_rxdiag_t rxdiag;                    //!< DW1000 receive diagnostics
     dw1000_dev_control_t control;                  //!< DW1000 device control parameters
+#if MYNEWT_VAL(DW1000_CBS_TABLE_ENABLED)
+    struct dw1000_cbs_table cbs_table;             //!< Interface callbacks by event
+#endif
 
 #if MYNEWT_VAL(DW1000_LWIP)
     void (* lwip_rx_complete_cb) (struct _dw1000_dev_instance_t *);
@@ -189,6 +263,9 @@ typedef struct _dw1000_dev_instance_t{
 #if MYNEWT_VAL(DW1000_MAC_STATS)
     STATS_SECT_DECL(mac_stat_section) stat;
 #endif
+#if MYNEWT_VAL(DW1000_MAC_LATENCY)
+    struct dw1000_mac_latency lat;                 //!< Interrupt and callback timing
+#endif
 #if MYNEWT_VAL(DW1000_SYS_STATUS_BACKTRACE_LEN)
     struct dw1000_sys_status_backtrace sys_status_bt[MYNEWT_VAL(DW1000_SYS_STATUS_BACKTRACE_LEN)];
     uint16_t sys_status_bt_idx;
@@ -227,6 +304,7 @@ void dw1000_dev_deinit(dw1000_dev_instance_t * inst);
 int dw1000_dev_config(dw1000_dev_instance_t * inst);
 void dw1000_softreset(dw1000_dev_instance_t * inst);
 struct uwb_dev_status dw1000_read(dw1000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, uint8_t * buffer, uint16_t length);
+struct uwb_dev_status dw1000_read_inplace(dw1000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, uint8_t * buffer, uint16_t length);
 struct uwb_dev_status dw1000_write(dw1000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, uint8_t * buffer, uint16_t length);
 uint64_t dw1000_read_reg(dw1000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, size_t nsize);
 void dw1000_write_reg(dw1000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, uint64_t val, size_t nsize);
@@ -39,13 +39,37 @@ extern "C" {
 #include <dw1000/dw1000_dev.h>
 #include <dw1000/dw1000_phy.h>
 
+//! One part of a transfer, tx or rx may be NULL
+struct hal_dw1000_spi_seg {
+    const uint8_t * tx;             //!< Bytes to send, NULL to clock out don't care bytes
+    uint8_t * rx;                   //!< Where to receive, NULL to discard
+    uint16_t len;                   //!< Segment length
+};
+
+#if MYNEWT_VAL(DW1000_HAL_SPI_SG)
+/* Provided by the platform spi, all segments go in one message */
+int hal_spi_txrx_sg(int spi_num, const struct hal_dw1000_spi_seg * seg, int nseg);
+#endif
+#if MYNEWT_VAL(DW1000_HAL_SPI_SG_NOBLOCK)
+/* As above without waiting, completes through the txrx callback like hal_spi_txrx_noblock */
+int hal_spi_txrx_sg_noblock(int spi_num, const struct hal_dw1000_spi_seg * seg, int nseg);
+#endif
+#if MYNEWT_VAL(DW1000_HAL_SPI_CS_AUTO)
+/* Holds the chip select of spi_num low for usecs with the clock idle, waking the DW1000 */
+int hal_spi_cs_wake(int spi_num, uint32_t usecs);
+#endif
+
 struct _dw1000_dev_instance_t * hal_dw1000_inst(uint8_t idx);     //!< Structure of hal instances.
 void hal_dw1000_reset(struct _dw1000_dev_instance_t * inst);
 int hal_dw1000_read(struct _dw1000_dev_instance_t * inst, const uint8_t * cmd, uint8_t cmd_size, uint8_t * buffer, uint16_t length);
 int hal_dw1000_read_noblock(struct _dw1000_dev_instance_t * inst, const uint8_t * cmd, uint8_t cmd_size, uint8_t * buffer, uint16_t length);
+int hal_dw1000_read_inplace(struct _dw1000_dev_instance_t * inst, const uint8_t * cmd, uint8_t cmd_size, uint8_t * buffer, uint16_t length, bool noblock);
 int hal_dw1000_write(struct _dw1000_dev_instance_t * inst, const uint8_t * cmd, uint8_t cmd_size, uint8_t * buffer, uint16_t length);
 int hal_dw1000_write_noblock(struct _dw1000_dev_instance_t * inst, const uint8_t * cmd, uint8_t cmd_size, uint8_t * buffer, uint16_t length);
 int hal_dw1000_rw_noblock_wait(struct _dw1000_dev_instance_t * inst, uint32_t timeout_ms);
+#if MYNEWT_VAL(DW1000_SPI_XOVER_CAL)
+void hal_dw1000_spi_xover_cal(struct _dw1000_dev_instance_t * inst);
+#endif
 
 int hal_dw1000_wakeup(struct _dw1000_dev_instance_t * inst);
 int hal_dw1000_get_rst(struct _dw1000_dev_instance_t * inst);
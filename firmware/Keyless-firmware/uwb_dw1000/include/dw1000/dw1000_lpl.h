@@ -0,0 +1,122 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw1000_lpl.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief Low-power listening
+ *
+ * @details This is the low-power listening class which sequences the receiver through SNIFF mode and the
+ * sleep/listen/snooze/listen cycle of the DW1000, and schedules the on/off times so that a wake-up burst
+ * is detected within a target latency at the lowest possible duty cycle.
+ */
+
+#ifndef _DW1000_LPL_H_
+#define _DW1000_LPL_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <dw1000/dw1000_regs.h>
+#include <dw1000/dw1000_dev.h>
+
+#define DW1000_LPL_SNIFF_ON_MAX     (15)        //!< Max SNIFF ON time in PAC units, the IC adds one PAC
+#define DW1000_LPL_SNIFF_OFF_MAX    (255)       //!< Max SNIFF OFF time in 128/125 us units
+#define DW1000_LPL_SNIFF_OFF_NS     (1024)      //!< SNIFF OFF time unit (ns)
+#define DW1000_LPL_SNOOZE_MIN       (1)         //!< Smallest working snooze value, the IC adds one unit
+#define DW1000_LPL_SNOOZE_MAX       (255)       //!< Max snooze value
+#define DW1000_LPL_SNOOZE_NS        (26667)     //!< Snooze time unit, 512/19.2 us (ns)
+#define DW1000_LPL_SLEEP_CNT_SHIFT  (12)        //!< The sleep timer programs the high 16 bits of a 28 bit counter
+
+//! Preamble symbol duration in ns for a given PRF
+#define DW1000_LPL_PSYM_NS(_prf) (((_prf) == DWT_PRF_16M) ? 994 : 1018)
+
+//! Requirements handed to the scheduler
+struct dw1000_lpl_config {
+    uint32_t target_latency_usec;   //!< Worst-case time from start of a wake-up burst to detection
+    uint32_t burst_period_usec;     //!< Repetition interval of the wake-up frames within a burst
+    uint32_t burst_duration_usec;   //!< Total length of a wake-up burst
+    uint16_t frame_len;             //!< Wake-up frame length excluding crc
+};
+
+//! Operating point picked by the scheduler
+struct dw1000_lpl_schedule {
+    uint8_t sniff_on;               //!< SNIFF ON time, PAC units
+    uint8_t sniff_off;              //!< SNIFF OFF time, 128/125 us units
+    uint8_t snooze;                 //!< Snooze time, 512/19.2 us units
+    uint8_t use_sleep:1;            //!< Long sleep in use, otherwise SNIFF-only continuous RX
+    uint16_t listen_pac;            //!< Length of each listen phase (preamble detect timeout), PAC units
+    uint16_t sleep_cnt;             //!< Long sleep, high 16 bits of the sleep counter
+    uint32_t listen_usec;           //!< Length of each listen phase
+    uint32_t period_usec;           //!< Length of one sleep/listen/snooze/listen cycle
+    uint32_t latency_usec;          //!< Predicted worst-case detection latency
+    uint16_t sniff_duty_pm;         //!< Receiver duty cycle whilst listening (per mille)
+    uint16_t duty_pm;               //!< Predicted overall receiver duty cycle (per mille)
+};
+
+//! Detection statistics
+struct dw1000_lpl_stats {
+    uint32_t detections;            //!< Number of wake-up bursts detected
+    uint32_t latency_min_usec;      //!< Shortest reported detection latency
+    uint32_t latency_max_usec;      //!< Longest reported detection latency
+    uint64_t latency_sum_usec;      //!< Sum of reported detection latencies
+    uint32_t latency_cnt;           //!< Number of reported detection latencies
+    uint64_t lpl_usec;              //!< Time spent in low-power listening
+    uint64_t rx_usec;               //!< Time spent with the receiver fully on after a detection
+};
+
+//! Low-power listening instance
+struct dw1000_lpl_instance {
+    struct _dw1000_dev_instance_t * dev_inst;   //!< Pointer to the DW1000 instance
+    struct dw1000_lpl_config config;            //!< Requirements of the current schedule
+    struct dw1000_lpl_schedule sched;           //!< Current schedule
+    struct dw1000_lpl_stats stats;              //!< Detection statistics
+    uint16_t lposc_cal;                         //!< XTAL/2 cycles per low-power oscillator cycle
+    uint32_t sys_mask;                          //!< Interrupt mask saved whilst listening
+    uint8_t sleep_enable:1;                     //!< config.sleep_enable saved whilst listening
+    uint8_t wakeup_rx_enable:1;                 //!< config.wakeup_rx_enable saved whilst listening
+    uint32_t state_ticks;                       //!< cputime of the last start/detect
+    uint8_t active:1;                           //!< Low-power listening armed
+    uint8_t rx_on:1;                            //!< Receiver left fully on after a detection
+};
+
+struct dw1000_lpl_instance * dw1000_lpl_init(struct _dw1000_dev_instance_t * inst);
+uint16_t dw1000_lpl_calibrate_sleep_cnt(struct _dw1000_dev_instance_t * inst);
+void dw1000_lpl_set_sniff(struct _dw1000_dev_instance_t * inst, bool enable, uint8_t on, uint8_t off);
+void dw1000_lpl_set_snooze(struct _dw1000_dev_instance_t * inst, uint8_t snooze);
+void dw1000_lpl_set_listening(struct _dw1000_dev_instance_t * inst, bool enable);
+int dw1000_lpl_schedule(struct dw1000_lpl_instance * lpl, const struct dw1000_lpl_config * config,
+                        struct dw1000_lpl_schedule * sched);
+struct uwb_dev_status dw1000_lpl_start(struct dw1000_lpl_instance * lpl);
+struct uwb_dev_status dw1000_lpl_stop(struct dw1000_lpl_instance * lpl);
+void dw1000_lpl_detected(struct _dw1000_dev_instance_t * inst);
+void dw1000_lpl_report_latency(struct dw1000_lpl_instance * lpl, uint16_t burst_idx);
+struct dw1000_lpl_instance * dw1000_lpl_get(struct _dw1000_dev_instance_t * inst);
+uint16_t dw1000_lpl_measured_duty(struct dw1000_lpl_instance * lpl);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DW1000_LPL_H_ */
@@ -122,6 +122,8 @@ typedef struct _dw1000_mac_deviceentcnts_t{
 
 struct uwb_dev_status dw1000_mac_init(struct _dw1000_dev_instance_t * inst, struct uwb_dev_config * config);
 struct uwb_dev_status dw1000_mac_config(struct _dw1000_dev_instance_t * inst, struct uwb_dev_config * config);
+void dw1000_mac_build_regimage(struct _dw1000_dev_instance_t * inst, const struct uwb_dev_config * config, struct dw1000_mac_regimage * img);
+int dw1000_mac_apply_regimage(struct _dw1000_dev_instance_t * inst, const struct dw1000_mac_regimage * img, const struct dw1000_mac_regimage * prev);
 void dw1000_tasks_init(struct _dw1000_dev_instance_t * inst);
 struct uwb_dev_status dw1000_mac_framefilter(struct _dw1000_dev_instance_t * inst, uint16_t enable);
 struct uwb_dev_status dw1000_write_tx(struct _dw1000_dev_instance_t * inst,  uint8_t *txFrameBytes, uint16_t txBufferOffset, uint16_t txFrameLength);
@@ -179,6 +181,68 @@ uint32_t dw1000_read_txtime_lo(struct _dw1000_dev_instance_t * inst);
 
 void dw1000_configcwmode(struct _dw1000_dev_instance_t * inst, uint8_t chan);
 
+#if MYNEWT_VAL(DW1000_CBS_TABLE_ENABLED)
+void dw1000_mac_cbs_rebuild(struct _dw1000_dev_instance_t * inst);
+struct uwb_dev * dw1000_mac_append_interface(struct _dw1000_dev_instance_t * inst, struct uwb_mac_interface * cbs);
+void dw1000_mac_remove_interface(struct _dw1000_dev_instance_t * inst, uwb_extension_id_t id);
+
+/**
+ * Rebuild the callback table if interface_cbs changed since it was built. uwb_mac_append_interface and
+ * uwb_mac_remove_interface are wrapped at link time (-Wl,--wrap) to bump the generation, so changes made
+ * directly through the uwb core are caught too and the interrupt path only compares two words.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return void
+ */
+static inline void
+dw1000_mac_cbs_check(struct _dw1000_dev_instance_t * inst)
+{
+    if (inst->cbs_table.built != inst->cbs_table.gen) {
+        dw1000_mac_cbs_rebuild(inst);
+    }
+}
+
+/**
+ * Call the handlers of an event in list order.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @param ev    Event.
+ * @param stop  Stop at the first handler that returns true.
+ * @return void
+ */
+static inline void
+dw1000_mac_cbs_dispatch(struct _dw1000_dev_instance_t * inst, dw1000_cbs_event_t ev, bool stop)
+{
+    const struct dw1000_cbs_entry * e = inst->cbs_table.ent[ev];
+    const struct dw1000_cbs_entry * end = e + inst->cbs_table.num[ev];
+    for (; e < end; e++) {
+        if (e->cb((struct uwb_dev *)inst, e->cbs) && stop) {
+            break;
+        }
+    }
+}
+#endif
+
+#define DW1000_MAC_CBS_WALK(_inst, _fn, _stop) \
+    do { \
+        struct uwb_mac_interface * _cbs; \
+        SLIST_FOREACH(_cbs, &(_inst)->uwb_dev.interface_cbs, next) { \
+            if (_cbs->_fn && _cbs->_fn((struct uwb_dev *)(_inst), _cbs) && (_stop)) break; \
+        } \
+    } while (0)
+
+#if MYNEWT_VAL(DW1000_CBS_TABLE_ENABLED)
+#define DW1000_MAC_CBS_DISPATCH(_inst, _ev, _fn, _stop) \
+    do { \
+        if ((_inst)->cbs_table.overflow) \
+            DW1000_MAC_CBS_WALK(_inst, _fn, _stop); \
+        else \
+            dw1000_mac_cbs_dispatch((_inst), DW1000_CBS_##_ev, (_stop)); \
+    } while (0)
+#else
+#define DW1000_MAC_CBS_DISPATCH(_inst, _ev, _fn, _stop) DW1000_MAC_CBS_WALK(_inst, _fn, _stop)
+#endif
+
 #ifdef __cplusplus
 }
 #endif
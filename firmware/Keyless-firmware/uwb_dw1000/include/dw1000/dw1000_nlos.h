@@ -0,0 +1,107 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw1000_nlos.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief First path analysis
+ *
+ * @details This is the nlos class which looks at a small accumulator window around the first path of each
+ * received frame and turns its shape into an nlos probability and a timestamp bias correction.
+ *
+ * The analysis itself only needs this header, build it on a host with DW1000_NLOS_KERNEL_ONLY defined.
+ */
+
+#ifndef _DW1000_NLOS_H_
+#define _DW1000_NLOS_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DW1000_NLOS_KERNEL_ONLY
+#include <dw1000/dw1000_regs.h>
+#include <dw1000/dw1000_dev.h>
+#endif
+
+#define DW1000_NLOS_MAX_TAPS    (64)        //!< Largest window the analysis takes
+#define DW1000_NLOS_ONE         (256)       //!< Probability of 1.0
+
+/**
+ * Thresholds of the analysis. Each feature scores 0 at its los value and DW1000_NLOS_ONE at its nlos
+ * value, linearly in between. Delays are in 1/64 tap, which is also one device time unit.
+ */
+struct dw1000_nlos_params {
+    uint16_t rise_los;              //!< Rise time of a clean first path
+    uint16_t rise_nlos;             //!< Rise time of a blocked first path
+    uint16_t ratio_los;             //!< First path to peak power ratio (Q8) of a clean first path
+    uint16_t ratio_nlos;            //!< First path to peak power ratio (Q8) of a blocked first path
+    uint16_t excess_los;            //!< Mean excess delay of a clean channel
+    uint16_t excess_nlos;           //!< Mean excess delay of a blocked channel
+    uint16_t bias_gain;             //!< Timestamp bias per unit mean excess delay at full nlos (Q8)
+};
+
+//! Result of one analysis
+struct dw1000_nlos_result {
+    uint16_t rise;                  //!< First path to the first tap at half the peak amplitude
+    uint16_t ratio;                 //!< First path to peak power ratio (Q8)
+    uint16_t excess;                //!< Power weighted mean delay after the first path
+    uint16_t peak;                  //!< First path to the strongest tap
+    uint16_t p_nlos;                //!< Probability of nlos, 0 to DW1000_NLOS_ONE
+    int16_t bias;                   //!< Lateness of the rx timestamp in dtu
+};
+
+void dw1000_nlos_analyse(const struct dw1000_nlos_params * params, const uint32_t * cir, uint16_t ntaps,
+                         uint16_t fp, uint32_t noise, struct dw1000_nlos_result * r);
+
+#ifndef DW1000_NLOS_KERNEL_ONLY
+
+//! Analysis statistics
+struct dw1000_nlos_stats {
+    uint32_t analysed;              //!< Frames analysed
+    uint32_t nlos;                  //!< Frames more likely nlos than not
+    uint32_t skipped;               //!< Frames without a first path
+    uint32_t shared;                //!< Frames analysed from the cir stream capture, no accumulator read
+};
+
+//! First path analysis instance
+struct dw1000_nlos_instance {
+    struct _dw1000_dev_instance_t * dev_inst;                   //!< Pointer to the DW1000 instance
+    struct dw1000_nlos_params params;                           //!< Thresholds
+    struct dw1000_nlos_result result;                           //!< Result for the last received frame
+    uint8_t acc[4 + MYNEWT_VAL(DW1000_NLOS_TAPS) * 4] __attribute__((aligned(4)));   //!< Accumulator read, taps from acc[4]
+    struct dw1000_nlos_stats stats;                             //!< Statistics
+};
+
+struct dw1000_nlos_instance * dw1000_nlos_init(struct _dw1000_dev_instance_t * inst);
+struct dw1000_nlos_instance * dw1000_nlos_get(struct _dw1000_dev_instance_t * inst);
+void dw1000_nlos_update(struct _dw1000_dev_instance_t * inst);
+int32_t dw1000_nlos_correct(struct _dw1000_dev_instance_t * inst, int32_t tof_dtu);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DW1000_NLOS_H_ */
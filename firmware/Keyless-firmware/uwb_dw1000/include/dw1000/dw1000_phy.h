@@ -74,6 +74,8 @@ void dw1000_phy_sysclk_ACC(struct _dw1000_dev_instance_t * inst, uint8_t mode);
 void dw1000_phy_disable_sequencing(struct _dw1000_dev_instance_t * inst);
 void dw1000_phy_config_lde(struct _dw1000_dev_instance_t * inst, int prfIndex);
 void dw1000_phy_config_txrf(struct _dw1000_dev_instance_t * inst, struct uwb_dev_txrf_config * config);
+void dw1000_phy_set_xtal_trim(struct _dw1000_dev_instance_t * inst, uint8_t trim);
+uint16_t dw1000_phy_read_tempvbat(struct _dw1000_dev_instance_t * inst);
 void dw1000_phy_rx_reset(struct _dw1000_dev_instance_t * inst);
 void dw1000_phy_forcetrxoff(struct _dw1000_dev_instance_t * inst);
 void dw1000_phy_interrupt_mask(struct _dw1000_dev_instance_t * inst, uint32_t bitmask, uint8_t enable);
@@ -0,0 +1,89 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw1000_profile.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief Phy profiles
+ *
+ * @details This is the phy profile class which keeps a precomputed register image per named profile and
+ * switches the device between them by writing only the registers that differ.
+ */
+
+#ifndef _DW1000_PROFILE_H_
+#define _DW1000_PROFILE_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <dw1000/dw1000_regs.h>
+#include <dw1000/dw1000_dev.h>
+
+//! Built-in profiles
+typedef enum _dw1000_profile_id_t {
+    DW1000_PROFILE_DISCOVERY,       //!< Long range, 110k with 1024 preamble
+    DW1000_PROFILE_RANGING,         //!< Short airtime, 6.8M with 128 preamble
+    DW1000_PROFILE_NUM
+} dw1000_profile_id_t;
+
+//! Settings that make up a profile, everything else is kept from the device config
+struct dw1000_profile {
+    const char * name;              //!< Profile name
+    uint8_t dataRate;               //!< DWT_BR_110K, DWT_BR_850K or DWT_BR_6M8
+    uint8_t preambleLength;         //!< DWT_PLEN_64..DWT_PLEN_4096
+    uint8_t pacLength;              //!< DWT_PAC8..DWT_PAC64
+    uint8_t sfdType;                //!< Use the DW non-standard SFD
+};
+
+//! Profile switching statistics
+struct dw1000_profile_stats {
+    uint32_t switches;              //!< Profile changes
+    uint32_t regs_written;          //!< Registers written by profile changes
+    uint32_t escalations;           //!< Changes to the ranging profile on acquisition
+    uint32_t fallbacks;             //!< Changes back to discovery after lost ranges
+};
+
+//! Phy profile instance
+struct dw1000_profile_instance {
+    struct _dw1000_dev_instance_t * dev_inst;                   //!< Pointer to the DW1000 instance
+    dw1000_profile_id_t current;                                //!< Profile in the device
+    struct uwb_dev_config config[DW1000_PROFILE_NUM];           //!< Device config of each profile
+    struct dw1000_mac_regimage img[DW1000_PROFILE_NUM];         //!< Register image of each profile
+    uint16_t misses;                                            //!< Consecutive failed ranges in the ranging profile
+    struct dw1000_profile_stats stats;                          //!< Statistics
+};
+
+extern const struct dw1000_profile g_dw1000_profiles[DW1000_PROFILE_NUM];
+
+struct dw1000_profile_instance * dw1000_profile_init(struct _dw1000_dev_instance_t * inst);
+struct dw1000_profile_instance * dw1000_profile_get(struct _dw1000_dev_instance_t * inst);
+int dw1000_profile_switch(struct _dw1000_dev_instance_t * inst, dw1000_profile_id_t id);
+int dw1000_profile_find(const char * name);
+void dw1000_profile_range_result(struct _dw1000_dev_instance_t * inst, bool success);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DW1000_PROFILE_H_ */
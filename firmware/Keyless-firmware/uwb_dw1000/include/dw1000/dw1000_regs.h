@@ -985,6 +985,7 @@ extern "C" {
 #define RF_CONF_TXPOW_MASK      0x001F0000UL   /* turn on power all LDOs */
 #define RF_CONF_PLLEN_MASK      0x0000E000UL   /* enable PLLs */
 #define RF_CONF_TXBLOCKSEN_MASK 0x00001F00UL   /* enable TX blocks */
+#define RF_CONF_PGMIXBIASEN_MASK    0x0000A700UL    /* Enable TX mixer bias and pulse gen */
 #define RF_CONF_TXPLLPOWEN_MASK (RF_CONF_PLLEN_MASK | RF_CONF_TXPOW_MASK)
 #define RF_CONF_TXALLEN_MASK    (RF_CONF_TXEN_MASK | RF_CONF_TXPOW_MASK | RF_CONF_PLLEN_MASK | RF_CONF_TXBLOCKSEN_MASK)
 /* offset from TX_CAL_ID in bytes */
@@ -1026,6 +1027,17 @@ extern "C" {
 #define TC_SARW_SAR_WTEMP_OFFSET    0x06            /* SAR reading of Temperature level taken at last wakeup event */
 #define TC_SARW_SAR_WVBAT_OFFSET    0x07            /* SAR reading of Voltage level taken at last wakeup event */
 /* offset from TX_CAL_ID in bytes */
+#define TC_PGCCTRL_OFFSET       0x08            /* Pulse Generator Calibration control */
+#define TC_PGCCTRL_LEN          (1)
+#define TC_PGCCTRL_CALSTART     0x01            /* Start PG cal procedure */
+#define TC_PGCCTRL_AUTOCAL      0x02            /* Starts a PG autocalibration loop */
+#define TC_PGCCTRL_TMEAS_MASK   0x3C            /* Mask to retrieve number of clock cycles over which to run PG cal counter */
+#define TC_PGCCTRL_DIR_CONV     0x80            /* Direction (converging) of autocal binary search */
+/* offset from TX_CAL_ID in bytes */
+#define TC_PGCAL_STATUS_OFFSET      0x09        /* Status register from PG calibration block */
+#define TC_PGCAL_STATUS_LEN         (2)
+#define TC_PGCAL_STATUS_DELAY_MASK  0xFFF       /* Mask to retrieve PG delay count from calibration */
+/* offset from TX_CAL_ID in bytes */
 #define TC_PGDELAY_OFFSET       0x0B            /* Transmitter Calibration � Pulse Generator Delay */
 #define TC_PGDELAY_LEN          (1)
 #define TC_PGDELAY_CH1          0xC9            /* Recommended value for channel 1 */
@@ -0,0 +1,88 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw1000_rxring.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief RX frame ring
+ *
+ * @details This is the rx ring class which keeps a fixed pool of frame slots owned by the mac. Frames are read
+ * from the device straight into a free slot and uwb_dev.rxbuf points at it while the rx_complete callbacks run.
+ * A consumer that needs the frame afterwards takes the slot with dw1000_rxring_hold and gives it back with
+ * dw1000_rxring_release.
+ */
+
+#ifndef _DW1000_RXRING_H_
+#define _DW1000_RXRING_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <dw1000/dw1000_regs.h>
+#include <dw1000/dw1000_dev.h>
+
+//! Slot state
+typedef enum _dw1000_rxring_state_t {
+    DW1000_RXRING_FREE,             //!< May be filled, possibly still holding an older frame
+    DW1000_RXRING_HELD              //!< Owned by a consumer until released
+} dw1000_rxring_state_t;
+
+//! Frame slot
+struct dw1000_rxring_desc {
+    uint8_t spi_hdr[4];                             //!< Room for the SPI command, must directly precede buf
+    uint8_t buf[MYNEWT_VAL(UWB_RX_BUFFER_SIZE)];    //!< Frame, without CRC
+    uint16_t len;                                   //!< Frame length, set by dw1000_rxring_hold
+    uint16_t fctrl;                                 //!< Frame control, set by dw1000_rxring_hold
+    uint64_t rxtimestamp;                           //!< Receive timestamp, set by dw1000_rxring_hold
+    volatile uint8_t state;                         //!< dw1000_rxring_state_t
+};
+
+//! Ring statistics
+struct dw1000_rxring_stats {
+    uint32_t frames;                //!< Frames read into a slot
+    uint32_t held;                  //!< Slots taken by consumers
+    uint32_t exhausted;             //!< Frames read into the fallback buffer, every slot held
+};
+
+//! RX ring instance
+struct dw1000_rxring_instance {
+    struct _dw1000_dev_instance_t * dev_inst;       //!< Pointer to the DW1000 instance
+    uint8_t * rxbuf;                                //!< uwb_dev.rxbuf as allocated, used when every slot is held
+    struct dw1000_rxring_desc * current;            //!< Slot of the last frame, NULL if it is in rxbuf
+    uint8_t next;                                   //!< Slot to try first for the next frame
+    struct dw1000_rxring_stats stats;               //!< Statistics
+    struct dw1000_rxring_desc desc[MYNEWT_VAL(DW1000_RXRING_SLOTS)];  //!< Slots
+};
+
+struct dw1000_rxring_instance * dw1000_rxring_init(struct _dw1000_dev_instance_t * inst);
+struct dw1000_rxring_instance * dw1000_rxring_get(struct _dw1000_dev_instance_t * inst);
+void dw1000_rxring_read(struct _dw1000_dev_instance_t * inst, uint16_t len);
+struct dw1000_rxring_desc * dw1000_rxring_hold(struct _dw1000_dev_instance_t * inst);
+void dw1000_rxring_release(struct _dw1000_dev_instance_t * inst, struct dw1000_rxring_desc * desc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DW1000_RXRING_H_ */
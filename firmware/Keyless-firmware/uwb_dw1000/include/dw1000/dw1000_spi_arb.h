@@ -0,0 +1,86 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw1000_spi_arb.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief SPI bus arbitration
+ *
+ * @details This is the spi arbiter class which orders the transfers of all DW1000 instances sharing a
+ * bus by the class of the task issuing them, and keeps per instance histograms of the time spent
+ * waiting for the bus.
+ */
+
+#ifndef _DW1000_SPI_ARB_H_
+#define _DW1000_SPI_ARB_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <dw1000/dw1000_regs.h>
+#include <dw1000/dw1000_dev.h>
+
+//! Transfer classes, higher goes first
+typedef enum _dw1000_spi_class_t {
+    DW1000_SPI_CLASS_DIAG,          //!< CLI, register dumps and other diagnostics
+    DW1000_SPI_CLASS_TX,            //!< Ranging and tx scheduling, tasks without a class
+    DW1000_SPI_CLASS_IRQ,           //!< Interrupt task
+    DW1000_SPI_CLASS_NUM
+} dw1000_spi_class_t;
+
+//! Arbitration state of one bus, shared by the instances with the same spi_sem
+struct dw1000_spi_arb_bus {
+    struct dpl_sem * spi_sem;                           //!< Bus semaphore the arbiter sits in front of
+    uint8_t busy;                                       //!< A transfer owns the bus
+    uint8_t waiting[DW1000_SPI_CLASS_NUM];              //!< Waiters per class
+    struct dpl_sem gate[DW1000_SPI_CLASS_NUM];          //!< Waiters pend here until handed the bus
+};
+
+//! Wait statistics of one class
+struct dw1000_spi_arb_stats {
+    uint32_t count;                                     //!< Transfers
+    uint32_t max_usec;                                  //!< Longest wait
+    uint32_t hist[MYNEWT_VAL(DW1000_SPI_ARB_HIST_BINS)];  //!< Waits, bin 0 is < 1us, bin n is < 2^n us
+};
+
+//! SPI arbiter instance
+struct dw1000_spi_arb_instance {
+    struct _dw1000_dev_instance_t * dev_inst;           //!< Pointer to the DW1000 instance
+    struct dw1000_spi_arb_bus * bus;                    //!< Bus of the instance
+    uint8_t irq_task_set;                               //!< Interrupt task has been given DW1000_SPI_CLASS_IRQ
+    struct dw1000_spi_arb_stats stats[DW1000_SPI_CLASS_NUM];  //!< Wait statistics per class
+};
+
+struct dw1000_spi_arb_instance * dw1000_spi_arb_init(struct _dw1000_dev_instance_t * inst);
+struct dw1000_spi_arb_instance * dw1000_spi_arb_get(struct _dw1000_dev_instance_t * inst);
+int dw1000_spi_arb_set_task_class(void * task, dw1000_spi_class_t cls);
+void dw1000_spi_arb_irq_task(struct _dw1000_dev_instance_t * inst);
+int dw1000_spi_arb_acquire(struct _dw1000_dev_instance_t * inst);
+void dw1000_spi_arb_release(struct _dw1000_dev_instance_t * inst);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DW1000_SPI_ARB_H_ */
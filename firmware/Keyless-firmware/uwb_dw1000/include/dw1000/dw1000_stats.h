@@ -52,6 +52,46 @@ STATS_SECT_START(mac_stat_section)
 STATS_SECT_END
 #endif
 
+#if MYNEWT_VAL(DW1000_MAC_LATENCY)
+#define DW1000_MAC_LAT_BINS     (16)    //!< Bin k > 0 counts [2^(k-1), 2^k) cputime ticks, the last bin is open ended
+#define DW1000_MAC_LAT_EVENTS   (10)    //!< Interrupt events, DW1000_IRQ_EV_* of dw1000_mac.c
+
+//! Latency histogram
+struct dw1000_mac_lat_hist {
+    uint32_t n;                         //!< Samples
+    uint32_t max;                       //!< Longest sample in cputime ticks
+    uint32_t bin[DW1000_MAC_LAT_BINS];  //!< log2 bins
+};
+
+//! Time spent in the rx_complete_cb of one interface
+struct dw1000_mac_lat_rxcb {
+    uint16_t id;                        //!< Interface id
+    struct dw1000_mac_lat_hist hist;    //!< Duration of the callback
+};
+
+//! Interrupt timing of a device
+struct dw1000_mac_latency {
+    uint32_t irq_seen;                  //!< irq_at_ticks of the last interrupt counted in irq
+    struct dw1000_mac_lat_hist irq;     //!< Irq pin to the start of the interrupt event
+    struct dw1000_mac_lat_hist ev[DW1000_MAC_LAT_EVENTS];   //!< Handler duration per event
+    uint8_t nrxcb;                      //!< Interfaces seen in rx_complete
+    struct dw1000_mac_lat_rxcb rxcb[MYNEWT_VAL(DW1000_MAC_LATENCY_RXCB_MAX)];  //!< rx_complete_cb duration per interface
+};
+
+extern const char * const dw1000_mac_lat_event_names[DW1000_MAC_LAT_EVENTS];
+
+static inline void
+dw1000_mac_lat_add(struct dw1000_mac_lat_hist * h, uint32_t ticks)
+{
+    uint32_t b = ticks ? 32 - __builtin_clz(ticks) : 0;
+    h->bin[b < DW1000_MAC_LAT_BINS ? b : DW1000_MAC_LAT_BINS - 1]++;
+    h->n++;
+    if (ticks > h->max) {
+        h->max = ticks;
+    }
+}
+#endif
+
 #ifdef __cplusplus
 }
 #endif
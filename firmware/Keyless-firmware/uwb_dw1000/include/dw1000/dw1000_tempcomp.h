@@ -0,0 +1,90 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw1000_tempcomp.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief Temperature compensation of TX power and pulse bandwidth
+ *
+ * @details This is the temperature compensation class which keeps the TX_POWER and PG_DELAY registers
+ * matched to the die temperature, relative to a reference taken once at init.
+ */
+
+#ifndef _DW1000_TEMPCOMP_H_
+#define _DW1000_TEMPCOMP_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <dpl/dpl.h>
+#include <dw1000/dw1000_regs.h>
+#include <dw1000/dw1000_dev.h>
+
+//! Convert a raw SAR temperature reading to centi-degrees C
+#define DW1000_TEMPCOMP_RAW_TO_CDEG(_inst, _raw) (114 * ((int32_t)(_raw) - (_inst)->otp_temp) + 2300)
+
+//! Reference values the compensation is made against
+struct dw1000_tempcomp_ref {
+    uint8_t temp_raw;               //!< Raw SAR temperature when the reference was taken
+    uint8_t pgdly;                  //!< PG_DELAY at the reference temperature
+    uint16_t pg_count;              //!< PG calibration count for pgdly at the reference temperature
+    uint32_t power;                 //!< TX_POWER at the reference temperature
+};
+
+//! Temperature compensation statistics
+struct dw1000_tempcomp_stats {
+    uint32_t samples;               //!< Temperature samples taken
+    uint32_t pg_updates;            //!< PG_DELAY changes
+    uint32_t power_updates;         //!< TX_POWER changes
+    uint32_t pg_meas;               //!< PG calibration counts measured
+    uint32_t busy;                  //!< Samples put off because the transceiver was active
+};
+
+//! Temperature compensation instance
+struct dw1000_tempcomp_instance {
+    struct _dw1000_dev_instance_t * dev_inst;   //!< Pointer to the DW1000 instance
+    struct dw1000_tempcomp_ref ref;             //!< Cached reference
+    struct dpl_callout callout;                 //!< Sampling period timer
+    uint8_t temp_raw;                           //!< Last temperature sample
+    uint8_t applied_temp_raw;                   //!< Temperature the current registers were computed for
+    uint8_t active:1;                           //!< Periodic sampling running
+    uint8_t due:1;                              //!< A sample is due at the next service run
+    struct dw1000_tempcomp_stats stats;         //!< Statistics
+};
+
+struct dw1000_tempcomp_instance * dw1000_tempcomp_init(struct _dw1000_dev_instance_t * inst,
+                                                       const struct dw1000_tempcomp_ref * ref);
+struct dw1000_tempcomp_instance * dw1000_tempcomp_get(struct _dw1000_dev_instance_t * inst);
+void dw1000_tempcomp_start(struct dw1000_tempcomp_instance * tc);
+void dw1000_tempcomp_stop(struct dw1000_tempcomp_instance * tc);
+bool dw1000_tempcomp_service(struct dw1000_tempcomp_instance * tc);
+uint16_t dw1000_tempcomp_calc_pgcount(struct _dw1000_dev_instance_t * inst, uint8_t pgdly);
+uint32_t dw1000_tempcomp_power_adj(uint32_t ref_power, int32_t adj);
+int32_t dw1000_tempcomp_power_steps(uint8_t channel, int32_t delta_temp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DW1000_TEMPCOMP_H_ */
@@ -0,0 +1,82 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw1000_xtal.h
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief Crystal trim tracking
+ *
+ * @details This is the crystal trim class which follows the clock offset to a remote device, as seen by the
+ * carrier integrator or the time tracking offset of each received frame, and steps the XTAL trim to keep it small.
+ *
+ * The offset conversions only need this header, build them on a host with DW1000_XTAL_KERNEL_ONLY defined.
+ */
+
+#ifndef _DW1000_XTAL_H_
+#define _DW1000_XTAL_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int32_t dw1000_xtal_ci_ppb(uint8_t channel, bool rate_110k, int32_t integrator_val);
+int32_t dw1000_xtal_ttcko_ppb(bool prf_16m, int32_t ttcko);
+
+#ifndef DW1000_XTAL_KERNEL_ONLY
+#include <dw1000/dw1000_regs.h>
+#include <dw1000/dw1000_dev.h>
+
+#define DW1000_XTAL_ANY_SRC     (0xFFFF)    //!< Track frames from any source
+
+//! Crystal trim tracking statistics
+struct dw1000_xtal_stats {
+    uint32_t samples;               //!< Samples fed to the filter
+    uint32_t rejected;              //!< Samples rejected as outliers
+    uint32_t adjustments;           //!< Number of trim changes
+    int32_t last_ppb;               //!< Last accepted sample
+};
+
+//! Crystal trim tracking instance
+struct dw1000_xtal_instance {
+    struct _dw1000_dev_instance_t * dev_inst;   //!< Pointer to the DW1000 instance
+    uint16_t src_uid;                           //!< Only track frames from this short address
+    int32_t filt_ppb;                           //!< Filtered clock offset, positive when the local clock is fast
+    uint16_t settle;                            //!< Samples left before the filter is trusted
+    struct dw1000_xtal_stats stats;             //!< Statistics
+};
+
+struct dw1000_xtal_instance * dw1000_xtal_track_init(struct _dw1000_dev_instance_t * inst, uint16_t src_uid);
+void dw1000_xtal_track_enable(struct _dw1000_dev_instance_t * inst, bool enable);
+struct dw1000_xtal_instance * dw1000_xtal_get(struct _dw1000_dev_instance_t * inst);
+int32_t dw1000_xtal_ci_to_ppb(struct _dw1000_dev_instance_t * inst, int32_t integrator_val);
+int32_t dw1000_xtal_ttcko_to_ppb(struct _dw1000_dev_instance_t * inst, int32_t ttcko);
+void dw1000_xtal_track_sample(struct _dw1000_dev_instance_t * inst, int32_t ppb);
+void dw1000_xtal_track_rx(struct _dw1000_dev_instance_t * inst);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DW1000_XTAL_H_ */
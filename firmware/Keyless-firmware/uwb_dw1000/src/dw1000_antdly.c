@@ -0,0 +1,323 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw1000_antdly.c
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief Antenna delay calibration
+ *
+ * @details The device ranges against a reference whose antenna delays are known to be right, placed at a known
+ * distance. The ToF of each DS-TWR exchange, as handed over from the ranging service, is compared with the ToF the
+ * distance should give. Half the round trip error belongs to this device's combined tx+rx delay, so the median
+ * error is added to each of the tx and rx delay. The median absolute deviation is kept as a measure of quality and
+ * a calibration with too much spread is not applied.
+ *
+ * Delays are stored with the config package under dw1000_antdly/<inst>/rx and tx, and loaded over the syscfg
+ * defaults when the application calls conf_load.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <dpl/dpl.h>
+#include <dw1000/dw1000_regs.h>
+#include <dw1000/dw1000_dev.h>
+#include <dw1000/dw1000_hal.h>
+#include <dw1000/dw1000_phy.h>
+#include <dw1000/dw1000_antdly.h>
+
+#if MYNEWT_VAL(DW1000_ANTDLY_CAL_ENABLED)
+
+#if defined(MYNEWT)
+#include <config/config.h>
+#endif
+
+static struct dw1000_antdly_instance g_antdly_instances[MYNEWT_VAL(UWB_DEVICE_MAX)];
+
+/**
+ * API to get the antenna delay calibration instance of a device.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return struct dw1000_antdly_instance *
+ */
+struct dw1000_antdly_instance *
+dw1000_antdly_get(struct _dw1000_dev_instance_t * inst)
+{
+    assert(inst->uwb_dev.idx < MYNEWT_VAL(UWB_DEVICE_MAX));
+    return &g_antdly_instances[inst->uwb_dev.idx];
+}
+
+/**
+ * API to set the antenna delays of a device. The values are kept in uwb_dev so they are
+ * reloaded on wakeup.
+ *
+ * @param inst      Pointer to _dw1000_dev_instance_t.
+ * @param rx_delay  Receive antenna delay in dtu.
+ * @param tx_delay  Transmit antenna delay in dtu.
+ * @return void
+ */
+void
+dw1000_antdly_set(struct _dw1000_dev_instance_t * inst, uint16_t rx_delay, uint16_t tx_delay)
+{
+    inst->uwb_dev.rx_antenna_delay = rx_delay;
+    inst->uwb_dev.tx_antenna_delay = tx_delay;
+    if (inst->uwb_dev.status.initialized && !inst->uwb_dev.status.sleeping) {
+        dw1000_phy_set_rx_antennadelay(inst, inst->uwb_dev.rx_antenna_delay);
+        dw1000_phy_set_tx_antennadelay(inst, inst->uwb_dev.tx_antenna_delay);
+    }
+}
+
+/**
+ * API to start a calibration run.
+ *
+ * @param inst         Pointer to _dw1000_dev_instance_t.
+ * @param distance_mm  Distance to the reference device.
+ * @param nsamples     Number of exchanges to collect, up to DW1000_ANTDLY_CAL_MAX_SAMPLES.
+ * @return DPL_OK on success
+ */
+int
+dw1000_antdly_cal_start(struct _dw1000_dev_instance_t * inst, uint32_t distance_mm, uint16_t nsamples)
+{
+    struct dw1000_antdly_instance * cal = dw1000_antdly_get(inst);
+
+    if (nsamples == 0 || nsamples > MYNEWT_VAL(DW1000_ANTDLY_CAL_MAX_SAMPLES)) {
+        return DPL_EINVAL;
+    }
+    cal->dev_inst = inst;
+    cal->tof_true_dtu = (int32_t)(((int64_t)distance_mm * DW1000_ANTDLY_DTU_PER_SEC + DW1000_ANTDLY_C_MM_PER_SEC / 2)
+                                  / DW1000_ANTDLY_C_MM_PER_SEC);
+    cal->nsamples = nsamples;
+    cal->idx = 0;
+    cal->state = DW1000_ANTDLY_RUNNING;
+    return DPL_OK;
+}
+
+static void
+sort(int32_t * v, uint16_t n)
+{
+    uint16_t i, j;
+    for (i = 1; i < n; i++) {
+        int32_t x = v[i];
+        for (j = i; j > 0 && v[j - 1] > x; j--) {
+            v[j] = v[j - 1];
+        }
+        v[j] = x;
+    }
+}
+
+static int32_t
+median(int32_t * v, uint16_t n)
+{
+    sort(v, n);
+    return (n & 1) ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+static void
+solve(struct dw1000_antdly_instance * cal)
+{
+    struct _dw1000_dev_instance_t * inst = cal->dev_inst;
+    struct dw1000_antdly_result * r = &cal->result;
+    uint16_t i;
+
+    r->bias_dtu = median(cal->err_dtu, cal->nsamples);
+    for (i = 0; i < cal->nsamples; i++) {
+        cal->err_dtu[i] = abs(cal->err_dtu[i] - r->bias_dtu);
+    }
+    r->spread_dtu = median(cal->err_dtu, cal->nsamples);
+
+    r->rx_antenna_delay = (uint16_t)((int32_t)inst->uwb_dev.rx_antenna_delay + r->bias_dtu);
+    r->tx_antenna_delay = (uint16_t)((int32_t)inst->uwb_dev.tx_antenna_delay + r->bias_dtu);
+
+    if (r->spread_dtu > MYNEWT_VAL(DW1000_ANTDLY_CAL_MAX_SPREAD_DTU)) {
+        cal->state = DW1000_ANTDLY_FAILED;
+        return;
+    }
+    dw1000_antdly_set(inst, r->rx_antenna_delay, r->tx_antenna_delay);
+    cal->state = DW1000_ANTDLY_DONE;
+}
+
+/**
+ * API to hand the ToF of a completed DS-TWR exchange with the reference to the calibration. Once all
+ * exchanges are in the delays are solved for and applied, but not saved.
+ *
+ * @param inst     Pointer to _dw1000_dev_instance_t.
+ * @param tof_dtu  Measured time of flight in dtu.
+ * @return dw1000_antdly_state_t
+ */
+dw1000_antdly_state_t
+dw1000_antdly_cal_add(struct _dw1000_dev_instance_t * inst, int32_t tof_dtu)
+{
+    struct dw1000_antdly_instance * cal = dw1000_antdly_get(inst);
+
+    if (cal->state != DW1000_ANTDLY_RUNNING) {
+        return cal->state;
+    }
+    cal->err_dtu[cal->idx++] = tof_dtu - cal->tof_true_dtu;
+    if (cal->idx == cal->nsamples) {
+        solve(cal);
+    }
+    return cal->state;
+}
+
+#if defined(MYNEWT)
+
+static char *antdly_conf_get(int argc, char **argv, char *val, int val_len_max);
+static int antdly_conf_set(int argc, char **argv, char *val);
+static int antdly_conf_export(void (*export_func)(char *name, char *val), enum conf_export_tgt tgt);
+
+static struct conf_handler antdly_conf_handler = {
+    .ch_name = "dw1000_antdly",
+    .ch_get = antdly_conf_get,
+    .ch_set = antdly_conf_set,
+    .ch_commit = NULL,
+    .ch_export = antdly_conf_export,
+};
+
+static uint16_t *
+antdly_conf_field(int argc, char **argv)
+{
+    struct _dw1000_dev_instance_t * inst;
+    int idx;
+
+    if (argc != 2) {
+        return NULL;
+    }
+    idx = strtol(argv[0], NULL, 0);
+    if (idx < 0 || idx >= MYNEWT_VAL(UWB_DEVICE_MAX) || (inst = hal_dw1000_inst(idx)) == NULL) {
+        return NULL;
+    }
+    if (!strcmp(argv[1], "rx")) {
+        return &inst->uwb_dev.rx_antenna_delay;
+    } else if (!strcmp(argv[1], "tx")) {
+        return &inst->uwb_dev.tx_antenna_delay;
+    }
+    return NULL;
+}
+
+static char *
+antdly_conf_get(int argc, char **argv, char *val, int val_len_max)
+{
+    uint16_t * field = antdly_conf_field(argc, argv);
+    int32_t v;
+
+    if (field == NULL) {
+        return NULL;
+    }
+    v = *field;
+    return conf_str_from_value(CONF_INT32, &v, val, val_len_max);
+}
+
+static int
+antdly_conf_set(int argc, char **argv, char *val)
+{
+    struct _dw1000_dev_instance_t * inst;
+    uint16_t * field = antdly_conf_field(argc, argv);
+    int32_t v;
+    int rc;
+
+    if (field == NULL) {
+        return DPL_ENOENT;
+    }
+    rc = conf_value_from_str(val, CONF_INT32, &v, sizeof(v));
+    if (rc || v <= 0 || v > UINT16_MAX) {
+        return DPL_EINVAL;
+    }
+    inst = hal_dw1000_inst(strtol(argv[0], NULL, 0));
+    if (field == &inst->uwb_dev.rx_antenna_delay) {
+        dw1000_antdly_set(inst, (uint16_t)v, inst->uwb_dev.tx_antenna_delay);
+    } else {
+        dw1000_antdly_set(inst, inst->uwb_dev.rx_antenna_delay, (uint16_t)v);
+    }
+    return DPL_OK;
+}
+
+static int
+antdly_conf_export(void (*export_func)(char *name, char *val), enum conf_export_tgt tgt)
+{
+    struct _dw1000_dev_instance_t * inst;
+    char name[32], val[8];
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(UWB_DEVICE_MAX); i++) {
+        if ((inst = hal_dw1000_inst(i)) == NULL) {
+            continue;
+        }
+        snprintf(name, sizeof(name), "dw1000_antdly/%d/rx", i);
+        snprintf(val, sizeof(val), "%d", inst->uwb_dev.rx_antenna_delay);
+        export_func(name, val);
+        snprintf(name, sizeof(name), "dw1000_antdly/%d/tx", i);
+        snprintf(val, sizeof(val), "%d", inst->uwb_dev.tx_antenna_delay);
+        export_func(name, val);
+    }
+    return 0;
+}
+
+/**
+ * API to save the current antenna delays of a device to flash.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return DPL_OK on success
+ */
+int
+dw1000_antdly_save(struct _dw1000_dev_instance_t * inst)
+{
+    char name[32], val[8];
+    int rc;
+
+    snprintf(name, sizeof(name), "dw1000_antdly/%d/rx", inst->uwb_dev.idx);
+    snprintf(val, sizeof(val), "%d", inst->uwb_dev.rx_antenna_delay);
+    rc = conf_save_one(name, val);
+    if (rc) {
+        return rc;
+    }
+    snprintf(name, sizeof(name), "dw1000_antdly/%d/tx", inst->uwb_dev.idx);
+    snprintf(val, sizeof(val), "%d", inst->uwb_dev.tx_antenna_delay);
+    return conf_save_one(name, val);
+}
+
+/**
+ * API to register the antenna delay config handler, stored delays are applied when
+ * the application calls conf_load.
+ *
+ * @param void
+ * @return DPL_OK on success
+ */
+int
+dw1000_antdly_pkg_init(void)
+{
+    return conf_register(&antdly_conf_handler);
+}
+
+#else
+
+int
+dw1000_antdly_save(struct _dw1000_dev_instance_t * inst)
+{
+    return DPL_ENOENT;
+}
+
+int
+dw1000_antdly_pkg_init(void)
+{
+    return DPL_OK;
+}
+
+#endif
+#endif
@@ -0,0 +1,315 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw1000_cirstream.c
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief CIR streaming
+ *
+ * @details Captures are taken in the interrupt task straight after the rx diagnostics, before the
+ * receiver can overwrite the accumulator: DW1000_CIRSTREAM_TAPS taps starting DW1000_CIRSTREAM_PRE taps
+ * before the first path are read, encoded into a frame and copied to a byte queue. The queue is drained
+ * to the output from the default event queue, so a slow uart only ever drops captures and never holds
+ * up the radio. Accumulator samples of neighbouring taps are close, the delta coding typically takes a
+ * 256 byte window to well under half.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <dpl/dpl.h>
+#include <dw1000/dw1000_regs.h>
+#include <dw1000/dw1000_dev.h>
+#include <dw1000/dw1000_mac.h>
+#include <dw1000/dw1000_cirstream.h>
+
+#if MYNEWT_VAL(DW1000_CIRSTREAM_ENABLED)
+
+#define QUEUE_SIZE MYNEWT_VAL(DW1000_CIRSTREAM_QUEUE)
+
+static struct dw1000_cirstream_instance g_cirstream_instances[MYNEWT_VAL(UWB_DEVICE_MAX)];
+
+/**
+ * API to get the cir stream instance of a device.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return struct dw1000_cirstream_instance *
+ */
+struct dw1000_cirstream_instance *
+dw1000_cirstream_get(struct _dw1000_dev_instance_t * inst)
+{
+    assert(inst->uwb_dev.idx < MYNEWT_VAL(UWB_DEVICE_MAX));
+    return &g_cirstream_instances[inst->uwb_dev.idx];
+}
+
+static void
+drain_cb(struct dpl_event * ev)
+{
+    struct dw1000_cirstream_instance * cs = (struct dw1000_cirstream_instance *) dpl_event_get_arg(ev);
+    uint32_t avail, n, off;
+    int rc;
+
+    while ((avail = cs->head - cs->tail) != 0 && cs->write) {
+        off = cs->tail % QUEUE_SIZE;
+        n = (avail < QUEUE_SIZE - off) ? avail : QUEUE_SIZE - off;
+        rc = cs->write(cs->write_arg, &cs->queue[off], n);
+        if (rc > 0) {
+            cs->tail += rc;
+        }
+        if (rc < (int)n) {
+            /* Output is full, try again on the next tick */
+            dpl_callout_reset(&cs->drain, 1);
+            return;
+        }
+    }
+}
+
+/**
+ * API to initialise the cir stream of a device, capture starts disabled.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return struct dw1000_cirstream_instance *
+ */
+struct dw1000_cirstream_instance *
+dw1000_cirstream_init(struct _dw1000_dev_instance_t * inst)
+{
+    struct dw1000_cirstream_instance * cs = dw1000_cirstream_get(inst);
+
+    /* Free running positions, the queue has to divide 2^32 */
+    assert((QUEUE_SIZE & (QUEUE_SIZE - 1)) == 0);
+    assert(QUEUE_SIZE >= DW1000_CIRSTREAM_FRAME_MAX);
+    memset(cs, 0, sizeof(struct dw1000_cirstream_instance));
+    cs->dev_inst = inst;
+    dpl_callout_init(&cs->drain, dpl_eventq_dflt_get(), drain_cb, (void *) cs);
+    return cs;
+}
+
+/**
+ * API to set where encoded frames go. The function is called from the default event queue and
+ * returns how many bytes it took, anything less than offered is retried a tick later.
+ *
+ * @param inst   Pointer to _dw1000_dev_instance_t.
+ * @param write  Output function, NULL to stop draining.
+ * @param arg    Argument passed to write.
+ * @return void
+ */
+void
+dw1000_cirstream_set_output(struct _dw1000_dev_instance_t * inst, dw1000_cirstream_write_t write, void * arg)
+{
+    struct dw1000_cirstream_instance * cs = dw1000_cirstream_get(inst);
+
+    cs->write_arg = arg;
+    cs->write = write;
+}
+
+/**
+ * API to start or stop capturing received frames. The device needs LDE enabled for the first path.
+ *
+ * @param inst    Pointer to _dw1000_dev_instance_t.
+ * @param enable  Capture received frames, at most one per DW1000_CIRSTREAM_INTERVAL.
+ * @return void
+ */
+void
+dw1000_cirstream_enable(struct _dw1000_dev_instance_t * inst, bool enable)
+{
+    dw1000_cirstream_get(inst)->enabled = enable;
+}
+
+struct bitwriter {
+    uint8_t * p;
+    uint32_t acc;
+    uint8_t n;
+};
+
+static inline void
+put_bits(struct bitwriter * bw, uint32_t v, uint8_t w)
+{
+    bw->acc |= v << bw->n;
+    bw->n += w;
+    while (bw->n >= 8) {
+        *bw->p++ = (uint8_t) bw->acc;
+        bw->acc >>= 8;
+        bw->n -= 8;
+    }
+}
+
+/**
+ * API to encode taps into the payload format described in dw1000_cirstream.h.
+ *
+ * @param out    At least DW1000_CIRSTREAM_PAYLOAD_MAX bytes for DW1000_CIRSTREAM_TAPS taps.
+ * @param taps   Real, imag pairs.
+ * @param ntaps  Number of taps.
+ * @return uint16_t payload length.
+ */
+uint16_t
+dw1000_cirstream_encode(uint8_t * out, const int16_t * taps, uint16_t ntaps)
+{
+    struct bitwriter bw = {.p = out, .acc = 0, .n = 0};
+    uint32_t z[2 * DW1000_CIRSTREAM_BLOCK];
+    int32_t prev[2] = {0, 0};
+    uint16_t t, i, nb;
+
+    for (t = 0; t < ntaps; t += nb) {
+        uint32_t all = 0;
+        uint8_t w;
+
+        nb = (ntaps - t < DW1000_CIRSTREAM_BLOCK) ? ntaps - t : DW1000_CIRSTREAM_BLOCK;
+        for (i = 0; i < 2 * nb; i++) {
+            int32_t d = (int32_t) taps[2 * t + i] - prev[i & 1];
+            prev[i & 1] = taps[2 * t + i];
+            z[i] = ((uint32_t) d << 1) ^ (uint32_t)(d >> 31);
+            all |= z[i];
+        }
+        w = all ? 32 - __builtin_clz(all) : 0;
+        put_bits(&bw, w, DW1000_CIRSTREAM_WBITS);
+        for (i = 0; i < 2 * nb; i++) {
+            put_bits(&bw, z[i], w);
+        }
+    }
+    if (bw.n) {
+        *bw.p++ = (uint8_t) bw.acc;
+    }
+    return bw.p - out;
+}
+
+static uint16_t
+crc16(const uint8_t * p, uint16_t len)
+{
+    uint16_t crc = 0xffff;
+    uint8_t i;
+
+    while (len--) {
+        crc ^= (uint16_t)(*p++) << 8;
+        for (i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static inline void
+put16(uint8_t * p, uint16_t v)
+{
+    p[0] = (uint8_t) v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+/**
+ * API to capture the accumulator of the frame just received, called from the rx handler after
+ * the rx diagnostics have been read.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return void
+ */
+void
+dw1000_cirstream_capture(struct _dw1000_dev_instance_t * inst)
+{
+    struct dw1000_cirstream_instance * cs = dw1000_cirstream_get(inst);
+    uint16_t acc_taps = (inst->uwb_dev.config.prf == DWT_PRF_16M) ? 992 : 1016;
+    uint16_t ntaps = MYNEWT_VAL(DW1000_CIRSTREAM_TAPS);
+    uint16_t fp_idx, start, plen, flen, i;
+    uint32_t off, now;
+
+    cs->acc_valid = false;
+    if (!cs->enabled || cs->dev_inst == NULL) {
+        return;
+    }
+    if (inst->uwb_dev.status.lde_error) {
+        cs->stats.skipped++;
+        return;
+    }
+    /* The read is over a kilobyte at 255 taps, bound what the stream takes from the radio */
+    now = dpl_cputime_get32();
+    if (cs->stats.frames &&
+        dpl_cputime_ticks_to_usecs(now - cs->capture_ticks) < MYNEWT_VAL(DW1000_CIRSTREAM_INTERVAL) * 1000) {
+        cs->stats.limited++;
+        return;
+    }
+    if (QUEUE_SIZE - (cs->head - cs->tail) < DW1000_CIRSTREAM_FRAME_MAX) {
+        cs->stats.dropped++;
+        cs->seq++;
+        return;
+    }
+
+    fp_idx = inst->uwb_dev.config.rxdiag_enable ? inst->rxdiag.fp_idx :
+        (uint16_t) dw1000_read_reg(inst, RX_TIME_ID, RX_TIME_FP_INDEX_OFFSET, sizeof(uint16_t));
+    start = fp_idx >> 6;
+    start = (start > MYNEWT_VAL(DW1000_CIRSTREAM_PRE)) ? start - MYNEWT_VAL(DW1000_CIRSTREAM_PRE) : 0;
+    if (start + ntaps > acc_taps) {
+        start = acc_taps - ntaps;
+    }
+
+    /* The first byte of an accumulator read is a dummy */
+    dw1000_read_accdata(inst, cs->acc, start * 4, 1 + ntaps * 4);
+    cs->acc_valid = true;
+    cs->acc_start = start;
+    cs->capture_ticks = now;
+    for (i = 0; i < 2 * ntaps; i++) {
+        cs->taps[i] = (int16_t)((uint16_t) cs->acc[1 + 2 * i] | ((uint16_t) cs->acc[2 + 2 * i] << 8));
+    }
+
+    plen = dw1000_cirstream_encode(&cs->frame[DW1000_CIRSTREAM_HDR_LEN], cs->taps, ntaps);
+    put16(&cs->frame[0], DW1000_CIRSTREAM_MAGIC);
+    cs->frame[2] = DW1000_CIRSTREAM_VERSION;
+    cs->frame[3] = (uint8_t) ntaps;
+    put16(&cs->frame[4], cs->seq++);
+    put16(&cs->frame[6], fp_idx);
+    put16(&cs->frame[8], start);
+    put16(&cs->frame[10], plen);
+    flen = DW1000_CIRSTREAM_HDR_LEN + plen;
+    put16(&cs->frame[flen], crc16(cs->frame, flen));
+    flen += 2;
+
+    for (i = 0; i < flen; i++) {
+        off = (cs->head + i) % QUEUE_SIZE;
+        cs->queue[off] = cs->frame[i];
+    }
+    cs->head += flen;
+
+    cs->stats.frames++;
+    cs->stats.raw_bytes += ntaps * 4;
+    cs->stats.bytes += flen;
+    if (cs->write) {
+        dpl_callout_reset(&cs->drain, 0);
+    }
+}
+
+/**
+ * API to get taps of the frame just received from the capture, so other users of the accumulator do
+ * not read it again. Only valid in the rx handler after dw1000_cirstream_capture.
+ *
+ * @param inst   Pointer to _dw1000_dev_instance_t.
+ * @param start  First tap.
+ * @param ntaps  Number of taps.
+ * @return const uint8_t * raw taps, NULL unless the capture covers the window
+ */
+const uint8_t *
+dw1000_cirstream_window(struct _dw1000_dev_instance_t * inst, uint16_t start, uint16_t ntaps)
+{
+    struct dw1000_cirstream_instance * cs = dw1000_cirstream_get(inst);
+
+    if (!cs->acc_valid || start < cs->acc_start ||
+        start + ntaps > cs->acc_start + MYNEWT_VAL(DW1000_CIRSTREAM_TAPS)) {
+        return NULL;
+    }
+    return &cs->acc[1 + (start - cs->acc_start) * 4];
+}
+
+#endif
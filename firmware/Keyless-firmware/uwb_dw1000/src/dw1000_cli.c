@@ -48,6 +48,36 @@
 #if MYNEWT_VAL(UWB_RNG_ENABLED)
 #include <uwb_rng/uwb_rng.h>
 #endif
+#if MYNEWT_VAL(DW1000_LPL_ENABLED)
+#include <dw1000/dw1000_lpl.h>
+#endif
+#if MYNEWT_VAL(DW1000_XTAL_TRACK_ENABLED)
+#include <dw1000/dw1000_xtal.h>
+#endif
+#if MYNEWT_VAL(DW1000_TEMPCOMP_ENABLED)
+#include <dw1000/dw1000_tempcomp.h>
+#endif
+#if MYNEWT_VAL(DW1000_ANTDLY_CAL_ENABLED)
+#include <dw1000/dw1000_antdly.h>
+#endif
+#if MYNEWT_VAL(DW1000_PROFILE_ENABLED)
+#include <dw1000/dw1000_profile.h>
+#endif
+#if MYNEWT_VAL(DW1000_CBS_TABLE_ENABLED)
+#include <dw1000/dw1000_mac.h>
+#endif
+#if MYNEWT_VAL(DW1000_RXRING_ENABLED)
+#include <dw1000/dw1000_rxring.h>
+#endif
+#if MYNEWT_VAL(DW1000_SPI_ARB_ENABLED)
+#include <dw1000/dw1000_spi_arb.h>
+#endif
+#if MYNEWT_VAL(DW1000_CIRSTREAM_ENABLED)
+#include <dw1000/dw1000_cirstream.h>
+#endif
+#if MYNEWT_VAL(DW1000_NLOS_ENABLED)
+#include <dw1000/dw1000_nlos.h>
+#endif
 
 #ifdef __KERNEL__
 #ifndef console_printf
@@ -68,6 +98,40 @@ const struct shell_param cmd_dw1000_param[] = {
     {"ev", "<inst> <on|reset|dump> event counters"},
 #endif
     {"cw", "<inst> tx CW on current channel"},
+#if MYNEWT_VAL(DW1000_LPL_ENABLED)
+    {"lpl", "<inst> low-power listening schedule and stats"},
+#endif
+#if MYNEWT_VAL(DW1000_XTAL_TRACK_ENABLED)
+    {"xtal", "<inst> crystal trim tracking state"},
+#endif
+#if MYNEWT_VAL(DW1000_TEMPCOMP_ENABLED)
+    {"tempcomp", "<inst> temperature compensation state"},
+#endif
+#if MYNEWT_VAL(DW1000_ANTDLY_CAL_ENABLED)
+    {"antdly", "<inst> [cal <distance_mm> <n>|save], antenna delay calibration"},
+#endif
+#if MYNEWT_VAL(DW1000_PROFILE_ENABLED)
+    {"profile", "<inst> [name], show or switch phy profile"},
+#endif
+#if MYNEWT_VAL(DW1000_CBS_TABLE_ENABLED)
+    {"cbs", "<inst> [n], callback table and n rounds of list walk vs table timing"},
+#endif
+#if MYNEWT_VAL(DW1000_RXRING_ENABLED)
+    {"rxring", "<inst> rx frame ring slots and stats"},
+#endif
+#if MYNEWT_VAL(DW1000_SPI_ARB_ENABLED)
+    {"arb", "<inst> spi bus wait histograms per class"},
+#endif
+#if MYNEWT_VAL(DW1000_CIRSTREAM_ENABLED)
+    {"cirstream", "<inst> [on|off], stream cir captures to the console"},
+#endif
+#if MYNEWT_VAL(DW1000_NLOS_ENABLED)
+    {"nlos", "<inst> first path analysis of the last frame"},
+#endif
+#if MYNEWT_VAL(DW1000_MAC_LATENCY)
+    {"lat", "<inst> [clear] interrupt latency and handler time histograms"},
+#endif
+    {"spi", "<inst> [cal], blocking vs nonblocking transfer thresholds"},
     {"da", "<inst> <addr> [length], dump area"},
     {"rd", "<inst> <addr> <subaddr> <length>, read register"},
     {"wr", "<inst> <addr> <subaddr> <value> <length>, write value to register"},
@@ -200,6 +264,311 @@ dw1000_cli_dump_event_counters(struct _dw1000_dev_instance_t * inst, struct stre
 }
 #endif
 
+#if MYNEWT_VAL(DW1000_LPL_ENABLED)
+void
+dw1000_cli_dump_lpl(struct _dw1000_dev_instance_t * inst, struct streamer *streamer)
+{
+    struct dw1000_lpl_instance * lpl = dw1000_lpl_get(inst);
+    struct dw1000_lpl_schedule * s = &lpl->sched;
+    uint32_t avg = (lpl->stats.latency_cnt) ? (uint32_t)(lpl->stats.latency_sum_usec / lpl->stats.latency_cnt) : 0;
+
+    streamer_printf(streamer, "{\"lposc_cal\"=%d, \"active\"=%d, \"use_sleep\"=%d}\n",
+                    lpl->lposc_cal, lpl->active, s->use_sleep);
+    streamer_printf(streamer, "{\"sniff_on\"=%d, \"sniff_off\"=%d, \"snooze\"=%d, \"listen_pac\"=%d, \"sleep_cnt\"=%d}\n",
+                    s->sniff_on, s->sniff_off, s->snooze, s->listen_pac, s->sleep_cnt);
+    streamer_printf(streamer, "{\"period_usec\"=%"PRIu32", \"latency_usec\"=%"PRIu32", \"duty_pm\"=%d}\n",
+                    s->period_usec, s->latency_usec, s->duty_pm);
+    streamer_printf(streamer, "{\"detections\"=%"PRIu32", \"latency_min\"=%"PRIu32", \"latency_avg\"=%"PRIu32", \"latency_max\"=%"PRIu32"}\n",
+                    lpl->stats.detections, (lpl->stats.latency_cnt) ? lpl->stats.latency_min_usec : 0,
+                    avg, lpl->stats.latency_max_usec);
+    streamer_printf(streamer, "{\"measured_duty_pm\"=%d}\n", dw1000_lpl_measured_duty(lpl));
+}
+#endif
+
+#if MYNEWT_VAL(DW1000_XTAL_TRACK_ENABLED)
+void
+dw1000_cli_dump_xtal(struct _dw1000_dev_instance_t * inst, struct streamer *streamer)
+{
+    struct dw1000_xtal_instance * xtal = dw1000_xtal_get(inst);
+
+    streamer_printf(streamer, "{\"enabled\"=%d, \"src\"=\"0x%04X\", \"trim\"=%d, \"filt_ppb\"=%"PRIi32", \"settle\"=%d}\n",
+                    inst->control.xtal_track_enabled, xtal->src_uid, inst->uwb_dev.config.rx.xtalTrim,
+                    xtal->filt_ppb, xtal->settle);
+    streamer_printf(streamer, "{\"samples\"=%"PRIu32", \"rejected\"=%"PRIu32", \"adjustments\"=%"PRIu32", \"last_ppb\"=%"PRIi32"}\n",
+                    xtal->stats.samples, xtal->stats.rejected, xtal->stats.adjustments, xtal->stats.last_ppb);
+}
+#endif
+
+#if MYNEWT_VAL(DW1000_TEMPCOMP_ENABLED)
+void
+dw1000_cli_dump_tempcomp(struct _dw1000_dev_instance_t * inst, struct streamer *streamer)
+{
+    struct dw1000_tempcomp_instance * tc = dw1000_tempcomp_get(inst);
+
+    streamer_printf(streamer, "{\"active\"=%d, \"temp_cdeg\"=%"PRIi32", \"ref_temp_cdeg\"=%"PRIi32"}\n",
+                    tc->active, DW1000_TEMPCOMP_RAW_TO_CDEG(inst, tc->temp_raw),
+                    DW1000_TEMPCOMP_RAW_TO_CDEG(inst, tc->ref.temp_raw));
+    streamer_printf(streamer, "{\"pgdly\"=\"0x%02X\", \"ref_pgdly\"=\"0x%02X\", \"ref_pg_count\"=%d}\n",
+                    inst->uwb_dev.config.txrf.PGdly, tc->ref.pgdly, tc->ref.pg_count);
+    streamer_printf(streamer, "{\"power\"=\"0x%08"PRIX32"\", \"ref_power\"=\"0x%08"PRIX32"\"}\n",
+                    inst->uwb_dev.config.txrf.power, tc->ref.power);
+    streamer_printf(streamer, "{\"samples\"=%"PRIu32", \"pg_updates\"=%"PRIu32", \"power_updates\"=%"PRIu32", \"pg_meas\"=%"PRIu32", \"busy\"=%"PRIu32"}\n",
+                    tc->stats.samples, tc->stats.pg_updates, tc->stats.power_updates, tc->stats.pg_meas, tc->stats.busy);
+}
+#endif
+
+#if MYNEWT_VAL(DW1000_ANTDLY_CAL_ENABLED)
+void
+dw1000_cli_dump_antdly(struct _dw1000_dev_instance_t * inst, struct streamer *streamer)
+{
+    struct dw1000_antdly_instance * cal = dw1000_antdly_get(inst);
+
+    streamer_printf(streamer, "{\"rx_antenna_delay\"=%d, \"tx_antenna_delay\"=%d}\n",
+                    inst->uwb_dev.rx_antenna_delay, inst->uwb_dev.tx_antenna_delay);
+    streamer_printf(streamer, "{\"state\"=%d, \"samples\"=%d, \"nsamples\"=%d, \"tof_true_dtu\"=%"PRIi32"}\n",
+                    cal->state, cal->idx, cal->nsamples, cal->tof_true_dtu);
+    streamer_printf(streamer, "{\"bias_dtu\"=%"PRIi32", \"spread_dtu\"=%"PRIu32", \"rx\"=%d, \"tx\"=%d}\n",
+                    cal->result.bias_dtu, cal->result.spread_dtu,
+                    cal->result.rx_antenna_delay, cal->result.tx_antenna_delay);
+}
+#endif
+
+#if MYNEWT_VAL(DW1000_PROFILE_ENABLED)
+void
+dw1000_cli_dump_profile(struct _dw1000_dev_instance_t * inst, struct streamer *streamer)
+{
+    struct dw1000_profile_instance * p = dw1000_profile_get(inst);
+
+    streamer_printf(streamer, "{\"profile\"=\"%s\", \"dataRate\"=%d, \"nsync\"=%d, \"pac\"=%d, \"sfdTimeout\"=%d}\n",
+                    (p->current < DW1000_PROFILE_NUM) ? g_dw1000_profiles[p->current].name : "custom",
+                    inst->uwb_dev.config.dataRate, inst->uwb_dev.attrib.nsync,
+                    8 << inst->uwb_dev.config.rx.pacLength, inst->uwb_dev.config.rx.sfdTimeout);
+    streamer_printf(streamer, "{\"switches\"=%"PRIu32", \"regs_written\"=%"PRIu32", \"escalations\"=%"PRIu32", \"fallbacks\"=%"PRIu32"}\n",
+                    p->stats.switches, p->stats.regs_written, p->stats.escalations, p->stats.fallbacks);
+}
+#endif
+
+#if MYNEWT_VAL(DW1000_CBS_TABLE_ENABLED)
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+#define CLI_DEMCR       (*(volatile uint32_t *)0xE000EDFC)
+#define CLI_DWT_CTRL    (*(volatile uint32_t *)0xE0001000)
+#define CLI_DWT_CYCCNT  (*(volatile uint32_t *)0xE0001004)
+#define CLI_CYCLES_UNIT "cycles"
+
+/* Core clock cycles from the DWT counter, enabled on first use */
+static uint32_t
+cli_cycles(void)
+{
+    CLI_DEMCR |= 1UL << 24;             /* TRCENA */
+    CLI_DWT_CTRL |= 1UL;                /* CYCCNTENA */
+    return CLI_DWT_CYCCNT;
+}
+#else
+#include <time.h>
+#define CLI_CYCLES_UNIT "ns"
+
+/* No cycle counter to read off an armv7-m core, nanoseconds instead */
+static uint32_t
+cli_cycles(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)ts.tv_sec * 1000000000UL + (uint32_t)ts.tv_nsec;
+}
+#endif
+
+void
+dw1000_cli_dump_cbs(struct _dw1000_dev_instance_t * inst, uint32_t n, struct streamer *streamer)
+{
+    static const char * names[DW1000_CBS_NUM] = {
+        "rx_complete", "tx_begins", "tx_complete", "rx_timeout",
+        "rx_error", "reset", "sleep", "cir_complete"
+    };
+    struct dw1000_cbs_table * t = &inst->cbs_table;
+    struct uwb_mac_interface * cbs;
+    const struct dw1000_cbs_entry * e;
+    volatile uintptr_t sink = 0;
+    uint32_t i, ev, t0, walk_cycles, table_cycles;
+
+    dw1000_mac_cbs_check(inst);
+    streamer_printf(streamer, "{\"ifaces\"=%d, \"overflow\"=%d}\n", t->nifaces, t->overflow);
+    for (ev = 0; ev < DW1000_CBS_NUM; ev++) {
+        streamer_printf(streamer, "{\"%s\"=%d}\n", names[ev], t->num[ev]);
+    }
+    if (n == 0) {
+        return;
+    }
+
+    /* Lookup cost only, handlers are not called. The walk does what the
+     * interrupt handler did per event before the table, the table side
+     * includes the generation check the interrupt task makes */
+    t0 = cli_cycles();
+    for (i = 0; i < n; i++) {
+        SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next) {
+            if (cbs != NULL && cbs->rx_complete_cb) sink += (uintptr_t)cbs->rx_complete_cb;
+        }
+        SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next) {
+            if (cbs != NULL && cbs->tx_complete_cb) sink += (uintptr_t)cbs->tx_complete_cb;
+        }
+        SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next) {
+            if (cbs != NULL && cbs->rx_timeout_cb) sink += (uintptr_t)cbs->rx_timeout_cb;
+        }
+        SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next) {
+            if (cbs != NULL && cbs->rx_error_cb) sink += (uintptr_t)cbs->rx_error_cb;
+        }
+    }
+    walk_cycles = cli_cycles() - t0;
+
+    t0 = cli_cycles();
+    for (i = 0; i < n; i++) {
+        dw1000_mac_cbs_check(inst);
+        for (e = t->ent[DW1000_CBS_RX_COMPLETE]; e < t->ent[DW1000_CBS_RX_COMPLETE] + t->num[DW1000_CBS_RX_COMPLETE]; e++) {
+            sink += (uintptr_t)e->cb;
+        }
+        for (e = t->ent[DW1000_CBS_TX_COMPLETE]; e < t->ent[DW1000_CBS_TX_COMPLETE] + t->num[DW1000_CBS_TX_COMPLETE]; e++) {
+            sink += (uintptr_t)e->cb;
+        }
+        for (e = t->ent[DW1000_CBS_RX_TIMEOUT]; e < t->ent[DW1000_CBS_RX_TIMEOUT] + t->num[DW1000_CBS_RX_TIMEOUT]; e++) {
+            sink += (uintptr_t)e->cb;
+        }
+        for (e = t->ent[DW1000_CBS_RX_ERROR]; e < t->ent[DW1000_CBS_RX_ERROR] + t->num[DW1000_CBS_RX_ERROR]; e++) {
+            sink += (uintptr_t)e->cb;
+        }
+    }
+    table_cycles = cli_cycles() - t0;
+    (void)sink;
+
+    streamer_printf(streamer, "{\"rounds\"=%"PRIu32", \"unit\"=\"%s\", \"walk\"=%"PRIu32", \"table\"=%"PRIu32"}\n",
+                    n, CLI_CYCLES_UNIT, walk_cycles, table_cycles);
+}
+#endif
+
+void
+dw1000_cli_dump_spi_xover(struct _dw1000_dev_instance_t * inst, struct streamer *streamer)
+{
+    struct dw1000_spi_xover * x = &inst->spi_xover;
+
+    streamer_printf(streamer, "{\"rd_min\"=%d, \"wr_min\"=%d, \"blocking_spi_transfers\"=%d}\n",
+                    x->rd_min, x->wr_min, inst->uwb_dev.config.blocking_spi_transfers);
+#if MYNEWT_VAL(DW1000_SPI_XOVER_CAL)
+    int k;
+    for (k = 0; k < DW1000_SPI_XOVER_NSIZES; k++) {
+        streamer_printf(streamer, "{\"len\"=%d, \"rd_usec\"=[%"PRIu32",%"PRIu32"], \"wr_usec\"=[%"PRIu32",%"PRIu32"]}\n",
+                        2 << k,
+                        dpl_cputime_ticks_to_usecs(x->rd_ticks[0][k]) / MYNEWT_VAL(DW1000_SPI_XOVER_ROUNDS),
+                        dpl_cputime_ticks_to_usecs(x->rd_ticks[1][k]) / MYNEWT_VAL(DW1000_SPI_XOVER_ROUNDS),
+                        dpl_cputime_ticks_to_usecs(x->wr_ticks[0][k]) / MYNEWT_VAL(DW1000_SPI_XOVER_ROUNDS),
+                        dpl_cputime_ticks_to_usecs(x->wr_ticks[1][k]) / MYNEWT_VAL(DW1000_SPI_XOVER_ROUNDS));
+    }
+#endif
+}
+
+#if MYNEWT_VAL(DW1000_RXRING_ENABLED)
+void
+dw1000_cli_dump_rxring(struct _dw1000_dev_instance_t * inst, struct streamer *streamer)
+{
+    struct dw1000_rxring_instance * ring = dw1000_rxring_get(inst);
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(DW1000_RXRING_SLOTS); i++) {
+        streamer_printf(streamer, "{\"slot\"=%d, \"state\"=%d, \"len\"=%d, \"fctrl\"=0x%04X}\n",
+                        i, ring->desc[i].state, ring->desc[i].len, ring->desc[i].fctrl);
+    }
+    streamer_printf(streamer, "{\"frames\"=%"PRIu32", \"held\"=%"PRIu32", \"exhausted\"=%"PRIu32"}\n",
+                    ring->stats.frames, ring->stats.held, ring->stats.exhausted);
+}
+#endif
+
+#if MYNEWT_VAL(DW1000_SPI_ARB_ENABLED)
+void
+dw1000_cli_dump_spi_arb(struct _dw1000_dev_instance_t * inst, struct streamer *streamer)
+{
+    static const char * names[DW1000_SPI_CLASS_NUM] = {"diag", "tx", "irq"};
+    struct dw1000_spi_arb_instance * arb = dw1000_spi_arb_get(inst);
+    int cls, i;
+
+    for (cls = DW1000_SPI_CLASS_NUM - 1; cls >= 0; cls--) {
+        struct dw1000_spi_arb_stats * st = &arb->stats[cls];
+        streamer_printf(streamer, "{\"class\"=\"%s\", \"count\"=%"PRIu32", \"max_usec\"=%"PRIu32", \"hist\"=[",
+                        names[cls], st->count, st->max_usec);
+        for (i = 0; i < MYNEWT_VAL(DW1000_SPI_ARB_HIST_BINS); i++) {
+            streamer_printf(streamer, "%s%"PRIu32, i ? "," : "", st->hist[i]);
+        }
+        streamer_printf(streamer, "]}\n");
+    }
+}
+#endif
+
+#if MYNEWT_VAL(DW1000_CIRSTREAM_ENABLED)
+static int
+cirstream_console_write(void * arg, const uint8_t * buf, uint16_t len)
+{
+    console_write((const char *) buf, len);
+    return len;
+}
+
+void
+dw1000_cli_dump_cirstream(struct _dw1000_dev_instance_t * inst, struct streamer *streamer)
+{
+    struct dw1000_cirstream_instance * cs = dw1000_cirstream_get(inst);
+
+    streamer_printf(streamer, "{\"enabled\"=%d, \"seq\"=%d, \"queued\"=%"PRIu32"}\n",
+                    cs->enabled, cs->seq, cs->head - cs->tail);
+    streamer_printf(streamer, "{\"frames\"=%"PRIu32", \"dropped\"=%"PRIu32", \"skipped\"=%"PRIu32", \"limited\"=%"PRIu32", \"raw_bytes\"=%"PRIu32", \"bytes\"=%"PRIu32"}\n",
+                    cs->stats.frames, cs->stats.dropped, cs->stats.skipped, cs->stats.limited, cs->stats.raw_bytes, cs->stats.bytes);
+}
+#endif
+
+#if MYNEWT_VAL(DW1000_NLOS_ENABLED)
+void
+dw1000_cli_dump_nlos(struct _dw1000_dev_instance_t * inst, struct streamer *streamer)
+{
+    struct dw1000_nlos_instance * nlos = dw1000_nlos_get(inst);
+    struct dw1000_nlos_result * r = &nlos->result;
+
+    streamer_printf(streamer, "{\"rise\"=%d, \"ratio\"=%d, \"excess\"=%d, \"peak\"=%d, \"p_nlos\"=%d, \"bias\"=%d}\n",
+                    r->rise, r->ratio, r->excess, r->peak, r->p_nlos, r->bias);
+    streamer_printf(streamer, "{\"analysed\"=%"PRIu32", \"nlos\"=%"PRIu32", \"skipped\"=%"PRIu32", \"shared\"=%"PRIu32"}\n",
+                    nlos->stats.analysed, nlos->stats.nlos, nlos->stats.skipped, nlos->stats.shared);
+}
+#endif
+
+#if MYNEWT_VAL(DW1000_MAC_LATENCY)
+static void
+dump_lat_hist(struct streamer *streamer, const struct dw1000_mac_lat_hist * h)
+{
+    int i;
+
+    streamer_printf(streamer, "\"n\"=%"PRIu32", \"max_us\"=%"PRIu32", \"hist\"=[",
+                    h->n, dpl_cputime_ticks_to_usecs(h->max));
+    for (i = 0; i < DW1000_MAC_LAT_BINS; i++) {
+        streamer_printf(streamer, "%s%"PRIu32, i ? "," : "", h->bin[i]);
+    }
+    streamer_printf(streamer, "]}\n");
+}
+
+void
+dw1000_cli_dump_latency(struct _dw1000_dev_instance_t * inst, struct streamer *streamer)
+{
+    struct dw1000_mac_latency * lat = &inst->lat;
+    int i;
+
+    streamer_printf(streamer, "# bin k>0 counts [2^(k-1), 2^k) cputime ticks\n");
+    streamer_printf(streamer, "{\"ev\"=\"irq\", ");
+    dump_lat_hist(streamer, &lat->irq);
+    for (i = 0; i < DW1000_MAC_LAT_EVENTS; i++) {
+        if (lat->ev[i].n) {
+            streamer_printf(streamer, "{\"ev\"=\"%s\", ", dw1000_mac_lat_event_names[i]);
+            dump_lat_hist(streamer, &lat->ev[i]);
+        }
+    }
+    for (i = 0; i < lat->nrxcb; i++) {
+        streamer_printf(streamer, "{\"rx_complete_cb\"=0x%x, ", lat->rxcb[i].id);
+        dump_lat_hist(streamer, &lat->rxcb[i].hist);
+    }
+}
+#endif
+
 #if MYNEWT_VAL(DW1000_SYS_STATUS_BACKTRACE_LEN)
 static char*
 sys_status_to_string(uint64_t s)
@@ -542,6 +911,9 @@ dw1000_cli_cmd(const struct shell_cmd *cmd, int argc, char **argv, struct stream
         dw1000_cli_too_few_args(streamer);
         return 0;
     }
+#if MYNEWT_VAL(DW1000_SPI_ARB_ENABLED)
+    dw1000_spi_arb_set_task_class(dpl_get_current_task_id(), DW1000_SPI_CLASS_DIAG);
+#endif
 
     if (!strcmp(argv[1], "dump")) {
         if (argc < 3) {
@@ -597,6 +969,189 @@ dw1000_cli_cmd(const struct shell_cmd *cmd, int argc, char **argv, struct stream
         dw1000_configcwmode(inst, inst->uwb_dev.config.channel);
         streamer_printf(streamer, "Device[%d] now in CW mode on ch %d. Reset to continue\n",
                         inst_n, inst->uwb_dev.config.channel);
+#if MYNEWT_VAL(DW1000_LPL_ENABLED)
+    } else if (!strcmp(argv[1], "lpl")) {
+        if (argc < 3) {
+            inst_n=0;
+        } else {
+            inst_n = strtol(argv[2], NULL, 0);
+        }
+        inst = hal_dw1000_inst(inst_n);
+        console_no_ticks();
+        dw1000_cli_dump_lpl(inst, streamer);
+        console_yes_ticks();
+#endif
+#if MYNEWT_VAL(DW1000_XTAL_TRACK_ENABLED)
+    } else if (!strcmp(argv[1], "xtal")) {
+        if (argc < 3) {
+            inst_n=0;
+        } else {
+            inst_n = strtol(argv[2], NULL, 0);
+        }
+        inst = hal_dw1000_inst(inst_n);
+        console_no_ticks();
+        dw1000_cli_dump_xtal(inst, streamer);
+        console_yes_ticks();
+#endif
+#if MYNEWT_VAL(DW1000_TEMPCOMP_ENABLED)
+    } else if (!strcmp(argv[1], "tempcomp")) {
+        if (argc < 3) {
+            inst_n=0;
+        } else {
+            inst_n = strtol(argv[2], NULL, 0);
+        }
+        inst = hal_dw1000_inst(inst_n);
+        console_no_ticks();
+        dw1000_cli_dump_tempcomp(inst, streamer);
+        console_yes_ticks();
+#endif
+#if MYNEWT_VAL(DW1000_ANTDLY_CAL_ENABLED)
+    } else if (!strcmp(argv[1], "antdly")) {
+        if (argc < 3) {
+            inst_n=0;
+        } else {
+            inst_n = strtol(argv[2], NULL, 0);
+        }
+        inst = hal_dw1000_inst(inst_n);
+        if (argc > 5 && !strcmp(argv[3], "cal")) {
+            uint32_t distance_mm = strtol(argv[4], NULL, 0);
+            uint16_t n = strtol(argv[5], NULL, 0);
+            if (dw1000_antdly_cal_start(inst, distance_mm, n) != DPL_OK) {
+                streamer_printf(streamer, "Invalid number of exchanges, max %d\n",
+                                MYNEWT_VAL(DW1000_ANTDLY_CAL_MAX_SAMPLES));
+            }
+        } else if (argc > 3 && !strcmp(argv[3], "save")) {
+            if (dw1000_antdly_save(inst) != DPL_OK) {
+                streamer_printf(streamer, "Save failed\n");
+            }
+        }
+        console_no_ticks();
+        dw1000_cli_dump_antdly(inst, streamer);
+        console_yes_ticks();
+#endif
+#if MYNEWT_VAL(DW1000_PROFILE_ENABLED)
+    } else if (!strcmp(argv[1], "profile")) {
+        if (argc < 3) {
+            inst_n=0;
+        } else {
+            inst_n = strtol(argv[2], NULL, 0);
+        }
+        inst = hal_dw1000_inst(inst_n);
+        if (dw1000_profile_get(inst)->dev_inst == NULL) {
+            dw1000_profile_init(inst);
+        }
+        if (argc > 3) {
+            int id = dw1000_profile_find(argv[3]);
+            if (id < 0) {
+                streamer_printf(streamer, "Unknown profile %s\n", argv[3]);
+                return 0;
+            }
+            streamer_printf(streamer, "%d registers written\n", dw1000_profile_switch(inst, id));
+        }
+        console_no_ticks();
+        dw1000_cli_dump_profile(inst, streamer);
+        console_yes_ticks();
+#endif
+#if MYNEWT_VAL(DW1000_CBS_TABLE_ENABLED)
+    } else if (!strcmp(argv[1], "cbs")) {
+        if (argc < 3) {
+            inst_n=0;
+        } else {
+            inst_n = strtol(argv[2], NULL, 0);
+        }
+        inst = hal_dw1000_inst(inst_n);
+        console_no_ticks();
+        dw1000_cli_dump_cbs(inst, (argc > 3) ? strtoul(argv[3], NULL, 0) : 0, streamer);
+        console_yes_ticks();
+#endif
+    } else if (!strcmp(argv[1], "spi")) {
+        if (argc < 3) {
+            inst_n=0;
+        } else {
+            inst_n = strtol(argv[2], NULL, 0);
+        }
+        inst = hal_dw1000_inst(inst_n);
+#if MYNEWT_VAL(DW1000_SPI_XOVER_CAL)
+        if (argc > 3 && !strcmp(argv[3], "cal")) {
+            hal_dw1000_spi_xover_cal(inst);
+        }
+#endif
+        console_no_ticks();
+        dw1000_cli_dump_spi_xover(inst, streamer);
+        console_yes_ticks();
+#if MYNEWT_VAL(DW1000_RXRING_ENABLED)
+    } else if (!strcmp(argv[1], "rxring")) {
+        if (argc < 3) {
+            inst_n=0;
+        } else {
+            inst_n = strtol(argv[2], NULL, 0);
+        }
+        inst = hal_dw1000_inst(inst_n);
+        console_no_ticks();
+        dw1000_cli_dump_rxring(inst, streamer);
+        console_yes_ticks();
+#endif
+#if MYNEWT_VAL(DW1000_SPI_ARB_ENABLED)
+    } else if (!strcmp(argv[1], "arb")) {
+        if (argc < 3) {
+            inst_n=0;
+        } else {
+            inst_n = strtol(argv[2], NULL, 0);
+        }
+        inst = hal_dw1000_inst(inst_n);
+        console_no_ticks();
+        dw1000_cli_dump_spi_arb(inst, streamer);
+        console_yes_ticks();
+#endif
+#if MYNEWT_VAL(DW1000_CIRSTREAM_ENABLED)
+    } else if (!strcmp(argv[1], "cirstream")) {
+        if (argc < 3) {
+            inst_n=0;
+        } else {
+            inst_n = strtol(argv[2], NULL, 0);
+        }
+        inst = hal_dw1000_inst(inst_n);
+        if (dw1000_cirstream_get(inst)->dev_inst == NULL) {
+            dw1000_cirstream_init(inst);
+        }
+        if (argc > 3) {
+            bool on = !strcmp(argv[3], "on");
+            if (on) {
+                dw1000_cirstream_set_output(inst, cirstream_console_write, NULL);
+            }
+            dw1000_cirstream_enable(inst, on);
+        }
+        console_no_ticks();
+        dw1000_cli_dump_cirstream(inst, streamer);
+        console_yes_ticks();
+#endif
+#if MYNEWT_VAL(DW1000_NLOS_ENABLED)
+    } else if (!strcmp(argv[1], "nlos")) {
+        if (argc < 3) {
+            inst_n=0;
+        } else {
+            inst_n = strtol(argv[2], NULL, 0);
+        }
+        inst = hal_dw1000_inst(inst_n);
+        console_no_ticks();
+        dw1000_cli_dump_nlos(inst, streamer);
+        console_yes_ticks();
+#endif
+#if MYNEWT_VAL(DW1000_MAC_LATENCY)
+    } else if (!strcmp(argv[1], "lat")) {
+        if (argc < 3) {
+            inst_n=0;
+        } else {
+            inst_n = strtol(argv[2], NULL, 0);
+        }
+        inst = hal_dw1000_inst(inst_n);
+        if (argc > 3 && !strcmp(argv[3], "clear")) {
+            memset(&inst->lat, 0, sizeof(inst->lat));
+        }
+        console_no_ticks();
+        dw1000_cli_dump_latency(inst, streamer);
+        console_yes_ticks();
+#endif
     } else if (!strcmp(argv[1], "wr")) {
         if (argc < 7) {
             return 0;
@@ -8,6 +8,18 @@ void dw1000_cli_dump_event_counters(struct _dw1000_dev_instance_t * inst, struct
 void dw1000_cli_dump_address(struct _dw1000_dev_instance_t * inst, uint32_t addr, uint16_t length, struct streamer *streamer);
 void dw1000_cli_backtrace(struct _dw1000_dev_instance_t * inst, uint16_t verbose, struct streamer *streamer);
 void dw1000_cli_spi_backtrace(struct _dw1000_dev_instance_t * inst, uint16_t verbose, struct streamer *streamer);
+void dw1000_cli_dump_lpl(struct _dw1000_dev_instance_t * inst, struct streamer *streamer);
+void dw1000_cli_dump_xtal(struct _dw1000_dev_instance_t * inst, struct streamer *streamer);
+void dw1000_cli_dump_tempcomp(struct _dw1000_dev_instance_t * inst, struct streamer *streamer);
+void dw1000_cli_dump_antdly(struct _dw1000_dev_instance_t * inst, struct streamer *streamer);
+void dw1000_cli_dump_profile(struct _dw1000_dev_instance_t * inst, struct streamer *streamer);
+void dw1000_cli_dump_cbs(struct _dw1000_dev_instance_t * inst, uint32_t n, struct streamer *streamer);
+void dw1000_cli_dump_spi_xover(struct _dw1000_dev_instance_t * inst, struct streamer *streamer);
+void dw1000_cli_dump_rxring(struct _dw1000_dev_instance_t * inst, struct streamer *streamer);
+void dw1000_cli_dump_spi_arb(struct _dw1000_dev_instance_t * inst, struct streamer *streamer);
+void dw1000_cli_dump_cirstream(struct _dw1000_dev_instance_t * inst, struct streamer *streamer);
+void dw1000_cli_dump_nlos(struct _dw1000_dev_instance_t * inst, struct streamer *streamer);
+void dw1000_cli_dump_latency(struct _dw1000_dev_instance_t * inst, struct streamer *streamer);
 void dw1000_cli_interrupt_backtrace(struct _dw1000_dev_instance_t * inst, uint16_t verbose, struct streamer *streamer);
 
 #endif /* _DW1000_CLI_PRIV_H_ */
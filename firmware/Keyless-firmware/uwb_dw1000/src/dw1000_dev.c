@@ -38,6 +38,15 @@
 #include <dw1000/dw1000_regs.h>
 #include <dw1000/dw1000_hal.h>
 #include <dw1000/dw1000_phy.h>
+#if MYNEWT_VAL(DW1000_RXRING_ENABLED)
+#include <dw1000/dw1000_rxring.h>
+#endif
+#if MYNEWT_VAL(DW1000_SPI_ARB_ENABLED)
+#include <dw1000/dw1000_spi_arb.h>
+#endif
+#if MYNEWT_VAL(DW1000_NLOS_ENABLED)
+#include <dw1000/dw1000_nlos.h>
+#endif
 
 #define DIAGMSG(s,u) printf(s,u)
 #ifndef DIAGMSG
@@ -53,6 +62,13 @@ typedef struct _dw1000_cmd{
     uint32_t subaddress:15;  //!< Indicates subaddress of register
 } dw1000_cmd_t;
 
+/* Payload length decides, the header is the same for both paths */
+static inline bool
+spi_noblock(dw1000_dev_instance_t * inst, uint16_t min, uint16_t length)
+{
+    return !inst->uwb_dev.config.blocking_spi_transfers && length >= min;
+}
+
 /**
  * API to perform dw1000_read from given address.
  *
@@ -83,14 +99,34 @@ dw1000_read(dw1000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, uin
 
     uint8_t len = cmd.subaddress?(cmd.extended?3:2):1;
 
+#if MYNEWT_VAL(DW1000_SPI_ARB_ENABLED)
+    if (length > MYNEWT_VAL(DW1000_SPI_ARB_CHUNK)) {
+        /* One transaction per chunk, the arbiter can hand the bus to a higher class in between */
+        uint16_t k, n, max;
+        for (k = 0; k < length; k += n) {
+            /* Every accumulator read returns a dummy byte first. Later chunks start one byte early,
+             * over the last byte already read, which is put back after */
+            max = (reg == ACC_MEM_ID && k) ? MYNEWT_VAL(DW1000_SPI_ARB_CHUNK) - 1 : MYNEWT_VAL(DW1000_SPI_ARB_CHUNK);
+            n = (length - k > max) ? max : length - k;
+            if (reg == ACC_MEM_ID && k) {
+                uint8_t keep = buffer[k - 1];
+                dw1000_read(inst, reg, subaddress + k - 1, buffer + k - 1, n + 1);
+                buffer[k - 1] = keep;
+            } else {
+                dw1000_read(inst, reg, subaddress + k, buffer + k, n);
+            }
+        }
+        return inst->uwb_dev.status;
+    }
+#endif
+
     assert(reg <= 0x3F); // Record number is limited to 6-bits.
     assert((subaddress <= 0x7FFF) && ((subaddress + length) <= 0x7FFF)); // Index and sub-addressable area are limited to 15-bits.
 
     /* Possible issue here when reading shorter amounts of data
      * using the nonblocking read with double buffer. Asserts on
      * mutex releases seen in calling function when reading frames of length 8 */
-    if (length < MYNEWT_VAL(DW1000_DEVICE_SPI_RD_MAX_NOBLOCK) ||
-        inst->uwb_dev.config.blocking_spi_transfers) {
+    if (!spi_noblock(inst, inst->spi_xover.rd_min, length)) {
         hal_dw1000_read(inst, header, len, buffer, length);
     } else {
         hal_dw1000_read_noblock(inst, header, len, buffer, length);
@@ -99,6 +135,45 @@ dw1000_read(dw1000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, uin
     return inst->uwb_dev.status;
 }
 
+/**
+ * API to perform dw1000_read into a buffer with DW1000_SPI_HEADROOM bytes free in front of it,
+ * the transfer is done in place without a bounce buffer.
+ *
+ * @param inst          Pointer to dw1000_dev_instance_t.
+ * @param reg           Member of dw1000_cmd_t structure.
+ * @param subaddress    Member of dw1000_cmd_t structure.
+ * @param buffer        Result is stored in buffer.
+ * @param length        Represents buffer length.
+ * @return struct uwb_dev_status
+ */
+struct uwb_dev_status
+dw1000_read_inplace(dw1000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, uint8_t * buffer, uint16_t length)
+{
+    dw1000_cmd_t cmd = {
+        .reg = reg,
+        .subindex = subaddress != 0,
+        .operation = 0, //Read
+        .extended = subaddress > 0x7F,
+        .subaddress = subaddress
+    };
+
+    uint8_t header[] = {
+        [0] = cmd.operation << 7 | cmd.subindex << 6 | cmd.reg,
+        [1] = cmd.extended << 7 | (uint8_t) (subaddress),
+        [2] = (uint8_t) (subaddress >> 7)
+    };
+
+    uint8_t len = cmd.subaddress?(cmd.extended?3:2):1;
+
+    assert(reg <= 0x3F); // Record number is limited to 6-bits.
+    assert((subaddress <= 0x7FFF) && ((subaddress + length) <= 0x7FFF)); // Index and sub-addressable area are limited to 15-bits.
+
+    hal_dw1000_read_inplace(inst, header, len, buffer, length,
+                            spi_noblock(inst, inst->spi_xover.rd_min, length));
+
+    return inst->uwb_dev.status;
+}
+
 /**
  * API to performs dw1000_write into given address.
  *
@@ -129,12 +204,23 @@ dw1000_write(dw1000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress, ui
 
     uint8_t len = cmd.subaddress?(cmd.extended?3:2):1;
 
+#if MYNEWT_VAL(DW1000_SPI_ARB_ENABLED)
+    if (length > MYNEWT_VAL(DW1000_SPI_ARB_CHUNK)) {
+        /* One transaction per chunk, the arbiter can hand the bus to a higher class in between */
+        uint16_t n;
+        for (; length; length -= n, subaddress += n, buffer += n) {
+            n = (length > MYNEWT_VAL(DW1000_SPI_ARB_CHUNK)) ? MYNEWT_VAL(DW1000_SPI_ARB_CHUNK) : length;
+            dw1000_write(inst, reg, subaddress, buffer, n);
+        }
+        return inst->uwb_dev.status;
+    }
+#endif
+
     assert(reg <= 0x3F); // Record number is limited to 6-bits.
     assert((subaddress <= 0x7FFF) && ((subaddress + length) <= 0x7FFF)); // Index and sub-addressable area are limited to 15-bits.
 
     /* Only use non-blocking write if the length of the write justifies it */
-    if (len+length < MYNEWT_VAL(DW1000_DEVICE_SPI_RD_MAX_NOBLOCK) ||
-        inst->uwb_dev.config.blocking_spi_transfers) {
+    if (!spi_noblock(inst, inst->spi_xover.wr_min, length)) {
         hal_dw1000_write(inst, header, len, buffer, length);
     } else {
         hal_dw1000_write_noblock(inst, header, len, buffer, length);
@@ -180,8 +266,7 @@ dw1000_read_reg(dw1000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress,
     assert((subaddress <= 0x7FFF) && ((subaddress + nbytes) <= 0x7FFF)); // Index and sub-addressable area are limited to 15-bits.
     assert(nbytes <= sizeof(uint64_t));
 
-    if (len+nbytes < MYNEWT_VAL(DW1000_DEVICE_SPI_RD_MAX_NOBLOCK) ||
-        inst->uwb_dev.config.blocking_spi_transfers) {
+    if (!spi_noblock(inst, inst->spi_xover.rd_min, nbytes)) {
         hal_dw1000_read(inst, header, len, buffer.array, nbytes);
     } else {
         hal_dw1000_read_noblock(inst, header, len, buffer.array, nbytes);
@@ -229,8 +314,7 @@ dw1000_write_reg(dw1000_dev_instance_t * inst, uint16_t reg, uint16_t subaddress
     assert(reg <= 0x3F); // Record number is limited to 6-bits.
     assert((subaddress <= 0x7FFF) && ((subaddress + nbytes) <= 0x7FFF)); // Index and sub-addressable area are limited to 15-bits.
 
-    if (len+nbytes < MYNEWT_VAL(DW1000_DEVICE_SPI_RD_MAX_NOBLOCK) ||
-        inst->uwb_dev.config.blocking_spi_transfers) {
+    if (!spi_noblock(inst, inst->spi_xover.wr_min, nbytes)) {
         hal_dw1000_write(inst, header, len, buffer.array, nbytes);
     } else {
         hal_dw1000_write_noblock(inst, header, len, buffer.array, nbytes);
@@ -310,6 +394,9 @@ retry:
     assert(rc == 0);
     rc = hal_spi_enable(inst->spi_num);
     assert(rc == 0);
+#if MYNEWT_VAL(DW1000_SPI_XOVER_CAL)
+    hal_dw1000_spi_xover_cal(inst);
+#endif
 
     inst->uwb_dev.pan_id = MYNEWT_VAL(PANID);
     inst->uwb_dev.uid = inst->part_id & 0xffff;
@@ -974,6 +1061,12 @@ dw1000_dev_init(struct os_dev *odev, void *arg)
     udev->rxbuf_size = MYNEWT_VAL(UWB_RX_BUFFER_SIZE);
     udev->txbuf_size = MYNEWT_VAL(DW1000_HAL_SPI_BUFFER_SIZE);
     uwb_dev_init(udev);
+#if MYNEWT_VAL(DW1000_RXRING_ENABLED)
+    dw1000_rxring_init(inst);
+#endif
+#if MYNEWT_VAL(DW1000_NLOS_ENABLED)
+    dw1000_nlos_init(inst);
+#endif
 
     /* Setup common uwb interface */
     udev->uw_funcs = &dw1000_uwb_funcs;
@@ -992,6 +1085,9 @@ dw1000_dev_init(struct os_dev *odev, void *arg)
 
     /* Capture dev_cfg parameters */
     inst->spi_sem = cfg->spi_sem;
+#if MYNEWT_VAL(DW1000_SPI_ARB_ENABLED)
+    dw1000_spi_arb_init(inst);
+#endif
     inst->spi_num = cfg->spi_num;
     inst->spi_baudrate = cfg->spi_baudrate;
     inst->spi_baudrate_low = cfg->spi_baudrate_low;
@@ -1009,6 +1105,8 @@ dw1000_dev_init(struct os_dev *odev, void *arg)
     assert(err == DPL_OK);
     err = dpl_sem_init(&inst->spi_nb_sem, 0x1);
     assert(err == DPL_OK);
+    inst->spi_xover.rd_min = MYNEWT_VAL(DW1000_DEVICE_SPI_RD_MAX_NOBLOCK);
+    inst->spi_xover.wr_min = MYNEWT_VAL(DW1000_DEVICE_SPI_RD_MAX_NOBLOCK);
 
     /* phy attritubes per the IEEE802.15.4-2011 standard, Table 99 and Table 101 */
     udev->attrib.Tpsym = DPL_FLOAT32_INIT(1.0176282f); //!< Preamble symbols duration (usec) for MPRF of 62.89Mhz
@@ -37,9 +37,19 @@
 #include <hal/hal_gpio.h>
 #include <dw1000/dw1000_hal.h>
 #include <dpl/dpl_cputime.h>
+#if MYNEWT_VAL(DW1000_SPI_ARB_ENABLED)
+#include <dw1000/dw1000_spi_arb.h>
+#endif
 
 #include <mcu/mcu.h>
 
+/* With DW1000_HAL_SPI_CS_AUTO the platform spi frames every transfer itself */
+#if MYNEWT_VAL(DW1000_HAL_SPI_CS_AUTO)
+#define HAL_DW1000_CS(_inst, _v)
+#else
+#define HAL_DW1000_CS(_inst, _v) hal_gpio_write((_inst)->ss_pin, (_v))
+#endif
+
 #if MYNEWT_VAL(DW1000_DEVICE_0)
 
 static dw1000_dev_instance_t hal_dw1000_instances[]= {
@@ -273,7 +283,9 @@ hal_dw1000_reset(struct _dw1000_dev_instance_t * inst)
 {
     assert(inst);
 
+#if !MYNEWT_VAL(DW1000_HAL_SPI_CS_AUTO)
     hal_gpio_init_out(inst->ss_pin, 1);
+#endif
     hal_gpio_init_out(inst->rst_pin, 0);
 
     hal_gpio_write(inst->rst_pin, 0);
@@ -284,6 +296,98 @@ hal_dw1000_reset(struct _dw1000_dev_instance_t * inst)
     dpl_cputime_delay_usecs(5000);
 }
 
+/* Take the bus, through the arbiter when enabled */
+static inline int
+hal_dw1000_bus_pend(struct _dw1000_dev_instance_t * inst)
+{
+    int rc;
+#if MYNEWT_VAL(DW1000_SPI_ARB_ENABLED)
+    rc = dw1000_spi_arb_acquire(inst);
+    if (rc != DPL_OK) {
+        return rc;
+    }
+#endif
+    rc = dpl_sem_pend(inst->spi_sem, DPL_TIMEOUT_NEVER);
+#if MYNEWT_VAL(DW1000_SPI_ARB_ENABLED)
+    if (rc != DPL_OK) {
+        dw1000_spi_arb_release(inst);
+    }
+#endif
+    return rc;
+}
+
+/* Give the bus back, also from the nonblocking completion callback */
+static inline int
+hal_dw1000_bus_release(struct _dw1000_dev_instance_t * inst)
+{
+    int rc = dpl_sem_release(inst->spi_sem);
+#if MYNEWT_VAL(DW1000_SPI_ARB_ENABLED)
+    dw1000_spi_arb_release(inst);
+#endif
+    return rc;
+}
+
+/**
+ * Blocking transfer of a list of segments under the chip select already held low by the caller.
+ * Platforms that set DW1000_HAL_SPI_SG take the whole list in hal_spi_txrx_sg. With mynewt the
+ * chip select is a gpio so the segments are clocked out one after the other straight from and
+ * into the callers buffers, only split where the hardware limits the transfer length. Reads send
+ * the receive buffer itself as don't care bytes. Otherwise they are copied through txbuf: the
+ * linux hal_spi of uwb-core drives the chip select per hal_spi_txrx call and keeps its spidev
+ * open inside, so this file cannot chain the segments itself. A linux platform that wants them
+ * unstaged provides hal_spi_txrx_sg, one spi_ioc_transfer per segment in a single SPI_IOC_MESSAGE,
+ * and sets DW1000_HAL_SPI_SG.
+ *
+ * @param inst  Pointer to dw1000_dev_instance_t.
+ * @param seg   Segments in the order they go on the bus.
+ * @param nseg  Number of segments.
+ * @return int  DPL_OK if the transfer is ok, error otherwise
+ */
+static int
+hal_dw1000_spi_sg(struct _dw1000_dev_instance_t * inst, const struct hal_dw1000_spi_seg * seg, int nseg)
+{
+    int rc = DPL_OK;
+#if MYNEWT_VAL(DW1000_HAL_SPI_SG)
+    rc = hal_spi_txrx_sg(inst->spi_num, seg, nseg);
+#elif defined(MYNEWT)
+    int i, offset, n;
+
+    for (i = 0; i < nseg && rc == DPL_OK; i++) {
+        for (offset = 0; offset < seg[i].len && rc == DPL_OK; offset += n) {
+            n = (seg[i].len - offset > MYNEWT_VAL(DW1000_HAL_SPI_MAX_CNT)) ?
+                MYNEWT_VAL(DW1000_HAL_SPI_MAX_CNT) : seg[i].len - offset;
+            rc = hal_spi_txrx(inst->spi_num,
+                              (void*)(seg[i].tx ? seg[i].tx + offset : seg[i].rx + offset),
+                              seg[i].rx ? seg[i].rx + offset : 0, n);
+        }
+    }
+#else
+    /* Command and data have to go in one transfer, copy through txbuf. Still staged, see above */
+    uint8_t * p = inst->uwb_dev.txbuf;
+    int i, total = 0;
+
+    for (i = 0; i < nseg; i++) {
+        total += seg[i].len;
+    }
+    assert(total < inst->uwb_dev.txbuf_size);
+    assert(total < MYNEWT_VAL(DW1000_HAL_SPI_MAX_CNT));
+    for (i = 0; i < nseg; p += seg[i++].len) {
+        if (seg[i].tx) {
+            memcpy(p, seg[i].tx, seg[i].len);
+        } else {
+            memset(p, 0, seg[i].len);
+        }
+    }
+    rc = hal_spi_txrx(inst->spi_num, inst->uwb_dev.txbuf, inst->uwb_dev.txbuf, total);
+    for (i = 0, p = inst->uwb_dev.txbuf; i < nseg; p += seg[i++].len) {
+        if (seg[i].rx) {
+            memcpy(seg[i].rx, p, seg[i].len);
+        }
+    }
+#endif
+    return rc;
+}
+
 /**
  * API to perform a blocking read over SPI
  *
@@ -299,44 +403,25 @@ hal_dw1000_read(struct _dw1000_dev_instance_t * inst,
                 const uint8_t * cmd, uint8_t cmd_size,
                 uint8_t * buffer, uint16_t length)
 {
+    const struct hal_dw1000_spi_seg seg[] = {
+        {.tx = cmd, .rx = NULL, .len = cmd_size},
+        {.tx = NULL, .rx = buffer, .len = length}
+    };
     int rc;
     assert(inst->spi_sem);
-    rc = dpl_sem_pend(inst->spi_sem, DPL_TIMEOUT_NEVER);
+    rc = hal_dw1000_bus_pend(inst);
     if (rc != DPL_OK) {
         inst->uwb_dev.status.sem_error = 1;
         goto early_exit;
     }
     DW1000_SPI_BT_ADD(inst, cmd, cmd_size, buffer, length, 0, 0);
 
-    hal_gpio_write(inst->ss_pin, 0);
-
-#if !defined(MYNEWT)
-    /* Linux mode really, for when we can't split the command and data */
-    assert(cmd_size + length < inst->uwb_dev.txbuf_size);
-    assert(cmd_size + length < MYNEWT_VAL(DW1000_HAL_SPI_MAX_CNT));
-
-    memcpy(inst->uwb_dev.txbuf, cmd, cmd_size);
-    memset(inst->uwb_dev.txbuf + cmd_size, 0, length);
-
-    rc = hal_spi_txrx(inst->spi_num, inst->uwb_dev.txbuf,
-                      inst->uwb_dev.txbuf, cmd_size+length);
-    memcpy(buffer, inst->uwb_dev.txbuf + cmd_size, length);
-#else
-    rc = hal_spi_txrx(inst->spi_num, (void*)cmd, 0, cmd_size);
-    assert(rc == DPL_OK);
-    int step = (inst->uwb_dev.txbuf_size > MYNEWT_VAL(DW1000_HAL_SPI_MAX_CNT)) ?
-        MYNEWT_VAL(DW1000_HAL_SPI_MAX_CNT) : inst->uwb_dev.txbuf_size;
-    int bytes_left = length;
-    for (int offset = 0;offset<length && rc == DPL_OK;offset+=step) {
-        int bytes_to_read = (bytes_left > step) ? step : bytes_left;
-        bytes_left-=bytes_to_read;
-        rc = hal_spi_txrx(inst->spi_num, inst->uwb_dev.txbuf, buffer+offset, bytes_to_read);
-    }
-#endif
-    hal_gpio_write(inst->ss_pin, 1);
+    HAL_DW1000_CS(inst, 0);
+    rc = hal_dw1000_spi_sg(inst, seg, 2);
+    HAL_DW1000_CS(inst, 1);
 
     DW1000_SPI_BT_ADD_END(inst);
-    rc = dpl_sem_release(inst->spi_sem);
+    rc = hal_dw1000_bus_release(inst);
     assert(rc == DPL_OK);
 early_exit:
     return rc;
@@ -361,9 +446,9 @@ hal_dw1000_spi_txrx_cb(void *arg, int len)
         err = dpl_sem_release(&inst->spi_nb_sem);
         assert(err == DPL_OK);
     } else {
-        hal_gpio_write(inst->ss_pin, 1);
+        HAL_DW1000_CS(inst, 1);
         DW1000_SPI_BT_ADD_END(inst);
-        err = dpl_sem_release(inst->spi_sem);
+        err = hal_dw1000_bus_release(inst);
         assert(err == DPL_OK);
     }
 }
@@ -385,7 +470,7 @@ hal_dw1000_read_noblock(struct _dw1000_dev_instance_t * inst, const uint8_t * cm
     int rc = DPL_OK;
     assert(inst->spi_sem);
 
-    rc = dpl_sem_pend(inst->spi_sem, DPL_TIMEOUT_NEVER);
+    rc = hal_dw1000_bus_pend(inst);
     if (rc != DPL_OK) {
         inst->uwb_dev.status.sem_error = 1;
         goto early_exit;
@@ -401,7 +486,34 @@ hal_dw1000_read_noblock(struct _dw1000_dev_instance_t * inst, const uint8_t * cm
         goto err_return;
     }
 
-    hal_gpio_write(inst->ss_pin, 0);
+    HAL_DW1000_CS(inst, 0);
+
+#if MYNEWT_VAL(DW1000_HAL_SPI_SG_NOBLOCK)
+    /* Command and data in one chained transfer straight into buffer, any length */
+    {
+        const struct hal_dw1000_spi_seg seg[] = {
+            {.tx = cmd, .rx = NULL, .len = cmd_size},
+            {.tx = NULL, .rx = buffer, .len = length}
+        };
+        /* Holding spi_nb_sem makes hal_dw1000_spi_txrx_cb give it back instead of the bus */
+        rc = dpl_sem_pend(&inst->spi_nb_sem, DPL_TIMEOUT_NEVER);
+        if (rc != DPL_OK) {
+            inst->uwb_dev.status.sem_error = 1;
+            goto err_return;
+        }
+        rc = hal_spi_txrx_sg_noblock(inst->spi_num, seg, 2);
+        if (rc == DPL_OK) {
+            rc = dpl_sem_pend(&inst->spi_nb_sem, DPL_TIMEOUT_NEVER);
+            if (rc != DPL_OK) {
+                inst->uwb_dev.status.sem_error = 1;
+            }
+        }
+        dpl_sem_release(&inst->spi_nb_sem);
+        HAL_DW1000_CS(inst, 1);
+        DW1000_SPI_BT_ADD_END(inst);
+        goto err_return;
+    }
+#endif
 
     /* Faster read for shorter exchanges */
     if (cmd_size + length < inst->uwb_dev.txbuf_size &&
@@ -425,11 +537,11 @@ hal_dw1000_read_noblock(struct _dw1000_dev_instance_t * inst, const uint8_t * cm
         }
         rc = dpl_sem_release(&inst->spi_nb_sem);
         assert(rc == DPL_OK);
-        hal_gpio_write(inst->ss_pin, 1);
+        HAL_DW1000_CS(inst, 1);
 
         memcpy(buffer, inst->uwb_dev.txbuf + cmd_size, length);
         DW1000_SPI_BT_ADD_END(inst);
-        rc = dpl_sem_release(inst->spi_sem);
+        rc = hal_dw1000_bus_release(inst);
         assert(rc == DPL_OK);
         return rc;
     }
@@ -495,7 +607,7 @@ hal_dw1000_read_noblock(struct _dw1000_dev_instance_t * inst, const uint8_t * cm
     }
 
     /* Reaquire semaphore after rx complete */
-    rc = dpl_sem_pend(inst->spi_sem, DPL_TIMEOUT_NEVER);
+    rc = hal_dw1000_bus_pend(inst);
     if (rc != DPL_OK) {
         inst->uwb_dev.status.sem_error = 1;
         goto err_return;
@@ -505,7 +617,7 @@ hal_dw1000_read_noblock(struct _dw1000_dev_instance_t * inst, const uint8_t * cm
     assert(0);
 #endif
 err_return:
-    rc = dpl_sem_release(inst->spi_sem);
+    rc = hal_dw1000_bus_release(inst);
     assert(rc == DPL_OK);
 
 early_exit:
@@ -513,6 +625,101 @@ early_exit:
 }
 
 
+/**
+ * API to perform a read over SPI into a buffer that has room for the command in front of it.
+ * The command is placed in that headroom and the transfer is done in place, so the data is
+ * not copied after it leaves the SPI peripheral.
+ *
+ * @param inst      Pointer to dw1000_dev_instance_t.
+ * @param cmd       Represents an array of masked attributes like reg,subindex,operation,extended,subaddress.
+ * @param cmd_size  Represents value based on the cmd attributes.
+ * @param buffer    Results are stored into the buffer, the cmd_size bytes in front of it are overwritten.
+ * @param length    Represents buffer length.
+ * @param noblock   Use nonblocking transfers.
+ * @return int      DPL_OK if read is ok, error otherwise
+ */
+int
+hal_dw1000_read_inplace(struct _dw1000_dev_instance_t * inst, const uint8_t * cmd, uint8_t cmd_size,
+                        uint8_t * buffer, uint16_t length, bool noblock)
+{
+    uint8_t * p = buffer - cmd_size;
+    int total = cmd_size + length;
+    int offset, n;
+    int rc, err;
+
+    assert(inst->spi_sem);
+#if !defined(MYNEWT)
+    /* Linux mode, a nonblocking command and data have to go in one transfer */
+    assert(!noblock || total < MYNEWT_VAL(DW1000_HAL_SPI_MAX_CNT));
+#endif
+    rc = hal_dw1000_bus_pend(inst);
+    if (rc != DPL_OK) {
+        inst->uwb_dev.status.sem_error = 1;
+        goto early_exit;
+    }
+    DW1000_SPI_BT_ADD(inst, cmd, cmd_size, buffer, length, 0, noblock);
+
+    if (noblock) {
+        rc = hal_spi_disable(inst->spi_num);
+        rc |= hal_spi_set_txrx_cb(inst->spi_num, hal_dw1000_spi_txrx_cb, (void*)inst);
+        rc |= hal_spi_enable(inst->spi_num);
+        if (rc != DPL_OK) {
+            goto err_return;
+        }
+    }
+
+    /* What is clocked out after the command is ignored by the DW1000, so the
+     * buffer is both source and destination */
+    memcpy(p, cmd, cmd_size);
+    HAL_DW1000_CS(inst, 0);
+    if (!noblock) {
+        const struct hal_dw1000_spi_seg seg = {.tx = p, .rx = p, .len = total};
+        rc = hal_dw1000_spi_sg(inst, &seg, 1);
+    }
+    for (offset = 0; noblock && offset < total && rc == DPL_OK; offset += n) {
+#if MYNEWT_VAL(DW1000_HAL_SPI_SG_NOBLOCK)
+        /* A chain takes any length in one go, which a platform driven chip select needs */
+        const struct hal_dw1000_spi_seg seg = {.tx = p, .rx = p, .len = total};
+        n = total;
+#else
+        n = (total - offset > MYNEWT_VAL(DW1000_HAL_SPI_MAX_CNT)) ?
+            MYNEWT_VAL(DW1000_HAL_SPI_MAX_CNT) : total - offset;
+#endif
+        /* Hold spi_nb_sem over the transfer, hal_dw1000_spi_txrx_cb gives it back */
+        rc = dpl_sem_pend(&inst->spi_nb_sem, DPL_TIMEOUT_NEVER);
+        if (rc != DPL_OK) {
+            inst->uwb_dev.status.sem_error = 1;
+            break;
+        }
+#if MYNEWT_VAL(DW1000_HAL_SPI_SG_NOBLOCK)
+        rc = hal_spi_txrx_sg_noblock(inst->spi_num, &seg, 1);
+#else
+        rc = hal_spi_txrx_noblock(inst->spi_num, p + offset, p + offset, n);
+#endif
+        if (rc != DPL_OK) {
+            err = dpl_sem_release(&inst->spi_nb_sem);
+            assert(err == DPL_OK);
+            break;
+        }
+        rc = dpl_sem_pend(&inst->spi_nb_sem, DPL_TIMEOUT_NEVER);
+        if (rc != DPL_OK) {
+            inst->uwb_dev.status.sem_error = 1;
+            break;
+        }
+        err = dpl_sem_release(&inst->spi_nb_sem);
+        assert(err == DPL_OK);
+    }
+    HAL_DW1000_CS(inst, 1);
+    DW1000_SPI_BT_ADD_END(inst);
+
+err_return:
+    err = hal_dw1000_bus_release(inst);
+    assert(err == DPL_OK);
+early_exit:
+    return rc;
+}
+
+
 /**
  * API to perform a blocking write over SPI
  *
@@ -526,40 +733,27 @@ early_exit:
 int
 hal_dw1000_write(struct _dw1000_dev_instance_t * inst, const uint8_t * cmd, uint8_t cmd_size, uint8_t * buffer, uint16_t length)
 {
+    const struct hal_dw1000_spi_seg seg[] = {
+        {.tx = cmd, .rx = NULL, .len = cmd_size},
+        {.tx = buffer, .rx = NULL, .len = length}
+    };
     int rc = DPL_OK;
     assert(inst->spi_sem);
-    rc = dpl_sem_pend(inst->spi_sem, DPL_TIMEOUT_NEVER);
+    rc = hal_dw1000_bus_pend(inst);
     if (rc != DPL_OK) {
         inst->uwb_dev.status.sem_error = 1;
         goto early_exit;
     }
     DW1000_SPI_BT_ADD(inst, cmd, cmd_size, buffer, length, 1, 0);
 
-    hal_gpio_write(inst->ss_pin, 0);
-
-#if !defined(MYNEWT)
-    /* Linux mode really, for when we can't split the command and data */
-    assert(cmd_size + length < inst->uwb_dev.txbuf_size);
-    assert(cmd_size + length < MYNEWT_VAL(DW1000_HAL_SPI_MAX_CNT));
-
-    memcpy(inst->uwb_dev.txbuf, cmd, cmd_size);
-    memcpy(inst->uwb_dev.txbuf+cmd_size, buffer, length);
-
-    rc = hal_spi_txrx(inst->spi_num, inst->uwb_dev.txbuf,
-                      0, cmd_size+length);
-    assert(rc == DPL_OK);
-#else
-    rc = hal_spi_txrx(inst->spi_num, (void*)cmd, 0, cmd_size);
+    HAL_DW1000_CS(inst, 0);
+    rc = hal_dw1000_spi_sg(inst, seg, length ? 2 : 1);
     assert(rc == DPL_OK);
-    if (length) {
-        hal_spi_txrx(inst->spi_num, (void*)buffer, 0, length);
-    }
-#endif
 
-    hal_gpio_write(inst->ss_pin, 1);
+    HAL_DW1000_CS(inst, 1);
 
     DW1000_SPI_BT_ADD_END(inst);
-    rc = dpl_sem_release(inst->spi_sem);
+    rc = hal_dw1000_bus_release(inst);
     assert(rc == DPL_OK);
 early_exit:
     return rc;
@@ -582,7 +776,7 @@ hal_dw1000_write_noblock(struct _dw1000_dev_instance_t * inst, const uint8_t * c
     int rc = DPL_OK;
     assert(length);
     assert(inst->spi_sem);
-    rc = dpl_sem_pend(inst->spi_sem, DPL_TIMEOUT_NEVER);
+    rc = hal_dw1000_bus_pend(inst);
     if (rc != DPL_OK) {
         inst->uwb_dev.status.sem_error = 1;
         goto early_exit;
@@ -598,7 +792,7 @@ hal_dw1000_write_noblock(struct _dw1000_dev_instance_t * inst, const uint8_t * c
         goto err_return;
     }
 
-    hal_gpio_write(inst->ss_pin, 0);
+    HAL_DW1000_CS(inst, 0);
 
     /* If command and data fit in inst->uwb_dev.txbuf, send immediately */
     if (cmd_size + length < inst->uwb_dev.txbuf_size &&
@@ -611,6 +805,24 @@ hal_dw1000_write_noblock(struct _dw1000_dev_instance_t * inst, const uint8_t * c
         return rc;
     }
 
+#if MYNEWT_VAL(DW1000_HAL_SPI_SG_NOBLOCK)
+    /* Too long for txbuf, chain the command from txbuf and the data from buffer, which has to
+     * stay valid until the transfer completes */
+    {
+        const struct hal_dw1000_spi_seg seg[] = {
+            {.tx = inst->uwb_dev.txbuf, .rx = NULL, .len = cmd_size},
+            {.tx = buffer, .rx = NULL, .len = length}
+        };
+        memcpy(inst->uwb_dev.txbuf, cmd, cmd_size);
+        rc = hal_spi_txrx_sg_noblock(inst->spi_num, seg, 2);
+        if (rc != DPL_OK) {
+            HAL_DW1000_CS(inst, 1);
+            goto err_return;
+        }
+        return rc;
+    }
+#endif
+
 #if MYNEWT_VAL(DW1000_HAL_SPI_BUFFER_SIZE) < 1024 || MYNEWT_VAL(DW1000_HAL_SPI_MAX_CNT) < 1028
     rc = dpl_sem_pend(&inst->spi_nb_sem, DPL_TIMEOUT_NEVER);
     if (rc != DPL_OK) {
@@ -673,7 +885,7 @@ early_exit:
     return rc;
 
 err_return:
-    rc = dpl_sem_release(inst->spi_sem);
+    rc = hal_dw1000_bus_release(inst);
     assert(rc == DPL_OK);
     return rc;
 }
@@ -703,6 +915,72 @@ hal_dw1000_rw_noblock_wait(struct _dw1000_dev_instance_t * inst, uint32_t timeou
 }
 
 
+#if MYNEWT_VAL(DW1000_SPI_XOVER_CAL)
+/* Shortest measured length from which nonblocking stays faster, not below floor */
+static uint16_t
+xover_min(uint32_t ticks[2][DW1000_SPI_XOVER_NSIZES], uint16_t floor)
+{
+    int k;
+
+    for (k = DW1000_SPI_XOVER_NSIZES; k > 0 && ticks[1][k - 1] < ticks[0][k - 1]; k--);
+    if (k == DW1000_SPI_XOVER_NSIZES) {
+        return UINT16_MAX;
+    }
+    return ((2 << k) > floor) ? (2 << k) : floor;
+}
+
+/**
+ * API to time blocking and nonblocking transfers of 2 to 512 bytes in each direction and set
+ * the payload lengths from which dw1000_read and dw1000_write go nonblocking. Reads come from
+ * the RX buffer and writes go to the TX buffer, so the device must not have a frame queued.
+ * Times include waiting for a nonblocking transfer to complete.
+ *
+ * @param inst  Pointer to dw1000_dev_instance_t.
+ * @return void
+ */
+void
+hal_dw1000_spi_xover_cal(struct _dw1000_dev_instance_t * inst)
+{
+    static uint8_t buf[2 << (DW1000_SPI_XOVER_NSIZES - 1)];
+    const uint8_t rd_cmd[] = {RX_BUFFER_ID};
+    const uint8_t wr_cmd[] = {0x80 | TX_BUFFER_ID};
+    struct dw1000_spi_xover * x = &inst->spi_xover;
+    uint32_t t0;
+    int k, i, mode;
+
+    for (k = 0; k < DW1000_SPI_XOVER_NSIZES; k++) {
+        uint16_t len = 2 << k;
+        for (mode = 0; mode < 2; mode++) {
+            t0 = dpl_cputime_get32();
+            for (i = 0; i < MYNEWT_VAL(DW1000_SPI_XOVER_ROUNDS); i++) {
+                if (mode) {
+                    hal_dw1000_read_noblock(inst, rd_cmd, sizeof(rd_cmd), buf, len);
+                } else {
+                    hal_dw1000_read(inst, rd_cmd, sizeof(rd_cmd), buf, len);
+                }
+            }
+            x->rd_ticks[mode][k] = dpl_cputime_get32() - t0;
+
+            t0 = dpl_cputime_get32();
+            for (i = 0; i < MYNEWT_VAL(DW1000_SPI_XOVER_ROUNDS); i++) {
+                if (mode) {
+                    hal_dw1000_write_noblock(inst, wr_cmd, sizeof(wr_cmd), buf, len);
+                    hal_dw1000_rw_noblock_wait(inst, DPL_TIMEOUT_NEVER);
+                } else {
+                    hal_dw1000_write(inst, wr_cmd, sizeof(wr_cmd), buf, len);
+                }
+            }
+            x->wr_ticks[mode][k] = dpl_cputime_get32() - t0;
+        }
+    }
+
+    /* Short nonblocking reads have been seen to trip the mutex asserts with
+     * double buffering, keep reads blocking below the configured length */
+    x->rd_min = xover_min(x->rd_ticks, MYNEWT_VAL(DW1000_DEVICE_SPI_RD_MAX_NOBLOCK));
+    x->wr_min = xover_min(x->wr_ticks, 1);
+}
+#endif
+
 /**
  * API to wake dw1000 from sleep mode
  *
@@ -712,10 +990,10 @@ hal_dw1000_rw_noblock_wait(struct _dw1000_dev_instance_t * inst, uint32_t timeou
 int
 hal_dw1000_wakeup(struct _dw1000_dev_instance_t * inst)
 {
-    int rc = DPL_OK;
+    int rc = DPL_OK, err;
     os_sr_t sr;
     assert(inst->spi_sem);
-    rc = dpl_sem_pend(inst->spi_sem, DPL_TIMEOUT_NEVER);
+    rc = hal_dw1000_bus_pend(inst);
     if (rc != DPL_OK) {
         inst->uwb_dev.status.sem_error = 1;
         goto early_exit;
@@ -723,14 +1001,18 @@ hal_dw1000_wakeup(struct _dw1000_dev_instance_t * inst)
 
     DPL_ENTER_CRITICAL(sr);
 
+    // Need to hold chip select for a minimum of 600us
+#if MYNEWT_VAL(DW1000_HAL_SPI_CS_AUTO)
+    rc = hal_spi_cs_wake(inst->spi_num, 2000);
+#else
     hal_spi_disable(inst->spi_num);
-    hal_gpio_write(inst->ss_pin, 0);
+    HAL_DW1000_CS(inst, 0);
 
-    // Need to hold chip select for a minimum of 600us
     dpl_cputime_delay_usecs(2000);
 
-    hal_gpio_write(inst->ss_pin, 1);
+    HAL_DW1000_CS(inst, 1);
     hal_spi_enable(inst->spi_num);
+#endif
 
     // Waiting for XTAL to start and stabilise - 5ms safe
     // (check PLL bit in IRQ?)
@@ -738,8 +1020,9 @@ hal_dw1000_wakeup(struct _dw1000_dev_instance_t * inst)
 
     DPL_EXIT_CRITICAL(sr);
 
-    rc = dpl_sem_release(inst->spi_sem);
-    assert(rc == DPL_OK);
+    err = hal_dw1000_bus_release(inst);
+    assert(err == DPL_OK);
+    (void)err;
 early_exit:
     return rc;
 }
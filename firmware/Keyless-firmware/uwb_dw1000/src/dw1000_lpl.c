@@ -0,0 +1,436 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw1000_lpl.c
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief Low-power listening
+ *
+ * @details The receiver is kept in a sleep -> listen -> snooze -> listen cycle, with SNIFF mode sequencing the
+ * receiver on and off during each listen phase. The scheduler sizes each phase from the wake-up burst the
+ * transmitter sends and the latency the application asks for. When a good frame arrives the interrupt handler
+ * drops out of low-power listening and leaves the receiver fully on.
+ *
+ * The time model, per cycle of length C:
+ *      C = sleep + listen + snooze + listen
+ *      latency <= C + listen + frame
+ *      duty = 2 * listen * sniff_duty / C
+ * where each listen phase spans one burst period plus the SHR, so a full preamble always lands inside it.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <dpl/dpl.h>
+#include <dpl/dpl_cputime.h>
+#include <dw1000/dw1000_regs.h>
+#include <dw1000/dw1000_dev.h>
+#include <dw1000/dw1000_phy.h>
+#include <dw1000/dw1000_mac.h>
+#include <dw1000/dw1000_lpl.h>
+
+#if MYNEWT_VAL(DW1000_LPL_ENABLED)
+
+static struct dw1000_lpl_instance g_lpl_instances[MYNEWT_VAL(UWB_DEVICE_MAX)];
+
+/**
+ * API to get the low-power listening instance of a device.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return struct dw1000_lpl_instance *
+ */
+struct dw1000_lpl_instance *
+dw1000_lpl_get(struct _dw1000_dev_instance_t * inst)
+{
+    assert(inst->uwb_dev.idx < MYNEWT_VAL(UWB_DEVICE_MAX));
+    return &g_lpl_instances[inst->uwb_dev.idx];
+}
+
+/**
+ * API to initialise low-power listening on a device. Calibrates the low-power oscillator
+ * so that the long sleep can be expressed in time.
+ *
+ * NOTE: the SPI freq has to be < 3MHz, see dw1000_dev_set_sleep_timer.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return struct dw1000_lpl_instance *
+ */
+struct dw1000_lpl_instance *
+dw1000_lpl_init(struct _dw1000_dev_instance_t * inst)
+{
+    struct dw1000_lpl_instance * lpl = dw1000_lpl_get(inst);
+
+    memset(lpl, 0, sizeof(struct dw1000_lpl_instance));
+    lpl->dev_inst = inst;
+    lpl->stats.latency_min_usec = UINT32_MAX;
+    lpl->lposc_cal = dw1000_lpl_calibrate_sleep_cnt(inst);
+    return lpl;
+}
+
+/**
+ * API to calibrate the low-power oscillator, its frequency varies between 7 and 13kHz with
+ * temperature and voltage.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return uint16_t Number of XTAL/2 cycles per low-power oscillator cycle, LPOSC freq = 19.2MHz/value.
+ */
+uint16_t
+dw1000_lpl_calibrate_sleep_cnt(struct _dw1000_dev_instance_t * inst)
+{
+    uint16_t result;
+
+    dw1000_write_reg(inst, AON_ID, AON_CFG1_OFFSET, AON_CFG1_LPOSC_CAL, sizeof(uint8_t));   // Enable calibration
+    dw1000_write_reg(inst, AON_ID, AON_CTRL_OFFSET, AON_CTRL_UPL_CFG, sizeof(uint8_t));     // Upload array
+    dw1000_write_reg(inst, AON_ID, AON_CTRL_OFFSET, 0, sizeof(uint8_t));
+    dw1000_write_reg(inst, AON_ID, AON_CFG1_OFFSET, 0, sizeof(uint8_t));                    // Disable calibration
+    dw1000_write_reg(inst, AON_ID, AON_CTRL_OFFSET, AON_CTRL_UPL_CFG, sizeof(uint8_t));
+    dw1000_write_reg(inst, AON_ID, AON_CTRL_OFFSET, 0, sizeof(uint8_t));
+
+    dw1000_phy_sysclk_XTAL(inst);
+    dpl_cputime_delay_usecs(1000);
+
+    /* Read the result through direct AON access, upper byte first */
+    dw1000_write_reg(inst, AON_ID, AON_ADDR_OFFSET, AON_ADDR_LPOSC_CAL_1, sizeof(uint8_t));
+    dw1000_write_reg(inst, AON_ID, AON_CTRL_OFFSET, AON_CTRL_DCA_ENAB, sizeof(uint8_t));
+    dw1000_write_reg(inst, AON_ID, AON_CTRL_OFFSET, AON_CTRL_DCA_ENAB | AON_CTRL_DCA_READ, sizeof(uint8_t));
+    result = (uint16_t) dw1000_read_reg(inst, AON_ID, AON_RDAT_OFFSET, sizeof(uint8_t)) << 8;
+
+    dw1000_write_reg(inst, AON_ID, AON_ADDR_OFFSET, AON_ADDR_LPOSC_CAL_0, sizeof(uint8_t));
+    dw1000_write_reg(inst, AON_ID, AON_CTRL_OFFSET, AON_CTRL_DCA_ENAB, sizeof(uint8_t));
+    dw1000_write_reg(inst, AON_ID, AON_CTRL_OFFSET, AON_CTRL_DCA_ENAB | AON_CTRL_DCA_READ, sizeof(uint8_t));
+    result |= (uint16_t) dw1000_read_reg(inst, AON_ID, AON_RDAT_OFFSET, sizeof(uint8_t));
+
+    dw1000_write_reg(inst, AON_ID, AON_CTRL_OFFSET, 0, sizeof(uint8_t));                    // Disable manual override
+    dw1000_phy_sysclk_SEQ(inst);
+
+    return result;
+}
+
+/**
+ * API to enable/disable and configure SNIFF mode.
+ *
+ * @param inst    Pointer to _dw1000_dev_instance_t.
+ * @param enable  true to enable SNIFF mode.
+ * @param on      Receiver ON time in PAC units, the IC adds one PAC. 1..15.
+ * @param off     Receiver OFF time in 128/125 us units. 0..255.
+ * @return void
+ */
+void
+dw1000_lpl_set_sniff(struct _dw1000_dev_instance_t * inst, bool enable, uint8_t on, uint8_t off)
+{
+    uint32_t pmsc_reg = (uint32_t) dw1000_read_reg(inst, PMSC_ID, PMSC_CTRL0_OFFSET, sizeof(uint32_t));
+
+    if (enable) {
+        dw1000_write_reg(inst, RX_SNIFF_ID, RX_SNIFF_OFFSET, (((uint16_t)off << 8) | on) & RX_SNIFF_MASK, sizeof(uint16_t));
+        pmsc_reg |= PMSC_CTRL0_PLL2_SEQ_EN;
+    } else {
+        dw1000_write_reg(inst, RX_SNIFF_ID, RX_SNIFF_OFFSET, 0, sizeof(uint16_t));
+        pmsc_reg &= ~PMSC_CTRL0_PLL2_SEQ_EN;
+    }
+    dw1000_write_reg(inst, PMSC_ID, PMSC_CTRL0_OFFSET, pmsc_reg, sizeof(uint32_t));
+}
+
+/**
+ * API to set the snooze (short sleep) time between the two listen phases.
+ *
+ * @param inst    Pointer to _dw1000_dev_instance_t.
+ * @param snooze  Snooze time in 512/19.2 us units, the IC adds one unit. Smallest working value is 1.
+ * @return void
+ */
+void
+dw1000_lpl_set_snooze(struct _dw1000_dev_instance_t * inst, uint8_t snooze)
+{
+    dw1000_write_reg(inst, PMSC_ID, PMSC_SNOZT_OFFSET, snooze, sizeof(uint8_t));
+}
+
+/**
+ * API to enable/disable the automatic RX to sleep and snooze features that make up low-power listening.
+ *
+ * @param inst    Pointer to _dw1000_dev_instance_t.
+ * @param enable  true to enable low-power listening.
+ * @return void
+ */
+void
+dw1000_lpl_set_listening(struct _dw1000_dev_instance_t * inst, bool enable)
+{
+    uint32_t reg = (uint32_t) dw1000_read_reg(inst, PMSC_ID, PMSC_CTRL1_OFFSET, sizeof(uint32_t));
+    if (enable)
+        reg |= PMSC_CTRL1_ARXSLP | PMSC_CTRL1_SNOZE;
+    else
+        reg &= ~(PMSC_CTRL1_ARXSLP | PMSC_CTRL1_SNOZE);
+    dw1000_write_reg(inst, PMSC_ID, PMSC_CTRL1_OFFSET, reg, sizeof(uint32_t));
+}
+
+/**
+ * API to compute a low-power listening schedule. Picks the SNIFF on/off times for the current preamble
+ * and the sleep and snooze periods giving the lowest duty cycle that still detects the wake-up burst
+ * within the target latency. Falls back to SNIFF-only continuous reception when the target is
+ * shorter than one sleep counter unit. Pass &lpl->sched to have dw1000_lpl_start use the result.
+ *
+ * @param lpl     Pointer to struct dw1000_lpl_instance.
+ * @param config  Requirements of the wake-up burst.
+ * @param sched   Resulting schedule.
+ * @return int 0 on success, -1 if the target latency can not be met even with continuous reception.
+ */
+int
+dw1000_lpl_schedule(struct dw1000_lpl_instance * lpl, const struct dw1000_lpl_config * config,
+                    struct dw1000_lpl_schedule * sched)
+{
+    struct _dw1000_dev_instance_t * inst = lpl->dev_inst;
+    struct uwb_dev_config * dev_config = &inst->uwb_dev.config;
+    uint32_t psym_ns = DW1000_LPL_PSYM_NS(dev_config->prf);
+    uint32_t pac_ns = (8 << dev_config->rx.pacLength) * psym_ns;
+    uint32_t preamble_ns = inst->uwb_dev.attrib.nsync * psym_ns;
+    uint32_t shr_usec = dw1000_phy_SHR_duration(&inst->uwb_dev.attrib);
+    uint32_t frame_usec = dw1000_phy_frame_duration(&inst->uwb_dev.attrib, config->frame_len);
+    uint32_t on_ns, off_ns, off, budget, sleep_unit_usec, rest, snooze_ns, snooze;
+    uint16_t lposc_cal = (lpl->lposc_cal) ? lpl->lposc_cal : 1600;  /* 12kHz nominal */
+
+    memset(sched, 0, sizeof(struct dw1000_lpl_schedule));
+    if (sched == &lpl->sched) {
+        lpl->config = *config;
+    }
+
+    /* SNIFF: minimum ON time of two PACs, and an OFF time short enough that two
+     * complete ON windows always fall inside one preamble */
+    sched->sniff_on = 1;
+    on_ns = (sched->sniff_on + 1) * pac_ns;
+    off_ns = (preamble_ns > 3 * on_ns) ? (preamble_ns - 3 * on_ns) / 2 : 0;
+    off = off_ns / DW1000_LPL_SNIFF_OFF_NS;
+    sched->sniff_off = (off > DW1000_LPL_SNIFF_OFF_MAX) ? DW1000_LPL_SNIFF_OFF_MAX : off;
+    sched->sniff_duty_pm = (uint16_t)((uint64_t)on_ns * 1000 / (on_ns + sched->sniff_off * DW1000_LPL_SNIFF_OFF_NS));
+
+    /* Each listen phase spans one burst period plus the SHR */
+    sched->listen_usec = config->burst_period_usec + shr_usec;
+    sched->listen_pac = (uint16_t)(((uint64_t)sched->listen_usec * 1000 + pac_ns - 1) / pac_ns);
+
+    /* Continuous SNIFF reception as a baseline */
+    sched->latency_usec = sched->listen_usec + frame_usec;
+    sched->duty_pm = sched->sniff_duty_pm;
+    if (config->target_latency_usec < sched->latency_usec) {
+        return -1;
+    }
+
+    budget = (config->target_latency_usec < config->burst_duration_usec) ?
+        config->target_latency_usec : config->burst_duration_usec;
+    if (budget < sched->listen_usec + frame_usec) {
+        return 0;
+    }
+    budget -= sched->listen_usec + frame_usec;
+
+    /* The long sleep is the cheapest state, give it as many whole counter units as fit */
+    sleep_unit_usec = (uint32_t)(((uint64_t)lposc_cal << DW1000_LPL_SLEEP_CNT_SHIFT) * 10 / 192);
+    rest = 2 * sched->listen_usec + (DW1000_LPL_SNOOZE_MIN + 1) * DW1000_LPL_SNOOZE_NS / 1000;
+    if (budget < rest + sleep_unit_usec) {
+        return 0;
+    }
+    sched->sleep_cnt = (uint16_t)((budget - rest) / sleep_unit_usec);
+
+    /* Whatever is left over goes to the snooze */
+    snooze_ns = (budget - 2 * sched->listen_usec - sched->sleep_cnt * sleep_unit_usec) * 1000;
+    snooze = snooze_ns / DW1000_LPL_SNOOZE_NS;
+    snooze = (snooze > DW1000_LPL_SNOOZE_MIN + 1) ? snooze - 1 : DW1000_LPL_SNOOZE_MIN;
+    sched->snooze = (snooze > DW1000_LPL_SNOOZE_MAX) ? DW1000_LPL_SNOOZE_MAX : snooze;
+
+    sched->use_sleep = 1;
+    sched->period_usec = sched->sleep_cnt * sleep_unit_usec + 2 * sched->listen_usec +
+        (sched->snooze + 1) * DW1000_LPL_SNOOZE_NS / 1000;
+    sched->latency_usec = sched->period_usec + sched->listen_usec + frame_usec;
+    sched->duty_pm = (uint16_t)((uint64_t)2 * sched->listen_usec * sched->sniff_duty_pm / sched->period_usec);
+    return 0;
+}
+
+/**
+ * API to accumulate the time spent in the current state into the statistics.
+ *
+ * @param lpl  Pointer to struct dw1000_lpl_instance.
+ * @return void
+ */
+static void
+lpl_account(struct dw1000_lpl_instance * lpl)
+{
+    uint32_t now = dpl_cputime_get32();
+    uint32_t usecs = dpl_cputime_ticks_to_usecs(now - lpl->state_ticks);
+
+    if (lpl->active)
+        lpl->stats.lpl_usec += usecs;
+    else if (lpl->rx_on)
+        lpl->stats.rx_usec += usecs;
+    lpl->state_ticks = now;
+}
+
+/**
+ * API to leave low-power listening, restores the settings changed by dw1000_lpl_start.
+ *
+ * @param lpl  Pointer to struct dw1000_lpl_instance.
+ * @return void
+ */
+static void
+lpl_exit(struct dw1000_lpl_instance * lpl)
+{
+    struct _dw1000_dev_instance_t * inst = lpl->dev_inst;
+
+    if (lpl->sched.use_sleep) {
+        /* Low-power listening has to go before the status is cleared, otherwise the
+         * device drops straight back to sleep */
+        dw1000_lpl_set_listening(inst, false);
+        uint16_t reg = dw1000_read_reg(inst, AON_ID, AON_WCFG_OFFSET, sizeof(uint16_t));
+        dw1000_write_reg(inst, AON_ID, AON_WCFG_OFFSET, reg & ~AON_WCFG_PRES_SLEEP, sizeof(uint16_t));
+        dw1000_write_reg(inst, DRX_CONF_ID, DRX_PRETOC_OFFSET, 0, sizeof(uint16_t));
+        dw1000_write_reg(inst, SYS_MASK_ID, 0, lpl->sys_mask, sizeof(uint32_t));
+        inst->uwb_dev.config.sleep_enable = lpl->sleep_enable;
+        inst->uwb_dev.config.wakeup_rx_enable = lpl->wakeup_rx_enable;
+        dw1000_dev_configure_sleep(inst);
+    }
+    dw1000_lpl_set_sniff(inst, false, 0, 0);
+    inst->control.lpl_enabled = 0;
+    lpl->active = 0;
+}
+
+/**
+ * API to start low-power listening with the current schedule. The SPI bus must be left alone
+ * while listening as any access wakes the device.
+ *
+ * @param lpl  Pointer to struct dw1000_lpl_instance.
+ * @return struct uwb_dev_status
+ */
+struct uwb_dev_status
+dw1000_lpl_start(struct dw1000_lpl_instance * lpl)
+{
+    struct _dw1000_dev_instance_t * inst = lpl->dev_inst;
+    struct dw1000_lpl_schedule * sched = &lpl->sched;
+
+    if (lpl->active) {
+        return inst->uwb_dev.status;
+    }
+    lpl_account(lpl);
+    lpl->rx_on = 0;
+
+    dw1000_phy_forcetrxoff(inst);
+    dw1000_set_rx_timeout(inst, 0);
+    dw1000_lpl_set_sniff(inst, true, sched->sniff_on, sched->sniff_off);
+
+    if (sched->use_sleep) {
+        dw1000_lpl_set_snooze(inst, sched->snooze);
+        dw1000_write_reg(inst, DRX_CONF_ID, DRX_PRETOC_OFFSET, sched->listen_pac, sizeof(uint16_t));
+        dw1000_dev_set_sleep_timer(inst, sched->sleep_cnt);
+
+        /* Wake up on the counter straight into RX, keeping the RX to sleep control */
+        lpl->sleep_enable = inst->uwb_dev.config.sleep_enable;
+        lpl->wakeup_rx_enable = inst->uwb_dev.config.wakeup_rx_enable;
+        inst->uwb_dev.config.sleep_enable = 1;
+        inst->uwb_dev.config.wakeup_rx_enable = 1;
+        dw1000_dev_configure_sleep(inst);
+        uint16_t reg = dw1000_read_reg(inst, AON_ID, AON_WCFG_OFFSET, sizeof(uint16_t));
+        dw1000_write_reg(inst, AON_ID, AON_WCFG_OFFSET, reg | AON_WCFG_PRES_SLEEP, sizeof(uint16_t));
+
+        /* Only a good frame ends low-power listening */
+        lpl->sys_mask = (uint32_t) dw1000_read_reg(inst, SYS_MASK_ID, 0, sizeof(uint32_t));
+        dw1000_write_reg(inst, SYS_MASK_ID, 0, SYS_MASK_MRXFCG, sizeof(uint32_t));
+        dw1000_lpl_set_listening(inst, true);
+    }
+
+    inst->control.lpl_enabled = 1;
+    lpl->active = 1;
+    return dw1000_start_rx(inst);
+}
+
+/**
+ * API to stop low-power listening without a detection.
+ *
+ * @param lpl  Pointer to struct dw1000_lpl_instance.
+ * @return struct uwb_dev_status
+ */
+struct uwb_dev_status
+dw1000_lpl_stop(struct dw1000_lpl_instance * lpl)
+{
+    struct _dw1000_dev_instance_t * inst = lpl->dev_inst;
+
+    if (lpl->active) {
+        lpl_account(lpl);
+        lpl_exit(lpl);
+        dw1000_phy_forcetrxoff(inst);
+    }
+    lpl->rx_on = 0;
+    return inst->uwb_dev.status;
+}
+
+/**
+ * Called from the interrupt handler on a good frame whilst low-power listening is armed.
+ * Leaves low-power listening with the receiver fully on.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return void
+ */
+void
+dw1000_lpl_detected(struct _dw1000_dev_instance_t * inst)
+{
+    struct dw1000_lpl_instance * lpl = dw1000_lpl_get(inst);
+
+    lpl_account(lpl);
+    lpl_exit(lpl);
+    lpl->rx_on = 1;
+    lpl->stats.detections++;
+}
+
+/**
+ * API to report the detection latency of a wake-up burst. The transmitter numbers the frames of a burst,
+ * the index of the first frame heard gives how long the burst had been running.
+ *
+ * @param lpl        Pointer to struct dw1000_lpl_instance.
+ * @param burst_idx  Index within the burst of the frame that ended low-power listening.
+ * @return void
+ */
+void
+dw1000_lpl_report_latency(struct dw1000_lpl_instance * lpl, uint16_t burst_idx)
+{
+    struct _dw1000_dev_instance_t * inst = lpl->dev_inst;
+    uint32_t latency = burst_idx * lpl->config.burst_period_usec +
+        dw1000_phy_frame_duration(&inst->uwb_dev.attrib, lpl->config.frame_len);
+
+    if (latency < lpl->stats.latency_min_usec)
+        lpl->stats.latency_min_usec = latency;
+    if (latency > lpl->stats.latency_max_usec)
+        lpl->stats.latency_max_usec = latency;
+    lpl->stats.latency_sum_usec += latency;
+    lpl->stats.latency_cnt++;
+}
+
+/**
+ * API to calculate the measured receiver duty cycle, weighting the time spent listening by the
+ * scheduled duty and the time spent fully on after detections by one.
+ *
+ * @param lpl  Pointer to struct dw1000_lpl_instance.
+ * @return uint16_t duty cycle in per mille.
+ */
+uint16_t
+dw1000_lpl_measured_duty(struct dw1000_lpl_instance * lpl)
+{
+    uint64_t total;
+
+    lpl_account(lpl);
+    total = lpl->stats.lpl_usec + lpl->stats.rx_usec;
+    if (total == 0) {
+        return 0;
+    }
+    return (uint16_t)((lpl->stats.lpl_usec * lpl->sched.duty_pm + lpl->stats.rx_usec * 1000) / total);
+}
+
+#endif
@@ -45,6 +45,24 @@
 #include <dw1000/dw1000_phy.h>
 #include <dw1000/dw1000_stats.h>
 #include <dw1000/dw1000_mac.h>
+#if MYNEWT_VAL(DW1000_LPL_ENABLED)
+#include <dw1000/dw1000_lpl.h>
+#endif
+#if MYNEWT_VAL(DW1000_XTAL_TRACK_ENABLED)
+#include <dw1000/dw1000_xtal.h>
+#endif
+#if MYNEWT_VAL(DW1000_RXRING_ENABLED)
+#include <dw1000/dw1000_rxring.h>
+#endif
+#if MYNEWT_VAL(DW1000_SPI_ARB_ENABLED)
+#include <dw1000/dw1000_spi_arb.h>
+#endif
+#if MYNEWT_VAL(DW1000_CIRSTREAM_ENABLED)
+#include <dw1000/dw1000_cirstream.h>
+#endif
+#if MYNEWT_VAL(DW1000_NLOS_ENABLED)
+#include <dw1000/dw1000_nlos.h>
+#endif
 
 
 #if MYNEWT_VAL(DW1000_MAC_STATS)
@@ -215,6 +233,169 @@ static const uint16_t lde_replicaCoeff[] =
     LDE_REPC_PCODE_24
 };
 
+/**
+ * API to compute the phy register values written by dw1000_mac_config for a configuration without
+ * touching the device. SYS_CFG bits that are not part of the configuration are kept from sys_cfg_reg.
+ * @param inst     Pointer to _dw1000_dev_instance_t.
+ * @param config   Pointer to dw1000_dev_config_t.
+ * @param img      Pointer to the register image to fill.
+ * @return void
+ *
+ */
+void
+dw1000_mac_build_regimage(struct _dw1000_dev_instance_t * inst, const struct uwb_dev_config * config,
+                          struct dw1000_mac_regimage * img)
+{
+    uint8_t nsSfd_result  = 0;
+    uint8_t useDWnsSFD = 0;
+    uint8_t chan = config->channel;
+    uint8_t prfIndex = config->prf - DWT_PRF_16M;
+    uint8_t bw = ((chan == 4) || (chan == 7)) ? 1 : 0 ; // Select wide or narrow band
+
+    memset(img, 0, sizeof(struct dw1000_mac_regimage));
+    img->sys_cfg = inst->sys_cfg_reg;
+    img->lde_repc = lde_replicaCoeff[config->rx.preambleCodeIndex];
+
+    /* For 110 kbps we need a special setup */
+    if(config->dataRate == DWT_BR_110K){
+        img->sys_cfg |= SYS_CFG_RXM110K;
+        img->lde_repc >>= 3; // lde_replicaCoeff must be divided by 8
+    }else{
+        img->sys_cfg &= (~SYS_CFG_RXM110K);
+    }
+
+    img->sys_cfg &= ~SYS_CFG_PHR_MODE_11;
+    img->sys_cfg |= (SYS_CFG_PHR_MODE_11 & (((uint32_t)config->rx.phrMode) << SYS_CFG_PHR_MODE_SHFT));
+
+    if (config->rxauto_enable)
+        img->sys_cfg |=SYS_CFG_RXAUTR;
+    else
+        img->sys_cfg &= (~SYS_CFG_RXAUTR);
+
+    img->lde_cfg2 = (prfIndex) ? LDE_PARAM3_64 : LDE_PARAM3_16;
+
+    /* PLL2/RF PLL block CFG/TUNE (for a given channel) */
+    img->pll_cfg = fs_pll_cfg[chan_idx[chan]];
+    img->pll_tune = fs_pll_tune[chan_idx[chan]];
+    /* RF RX blocks (for specified channel/bandwidth) */
+    img->rxctrlh = rx_config[bw];
+    /* RF TX control */
+    img->txctrl = tx_config[chan_idx[chan]];
+
+    /* Baseband parameters (for specified PRF, bit rate, PAC, and SFD settings) */
+    img->dtune0b = sftsh[config->dataRate][config->rx.sfdType];
+    img->dtune1a = dtune1[prfIndex];
+    if(config->dataRate == DWT_BR_110K){
+        img->dtune1b = DRX_TUNE1b_110K;
+    }else{
+        img->dtune4h_valid = 1;
+        if(config->tx.preambleLength == DWT_PLEN_64){
+            img->dtune1b = DRX_TUNE1b_6M8_PRE64;
+            img->dtune4h = DRX_TUNE4H_PRE64;
+        }else{
+            img->dtune1b = DRX_TUNE1b_850K_6M8;
+            img->dtune4h = DRX_TUNE4H_PRE128PLUS;
+        }
+    }
+    img->dtune2 = digital_bb_config[prfIndex][config->rx.pacLength];
+    /* Don't allow 0 - SFD timeout will always be enabled */
+    img->sfdtoc = (config->rx.sfdTimeout) ? config->rx.sfdTimeout : DWT_SFDTOC_DEF;
+    img->agc_tune1 = agc_config.target[prfIndex];
+
+    /* Set (non-standard) user SFD for improved performance, */
+    if(config->rx.sfdType){
+        img->usr_sfd = dwnsSFDlen[config->dataRate];
+        img->usr_sfd_valid = 1;
+        nsSfd_result = 3 ;
+        useDWnsSFD = 1 ;
+    }
+    img->chan_ctrl = (CHAN_CTRL_TX_CHAN_MASK & (((uint32_t)chan) << CHAN_CTRL_TX_CHAN_SHIFT)) |            // Transmit Channel
+        (CHAN_CTRL_RX_CHAN_MASK & (((uint32_t)chan) << CHAN_CTRL_RX_CHAN_SHIFT)) |                         // Receive Channel
+        (CHAN_CTRL_RXFPRF_MASK & (((uint32_t)config->prf) << CHAN_CTRL_RXFPRF_SHIFT)) |                    // RX PRF
+        ((CHAN_CTRL_TNSSFD|CHAN_CTRL_RNSSFD) & (((uint32_t)nsSfd_result) << CHAN_CTRL_TNSSFD_SHIFT)) |     // nsSFD enable RX&TX
+        (CHAN_CTRL_DWSFD & (((uint32_t)useDWnsSFD) << CHAN_CTRL_DWSFD_SHIFT)) |                            // Use DW nsSFD
+        (CHAN_CTRL_TX_PCOD_MASK & (((uint32_t)config->tx.preambleCodeIndex) << CHAN_CTRL_TX_PCOD_SHIFT)) | // TX Preamble Code
+        (CHAN_CTRL_RX_PCOD_MASK & (((uint32_t)config->rx.preambleCodeIndex) << CHAN_CTRL_RX_PCOD_SHIFT)) ; // RX Preamble Code
+
+    /* TX Preamble Size, PRF and Data Rate */
+    img->tx_fctrl = (((uint32_t)(config->tx.preambleLength | config->prf)) << TX_FCTRL_TXPRF_SHFT) |
+        (((uint32_t)config->dataRate) << TX_FCTRL_TXBR_SHFT);
+}
+
+#define REGIMAGE_WRITE(_F, _ID, _OFF) \
+    if (prev == NULL || img->_F != prev->_F) { \
+        dw1000_write_reg(inst, _ID, _OFF, img->_F, sizeof(img->_F)); \
+        n++; \
+    }
+
+/**
+ * API to write a register image to the device. With a previous image only the registers that differ
+ * from it are written, otherwise all of them are. The transceiver must be idle.
+ * @param inst     Pointer to _dw1000_dev_instance_t.
+ * @param img      Pointer to the register image to write.
+ * @param prev     Pointer to the image currently in the device, or NULL.
+ * @return int     Number of registers written
+ *
+ */
+int
+dw1000_mac_apply_regimage(struct _dw1000_dev_instance_t * inst, const struct dw1000_mac_regimage * img,
+                          const struct dw1000_mac_regimage * prev)
+{
+    int n = 0;
+    int sfd_n;
+
+    REGIMAGE_WRITE(sys_cfg, SYS_CFG_ID, 0);
+    inst->sys_cfg_reg = img->sys_cfg;
+    REGIMAGE_WRITE(lde_repc, LDE_IF_ID, LDE_REPC_OFFSET);
+    if (prev == NULL) {
+        dw1000_write_reg(inst, LDE_IF_ID, LDE_CFG1_OFFSET, LDE_PARAM1, sizeof(uint8_t)); // 8-bit configuration register
+    }
+    REGIMAGE_WRITE(lde_cfg2, LDE_IF_ID, LDE_CFG2_OFFSET);
+    REGIMAGE_WRITE(pll_cfg, FS_CTRL_ID, FS_PLLCFG_OFFSET);
+    REGIMAGE_WRITE(pll_tune, FS_CTRL_ID, FS_PLLTUNE_OFFSET);
+    REGIMAGE_WRITE(rxctrlh, RF_CONF_ID, RF_RXCTRLH_OFFSET);
+    REGIMAGE_WRITE(txctrl, RF_CONF_ID, RF_TXCTRL_OFFSET);
+    REGIMAGE_WRITE(dtune0b, DRX_CONF_ID, DRX_TUNE0b_OFFSET);
+    REGIMAGE_WRITE(dtune1a, DRX_CONF_ID, DRX_TUNE1a_OFFSET);
+    REGIMAGE_WRITE(dtune1b, DRX_CONF_ID, DRX_TUNE1b_OFFSET);
+    /* DTUNE4H is left alone at 110k */
+    if (img->dtune4h_valid && (prev == NULL || !prev->dtune4h_valid || img->dtune4h != prev->dtune4h)) {
+        dw1000_write_reg(inst, DRX_CONF_ID, DRX_TUNE4H_OFFSET, img->dtune4h, sizeof(uint16_t));
+        n++;
+    }
+    REGIMAGE_WRITE(dtune2, DRX_CONF_ID, DRX_TUNE2_OFFSET);
+    REGIMAGE_WRITE(sfdtoc, DRX_CONF_ID, DRX_SFDTOC_OFFSET);
+    if (prev == NULL) {
+        dw1000_write_reg(inst, AGC_CTRL_ID, AGC_TUNE2_OFFSET, agc_config.lo32, sizeof(uint32_t));
+    }
+    REGIMAGE_WRITE(agc_tune1, AGC_CTRL_ID, AGC_TUNE1_OFFSET);
+
+    sfd_n = n;
+    if (img->usr_sfd_valid && (prev == NULL || !prev->usr_sfd_valid || img->usr_sfd != prev->usr_sfd)) {
+        /* Write non standard (DW) SFD length */
+        dw1000_write_reg(inst, USR_SFD_ID, 0x0, img->usr_sfd, sizeof(uint8_t));
+        n++;
+    }
+    REGIMAGE_WRITE(chan_ctrl, CHAN_CTRL_ID, 0);
+    REGIMAGE_WRITE(tx_fctrl, TX_FCTRL_ID, 0);
+    inst->tx_fctrl = img->tx_fctrl;
+
+    if (n != sfd_n) {
+        /* The SFD transmit pattern is initialised by the DW1000 upon a user TX request,
+         * but (due to an IC issue) it is not done for an auto-ACK TX.
+         * The SYS_CTRL write below works around this issue, by simultaneously initiating
+         * and aborting a transmission, which correctly initialises the SFD
+         * after its configuration or reconfiguration. */
+        /* Request TX start and TRX off at the same time */
+        dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET, SYS_CTRL_TXSTRT | SYS_CTRL_TRXOFF, sizeof(uint8_t));
+    }
+
+    if (img != &inst->mac_regimage) {
+        memcpy(&inst->mac_regimage, img, sizeof(struct dw1000_mac_regimage));
+    }
+    return n;
+}
+
 /**
  * API to configure the mac layer in dw1000
  * @param inst     Pointer to _dw1000_dev_instance_t.
@@ -226,13 +407,7 @@ struct uwb_dev_status
 dw1000_mac_config(struct _dw1000_dev_instance_t * inst,
                   struct uwb_dev_config * config)
 {
-    uint8_t nsSfd_result  = 0;
-    uint8_t useDWnsSFD = 0;
-    uint8_t chan;
-    uint8_t prfIndex;
-    uint8_t bw;
-    uint16_t reg16;
-    uint32_t regval;
+    struct dw1000_mac_regimage img;
 
     if (config == NULL) {
         config = &inst->uwb_dev.config;
@@ -240,15 +415,10 @@ dw1000_mac_config(struct _dw1000_dev_instance_t * inst,
         memcpy(&inst->uwb_dev.config, config, sizeof(struct uwb_dev_config));
     }
 
-    chan = config->channel;
-    prfIndex = config->prf - DWT_PRF_16M;
-    bw = ((chan == 4) || (chan == 7)) ? 1 : 0 ; // Select wide or narrow band
-    reg16 = lde_replicaCoeff[config->rx.preambleCodeIndex];
-
 #ifdef DW1000_API_ERROR_CHECK
     assert(config->dataRate <= DWT_BR_6M8);
     assert(config->rx.pacLength <= DWT_PAC64);
-    assert((chan >= 1) && (chan <= 7) && (chan != 6));
+    assert((config->channel >= 1) && (config->channel <= 7) && (config->channel != 6));
 
     assert(((config->prf == DWT_PRF_64M) && (config->tx.preambleCodeIndex >= 9) &&
             (config->tx.preambleCodeIndex <= 24)) ||
@@ -272,103 +442,18 @@ dw1000_mac_config(struct _dw1000_dev_instance_t * inst,
     /* Read sysconfig register */
     inst->sys_cfg_reg = SYS_CFG_MASK & dw1000_read_reg(inst, SYS_CFG_ID, 0, sizeof(uint32_t));
 
-    /* For 110 kbps we need a special setup */
-    if(config->dataRate == DWT_BR_110K){
-        inst->sys_cfg_reg |= SYS_CFG_RXM110K;
-        reg16 >>= 3; // lde_replicaCoeff must be divided by 8
-    }else{
-        inst->sys_cfg_reg &= (~SYS_CFG_RXM110K);
-    }
-
-    inst->sys_cfg_reg &= ~SYS_CFG_PHR_MODE_11;
-    inst->sys_cfg_reg |= (SYS_CFG_PHR_MODE_11 & (((uint32_t)config->rx.phrMode) << SYS_CFG_PHR_MODE_SHFT));
-
-    if (config->rxauto_enable)
-        inst->sys_cfg_reg |=SYS_CFG_RXAUTR;
-    else
-        inst->sys_cfg_reg &= (~SYS_CFG_RXAUTR);
-
-    /* By default disable dbl-rxbuffer here and reenable later if needed */
-    inst->sys_cfg_reg |= SYS_CFG_DIS_DRXB;
-
-    dw1000_write_reg(inst, SYS_CFG_ID, 0, inst->sys_cfg_reg, sizeof(uint32_t));
-    /* Set the lde_replicaCoeff */
-    dw1000_write_reg(inst, LDE_IF_ID, LDE_REPC_OFFSET, reg16, sizeof(uint16_t));
-
-    dw1000_phy_config_lde(inst, prfIndex);
-
-    /* Configure PLL2/RF PLL block CFG/TUNE (for a given channel) */
-    dw1000_write_reg(inst, FS_CTRL_ID, FS_PLLCFG_OFFSET, fs_pll_cfg[chan_idx[chan]], sizeof(uint32_t));
-    dw1000_write_reg(inst, FS_CTRL_ID, FS_PLLTUNE_OFFSET, fs_pll_tune[chan_idx[chan]], sizeof(uint8_t));
-
-    /* Configure RF RX blocks (for specified channel/bandwidth) */
-    dw1000_write_reg(inst, RF_CONF_ID, RF_RXCTRLH_OFFSET, rx_config[bw], sizeof(uint8_t));
-
-    /* Configure RF TX blocks (for specified channel and PRF)
-     * Configure RF TX control */
-    dw1000_write_reg(inst, RF_CONF_ID, RF_TXCTRL_OFFSET, tx_config[chan_idx[chan]], sizeof(uint32_t));
-
-    /* Configure the baseband parameters (for specified PRF, bit rate, PAC, and SFD settings) */
-    /* DTUNE0 */
-    dw1000_write_reg(inst, DRX_CONF_ID, DRX_TUNE0b_OFFSET, sftsh[config->dataRate][config->rx.sfdType], sizeof(uint16_t));
-    /* DTUNE1 */
-    dw1000_write_reg(inst, DRX_CONF_ID, DRX_TUNE1a_OFFSET, dtune1[prfIndex], sizeof(uint16_t));
-
-    if(config->dataRate == DWT_BR_110K){
-        dw1000_write_reg(inst, DRX_CONF_ID, DRX_TUNE1b_OFFSET, DRX_TUNE1b_110K, sizeof(uint16_t));
-    }else{
-        if(config->tx.preambleLength == DWT_PLEN_64){
-            dw1000_write_reg(inst, DRX_CONF_ID, DRX_TUNE1b_OFFSET, DRX_TUNE1b_6M8_PRE64, sizeof(uint16_t));
-            dw1000_write_reg(inst, DRX_CONF_ID, DRX_TUNE4H_OFFSET, DRX_TUNE4H_PRE64, sizeof(uint16_t));
-        }else{
-            dw1000_write_reg(inst, DRX_CONF_ID, DRX_TUNE1b_OFFSET, DRX_TUNE1b_850K_6M8, sizeof(uint16_t));
-            dw1000_write_reg(inst, DRX_CONF_ID, DRX_TUNE4H_OFFSET, DRX_TUNE4H_PRE128PLUS, sizeof(uint16_t));
-        }
-    }
-
-    /* DTUNE2 */
-    dw1000_write_reg(inst, DRX_CONF_ID, DRX_TUNE2_OFFSET,
-                     digital_bb_config[prfIndex][config->rx.pacLength], sizeof(uint32_t));
-
     /* DTUNE3 (SFD timeout) */
     /* Don't allow 0 - SFD timeout will always be enabled */
     if(config->rx.sfdTimeout == 0)
         config->rx.sfdTimeout= DWT_SFDTOC_DEF;
 
-    dw1000_write_reg(inst, DRX_CONF_ID, DRX_SFDTOC_OFFSET, config->rx.sfdTimeout, sizeof(uint16_t));
-
-    /* Configure AGC parameters */
-    dw1000_write_reg(inst, AGC_CTRL_ID, AGC_TUNE2_OFFSET, agc_config.lo32, sizeof(uint32_t));
-    dw1000_write_reg(inst, AGC_CTRL_ID, AGC_TUNE1_OFFSET, agc_config.target[prfIndex], sizeof(uint16_t));
+    dw1000_mac_build_regimage(inst, config, &img);
 
-    /* Set (non-standard) user SFD for improved performance, */
-    if(config->rx.sfdType){
-        /* Write non standard (DW) SFD length */
-        dw1000_write_reg(inst, USR_SFD_ID, 0x0, dwnsSFDlen[config->dataRate], sizeof(uint8_t));
-        nsSfd_result = 3 ;
-        useDWnsSFD = 1 ;
-    }
-    regval =  (CHAN_CTRL_TX_CHAN_MASK & (((uint32_t)chan) << CHAN_CTRL_TX_CHAN_SHIFT)) |                   // Transmit Channel
-        (CHAN_CTRL_RX_CHAN_MASK & (((uint32_t)chan) << CHAN_CTRL_RX_CHAN_SHIFT)) |                         // Receive Channel
-        (CHAN_CTRL_RXFPRF_MASK & (((uint32_t)config->prf) << CHAN_CTRL_RXFPRF_SHIFT)) |                    // RX PRF
-        ((CHAN_CTRL_TNSSFD|CHAN_CTRL_RNSSFD) & (((uint32_t)nsSfd_result) << CHAN_CTRL_TNSSFD_SHIFT)) |     // nsSFD enable RX&TX
-        (CHAN_CTRL_DWSFD & (((uint32_t)useDWnsSFD) << CHAN_CTRL_DWSFD_SHIFT)) |                            // Use DW nsSFD
-        (CHAN_CTRL_TX_PCOD_MASK & (((uint32_t)config->tx.preambleCodeIndex) << CHAN_CTRL_TX_PCOD_SHIFT)) | // TX Preamble Code
-        (CHAN_CTRL_RX_PCOD_MASK & (((uint32_t)config->rx.preambleCodeIndex) << CHAN_CTRL_RX_PCOD_SHIFT)) ; // RX Preamble Code
-
-    dw1000_write_reg(inst, CHAN_CTRL_ID, 0, regval, sizeof(uint32_t)) ;
+    /* By default disable dbl-rxbuffer here and reenable later if needed */
+    img.sys_cfg |= SYS_CFG_DIS_DRXB;
 
-    /* Set up TX Preamble Size, PRF and Data Rate */
-    inst->tx_fctrl = (((uint32_t)(config->tx.preambleLength | config->prf)) << TX_FCTRL_TXPRF_SHFT) |
-        (((uint32_t)config->dataRate) << TX_FCTRL_TXBR_SHFT);
-    dw1000_write_reg(inst, TX_FCTRL_ID, 0, inst->tx_fctrl, sizeof(uint32_t));
-    /* The SFD transmit pattern is initialised by the DW1000 upon a user TX request,
-     * but (due to an IC issue) it is not done for an auto-ACK TX.
-     * The SYS_CTRL write below works around this issue, by simultaneously initiating
-     * and aborting a transmission, which correctly initialises the SFD
-     * after its configuration or reconfiguration. */
-    /* Request TX start and TRX off at the same time */
-    dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET, SYS_CTRL_TXSTRT | SYS_CTRL_TRXOFF, sizeof(uint8_t));
+    /* Write every register, including the SFD initialisation */
+    dw1000_mac_apply_regimage(inst, &img, NULL);
 
     dw1000_mac_framefilter(inst, config->rx.frameFilter);
 
@@ -1424,383 +1509,700 @@ dw1000_ic_and_host_ptrs_equal(dw1000_dev_instance_t * inst)
     return (uint8_t)((b & (SYS_STATUS_ICRBP >> 24)) == ((b & (SYS_STATUS_HSRBP >> 24)) << 1));
 }
 
+#if MYNEWT_VAL(DW1000_CBS_TABLE_ENABLED)
+
+#define CBS_TABLE_ADD(_ev, _fn) \
+    if (cbs->_fn) { \
+        t->ent[DW1000_CBS_##_ev][t->num[DW1000_CBS_##_ev]].cb = cbs->_fn; \
+        t->ent[DW1000_CBS_##_ev][t->num[DW1000_CBS_##_ev]++].cbs = cbs; \
+    }
 
 /**
- * This is the DW1000's general Interrupt Service Routine. It will process/report the following events:
- *          - RXFCG (through rx_complete_cb callback)
- *          - TXFRS (through tx_complete_cb callback)
- *          - RXRFTO/RXPTO (through rx_timeout_cb callback)
- *          - RXPHE/RXFCE/RXRFSL/RXSFDTO/AFFREJ/LDEERR (through rx_error_cb cbRxErr)
- * For all events, corresponding interrupts are cleared and necessary resets are performed. In addition, in the RXFCG case,
- * received frame information and frame control are read before calling the callback. If double buffering is activated, it
- * will also toggle between reception buffers once the reception callback processing has ended.
+ * API to rebuild the per event callback arrays from interface_cbs. Only handlers that are set are
+ * entered, so dispatch is a loop over the array without NULL checks. With more interfaces than
+ * DW1000_CBS_TABLE_MAX the table is marked overflowed and dispatch walks the list instead.
  *
- * @param ev  Pointer to the queue of events.
+ * @param inst  Pointer to dw1000_dev_instance_t.
  * @return void
+ */
+void
+dw1000_mac_cbs_rebuild(dw1000_dev_instance_t * inst)
+{
+    struct dw1000_cbs_table * t = &inst->cbs_table;
+    struct uwb_mac_interface * cbs;
+    os_sr_t sr;
+
+    DPL_ENTER_CRITICAL(sr);
+    t->built = t->gen;
+    memset(t->num, 0, sizeof(t->num));
+    t->nifaces = 0;
+    t->overflow = 0;
+    SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next) {
+        if (t->nifaces == MYNEWT_VAL(DW1000_CBS_TABLE_MAX)) {
+            /* Each interface adds at most one handler per event, so only the interface count can overflow */
+            memset(t->num, 0, sizeof(t->num));
+            t->overflow = 1;
+            break;
+        }
+        t->nifaces++;
+        CBS_TABLE_ADD(RX_COMPLETE, rx_complete_cb);
+        CBS_TABLE_ADD(TX_BEGINS, tx_begins_cb);
+        CBS_TABLE_ADD(TX_COMPLETE, tx_complete_cb);
+        CBS_TABLE_ADD(RX_TIMEOUT, rx_timeout_cb);
+        CBS_TABLE_ADD(RX_ERROR, rx_error_cb);
+        CBS_TABLE_ADD(RESET, reset_cb);
+        CBS_TABLE_ADD(SLEEP, sleep_cb);
+        CBS_TABLE_ADD(CIR_COMPLETE, cir_complete_cb);
+    }
+    DPL_EXIT_CRITICAL(sr);
+}
+
+/**
+ * API to append a mac interface and rebuild the callback table.
  *
+ * @param inst  Pointer to dw1000_dev_instance_t.
+ * @param cbs   Pointer to the interface.
+ * @return struct uwb_dev *
  */
-static void
-dw1000_interrupt_ev_cb(struct dpl_event *ev)
+struct uwb_dev *
+dw1000_mac_append_interface(dw1000_dev_instance_t * inst, struct uwb_mac_interface * cbs)
 {
-    uint16_t finfo;
-    struct uwb_mac_interface * cbs = NULL;
-    dw1000_dev_instance_t * inst = dpl_event_get_arg(ev);
-    dpl_error_t err = dpl_sem_pend(&inst->uwb_dev.irq_sem,  DPL_TIMEOUT_NEVER);
-    if (err != DPL_OK) {
-        inst->uwb_dev.status.sem_error = 1;
-        goto sem_error_exit;
-    }
+    struct uwb_dev * udev = uwb_mac_append_interface(&inst->uwb_dev, cbs);
+    dw1000_mac_cbs_rebuild(inst);
+    return udev;
+}
 
-    /* Read status register */
-#if MYNEWT_VAL(DW1000_SYS_STATUS_BACKTRACE_LEN)
-    {
-        uint32_t irq_utime = dpl_cputime_get32();
+/**
+ * API to remove a mac interface and rebuild the callback table.
+ *
+ * @param inst  Pointer to dw1000_dev_instance_t.
+ * @param id    Extension id of the interface.
+ * @return void
+ */
+void
+dw1000_mac_remove_interface(dw1000_dev_instance_t * inst, uwb_extension_id_t id)
+{
+    uwb_mac_remove_interface(&inst->uwb_dev, id);
+    dw1000_mac_cbs_rebuild(inst);
+}
 #endif
-        inst->sys_status = dw1000_read_reg(inst, SYS_STATUS_ID, 0, sizeof(uint32_t));
-        /* Check for higher status bits only if needed */
-        if (!(inst->sys_status & (SYS_MASK_MCPLOCK | SYS_MASK_MRXDFR | SYS_MASK_MLDEERR | SYS_MASK_MTXFRB | SYS_MASK_MTXFRS | SYS_MASK_ALL_RX_TO | SYS_MASK_ALL_RX_ERR | SYS_MASK_MTXBERR))) {
-            inst->sys_status_hi = dw1000_read_reg(inst, SYS_STATUS_ID, 4, sizeof(uint8_t));
+
+/*
+ * The uwb core list mutators, wrapped with -Wl,--wrap so every change to interface_cbs bumps the
+ * callback table generation whoever makes it. The dw1000 is the only uwb device in the build.
+ */
+struct uwb_dev * __real_uwb_mac_append_interface(struct uwb_dev * dev, struct uwb_mac_interface * cbs);
+void __real_uwb_mac_remove_interface(struct uwb_dev * dev, uwb_extension_id_t id);
+
+struct uwb_dev *
+__wrap_uwb_mac_append_interface(struct uwb_dev * dev, struct uwb_mac_interface * cbs)
+{
+    struct uwb_dev * udev = __real_uwb_mac_append_interface(dev, cbs);
+#if MYNEWT_VAL(DW1000_CBS_TABLE_ENABLED)
+    ((dw1000_dev_instance_t *)dev)->cbs_table.gen++;
+#endif
+    return udev;
+}
+
+void
+__wrap_uwb_mac_remove_interface(struct uwb_dev * dev, uwb_extension_id_t id)
+{
+    __real_uwb_mac_remove_interface(dev, id);
+#if MYNEWT_VAL(DW1000_CBS_TABLE_ENABLED)
+    ((dw1000_dev_instance_t *)dev)->cbs_table.gen++;
+#endif
+}
+
+
+/*
+ * Interrupt events, in the order they are handled. Each event has a handler in
+ * dw1000_irq_handlers, a handler returning false skips the remaining events.
+ */
+#define DW1000_IRQ_EV_RX_GOOD       (1UL << 0)  //!< RXFCG, frame received
+#define DW1000_IRQ_EV_TX_BEGINS     (1UL << 1)  //!< TXFRB, transmission started
+#define DW1000_IRQ_EV_TX_DONE       (1UL << 2)  //!< TXFRS, frame sent
+#define DW1000_IRQ_EV_TXBUF_ERR     (1UL << 3)  //!< TXBERR, transmit buffer error
+#define DW1000_IRQ_EV_LDE_ERR       (1UL << 4)  //!< LDEERR, leading edge detection error
+#define DW1000_IRQ_EV_RX_TIMEOUT    (1UL << 5)  //!< RXRFTO/RXPTO
+#define DW1000_IRQ_EV_RX_ERROR      (1UL << 6)  //!< RXPHE/RXFCE/RXRFSL/RXOVRR/RXSFDTO/AFFREJ/RXRSCS
+#define DW1000_IRQ_EV_STATUS_CLR    (1UL << 7)  //!< One or more of SLP2INIT, CLKPLL_LL and MCPLOCK to clear
+#define DW1000_IRQ_EV_CLKPLL_LL     (1UL << 8)  //!< Clock PLL losing lock
+#define DW1000_IRQ_EV_WAKEUP        (1UL << 9)  //!< MCPLOCK, awake from sleep
+#define DW1000_IRQ_EV_NUM           (10)
+
+#if MYNEWT_VAL(DW1000_MAC_LATENCY)
+#if DW1000_IRQ_EV_NUM != DW1000_MAC_LAT_EVENTS
+#error "DW1000_MAC_LAT_EVENTS has to match DW1000_IRQ_EV_NUM"
+#endif
+const char * const dw1000_mac_lat_event_names[DW1000_MAC_LAT_EVENTS] = {
+    "rx_good", "tx_begins", "tx_done", "txbuf_err", "lde_err",
+    "rx_timeout", "rx_error", "status_clr", "clkpll_ll", "wakeup"
+};
+#endif
+
+/* Status bits cleared with a single write after the rx timeout and error handlers, as the separate
+ * writes were. Nothing touches the device between them */
+#define DW1000_IRQ_STATUS_CLR_MASK  (SYS_STATUS_SLP2INIT | SYS_STATUS_CLKPLL_LL | SYS_MASK_MCPLOCK)
+
+/**
+ * Classify the status registers into interrupt events.
+ *
+ * @param status     SYS_STATUS low word.
+ * @param status_hi  SYS_STATUS high byte.
+ * @return uint32_t  DW1000_IRQ_EV_* bitmask
+ */
+static inline uint32_t
+dw1000_irq_classify(uint32_t status, uint8_t status_hi)
+{
+    uint32_t events = 0;
+
+    if (status & SYS_STATUS_RXFCG)          events |= DW1000_IRQ_EV_RX_GOOD;
+    if (status & SYS_STATUS_TXFRB)          events |= DW1000_IRQ_EV_TX_BEGINS;
+    if (status & SYS_STATUS_TXFRS)          events |= DW1000_IRQ_EV_TX_DONE;
+    if (status & SYS_STATUS_TXBERR)         events |= DW1000_IRQ_EV_TXBUF_ERR;
+    if (status & SYS_STATUS_LDEERR)         events |= DW1000_IRQ_EV_LDE_ERR;
+    if (status & SYS_STATUS_ALL_RX_TO)      events |= DW1000_IRQ_EV_RX_TIMEOUT;
+    if ((status & SYS_STATUS_ALL_RX_ERR) || (status_hi & (SYS_STATUS_RXRSCS>>32)))
+                                            events |= DW1000_IRQ_EV_RX_ERROR;
+    if (status & DW1000_IRQ_STATUS_CLR_MASK) events |= DW1000_IRQ_EV_STATUS_CLR;
+    if (status & SYS_STATUS_CLKPLL_LL)      events |= DW1000_IRQ_EV_CLKPLL_LL;
+    if (status & SYS_MASK_MCPLOCK)          events |= DW1000_IRQ_EV_WAKEUP;
+    return events;
+}
+
+#if MYNEWT_VAL(DW1000_MAC_LATENCY)
+static void
+dw1000_mac_lat_rxcb(dw1000_dev_instance_t * inst, uint16_t id, uint32_t ticks)
+{
+    struct dw1000_mac_latency * lat = &inst->lat;
+    uint8_t i;
+
+    for (i = 0; i < lat->nrxcb; i++) {
+        if (lat->rxcb[i].id == id) {
+            break;
         }
+    }
+    if (i == lat->nrxcb) {
+        if (i == MYNEWT_VAL(DW1000_MAC_LATENCY_RXCB_MAX)) {
+            return;
+        }
+        lat->rxcb[lat->nrxcb++].id = id;
+    }
+    dw1000_mac_lat_add(&lat->rxcb[i].hist, ticks);
+}
 
-#if MYNEWT_VAL(DW1000_SYS_STATUS_BACKTRACE_LEN)
-        if(!inst->sys_status_bt_lock) {
-            DW1000_SYS_STATUS_BT_ADD(inst, inst->sys_status, irq_utime);
-#if MYNEWT_VAL(DW1000_SYS_STATUS_BACKTRACE_HI)
-            DW1000_SYS_STATUS_BT_HI(inst, inst->sys_status_hi);
+/* rx_complete dispatch with each callback timed */
+static void
+dw1000_mac_lat_rx_complete(dw1000_dev_instance_t * inst)
+{
+    uint32_t t0;
+    struct uwb_mac_interface * cbs;
+#if MYNEWT_VAL(DW1000_CBS_TABLE_ENABLED)
+    const struct dw1000_cbs_entry * e = inst->cbs_table.ent[DW1000_CBS_RX_COMPLETE];
+    const struct dw1000_cbs_entry * end = e + inst->cbs_table.num[DW1000_CBS_RX_COMPLETE];
+
+    if (!inst->cbs_table.overflow) {
+        for (; e < end; e++) {
+            t0 = dpl_cputime_get32();
+            e->cb((struct uwb_dev *)inst, e->cbs);
+            dw1000_mac_lat_rxcb(inst, e->cbs->id, dpl_cputime_get32() - t0);
+        }
+        return;
+    }
 #endif
+
+    SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next) {
+        if (cbs->rx_complete_cb) {
+            t0 = dpl_cputime_get32();
+            cbs->rx_complete_cb((struct uwb_dev *)inst, cbs);
+            dw1000_mac_lat_rxcb(inst, cbs->id, dpl_cputime_get32() - t0);
         }
     }
+}
 #endif
 
-    // Set status flags
-    inst->uwb_dev.status.rx_error = (inst->sys_status & SYS_STATUS_ALL_RX_ERR) !=0;
-    inst->uwb_dev.status.rx_error |= (inst->sys_status_hi & (SYS_STATUS_RXRSCS>>32)) != 0;
-    inst->uwb_dev.status.rx_autoframefilt_rej = (inst->sys_status & SYS_STATUS_AFFREJ) !=0;
-    inst->uwb_dev.status.rx_timeout_error = (inst->sys_status & SYS_STATUS_ALL_RX_TO) !=0;
-    inst->uwb_dev.status.lde_error = (inst->sys_status & SYS_STATUS_LDEDONE) == 0;
-    inst->uwb_dev.status.overrun_error = (inst->sys_status & SYS_STATUS_RXOVRR) != 0;
-    inst->uwb_dev.status.txbuf_error = (inst->sys_status & SYS_STATUS_TXBERR) != 0;
-    inst->uwb_dev.status.autoack_triggered = (inst->sys_status & SYS_STATUS_AAT) != 0;
-    inst->uwb_dev.status.rx_prej = (inst->sys_status_hi & (SYS_STATUS_RXPREJ>>32)) != 0;
+/* Frame received with good CRC */
+static bool
+dw1000_irq_rx_good(dw1000_dev_instance_t * inst)
+{
+    uint16_t finfo;
 
-    /* Clear tx_sem unless this is a TXFRB and not TXFRS */
-    if(dpl_sem_get_count(&inst->tx_sem) == 0 && !(
-           (inst->sys_status & SYS_STATUS_TXFRB) != 0 &&
-           (inst->sys_status & SYS_STATUS_TXFRS) == 0
-           )) {
-        dpl_error_t err = dpl_sem_release(&inst->tx_sem);
-        assert(err == DPL_OK);
-    }
+    MAC_STATS_INC(DFR_cnt);
 
-    // leading edge detection complete
-    if((inst->sys_status & SYS_STATUS_RXFCG)){
-        MAC_STATS_INC(DFR_cnt);
+#if MYNEWT_VAL(DW1000_LPL_ENABLED)
+    // A wake-up frame, drop out of low-power listening before any status bits are cleared
+    if (inst->control.lpl_enabled) {
+        dw1000_lpl_detected(inst);
+    }
+#endif
 
-        if (inst->uwb_dev.status.overrun_error){
-            MAC_STATS_INC(ROV_err);
-            /* Overrun flag has been set */
-            dw1000_write_reg(inst, SYS_STATUS_ID, 0, (SYS_STATUS_RXOVRR |SYS_STATUS_LDEDONE | SYS_STATUS_RXDFR | SYS_STATUS_RXFCG | SYS_STATUS_RXFCE | SYS_STATUS_RXDFR), sizeof(uint32_t));
-            dw1000_phy_forcetrxoff(inst);
-            dw1000_phy_rx_reset(inst);
-            dw1000_sync_rxbufptrs(inst);
-            dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET+1, SYS_CTRL_RXENAB>>8, sizeof(uint8_t));
-            goto early_exit;
-        }
+    if (inst->uwb_dev.status.overrun_error){
+        MAC_STATS_INC(ROV_err);
+        /* Overrun flag has been set */
+        dw1000_write_reg(inst, SYS_STATUS_ID, 0, (SYS_STATUS_RXOVRR |SYS_STATUS_LDEDONE | SYS_STATUS_RXDFR | SYS_STATUS_RXFCG | SYS_STATUS_RXFCE | SYS_STATUS_RXDFR), sizeof(uint32_t));
+        dw1000_phy_forcetrxoff(inst);
+        dw1000_phy_rx_reset(inst);
+        dw1000_sync_rxbufptrs(inst);
+        dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET+1, SYS_CTRL_RXENAB>>8, sizeof(uint8_t));
+        return false;
+    }
 
-        // The DW1000 has a bug that render the hardware auto_enable feature useless when used in conjunction with the double buffering.
-        // Consequently, we reenable the transeiver in the MAC-layer as early as possable. Note: The default behavior of MAC-Layer
-        // is that the transceiver only returns to the IDLE state with a timeout event occured. The MAC-layer should otherwise reenable.
+    // The DW1000 has a bug that render the hardware auto_enable feature useless when used in conjunction with the double buffering.
+    // Consequently, we reenable the transeiver in the MAC-layer as early as possable. Note: The default behavior of MAC-Layer
+    // is that the transceiver only returns to the IDLE state with a timeout event occured. The MAC-layer should otherwise reenable.
 
-        if (inst->uwb_dev.config.rxauto_enable == 0 && inst->uwb_dev.config.dblbuffon_enabled) {
-            if (inst->control.rxauto_disable == false && !inst->uwb_dev.status.autoack_triggered) {
-                dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET+1, SYS_CTRL_RXENAB>>8, sizeof(uint8_t));
-                inst->uwb_dev.status.rx_restarted = 1;
-            }
-            inst->control.rxauto_disable = false;
+    if (inst->uwb_dev.config.rxauto_enable == 0 && inst->uwb_dev.config.dblbuffon_enabled) {
+        if (inst->control.rxauto_disable == false && !inst->uwb_dev.status.autoack_triggered) {
+            dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET+1, SYS_CTRL_RXENAB>>8, sizeof(uint8_t));
+            inst->uwb_dev.status.rx_restarted = 1;
         }
+        inst->control.rxauto_disable = false;
+    }
 
-        /* Read frame info - Only the first two bytes of the register are used here. */
-        finfo = dw1000_read_reg(inst, RX_FINFO_ID, RX_FINFO_OFFSET, sizeof(uint16_t));
-        /* Report frame length - Standard frame length up to 127,
-         * extended frame length up to 1023 bytes */
-        inst->uwb_dev.frame_len = (finfo & RX_FINFO_RXFL_MASK_1023);
+    /* Read frame info - Only the first two bytes of the register are used here. */
+    finfo = dw1000_read_reg(inst, RX_FINFO_ID, RX_FINFO_OFFSET, sizeof(uint16_t));
+    /* Report frame length - Standard frame length up to 127,
+     * extended frame length up to 1023 bytes */
+    inst->uwb_dev.frame_len = (finfo & RX_FINFO_RXFL_MASK_1023);
 
-        /* Remove the two appended CRC bytes from frame if data is present */
-        if (inst->uwb_dev.frame_len) inst->uwb_dev.frame_len -= 2;
+    /* Remove the two appended CRC bytes from frame if data is present */
+    if (inst->uwb_dev.frame_len) inst->uwb_dev.frame_len -= 2;
 
-        /* Read the whole frame */
-        dw1000_read_rx(inst, inst->uwb_dev.rxbuf, 0,
-                       (inst->uwb_dev.frame_len < inst->uwb_dev.rxbuf_size) ?
-                       inst->uwb_dev.frame_len : inst->uwb_dev.rxbuf_size);
+    /* Read the whole frame */
+#if MYNEWT_VAL(DW1000_RXRING_ENABLED)
+    {
+        uint16_t len = (inst->uwb_dev.frame_len < inst->uwb_dev.rxbuf_size) ?
+            inst->uwb_dev.frame_len : inst->uwb_dev.rxbuf_size;
+        MAC_STATS_INCN(rx_bytes, len);
+        dw1000_rxring_read(inst, len);
+    }
+#else
+    dw1000_read_rx(inst, inst->uwb_dev.rxbuf, 0,
+                   (inst->uwb_dev.frame_len < inst->uwb_dev.rxbuf_size) ?
+                   inst->uwb_dev.frame_len : inst->uwb_dev.rxbuf_size);
+#endif
 
-        /* First two bytes are frame ctrl */
-        inst->uwb_dev.fctrl = ((uint16_t)inst->uwb_dev.rxbuf[1]<<8) | inst->uwb_dev.rxbuf[0];
+    /* First two bytes are frame ctrl */
+    inst->uwb_dev.fctrl = ((uint16_t)inst->uwb_dev.rxbuf[1]<<8) | inst->uwb_dev.rxbuf[0];
 
 #if MYNEWT_VAL(DW1000_SYS_STATUS_BACKTRACE_LEN)
-        if(!inst->sys_status_bt_lock) {
-            DW1000_SYS_STATUS_BT_FCTRL(inst, inst->uwb_dev.fctrl);
-        }
+    if(!inst->sys_status_bt_lock) {
+        DW1000_SYS_STATUS_BT_FCTRL(inst, inst->uwb_dev.fctrl);
+    }
 #endif
 
-        if (inst->uwb_dev.status.lde_error) // retest lde_error condition
-            inst->uwb_dev.status.lde_error = (dw1000_read_reg(inst, SYS_STATUS_ID, 1, sizeof(uint8_t))  & (SYS_STATUS_LDEDONE >> 8)) == 0;
-        if (inst->uwb_dev.status.lde_error) // LDE error or LDE late
-            MAC_STATS_INC(LDE_err);
-
-        inst->uwb_dev.rxtimestamp = dw1000_read_rxtime(inst);
-        if (inst->control.abs_timeout) {
-            update_rx_window_timeout(inst, inst->uwb_dev.rxtimestamp);
-        }
+    if (inst->uwb_dev.status.lde_error) // retest lde_error condition
+        inst->uwb_dev.status.lde_error = (dw1000_read_reg(inst, SYS_STATUS_ID, 1, sizeof(uint8_t))  & (SYS_STATUS_LDEDONE >> 8)) == 0;
+    if (inst->uwb_dev.status.lde_error) // LDE error or LDE late
+        MAC_STATS_INC(LDE_err);
 
-        if (inst->uwb_dev.status.autoack_triggered) {
-            /* Because of a previous frame not being received properly, AAT bit can be set upon the proper reception of a frame not requesting for
-             * acknowledgement (ACK frame is not actually sent though). If the AAT bit is set, check ACK request bit in frame control to confirm (this
-             * implementation works only for IEEE802.15.4-2011 compliant frames).
-             * This issue is not documented at the time of writing this code. It should be in next release of DW1000 User Manual (v2.09, from July 2016). */
-            if ((inst->uwb_dev.fctrl & UWB_FCTRL_ACK_REQUESTED) == 0){
-                /* Clear AAT status bit in callback data register copy and status */
-                dw1000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_AAT, sizeof(uint8_t));
-                inst->sys_status &= ~SYS_STATUS_AAT;
-                inst->uwb_dev.status.autoack_triggered = 0;
-            } else {
-                /* Clear RX flags in sys_status */
-                dw1000_write_reg(inst, SYS_STATUS_ID, 1, (inst->sys_status&(SYS_STATUS_LDEDONE | SYS_STATUS_RXDFR | SYS_STATUS_RXFCG | SYS_STATUS_RXFCE | SYS_STATUS_RXDFR))>>8, sizeof(uint8_t));
-            }
+    inst->uwb_dev.rxtimestamp = dw1000_read_rxtime(inst);
+    if (inst->control.abs_timeout) {
+        update_rx_window_timeout(inst, inst->uwb_dev.rxtimestamp);
+    }
+
+    if (inst->uwb_dev.status.autoack_triggered) {
+        /* Because of a previous frame not being received properly, AAT bit can be set upon the proper reception of a frame not requesting for
+         * acknowledgement (ACK frame is not actually sent though). If the AAT bit is set, check ACK request bit in frame control to confirm (this
+         * implementation works only for IEEE802.15.4-2011 compliant frames).
+         * This issue is not documented at the time of writing this code. It should be in next release of DW1000 User Manual (v2.09, from July 2016). */
+        if ((inst->uwb_dev.fctrl & UWB_FCTRL_ACK_REQUESTED) == 0){
+            /* Clear AAT status bit in callback data register copy and status */
+            dw1000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_AAT, sizeof(uint8_t));
+            inst->sys_status &= ~SYS_STATUS_AAT;
+            inst->uwb_dev.status.autoack_triggered = 0;
+        } else {
+            /* Clear RX flags in sys_status */
+            dw1000_write_reg(inst, SYS_STATUS_ID, 1, (inst->sys_status&(SYS_STATUS_LDEDONE | SYS_STATUS_RXDFR | SYS_STATUS_RXFCG | SYS_STATUS_RXFCE | SYS_STATUS_RXDFR))>>8, sizeof(uint8_t));
         }
+    }
 
-        // Collect RX Frame Quality diagnositics
-        if(inst->uwb_dev.config.rxdiag_enable)
-            dw1000_read_rxdiag(inst, &inst->rxdiag);
+    // Collect RX Frame Quality diagnositics
+    if(inst->uwb_dev.config.rxdiag_enable)
+        dw1000_read_rxdiag(inst, &inst->rxdiag);
+#if MYNEWT_VAL(DW1000_CIRSTREAM_ENABLED)
+    dw1000_cirstream_capture(inst);
+#endif
+#if MYNEWT_VAL(DW1000_NLOS_ENABLED)
+    dw1000_nlos_update(inst);
+#endif
 
-        // Toggle the Host side Receive Buffer Pointer
-        if (inst->uwb_dev.config.dblbuffon_enabled) {
-            // The rxttcko is a poor replacement for the carrier_integrator but
-            // better than nothing
-            if (inst->uwb_dev.config.rxttcko_enable) {
-                inst->uwb_dev.rxttcko = dw1000_read_time_tracking_offset(inst);
-            }
+    // Toggle the Host side Receive Buffer Pointer
+    if (inst->uwb_dev.config.dblbuffon_enabled) {
+        // The rxttcko is a poor replacement for the carrier_integrator but
+        // better than nothing
+        if (inst->uwb_dev.config.rxttcko_enable) {
+            inst->uwb_dev.rxttcko = dw1000_read_time_tracking_offset(inst);
+        }
 
-            inst->uwb_dev.status.overrun_error = dw1000_checkoverrun(inst);
-            if (inst->uwb_dev.status.overrun_error == 0) {
-                /* Check where the receiver is at, and if it's in the same buffer as we are,
-                 * mask out interrupt flags to avoid spurious interrupts when clearing status bits */
-                if (inst->uwb_dev.config.rxauto_enable) {
-                    if (dw1000_ic_and_host_ptrs_equal(inst)) {
-                        uint8_t mask = dw1000_read_reg(inst, SYS_MASK_ID, 1 , sizeof(uint8_t));
-                        dw1000_write_reg(inst, SYS_MASK_ID, 1, 0, sizeof(uint8_t));
-                        dw1000_write_reg(inst, SYS_STATUS_ID, 1, (inst->sys_status&(SYS_STATUS_LDEDONE | SYS_STATUS_RXDFR | SYS_STATUS_RXFCG | SYS_STATUS_RXFCE | SYS_STATUS_RXDFR))>>8, sizeof(uint8_t));
-                        dw1000_write_reg(inst, SYS_MASK_ID, 1, mask, sizeof(uint8_t));
-                    } else {
-                        dw1000_write_reg(inst, SYS_STATUS_ID, 1, (inst->sys_status&(SYS_STATUS_LDEDONE | SYS_STATUS_RXDFR | SYS_STATUS_RXFCG | SYS_STATUS_RXFCE | SYS_STATUS_RXDFR))>>8, sizeof(uint8_t));
-                    }
+        inst->uwb_dev.status.overrun_error = dw1000_checkoverrun(inst);
+        if (inst->uwb_dev.status.overrun_error == 0) {
+            /* Check where the receiver is at, and if it's in the same buffer as we are,
+             * mask out interrupt flags to avoid spurious interrupts when clearing status bits */
+            if (inst->uwb_dev.config.rxauto_enable) {
+                if (dw1000_ic_and_host_ptrs_equal(inst)) {
+                    uint8_t mask = dw1000_read_reg(inst, SYS_MASK_ID, 1 , sizeof(uint8_t));
+                    dw1000_write_reg(inst, SYS_MASK_ID, 1, 0, sizeof(uint8_t));
+                    dw1000_write_reg(inst, SYS_STATUS_ID, 1, (inst->sys_status&(SYS_STATUS_LDEDONE | SYS_STATUS_RXDFR | SYS_STATUS_RXFCG | SYS_STATUS_RXFCE | SYS_STATUS_RXDFR))>>8, sizeof(uint8_t));
+                    dw1000_write_reg(inst, SYS_MASK_ID, 1, mask, sizeof(uint8_t));
+                } else {
+                    dw1000_write_reg(inst, SYS_STATUS_ID, 1, (inst->sys_status&(SYS_STATUS_LDEDONE | SYS_STATUS_RXDFR | SYS_STATUS_RXFCG | SYS_STATUS_RXFCE | SYS_STATUS_RXDFR))>>8, sizeof(uint8_t));
                 }
-                /* Swap buffers */
-                dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_HRBT_OFFSET , 0b1, sizeof(uint8_t));
-            }else{
-                MAC_STATS_INC(ROV_err);
-                /* Overrun flag has been set, reset receiver and realign buffers */
-                dw1000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_RXOVRR, sizeof(uint32_t));
-                dw1000_phy_forcetrxoff(inst);
-                dw1000_phy_rx_reset(inst);
-                dw1000_sync_rxbufptrs(inst);
-                dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET+1, SYS_CTRL_RXENAB>>8, sizeof(uint8_t));
             }
+            /* Swap buffers */
+            dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_HRBT_OFFSET , 0b1, sizeof(uint8_t));
         }else{
-            // carrier_integrator only avilable while in single buffer mode.
-            inst->uwb_dev.carrier_integrator = dw1000_read_carrier_integrator(inst);
+            MAC_STATS_INC(ROV_err);
+            /* Overrun flag has been set, reset receiver and realign buffers */
+            dw1000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_RXOVRR, sizeof(uint32_t));
+            dw1000_phy_forcetrxoff(inst);
+            dw1000_phy_rx_reset(inst);
+            dw1000_sync_rxbufptrs(inst);
+            dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET+1, SYS_CTRL_RXENAB>>8, sizeof(uint8_t));
+        }
+    }else{
+        // carrier_integrator only avilable while in single buffer mode.
+        inst->uwb_dev.carrier_integrator = dw1000_read_carrier_integrator(inst);
 #if MYNEWT_VAL(CIR_ENABLED)
-            // Call CIR complete calbacks if present
-            if(inst->uwb_dev.config.cir_enable || inst->control.cir_enable) {
-                if(!(SLIST_EMPTY(&inst->uwb_dev.interface_cbs))) {
-                    SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next) {
-                        if (cbs != NULL && cbs->cir_complete_cb) {
-                            if(cbs->cir_complete_cb((struct uwb_dev*)inst,cbs)) continue;
-                        }
-                    }
-                }
-                inst->control.cir_enable = false;
-            }
+        // Call CIR complete calbacks if present
+        if(inst->uwb_dev.config.cir_enable || inst->control.cir_enable) {
+            DW1000_MAC_CBS_DISPATCH(inst, CIR_COMPLETE, cir_complete_cb, false);
+            inst->control.cir_enable = false;
+        }
 #endif
-            dw1000_write_reg(inst, SYS_STATUS_ID, 0,
-                             inst->sys_status & (SYS_STATUS_LDEDONE | SYS_STATUS_RXPHD | SYS_STATUS_RXDFR |
-                                                 SYS_STATUS_RXFCG | SYS_STATUS_RXFCE | SYS_STATUS_RXDFR),
-                             sizeof(uint16_t));
-            if (inst->control.rxauto_disable == false){
-                dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET+1, SYS_CTRL_RXENAB>>8, sizeof(uint8_t));
-                inst->uwb_dev.status.rx_restarted = 1;
-            }
-            inst->control.rxauto_disable = false;
-
+        dw1000_write_reg(inst, SYS_STATUS_ID, 0,
+                         inst->sys_status & (SYS_STATUS_LDEDONE | SYS_STATUS_RXPHD | SYS_STATUS_RXDFR |
+                                             SYS_STATUS_RXFCG | SYS_STATUS_RXFCE | SYS_STATUS_RXDFR),
+                         sizeof(uint16_t));
+        if (inst->control.rxauto_disable == false){
+            dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET+1, SYS_CTRL_RXENAB>>8, sizeof(uint8_t));
+            inst->uwb_dev.status.rx_restarted = 1;
         }
+        inst->control.rxauto_disable = false;
 
-        // Call the corresponding frame services callback if present
-        if(!(SLIST_EMPTY(&inst->uwb_dev.interface_cbs))){
-            SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next){
-            if (cbs != NULL && cbs->rx_complete_cb)
-                if(cbs->rx_complete_cb((struct uwb_dev*)inst,cbs)) continue;
-            }
-        }
     }
 
-    // Handle TX Frame Begins
-    if(inst->sys_status & SYS_STATUS_TXFRB) {
-        // Call the corresponding callback if present
-        dw1000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_TXFRB, sizeof(uint8_t)); // Clear TX Frame Begins
+#if MYNEWT_VAL(DW1000_XTAL_TRACK_ENABLED)
+    // Feed the clock offset of this frame to the crystal trim tracker
+    if (inst->control.xtal_track_enabled) {
+        dw1000_xtal_track_rx(inst);
+    }
+#endif
 
-        if(!(SLIST_EMPTY(&inst->uwb_dev.interface_cbs))){
-            SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next){
-            if (cbs!=NULL && cbs->tx_begins_cb)
-                if(cbs->tx_begins_cb((struct uwb_dev*)inst,cbs)) break;
-            }
-        }
+    // Call the corresponding frame services callback if present
+#if MYNEWT_VAL(DW1000_MAC_LATENCY)
+    dw1000_mac_lat_rx_complete(inst);
+#else
+    DW1000_MAC_CBS_DISPATCH(inst, RX_COMPLETE, rx_complete_cb, false);
+#endif
+    return true;
+}
+
+/* TX frame begins */
+static bool
+dw1000_irq_tx_begins(dw1000_dev_instance_t * inst)
+{
+    /* With the frame also sent clear all TX event bits now, rather than TXFRB here and the rest in tx_done */
+    if (inst->sys_status & SYS_STATUS_TXFRS) {
+        dw1000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_ALL_TX, sizeof(uint8_t));
+    } else {
+        dw1000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_TXFRB, sizeof(uint8_t)); // Clear TX Frame Begins
     }
 
-    // Handle TX confirmation event
-    if(inst->sys_status & SYS_STATUS_TXFRS) {
-        MAC_STATS_INC(TFG_cnt);
+    // Call the corresponding callback if present
+    DW1000_MAC_CBS_DISPATCH(inst, TX_BEGINS, tx_begins_cb, true);
+    return true;
+}
+
+/* TX confirmation */
+static bool
+dw1000_irq_tx_done(dw1000_dev_instance_t * inst)
+{
+    dpl_error_t err;
 
+    MAC_STATS_INC(TFG_cnt);
+
+    if (!(inst->sys_status & SYS_STATUS_TXFRB)) {
         dw1000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_ALL_TX, sizeof(uint8_t)); // Clear TX event bits
+    }
 
-        if (inst->control.abs_timeout) {
-            dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET+1, SYS_CTRL_RXENAB>>8, sizeof(uint8_t));
-            update_rx_window_timeout(inst, dw1000_read_txtime(inst));
-        }
+    if (inst->control.abs_timeout) {
+        dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET+1, SYS_CTRL_RXENAB>>8, sizeof(uint8_t));
+        update_rx_window_timeout(inst, dw1000_read_txtime(inst));
+    }
 
-        if(dpl_sem_get_count(&inst->tx_sem) == 0){
-            err = dpl_sem_release(&inst->tx_sem);
-            assert(err == DPL_OK);
-        }
+    if(dpl_sem_get_count(&inst->tx_sem) == 0){
+        err = dpl_sem_release(&inst->tx_sem);
+        assert(err == DPL_OK);
+    }
 
 #if MYNEWT_VAL(DW1000_SYS_STATUS_BACKTRACE_LEN)
-        if(!inst->sys_status_bt_lock && !inst->uwb_dev.status.autoack_triggered) {
-            /* Assuming the start_tx writes the fctrl at send time */
-            DW1000_SYS_STATUS_BT_FCTRL(inst, inst->uwb_dev.fctrl);
-        }
+    if(!inst->sys_status_bt_lock && !inst->uwb_dev.status.autoack_triggered) {
+        /* Assuming the start_tx writes the fctrl at send time */
+        DW1000_SYS_STATUS_BT_FCTRL(inst, inst->uwb_dev.fctrl);
+    }
 #endif
 
-        // Call the corresponding callback if present
-        if(!(SLIST_EMPTY(&inst->uwb_dev.interface_cbs))){
-            SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next){
-            if (cbs!=NULL && cbs->tx_complete_cb)
-                if(cbs->tx_complete_cb((struct uwb_dev*)inst,cbs)) break;
-            }
-        }
+    // Call the corresponding callback if present
+    DW1000_MAC_CBS_DISPATCH(inst, TX_COMPLETE, tx_complete_cb, true);
+    return true;
+}
+
+/* Tx buffer error */
+static bool
+dw1000_irq_txbuf_err(dw1000_dev_instance_t * inst)
+{
+    dpl_error_t err;
+
+    if (!inst->uwb_dev.status.txbuf_error) {
+        return true;
     }
-    // Tx buffer error
-    if(inst->uwb_dev.status.txbuf_error){
-        MAC_STATS_INC(TXBUF_err);
-        dw1000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_TXBERR, sizeof(uint32_t));
-        if(dpl_sem_get_count(&inst->tx_sem) == 0){
-            err = dpl_sem_release(&inst->tx_sem);
-            assert(err == DPL_OK);
-        }
+    MAC_STATS_INC(TXBUF_err);
+    dw1000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_TXBERR, sizeof(uint32_t));
+    if(dpl_sem_get_count(&inst->tx_sem) == 0){
+        err = dpl_sem_release(&inst->tx_sem);
+        assert(err == DPL_OK);
     }
+    return true;
+}
 
-    // leading edge detection complete
-    if(inst->sys_status & SYS_STATUS_LDEERR){
-        MAC_STATS_INC(LDE_err);
-        dw1000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_LDEERR, sizeof(uint32_t));
-    }
+/* Leading edge detection error */
+static bool
+dw1000_irq_lde_err(dw1000_dev_instance_t * inst)
+{
+    MAC_STATS_INC(LDE_err);
+    dw1000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_LDEERR, sizeof(uint32_t));
+    return true;
+}
 
-    // Handle frame reception/preamble detect timeout events
-    if(inst->uwb_dev.status.rx_timeout_error){
-        MAC_STATS_INC(RTO_cnt);
-        dw1000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_ALL_RX_TO, sizeof(uint32_t)); // Clear RX timeout event bits
+/* Frame reception/preamble detect timeout, the flag is rechecked as a callback may have restarted the receiver */
+static bool
+dw1000_irq_rx_timeout(dw1000_dev_instance_t * inst)
+{
+    if (!inst->uwb_dev.status.rx_timeout_error) {
+        return true;
+    }
+    MAC_STATS_INC(RTO_cnt);
+    dw1000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_ALL_RX_TO, sizeof(uint32_t)); // Clear RX timeout event bits
 
-        if (inst->control.abs_timeout) {
-            /* Absolute timeout active, reactivate receiver if there's still time left */
-            uint64_t systime = dw1000_read_systime(inst);
-            uint32_t new_timeout = calc_rx_window_timeout(systime, inst->uwb_dev.abs_timeout);
-            if (new_timeout > 1) {
-                dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET+1, SYS_CTRL_RXENAB>>8, sizeof(uint8_t));
-                dw1000_adj_rx_timeout(inst, new_timeout);
-            } else {
-                inst->control.abs_timeout = false;
-            }
+    if (inst->control.abs_timeout) {
+        /* Absolute timeout active, reactivate receiver if there's still time left */
+        uint64_t systime = dw1000_read_systime(inst);
+        uint32_t new_timeout = calc_rx_window_timeout(systime, inst->uwb_dev.abs_timeout);
+        if (new_timeout > 1) {
+            dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET+1, SYS_CTRL_RXENAB>>8, sizeof(uint8_t));
+            dw1000_adj_rx_timeout(inst, new_timeout);
+        } else {
+            inst->control.abs_timeout = false;
         }
+    }
 
-        if (!inst->control.abs_timeout) {
-            // Because of an issue with receiver restart after error conditions, an RX reset must be applied
-            // after any error or timeout event to ensure the next good frame's timestamp is computed correctly.
-            // See section "RX Message timestamp" in DW1000 User Manual.
-            dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET, (uint16_t)SYS_CTRL_TRXOFF, sizeof(uint16_t)) ; // Disable the radio
-            dw1000_phy_rx_reset(inst);
+    if (!inst->control.abs_timeout) {
+        // Because of an issue with receiver restart after error conditions, an RX reset must be applied
+        // after any error or timeout event to ensure the next good frame's timestamp is computed correctly.
+        // See section "RX Message timestamp" in DW1000 User Manual.
+        dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET, (uint16_t)SYS_CTRL_TRXOFF, sizeof(uint16_t)) ; // Disable the radio
+        dw1000_phy_rx_reset(inst);
 
-            inst->control.cir_enable = false;
-            inst->control.rxauto_disable = false;
-            inst->control.abs_timeout = false;
+        inst->control.cir_enable = false;
+        inst->control.rxauto_disable = false;
+        inst->control.abs_timeout = false;
 
-            // Call the corresponding frame services callback if present
-            if(!(SLIST_EMPTY(&inst->uwb_dev.interface_cbs))){
-                SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next){
-                    if (cbs!=NULL && cbs->rx_timeout_cb)
-                        if(cbs->rx_timeout_cb((struct uwb_dev*)inst,cbs)) continue;
-                }
-            }
-        }
+        // Call the corresponding frame services callback if present
+        DW1000_MAC_CBS_DISPATCH(inst, RX_TIMEOUT, rx_timeout_cb, false);
     }
+    return true;
+}
 
-    // Handle RX errors events
-    if(inst->uwb_dev.status.rx_error) {
-        MAC_STATS_INC(RX_err);
+/* RX errors */
+static bool
+dw1000_irq_rx_error(dw1000_dev_instance_t * inst)
+{
+    if (!inst->uwb_dev.status.rx_error) {
+        return true;
+    }
+    MAC_STATS_INC(RX_err);
 
-        // Because of an issue with receiver restart after error conditions, an RX reset must be applied after any error or timeout event to ensure
-        // the next good frame's timestamp is computed correctly.
-        // See section "RX Message timestamp" in DW1000 User Manual.
+    // Because of an issue with receiver restart after error conditions, an RX reset must be applied after any error or timeout event to ensure
+    // the next good frame's timestamp is computed correctly.
+    // See section "RX Message timestamp" in DW1000 User Manual.
 
-        dw1000_write_reg(inst, SYS_STATUS_ID, 0, (SYS_STATUS_ALL_RX_ERR), sizeof(uint32_t)); // Clear RX error event bits
+    dw1000_write_reg(inst, SYS_STATUS_ID, 0, (SYS_STATUS_ALL_RX_ERR), sizeof(uint32_t)); // Clear RX error event bits
 
-        if (inst->uwb_dev.config.dblbuffon_enabled && inst->uwb_dev.status.overrun_error) {
-            MAC_STATS_INC(ROV_err);
-            dw1000_phy_rx_reset(inst);
-            dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_HRBT_OFFSET, 0b1, sizeof(uint8_t));
-            dw1000_sync_rxbufptrs(inst);
-        } else {
-            dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET, (uint8_t) SYS_CTRL_TRXOFF, sizeof(uint8_t));
-            dw1000_phy_rx_reset(inst);
-        }
-        /* Restart the receiver even if rxauto is not enabled. Timeout remain active if set.
-         * NOTE: Because we reset the receiver explicitly above we will need to reenable
-         * the receiver even though the auto-enable is on. */
-        dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET+1, SYS_CTRL_RXENAB>>8, sizeof(uint8_t));
-        if (inst->control.abs_timeout) {
-            update_rx_window_timeout(inst, dw1000_read_systime(inst));
+    if (inst->uwb_dev.config.dblbuffon_enabled && inst->uwb_dev.status.overrun_error) {
+        MAC_STATS_INC(ROV_err);
+        dw1000_phy_rx_reset(inst);
+        dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_HRBT_OFFSET, 0b1, sizeof(uint8_t));
+        dw1000_sync_rxbufptrs(inst);
+    } else {
+        dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET, (uint8_t) SYS_CTRL_TRXOFF, sizeof(uint8_t));
+        dw1000_phy_rx_reset(inst);
+    }
+    /* Restart the receiver even if rxauto is not enabled. Timeout remain active if set.
+     * NOTE: Because we reset the receiver explicitly above we will need to reenable
+     * the receiver even though the auto-enable is on. */
+    dw1000_write_reg(inst, SYS_CTRL_ID, SYS_CTRL_OFFSET+1, SYS_CTRL_RXENAB>>8, sizeof(uint8_t));
+    if (inst->control.abs_timeout) {
+        update_rx_window_timeout(inst, dw1000_read_systime(inst));
+    }
+
+    // Call the corresponding frame services callback if present
+    DW1000_MAC_CBS_DISPATCH(inst, RX_ERROR, rx_error_cb, false);
+    return true;
+}
+
+/* SLP2INIT, CLKPLL_LL and MCPLOCK in one write */
+static bool
+dw1000_irq_status_clr(dw1000_dev_instance_t * inst)
+{
+    dw1000_write_reg(inst, SYS_STATUS_ID, 0, inst->sys_status & DW1000_IRQ_STATUS_CLR_MASK, sizeof(uint32_t));
+    return true;
+}
+
+/* Clock PLL losing lock */
+static bool
+dw1000_irq_clkpll_ll(dw1000_dev_instance_t * inst)
+{
+    MAC_STATS_INC(PLL_LL_err);
+    return true;
+}
+
+/* Wakeup from sleep */
+static bool
+dw1000_irq_wakeup(dw1000_dev_instance_t * inst)
+{
+    // restore antenna delay value, these are not preserved during sleep/deepsleep */
+    dw1000_phy_set_rx_antennadelay(inst, inst->uwb_dev.rx_antenna_delay);
+    dw1000_phy_set_tx_antennadelay(inst, inst->uwb_dev.tx_antenna_delay);
+
+    // Call the corresponding callback if present
+    inst->uwb_dev.status.sleeping = 0;
+    DW1000_MAC_CBS_DISPATCH(inst, SLEEP, sleep_cb, false);
+    return true;
+}
+
+static bool (* const dw1000_irq_handlers[DW1000_IRQ_EV_NUM])(dw1000_dev_instance_t *) = {
+    dw1000_irq_rx_good,
+    dw1000_irq_tx_begins,
+    dw1000_irq_tx_done,
+    dw1000_irq_txbuf_err,
+    dw1000_irq_lde_err,
+    dw1000_irq_rx_timeout,
+    dw1000_irq_rx_error,
+    dw1000_irq_status_clr,
+    dw1000_irq_clkpll_ll,
+    dw1000_irq_wakeup,
+};
+
+/**
+ * This is the DW1000's general Interrupt Service Routine. It will process/report the following events:
+ *          - RXFCG (through rx_complete_cb callback)
+ *          - TXFRS (through tx_complete_cb callback)
+ *          - RXRFTO/RXPTO (through rx_timeout_cb callback)
+ *          - RXPHE/RXFCE/RXRFSL/RXSFDTO/AFFREJ/LDEERR (through rx_error_cb cbRxErr)
+ * For all events, corresponding interrupts are cleared and necessary resets are performed. In addition, in the RXFCG case,
+ * received frame information and frame control are read before calling the callback. If double buffering is activated, it
+ * will also toggle between reception buffers once the reception callback processing has ended.
+ *
+ * The status word is classified once into DW1000_IRQ_EV_* events which are handled lowest bit first through
+ * dw1000_irq_handlers. An interrupt that is only a good frame goes straight to the rx handler.
+ *
+ * @param ev  Pointer to the queue of events.
+ * @return void
+ *
+ */
+static void
+dw1000_interrupt_ev_cb(struct dpl_event *ev)
+{
+    struct uwb_dev_status status;
+    uint32_t events;
+    dw1000_dev_instance_t * inst = dpl_event_get_arg(ev);
+#if MYNEWT_VAL(DW1000_MAC_LATENCY)
+    uint32_t t0 = dpl_cputime_get32();
+    /* Events requeued for a missed interrupt have no new irq time */
+    if (inst->uwb_dev.irq_at_ticks != inst->lat.irq_seen) {
+        inst->lat.irq_seen = inst->uwb_dev.irq_at_ticks;
+        dw1000_mac_lat_add(&inst->lat.irq, t0 - inst->uwb_dev.irq_at_ticks);
+    }
+#endif
+    dpl_error_t err = dpl_sem_pend(&inst->uwb_dev.irq_sem,  DPL_TIMEOUT_NEVER);
+    if (err != DPL_OK) {
+        inst->uwb_dev.status.sem_error = 1;
+        goto sem_error_exit;
+    }
+#if MYNEWT_VAL(DW1000_CBS_TABLE_ENABLED)
+    dw1000_mac_cbs_check(inst);
+#endif
+#if MYNEWT_VAL(DW1000_SPI_ARB_ENABLED)
+    dw1000_spi_arb_irq_task(inst);
+#endif
+
+    /* Read status register */
+#if MYNEWT_VAL(DW1000_SYS_STATUS_BACKTRACE_LEN)
+    {
+        uint32_t irq_utime = dpl_cputime_get32();
+#endif
+        inst->sys_status = dw1000_read_reg(inst, SYS_STATUS_ID, 0, sizeof(uint32_t));
+        /* Check for higher status bits only if needed */
+        if (!(inst->sys_status & (SYS_MASK_MCPLOCK | SYS_MASK_MRXDFR | SYS_MASK_MLDEERR | SYS_MASK_MTXFRB | SYS_MASK_MTXFRS | SYS_MASK_ALL_RX_TO | SYS_MASK_ALL_RX_ERR | SYS_MASK_MTXBERR))) {
+            inst->sys_status_hi = dw1000_read_reg(inst, SYS_STATUS_ID, 4, sizeof(uint8_t));
         }
 
-        // Call the corresponding frame services callback if present
-        if(!(SLIST_EMPTY(&inst->uwb_dev.interface_cbs))){
-            SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next){
-            if (cbs!=NULL && cbs->rx_error_cb)
-                if(cbs->rx_error_cb((struct uwb_dev*)inst,cbs)) continue;
-            }
+#if MYNEWT_VAL(DW1000_SYS_STATUS_BACKTRACE_LEN)
+        if(!inst->sys_status_bt_lock) {
+            DW1000_SYS_STATUS_BT_ADD(inst, inst->sys_status, irq_utime);
+#if MYNEWT_VAL(DW1000_SYS_STATUS_BACKTRACE_HI)
+            DW1000_SYS_STATUS_BT_HI(inst, inst->sys_status_hi);
+#endif
         }
     }
+#endif
 
-    /* Clear SLP2INIT event bits */
-    if(inst->sys_status & SYS_STATUS_SLP2INIT){
-        dw1000_write_reg(inst, SYS_STATUS_ID, 2, SYS_STATUS_SLP2INIT>>16, 1);
-    }
+    events = dw1000_irq_classify(inst->sys_status, inst->sys_status_hi);
+
+    // Set status flags, on a copy so the bitfield is stored once
+    status = inst->uwb_dev.status;
+    status.rx_error = (events & DW1000_IRQ_EV_RX_ERROR) != 0;
+    status.rx_autoframefilt_rej = (inst->sys_status & SYS_STATUS_AFFREJ) !=0;
+    status.rx_timeout_error = (events & DW1000_IRQ_EV_RX_TIMEOUT) != 0;
+    status.lde_error = (inst->sys_status & SYS_STATUS_LDEDONE) == 0;
+    status.overrun_error = (inst->sys_status & SYS_STATUS_RXOVRR) != 0;
+    status.txbuf_error = (events & DW1000_IRQ_EV_TXBUF_ERR) != 0;
+    status.autoack_triggered = (inst->sys_status & SYS_STATUS_AAT) != 0;
+    status.rx_prej = (inst->sys_status_hi & (SYS_STATUS_RXPREJ>>32)) != 0;
+    inst->uwb_dev.status = status;
 
-    // Handle sleep timer event
-    if(inst->sys_status & SYS_STATUS_CLKPLL_LL){
-        dw1000_write_reg(inst, SYS_STATUS_ID, 0, SYS_STATUS_CLKPLL_LL, sizeof(uint32_t));
-        MAC_STATS_INC(PLL_LL_err);
+    /* Clear tx_sem unless this is a TXFRB and not TXFRS */
+    if(dpl_sem_get_count(&inst->tx_sem) == 0 &&
+       (events & (DW1000_IRQ_EV_TX_BEGINS | DW1000_IRQ_EV_TX_DONE)) != DW1000_IRQ_EV_TX_BEGINS) {
+        dpl_error_t err = dpl_sem_release(&inst->tx_sem);
+        assert(err == DPL_OK);
     }
-    // Handle sleep timer event
-    if(inst->sys_status & SYS_MASK_MCPLOCK){
-        dw1000_write_reg(inst, SYS_STATUS_ID, 0, SYS_MASK_MCPLOCK, sizeof(uint32_t));
 
-        // restore antenna delay value, these are not preserved during sleep/deepsleep */
-        dw1000_phy_set_rx_antennadelay(inst, inst->uwb_dev.rx_antenna_delay);
-        dw1000_phy_set_tx_antennadelay(inst, inst->uwb_dev.tx_antenna_delay);
+    if (events == DW1000_IRQ_EV_RX_GOOD) {
+#if MYNEWT_VAL(DW1000_MAC_LATENCY)
+        t0 = dpl_cputime_get32();
+        dw1000_irq_rx_good(inst);
+        dw1000_mac_lat_add(&inst->lat.ev[0], dpl_cputime_get32() - t0);
+#else
+        dw1000_irq_rx_good(inst);
+#endif
+        goto early_exit;
+    }
 
-        // Call the corresponding callback if present
-        inst->uwb_dev.status.sleeping = 0;
-        if(!(SLIST_EMPTY(&inst->uwb_dev.interface_cbs))){
-            SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next){
-            if (cbs!=NULL && cbs->sleep_cb)
-                if (cbs->sleep_cb((struct uwb_dev*)inst,cbs)) continue;
-            }
+    while (events) {
+        uint32_t i = __builtin_ctz(events);
+        bool more;
+        events &= events - 1;
+#if MYNEWT_VAL(DW1000_MAC_LATENCY)
+        t0 = dpl_cputime_get32();
+        more = dw1000_irq_handlers[i](inst);
+        dw1000_mac_lat_add(&inst->lat.ev[i], dpl_cputime_get32() - t0);
+#else
+        more = dw1000_irq_handlers[i](inst);
+#endif
+        if (!more) {
+            break;
         }
     }
 
@@ -0,0 +1,278 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw1000_nlos.c
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief First path analysis
+ *
+ * @details dw1000_estimate_los only compares the first path and total rx power. Here a window of
+ * DW1000_NLOS_TAPS accumulator taps starting DW1000_NLOS_PRE taps ahead of the first path is read after the rx
+ * diagnostics of every good frame and three features of the channel are taken from it:
+ *
+ * - rise time, from the first path to the first tap reaching half the peak amplitude
+ * - the power ratio of the first path to the strongest tap
+ * - the mean excess delay, power weighted over the taps after the first path that are above the noise floor
+ *
+ * With a clear line of sight the first path is the strongest tap and the power arrives at once. When the direct
+ * path is attenuated it is weak against the reflections that follow, and the leading edge detector tends to fire
+ * late on a rising edge. Each feature is scored linearly between a los and an nlos threshold and the average is the
+ * nlos probability. The bias estimate is the mean excess delay scaled by that probability and DW1000_NLOS_BIAS_GAIN.
+ *
+ * Power is taken from the packed accumulator samples with one dual 16 bit multiply-accumulate per tap where the
+ * core has the DSP extension; everything is integer so it can run in the rx handler of every frame.
+ * tools/dw1000_nlos_bench.c runs the same analysis on captures from dw1000_cirstream.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#if defined(DW1000_NLOS_KERNEL_ONLY)
+#include <dw1000/dw1000_nlos.h>
+#define DW1000_NLOS_BUILD 1
+#else
+#include <dpl/dpl.h>
+#include <dw1000/dw1000_regs.h>
+#include <dw1000/dw1000_dev.h>
+#include <dw1000/dw1000_mac.h>
+#include <dw1000/dw1000_nlos.h>
+#if MYNEWT_VAL(DW1000_CIRSTREAM_ENABLED)
+#include <dw1000/dw1000_cirstream.h>
+#endif
+#define DW1000_NLOS_BUILD MYNEWT_VAL(DW1000_NLOS_ENABLED)
+#endif
+
+#if DW1000_NLOS_BUILD
+
+/* Power of a tap packed as real in the low and imag in the high half word */
+static inline uint32_t
+tap_pwr(uint32_t v)
+{
+#if defined(__ARM_FEATURE_DSP)
+    uint32_t p;
+    __asm__ ("smuad %0, %1, %1" : "=r" (p) : "r" (v));
+    return p;
+#else
+    int32_t re = (int16_t) v, im = (int16_t)(v >> 16);
+    return (uint32_t)(re * re) + (uint32_t)(im * im);
+#endif
+}
+
+static inline uint16_t
+score(int32_t x, int32_t los, int32_t nlos)
+{
+    int32_t s;
+
+    if (los == nlos) {
+        return 0;
+    }
+    s = (x - los) * DW1000_NLOS_ONE / (nlos - los);
+    return (s < 0) ? 0 : (s > DW1000_NLOS_ONE) ? DW1000_NLOS_ONE : s;
+}
+
+/**
+ * API to analyse an accumulator window.
+ *
+ * @param params  Thresholds.
+ * @param cir     Taps, real in the low and imag in the high 16 bits.
+ * @param ntaps   Number of taps, up to DW1000_NLOS_MAX_TAPS.
+ * @param fp      First path index relative to cir[0] in 1/64 tap.
+ * @param noise   Tap power below which a tap is noise.
+ * @param r       Result.
+ * @return void
+ */
+void
+dw1000_nlos_analyse(const struct dw1000_nlos_params * params, const uint32_t * cir, uint16_t ntaps,
+                    uint16_t fp, uint32_t noise, struct dw1000_nlos_result * r)
+{
+    uint32_t pwr[DW1000_NLOS_MAX_TAPS];
+    uint32_t peak = 0, p_fp, w, den = 0;
+    uint64_t num = 0, bias;
+    uint16_t i, pk = 0, fp_tap = fp >> 6;
+
+    assert(ntaps <= DW1000_NLOS_MAX_TAPS);
+    if (fp_tap + 1 >= ntaps) {
+        memset(r, 0, sizeof(struct dw1000_nlos_result));
+        return;
+    }
+
+    for (i = 0; i < ntaps; i++) {
+        pwr[i] = tap_pwr(cir[i]);
+    }
+    for (i = fp_tap; i < ntaps; i++) {
+        if (pwr[i] > peak) {
+            peak = pwr[i];
+            pk = i;
+        }
+    }
+    if (peak == 0) {
+        memset(r, 0, sizeof(struct dw1000_nlos_result));
+        return;
+    }
+
+    /* The first path amplitude of the rx diagnostics is taken at floor(fp) + 1 */
+    p_fp = pwr[fp_tap + 1] > pwr[fp_tap] ? pwr[fp_tap + 1] : pwr[fp_tap];
+    r->ratio = (p_fp >= peak) ? DW1000_NLOS_ONE : (uint16_t)(((uint64_t) p_fp << 8) / peak);
+
+    r->rise = 0;
+    for (i = fp_tap; i <= pk; i++) {
+        if (pwr[i] >= peak / 4) {
+            r->rise = (i * 64 > fp) ? i * 64 - fp : 0;
+            break;
+        }
+    }
+    r->peak = (pk * 64 > fp) ? pk * 64 - fp : 0;
+
+    /* 8 bits off the power keeps den in 32 bits for a full window */
+    for (i = fp_tap + 1; i < ntaps; i++) {
+        w = (pwr[i] > noise) ? pwr[i] >> 8 : 0;
+        num += (uint64_t) w * (uint32_t)(i * 64 - fp);
+        den += w;
+    }
+    r->excess = den ? (uint16_t)(num / den) : 0;
+
+    r->p_nlos = (score(r->rise, params->rise_los, params->rise_nlos) +
+                 score(r->ratio, params->ratio_los, params->ratio_nlos) +
+                 score(r->excess, params->excess_los, params->excess_nlos)) / 3;
+    /* excess * p_nlos * bias_gain is up to 48 bits, and the bias saturates rather than wrap negative */
+    bias = ((uint64_t) r->excess * r->p_nlos * params->bias_gain) >> 16;
+    r->bias = (int16_t)((bias > INT16_MAX) ? INT16_MAX : bias);
+}
+
+#ifndef DW1000_NLOS_KERNEL_ONLY
+
+static struct dw1000_nlos_instance g_nlos_instances[MYNEWT_VAL(UWB_DEVICE_MAX)];
+
+/**
+ * API to get the first path analysis instance of a device.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return struct dw1000_nlos_instance *
+ */
+struct dw1000_nlos_instance *
+dw1000_nlos_get(struct _dw1000_dev_instance_t * inst)
+{
+    assert(inst->uwb_dev.idx < MYNEWT_VAL(UWB_DEVICE_MAX));
+    return &g_nlos_instances[inst->uwb_dev.idx];
+}
+
+/**
+ * API to initialise the first path analysis of a device with the syscfg thresholds.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return struct dw1000_nlos_instance *
+ */
+struct dw1000_nlos_instance *
+dw1000_nlos_init(struct _dw1000_dev_instance_t * inst)
+{
+    struct dw1000_nlos_instance * nlos = dw1000_nlos_get(inst);
+
+    memset(nlos, 0, sizeof(struct dw1000_nlos_instance));
+    nlos->dev_inst = inst;
+    nlos->params = (struct dw1000_nlos_params) {
+        .rise_los = MYNEWT_VAL(DW1000_NLOS_RISE_LOS),
+        .rise_nlos = MYNEWT_VAL(DW1000_NLOS_RISE_NLOS),
+        .ratio_los = MYNEWT_VAL(DW1000_NLOS_RATIO_LOS),
+        .ratio_nlos = MYNEWT_VAL(DW1000_NLOS_RATIO_NLOS),
+        .excess_los = MYNEWT_VAL(DW1000_NLOS_EXCESS_LOS),
+        .excess_nlos = MYNEWT_VAL(DW1000_NLOS_EXCESS_NLOS),
+        .bias_gain = MYNEWT_VAL(DW1000_NLOS_BIAS_GAIN)
+    };
+    return nlos;
+}
+
+/**
+ * API to analyse the frame just received, called from the rx handler after the rx diagnostics
+ * have been read. The result stays valid until the next frame.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return void
+ */
+void
+dw1000_nlos_update(struct _dw1000_dev_instance_t * inst)
+{
+    struct dw1000_nlos_instance * nlos = dw1000_nlos_get(inst);
+    uint16_t acc_taps = (inst->uwb_dev.config.prf == DWT_PRF_16M) ? 992 : 1016;
+    uint16_t ntaps = MYNEWT_VAL(DW1000_NLOS_TAPS);
+    uint16_t fp_idx, start;
+    uint32_t noise;
+#if MYNEWT_VAL(DW1000_CIRSTREAM_ENABLED)
+    const uint8_t * win;
+#endif
+
+    if (nlos->dev_inst == NULL) {
+        return;
+    }
+    if (inst->uwb_dev.status.lde_error) {
+        memset(&nlos->result, 0, sizeof(struct dw1000_nlos_result));
+        nlos->stats.skipped++;
+        return;
+    }
+
+    if (inst->uwb_dev.config.rxdiag_enable) {
+        fp_idx = inst->rxdiag.fp_idx;
+        noise = (uint32_t) inst->rxdiag.rx_std * MYNEWT_VAL(DW1000_NLOS_NOISE_K);
+        noise *= noise;
+    } else {
+        fp_idx = (uint16_t) dw1000_read_reg(inst, RX_TIME_ID, RX_TIME_FP_INDEX_OFFSET, sizeof(uint16_t));
+        noise = 0;
+    }
+    start = fp_idx >> 6;
+    start = (start > MYNEWT_VAL(DW1000_NLOS_PRE)) ? start - MYNEWT_VAL(DW1000_NLOS_PRE) : 0;
+    if (start + ntaps > acc_taps) {
+        start = acc_taps - ntaps;
+    }
+
+#if MYNEWT_VAL(DW1000_CIRSTREAM_ENABLED)
+    /* The stream captured this frame around the same first path, its window usually covers ours */
+    win = dw1000_cirstream_window(inst, start, ntaps);
+    if (win) {
+        memcpy(&nlos->acc[4], win, ntaps * 4);
+        nlos->stats.shared++;
+    } else
+#endif
+    /* Read so the dummy byte lands in acc[3] and the taps are word aligned */
+    dw1000_read_accdata(inst, &nlos->acc[3], start * 4, 1 + ntaps * 4);
+    dw1000_nlos_analyse(&nlos->params, (const uint32_t *) &nlos->acc[4], ntaps, fp_idx - start * 64, noise,
+                        &nlos->result);
+
+    nlos->stats.analysed++;
+    if (nlos->result.p_nlos > DW1000_NLOS_ONE / 2) {
+        nlos->stats.nlos++;
+    }
+}
+
+/**
+ * API to correct a time of flight with the bias of the last received frame. A late rx timestamp
+ * adds half its lateness to a two way ToF, call once per frame received in the exchange.
+ *
+ * @param inst     Pointer to _dw1000_dev_instance_t.
+ * @param tof_dtu  Time of flight in dtu.
+ * @return int32_t corrected time of flight
+ */
+int32_t
+dw1000_nlos_correct(struct _dw1000_dev_instance_t * inst, int32_t tof_dtu)
+{
+    return tof_dtu - dw1000_nlos_get(inst)->result.bias / 2;
+}
+
+#endif
+#endif
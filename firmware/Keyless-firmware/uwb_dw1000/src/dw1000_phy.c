@@ -310,6 +310,51 @@ void dw1000_phy_config_txrf(struct _dw1000_dev_instance_t * inst, struct uwb_dev
     dw1000_write_reg(inst, TX_POWER_ID, 0, config->power, sizeof(uint32_t));
 }
 
+/**
+ * API to adjust the crystal trim. The value is also kept in the rx config so that it survives
+ * a later dw1000_phy_init.
+ *
+ * @param inst   Pointer to dw1000_dev_instance_t.
+ * @param trim   Crystal trim value, 0..31. Each step is roughly 1.5ppm.
+ * @return void
+ */
+void dw1000_phy_set_xtal_trim(struct _dw1000_dev_instance_t * inst, uint8_t trim)
+{
+    inst->uwb_dev.config.rx.xtalTrim = trim & FS_XTALT_MASK;
+    // The 3 MSb in this 8-bit register must be kept to 0b011 to avoid any malfunction.
+    dw1000_write_reg(inst, FS_CTRL_ID, FS_XTALT_OFFSET, (3 << 5) | inst->uwb_dev.config.rx.xtalTrim, sizeof(uint8_t));
+}
+
+/**
+ * API to sample the current temperature and battery voltage with the SAR. Unlike the wakeup
+ * values these are read now, the system clock is briefly forced to the XTAL for the reading
+ * to be reliable so the transceiver should be idle and the SPI freq has to be < 3MHz.
+ *
+ * @param inst   Pointer to dw1000_dev_instance_t.
+ * @return uint16_t (temp_raw << 8) | vbat_raw
+ */
+uint16_t dw1000_phy_read_tempvbat(struct _dw1000_dev_instance_t * inst)
+{
+    uint8_t vbat_raw, temp_raw;
+
+    // These writes should be single writes and in sequence
+    dw1000_write_reg(inst, RF_CONF_ID, 0x11, 0x80, sizeof(uint8_t)); // Enable TLD Bias
+    dw1000_write_reg(inst, RF_CONF_ID, 0x12, 0x0A, sizeof(uint8_t)); // Enable TLD Bias and ADC Bias
+    dw1000_write_reg(inst, RF_CONF_ID, 0x12, 0x0F, sizeof(uint8_t)); // Enable Outputs (only after Biases are up and running)
+
+    dw1000_phy_sysclk_XTAL(inst);
+    dw1000_write_reg(inst, TX_CAL_ID, TC_SARL_SAR_C, 0, sizeof(uint8_t));
+    dw1000_write_reg(inst, TX_CAL_ID, TC_SARL_SAR_C, 1, sizeof(uint8_t)); // Set SAR enable
+    /* cause bug in register block TX_CAL, we need to read 1 byte in a time */
+    vbat_raw = (uint8_t) dw1000_read_reg(inst, TX_CAL_ID, TC_SARL_SAR_LVBAT_OFFSET, sizeof(uint8_t));
+    temp_raw = (uint8_t) dw1000_read_reg(inst, TX_CAL_ID, TC_SARL_SAR_LTEMP_OFFSET, sizeof(uint8_t));
+    dw1000_phy_sysclk_SEQ(inst);
+
+    dw1000_write_reg(inst, TX_CAL_ID, TC_SARL_SAR_C, 0, sizeof(uint8_t)); // Clear SAR enable
+
+    return ((uint16_t)temp_raw << 8) | vbat_raw;
+}
+
 
 #ifndef __KERNEL__
 /**
@@ -372,7 +417,6 @@ void dw1000_phy_rx_reset(struct _dw1000_dev_instance_t * inst)
 void dw1000_phy_forcetrxoff(struct _dw1000_dev_instance_t * inst)
 {
     dpl_error_t err;
-    struct uwb_mac_interface * cbs = NULL;
     uint32_t mask = dw1000_read_reg(inst, SYS_MASK_ID, 0 , sizeof(uint32_t)) ; // Read set interrupt mask
 
     // Need to beware of interrupts occurring in the middle of following read modify write cycle
@@ -396,12 +440,10 @@ void dw1000_phy_forcetrxoff(struct _dw1000_dev_instance_t * inst)
 
     dw1000_write_reg(inst, SYS_MASK_ID, 0, mask, sizeof(uint32_t)); // Restore mask to what it was
 
-    if(!(SLIST_EMPTY(&inst->uwb_dev.interface_cbs))){
-        SLIST_FOREACH(cbs, &inst->uwb_dev.interface_cbs, next){
-            if (cbs!=NULL && cbs->reset_cb)
-                if(cbs->reset_cb((struct uwb_dev*)inst, cbs)) continue;
-            }
-    }
+#if MYNEWT_VAL(DW1000_CBS_TABLE_ENABLED)
+    dw1000_mac_cbs_check(inst);
+#endif
+    DW1000_MAC_CBS_DISPATCH(inst, RESET, reset_cb, false);
     // Enable/restore interrupts again...
     err = dpl_mutex_release(&inst->mutex);
     assert(err == DPL_OK);
@@ -37,6 +37,9 @@
 #include <dw1000/dw1000_regs.h>
 #include <dw1000/dw1000_hal.h>
 #include <dw1000/dw1000_phy.h>
+#if MYNEWT_VAL(DW1000_ANTDLY_CAL_ENABLED)
+#include <dw1000/dw1000_antdly.h>
+#endif
 
 int dw1000_cli_register(void);
 int dw1000_cli_down(int reason);
@@ -87,6 +90,10 @@ void dw1000_pkg_init(void)
     }
 #endif
 
+#if MYNEWT_VAL(DW1000_ANTDLY_CAL_ENABLED)
+    dw1000_antdly_pkg_init();
+#endif
+
 #if MYNEWT_VAL(DW1000_CLI)
     dw1000_cli_register();
 #endif
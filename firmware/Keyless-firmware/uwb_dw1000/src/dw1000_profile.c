@@ -0,0 +1,263 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw1000_profile.c
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief Phy profiles
+ *
+ * @details Each profile overrides the data rate, preamble, PAC and SFD of the device config. The resulting
+ * config and its register image are built once in dw1000_profile_init, so a switch is a compare against the
+ * image last written to the device followed by the writes that differ. Between the discovery and ranging
+ * profiles that is SYS_CFG, the LDE replica coefficient, the DRX tunes, SFD timeout, USR_SFD, CHAN_CTRL and
+ * TX_FCTRL; the PLL, RF and AGC registers are shared and never rewritten.
+ *
+ * Profiles are built for the channel, PRF and preamble codes in the config at init time; call
+ * dw1000_profile_init again after changing those with dw1000_mac_config.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <dpl/dpl.h>
+#include <dw1000/dw1000_regs.h>
+#include <dw1000/dw1000_dev.h>
+#include <dw1000/dw1000_mac.h>
+#include <dw1000/dw1000_profile.h>
+
+#if MYNEWT_VAL(DW1000_PROFILE_ENABLED)
+
+const struct dw1000_profile g_dw1000_profiles[DW1000_PROFILE_NUM] = {
+    [DW1000_PROFILE_DISCOVERY] = {
+        .name = "discovery",
+        .dataRate = DWT_BR_110K,
+        .preambleLength = DWT_PLEN_1024,
+        .pacLength = DWT_PAC32,
+        .sfdType = 1
+    },
+    [DW1000_PROFILE_RANGING] = {
+        .name = "ranging",
+        .dataRate = DWT_BR_6M8,
+        .preambleLength = DWT_PLEN_128,
+        .pacLength = DWT_PAC8,
+        .sfdType = 1
+    },
+};
+
+static struct dw1000_profile_instance g_profile_instances[MYNEWT_VAL(UWB_DEVICE_MAX)];
+
+/**
+ * API to get the phy profile instance of a device.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return struct dw1000_profile_instance *
+ */
+struct dw1000_profile_instance *
+dw1000_profile_get(struct _dw1000_dev_instance_t * inst)
+{
+    assert(inst->uwb_dev.idx < MYNEWT_VAL(UWB_DEVICE_MAX));
+    return &g_profile_instances[inst->uwb_dev.idx];
+}
+
+static uint16_t
+preamble_symbols(uint8_t plen)
+{
+    switch (plen) {
+    case DWT_PLEN_64: return 64;
+    case DWT_PLEN_128: return 128;
+    case DWT_PLEN_256: return 256;
+    case DWT_PLEN_512: return 512;
+    case DWT_PLEN_1024: return 1024;
+    case DWT_PLEN_1536: return 1536;
+    case DWT_PLEN_2048: return 2048;
+    case DWT_PLEN_4096: return 4096;
+    default: assert(0); return 0;
+    }
+}
+
+static uint16_t
+sfd_symbols(uint8_t dataRate, uint8_t sfdType)
+{
+    if (dataRate == DWT_BR_110K) {
+        return 64;
+    }
+    return (dataRate == DWT_BR_850K && sfdType) ? 16 : 8;
+}
+
+static void
+update_attrib(struct _dw1000_dev_instance_t * inst, const struct uwb_dev_config * config)
+{
+    struct uwb_phy_attributes * attrib = &inst->uwb_dev.attrib;
+
+    attrib->nsync = preamble_symbols(config->tx.preambleLength);
+    attrib->nsfd = sfd_symbols(config->dataRate, config->rx.sfdType);
+    switch (config->dataRate) {
+    case DWT_BR_110K:
+        attrib->Tbsym = DPL_FLOAT32_INIT(8.2051282f);
+        attrib->Tdsym = DPL_FLOAT32_INIT(8.2051282f);
+        break;
+    case DWT_BR_850K:
+        attrib->Tbsym = DPL_FLOAT32_INIT(1.0256410f);
+        attrib->Tdsym = DPL_FLOAT32_INIT(1.0256410f);
+        break;
+    default:
+        attrib->Tbsym = DPL_FLOAT32_INIT(1.0256410f);
+        attrib->Tdsym = DPL_FLOAT32_INIT(0.1282051f);
+        break;
+    }
+}
+
+/**
+ * API to build the config and register image of every profile from the current device config.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return struct dw1000_profile_instance *
+ */
+struct dw1000_profile_instance *
+dw1000_profile_init(struct _dw1000_dev_instance_t * inst)
+{
+    struct dw1000_profile_instance * p = dw1000_profile_get(inst);
+    int i;
+
+    memset(p, 0, sizeof(struct dw1000_profile_instance));
+    p->dev_inst = inst;
+    p->current = DW1000_PROFILE_NUM;
+
+    for (i = 0; i < DW1000_PROFILE_NUM; i++) {
+        const struct dw1000_profile * prof = &g_dw1000_profiles[i];
+        struct uwb_dev_config * config = &p->config[i];
+
+        memcpy(config, &inst->uwb_dev.config, sizeof(struct uwb_dev_config));
+        config->dataRate = prof->dataRate;
+        config->tx.preambleLength = prof->preambleLength;
+        config->rx.pacLength = prof->pacLength;
+        config->rx.sfdType = prof->sfdType;
+        /* preamble length + 1 + SFD length - PAC size */
+        config->rx.sfdTimeout = preamble_symbols(prof->preambleLength) + 1 +
+            sfd_symbols(prof->dataRate, prof->sfdType) - (8 << prof->pacLength);
+        dw1000_mac_build_regimage(inst, config, &p->img[i]);
+
+        if (config->dataRate == inst->uwb_dev.config.dataRate &&
+            config->tx.preambleLength == inst->uwb_dev.config.tx.preambleLength &&
+            config->rx.pacLength == inst->uwb_dev.config.rx.pacLength) {
+            p->current = i;
+        }
+    }
+    return p;
+}
+
+/**
+ * API to look up a profile by name.
+ *
+ * @param name  Profile name.
+ * @return int profile id, -1 if not found.
+ */
+int
+dw1000_profile_find(const char * name)
+{
+    int i;
+    for (i = 0; i < DW1000_PROFILE_NUM; i++) {
+        if (!strcmp(name, g_dw1000_profiles[i].name)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * API to switch the device to a profile. Only registers that differ from what is in the device are
+ * written. The transceiver must be idle.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @param id    Profile to switch to.
+ * @return int number of registers written, -1 on an invalid id.
+ */
+int
+dw1000_profile_switch(struct _dw1000_dev_instance_t * inst, dw1000_profile_id_t id)
+{
+    struct dw1000_profile_instance * p = dw1000_profile_get(inst);
+    const uint32_t cfg_mask = SYS_CFG_RXM110K | SYS_CFG_PHR_MODE_11 | SYS_CFG_RXAUTR;
+    struct dw1000_mac_regimage img;
+    struct uwb_dev_config * config;
+    uint32_t sys_cfg;
+    int n;
+
+    if (id >= DW1000_PROFILE_NUM) {
+        return -1;
+    }
+    config = &p->config[id];
+
+    /* Frame filter, autoack and double buffering are set outside of dw1000_mac_config,
+     * take the rest of SYS_CFG from the device */
+    sys_cfg = SYS_CFG_MASK & dw1000_read_reg(inst, SYS_CFG_ID, 0, sizeof(uint32_t));
+    inst->mac_regimage.sys_cfg = sys_cfg;
+    memcpy(&img, &p->img[id], sizeof(struct dw1000_mac_regimage));
+    img.sys_cfg = (sys_cfg & ~cfg_mask) | (img.sys_cfg & cfg_mask);
+
+    n = dw1000_mac_apply_regimage(inst, &img, &inst->mac_regimage);
+
+    inst->uwb_dev.config.dataRate = config->dataRate;
+    inst->uwb_dev.config.tx.preambleLength = config->tx.preambleLength;
+    inst->uwb_dev.config.rx.pacLength = config->rx.pacLength;
+    inst->uwb_dev.config.rx.sfdType = config->rx.sfdType;
+    inst->uwb_dev.config.rx.sfdTimeout = config->rx.sfdTimeout;
+    update_attrib(inst, config);
+
+    if (p->current != id) {
+        p->stats.switches++;
+    }
+    p->current = id;
+    p->stats.regs_written += n;
+    return n;
+}
+
+/**
+ * API to report the outcome of a ranging exchange. A success in the discovery profile escalates to the
+ * ranging profile, a run of failures in the ranging profile falls back to discovery. Both ends of the link
+ * must report the same outcome, so call this after the final frame of the exchange on each side.
+ *
+ * @param inst     Pointer to _dw1000_dev_instance_t.
+ * @param success  true if the exchange produced a range.
+ * @return void
+ */
+void
+dw1000_profile_range_result(struct _dw1000_dev_instance_t * inst, bool success)
+{
+    struct dw1000_profile_instance * p = dw1000_profile_get(inst);
+
+    if (p->current != DW1000_PROFILE_RANGING) {
+        if (success) {
+            p->misses = 0;
+            dw1000_profile_switch(inst, DW1000_PROFILE_RANGING);
+            p->stats.escalations++;
+        }
+        return;
+    }
+
+    if (success) {
+        p->misses = 0;
+    } else if (++p->misses >= MYNEWT_VAL(DW1000_PROFILE_FALLBACK_MISSES)) {
+        p->misses = 0;
+        dw1000_profile_switch(inst, DW1000_PROFILE_DISCOVERY);
+        p->stats.fallbacks++;
+    }
+}
+
+#endif
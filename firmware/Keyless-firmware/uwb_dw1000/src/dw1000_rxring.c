@@ -0,0 +1,167 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw1000_rxring.c
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief RX frame ring
+ *
+ * @details The interrupt handler reads each frame with dw1000_rxring_read, which picks the next slot that
+ * is not held, points uwb_dev.rxbuf at it and reads the RX buffer into it in place. Existing rx_complete
+ * consumers keep using uwb_dev.rxbuf. Slots are reused round robin, so a frame that is not held stays
+ * valid until DW1000_RXRING_SLOTS - 1 more frames have arrived rather than being overwritten by the next
+ * one. If every slot is held the frame goes to the original rxbuf and dw1000_rxring_hold returns NULL.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <dpl/dpl.h>
+#include <dw1000/dw1000_regs.h>
+#include <dw1000/dw1000_dev.h>
+#include <dw1000/dw1000_mac.h>
+#include <dw1000/dw1000_rxring.h>
+
+#if MYNEWT_VAL(DW1000_RXRING_ENABLED)
+
+static struct dw1000_rxring_instance g_rxring_instances[MYNEWT_VAL(UWB_DEVICE_MAX)];
+
+/**
+ * API to get the rx ring instance of a device.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return struct dw1000_rxring_instance *
+ */
+struct dw1000_rxring_instance *
+dw1000_rxring_get(struct _dw1000_dev_instance_t * inst)
+{
+    assert(inst->uwb_dev.idx < MYNEWT_VAL(UWB_DEVICE_MAX));
+    return &g_rxring_instances[inst->uwb_dev.idx];
+}
+
+/**
+ * API to initialise the rx ring, called once uwb_dev.rxbuf has been allocated.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return struct dw1000_rxring_instance *
+ */
+struct dw1000_rxring_instance *
+dw1000_rxring_init(struct _dw1000_dev_instance_t * inst)
+{
+    struct dw1000_rxring_instance * ring = dw1000_rxring_get(inst);
+
+    assert(DW1000_SPI_HEADROOM <= sizeof(ring->desc[0].spi_hdr));
+    assert(inst->uwb_dev.rxbuf_size <= sizeof(ring->desc[0].buf));
+    memset(ring, 0, sizeof(struct dw1000_rxring_instance));
+    ring->dev_inst = inst;
+    ring->rxbuf = inst->uwb_dev.rxbuf;
+    return ring;
+}
+
+/**
+ * API to read the received frame into the next free slot and point uwb_dev.rxbuf at it. Called from the
+ * interrupt handler once the frame length is known.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @param len   Bytes to read.
+ * @return void
+ */
+void
+dw1000_rxring_read(struct _dw1000_dev_instance_t * inst, uint16_t len)
+{
+    struct dw1000_rxring_instance * ring = dw1000_rxring_get(inst);
+    struct dw1000_rxring_desc * desc = NULL;
+    dpl_error_t err;
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(DW1000_RXRING_SLOTS); i++) {
+        struct dw1000_rxring_desc * d = &ring->desc[(ring->next + i) % MYNEWT_VAL(DW1000_RXRING_SLOTS)];
+        if (d->state == DW1000_RXRING_FREE) {
+            desc = d;
+            ring->next = (ring->next + i + 1) % MYNEWT_VAL(DW1000_RXRING_SLOTS);
+            break;
+        }
+    }
+
+    ring->current = desc;
+    if (desc == NULL) {
+        ring->stats.exhausted++;
+        inst->uwb_dev.rxbuf = ring->rxbuf;
+    } else {
+        ring->stats.frames++;
+        inst->uwb_dev.rxbuf = desc->buf;
+    }
+
+    err = dpl_mutex_pend(&inst->mutex, DPL_TIMEOUT_NEVER);
+    if (err != DPL_OK) {
+        inst->uwb_dev.status.mtx_error = 1;
+        return;
+    }
+    if (desc == NULL) {
+        dw1000_read(inst, RX_BUFFER_ID, 0, inst->uwb_dev.rxbuf, len);
+    } else {
+        dw1000_read_inplace(inst, RX_BUFFER_ID, 0, desc->buf, len);
+    }
+    err = dpl_mutex_release(&inst->mutex);
+    assert(err == DPL_OK);
+}
+
+/**
+ * API to take ownership of the frame being delivered, call from an rx_complete callback. The slot is
+ * not reused until released.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return struct dw1000_rxring_desc *, NULL if the frame is not in a slot and has to be copied.
+ */
+struct dw1000_rxring_desc *
+dw1000_rxring_hold(struct _dw1000_dev_instance_t * inst)
+{
+    struct dw1000_rxring_instance * ring = dw1000_rxring_get(inst);
+    struct dw1000_rxring_desc * desc = ring->current;
+
+    if (desc == NULL || desc->state == DW1000_RXRING_HELD) {
+        return NULL;
+    }
+    desc->len = inst->uwb_dev.frame_len;
+    desc->fctrl = inst->uwb_dev.fctrl;
+    desc->rxtimestamp = inst->uwb_dev.rxtimestamp;
+    desc->state = DW1000_RXRING_HELD;
+    ring->stats.held++;
+    return desc;
+}
+
+/**
+ * API to give a held slot back to the ring.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @param desc  Slot returned by dw1000_rxring_hold.
+ * @return void
+ */
+void
+dw1000_rxring_release(struct _dw1000_dev_instance_t * inst, struct dw1000_rxring_desc * desc)
+{
+    struct dw1000_rxring_instance * ring = dw1000_rxring_get(inst);
+
+    assert(desc >= ring->desc && desc < ring->desc + MYNEWT_VAL(DW1000_RXRING_SLOTS));
+    assert(desc->state == DW1000_RXRING_HELD);
+    desc->state = DW1000_RXRING_FREE;
+}
+
+#endif
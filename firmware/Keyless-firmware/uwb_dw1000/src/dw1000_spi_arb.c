@@ -0,0 +1,242 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw1000_spi_arb.c
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief SPI bus arbitration
+ *
+ * @details Every hal transfer acquires the arbiter of its bus before pending on spi_sem. A free bus is
+ * taken directly, otherwise the caller waits on the gate of its class and the releasing transfer hands
+ * the bus to the oldest waiter of the highest class. The class comes from the calling task: the
+ * interrupt task of each instance is IRQ, tasks registered with dw1000_spi_arb_set_task_class get what
+ * they registered, everything else is TX.
+ *
+ * dw1000_read and dw1000_write split long transfers into DW1000_SPI_ARB_CHUNK byte transactions, so a
+ * waiting higher class gets the bus between chunks. Accumulator reads are not split as each read starts
+ * with a dummy byte.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <dpl/dpl.h>
+#include <dpl/dpl_cputime.h>
+#include <dw1000/dw1000_regs.h>
+#include <dw1000/dw1000_dev.h>
+#include <dw1000/dw1000_spi_arb.h>
+
+#if MYNEWT_VAL(DW1000_SPI_ARB_ENABLED)
+
+static struct dw1000_spi_arb_instance g_spi_arb_instances[MYNEWT_VAL(UWB_DEVICE_MAX)];
+static struct dw1000_spi_arb_bus g_spi_arb_buses[MYNEWT_VAL(UWB_DEVICE_MAX)];
+
+static struct {
+    void * task;
+    uint8_t cls;
+} g_spi_arb_tasks[MYNEWT_VAL(DW1000_SPI_ARB_TASKS)];
+
+/**
+ * API to get the spi arbiter instance of a device.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return struct dw1000_spi_arb_instance *
+ */
+struct dw1000_spi_arb_instance *
+dw1000_spi_arb_get(struct _dw1000_dev_instance_t * inst)
+{
+    assert(inst->uwb_dev.idx < MYNEWT_VAL(UWB_DEVICE_MAX));
+    return &g_spi_arb_instances[inst->uwb_dev.idx];
+}
+
+/**
+ * API to attach a device to the arbiter of its bus, called once spi_sem is known. Devices with the
+ * same spi_sem share an arbiter.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return struct dw1000_spi_arb_instance *
+ */
+struct dw1000_spi_arb_instance *
+dw1000_spi_arb_init(struct _dw1000_dev_instance_t * inst)
+{
+    struct dw1000_spi_arb_instance * arb = dw1000_spi_arb_get(inst);
+    struct dw1000_spi_arb_bus * bus = NULL;
+    dpl_error_t err;
+    int i;
+
+    assert(inst->spi_sem);
+    memset(arb, 0, sizeof(struct dw1000_spi_arb_instance));
+    arb->dev_inst = inst;
+
+    for (i = 0; i < MYNEWT_VAL(UWB_DEVICE_MAX); i++) {
+        if (g_spi_arb_buses[i].spi_sem == inst->spi_sem) {
+            arb->bus = &g_spi_arb_buses[i];
+            return arb;
+        }
+        if (bus == NULL && g_spi_arb_buses[i].spi_sem == NULL) {
+            bus = &g_spi_arb_buses[i];
+        }
+    }
+    assert(bus);
+    bus->spi_sem = inst->spi_sem;
+    for (i = 0; i < DW1000_SPI_CLASS_NUM; i++) {
+        err = dpl_sem_init(&bus->gate[i], 0);
+        assert(err == DPL_OK);
+    }
+    arb->bus = bus;
+    return arb;
+}
+
+/**
+ * API to set the class of the transfers a task makes.
+ *
+ * @param task  Task id as returned by dpl_get_current_task_id.
+ * @param cls   Class of the task.
+ * @return DPL_OK on success, DPL_ENOMEM if DW1000_SPI_ARB_TASKS tasks are registered already.
+ */
+int
+dw1000_spi_arb_set_task_class(void * task, dw1000_spi_class_t cls)
+{
+    int i, free = -1;
+
+    assert(cls < DW1000_SPI_CLASS_NUM);
+    for (i = 0; i < MYNEWT_VAL(DW1000_SPI_ARB_TASKS); i++) {
+        if (g_spi_arb_tasks[i].task == task) {
+            g_spi_arb_tasks[i].cls = cls;
+            return DPL_OK;
+        }
+        if (free < 0 && g_spi_arb_tasks[i].task == NULL) {
+            free = i;
+        }
+    }
+    if (free < 0) {
+        return DPL_ENOMEM;
+    }
+    g_spi_arb_tasks[free].cls = cls;
+    g_spi_arb_tasks[free].task = task;
+    return DPL_OK;
+}
+
+/**
+ * API for the interrupt task to claim DW1000_SPI_CLASS_IRQ, only registers on the first call.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return void
+ */
+void
+dw1000_spi_arb_irq_task(struct _dw1000_dev_instance_t * inst)
+{
+    struct dw1000_spi_arb_instance * arb = dw1000_spi_arb_get(inst);
+
+    if (!arb->irq_task_set) {
+        arb->irq_task_set = (dw1000_spi_arb_set_task_class(dpl_get_current_task_id(),
+                                                           DW1000_SPI_CLASS_IRQ) == DPL_OK);
+    }
+}
+
+static uint8_t
+task_class(void)
+{
+    void * task = dpl_get_current_task_id();
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(DW1000_SPI_ARB_TASKS); i++) {
+        if (g_spi_arb_tasks[i].task == task) {
+            return g_spi_arb_tasks[i].cls;
+        }
+    }
+    return DW1000_SPI_CLASS_TX;
+}
+
+static void
+stats_add(struct dw1000_spi_arb_stats * s, uint32_t usec)
+{
+    uint32_t bin = usec ? 32 - __builtin_clz(usec) : 0;
+
+    if (bin >= MYNEWT_VAL(DW1000_SPI_ARB_HIST_BINS)) {
+        bin = MYNEWT_VAL(DW1000_SPI_ARB_HIST_BINS) - 1;
+    }
+    s->hist[bin]++;
+    s->count++;
+    if (usec > s->max_usec) {
+        s->max_usec = usec;
+    }
+}
+
+/**
+ * API to acquire the bus for a transfer, blocks until the bus is free or handed over.
+ * Not for interrupt context.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return DPL_OK on success
+ */
+int
+dw1000_spi_arb_acquire(struct _dw1000_dev_instance_t * inst)
+{
+    struct dw1000_spi_arb_instance * arb = dw1000_spi_arb_get(inst);
+    struct dw1000_spi_arb_bus * bus = arb->bus;
+    uint8_t cls = task_class();
+    uint32_t t0 = dpl_cputime_get32();
+    dpl_error_t err = DPL_OK;
+    os_sr_t sr;
+
+    DPL_ENTER_CRITICAL(sr);
+    if (!bus->busy) {
+        bus->busy = 1;
+        DPL_EXIT_CRITICAL(sr);
+    } else {
+        bus->waiting[cls]++;
+        DPL_EXIT_CRITICAL(sr);
+        /* busy stays set, the releasing transfer hands the bus over */
+        err = dpl_sem_pend(&bus->gate[cls], DPL_TIMEOUT_NEVER);
+        assert(err == DPL_OK);
+    }
+    stats_add(&arb->stats[cls], dpl_cputime_ticks_to_usecs(dpl_cputime_get32() - t0));
+    return err;
+}
+
+/**
+ * API to release the bus after a transfer, may be called from interrupt context.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return void
+ */
+void
+dw1000_spi_arb_release(struct _dw1000_dev_instance_t * inst)
+{
+    struct dw1000_spi_arb_bus * bus = dw1000_spi_arb_get(inst)->bus;
+    dpl_error_t err;
+    os_sr_t sr;
+    int cls;
+
+    DPL_ENTER_CRITICAL(sr);
+    for (cls = DW1000_SPI_CLASS_NUM - 1; cls >= 0 && !bus->waiting[cls]; cls--);
+    if (cls < 0) {
+        bus->busy = 0;
+        DPL_EXIT_CRITICAL(sr);
+        return;
+    }
+    bus->waiting[cls]--;
+    DPL_EXIT_CRITICAL(sr);
+    err = dpl_sem_release(&bus->gate[cls]);
+    assert(err == DPL_OK);
+}
+
+#endif
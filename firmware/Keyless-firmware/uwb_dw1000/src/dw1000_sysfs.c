@@ -61,6 +61,39 @@ static struct dw1000cli_sysfs_data* get_instance(struct kobject* kobj)
     return 0;
 }
 
+#if MYNEWT_VAL(DW1000_MAC_LATENCY)
+static unsigned int lat_hist_show(char *buf, unsigned int len, const char *name,
+                                  const struct dw1000_mac_lat_hist *h)
+{
+    int i;
+    len += snprintf(buf+len, PAGE_SIZE-len, "%s %u %u", name, h->n, h->max);
+    for (i=0;i<DW1000_MAC_LAT_BINS;i++) {
+        len += snprintf(buf+len, PAGE_SIZE-len, " %u", h->bin[i]);
+    }
+    len += snprintf(buf+len, PAGE_SIZE-len, "\n");
+    return len;
+}
+
+/* One line per histogram: name, samples, max ticks, log2 bins */
+static unsigned int lat_show(struct _dw1000_dev_instance_t *inst, char *buf)
+{
+    struct dw1000_mac_latency *lat = &inst->lat;
+    char name[24];
+    unsigned int len = 0;
+    int i;
+
+    len = lat_hist_show(buf, len, "irq", &lat->irq);
+    for (i=0;i<DW1000_MAC_LAT_EVENTS;i++) {
+        len = lat_hist_show(buf, len, dw1000_mac_lat_event_names[i], &lat->ev[i]);
+    }
+    for (i=0;i<lat->nrxcb;i++) {
+        snprintf(name, sizeof(name), "rx_complete_cb:0x%x", lat->rxcb[i].id);
+        len = lat_hist_show(buf, len, name, &lat->rxcb[i].hist);
+    }
+    return len;
+}
+#endif
+
 static ssize_t cmd_show(struct kobject *kobj,
     struct kobj_attribute *attr, char *buf)
 {
@@ -108,6 +141,12 @@ static ssize_t cmd_show(struct kobject *kobj,
         }
     }
 
+#if MYNEWT_VAL(DW1000_MAC_LATENCY)
+    if (!strcmp(attr->attr.name, "lat")) {
+        copied = lat_show(inst, buf);
+    }
+#endif
+
     return copied;
 }
 
@@ -159,6 +198,13 @@ static ssize_t cmd_store(struct kobject *kobj,
 
     }
 
+#if MYNEWT_VAL(DW1000_MAC_LATENCY)
+    /* Any write clears the histograms */
+    if (!strcmp(attr->attr.name, "lat")) {
+        memset(&inst->lat, 0, sizeof(inst->lat));
+    }
+#endif
+
 #if MYNEWT_VAL(DW1000_CLI_EVENT_COUNTERS)
     if (!strcmp(attr->attr.name, "ev")) {
         ret = kstrtoll(buf, 0, &res);
@@ -215,6 +261,9 @@ static const char* rw_attr[] = {
     "cw",
 #if MYNEWT_VAL(DW1000_CLI_EVENT_COUNTERS)
     "ev",
+#endif
+#if MYNEWT_VAL(DW1000_MAC_LATENCY)
+    "lat",
 #endif
     "gpio0_mode", "gpio1_mode", "gpio2_mode",
     "gpio3_mode", "gpio4_mode", "gpio5_mode",
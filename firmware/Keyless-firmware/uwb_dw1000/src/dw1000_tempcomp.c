@@ -0,0 +1,413 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw1000_tempcomp.c
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief Temperature compensation of TX power and pulse bandwidth
+ *
+ * @details A reference temperature, PG_DELAY, PG calibration count and TX_POWER are cached once at init;
+ * this is the only full PG count measurement. Afterwards a timer on the default queue marks a sample as due and
+ * runs dw1000_tempcomp_service once the transceiver is idle between ranging rounds, retrying shortly while it is
+ * busy. The service reads the die temperature. Once it has moved far enough from the temperature the registers
+ * were last computed for, TX_POWER is recomputed from the reference and PG_DELAY is walked a few codes from its
+ * current value until the PG count crosses the reference count again.
+ *
+ * Reading the temperature and the PG count both take the system clock off the PLL, so the service must not be
+ * called with the transceiver active. An application that calls it itself has to make sure of that.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <dpl/dpl.h>
+#include <dpl/dpl_cputime.h>
+#include <hal/hal_spi.h>
+#include <dw1000/dw1000_regs.h>
+#include <dw1000/dw1000_dev.h>
+#include <dw1000/dw1000_phy.h>
+#include <dw1000/dw1000_tempcomp.h>
+
+#if MYNEWT_VAL(DW1000_TEMPCOMP_ENABLED)
+
+#define PGCAL_SETTLE_USEC       (100)   //!< Time for the PG calibration counter to complete, min 10us
+#define PGCAL_REF_SAMPLES       (10)    //!< PG counts averaged for the reference
+#define MIX_DA_FACTOR           (5)     //!< Mixer gain steps (0.5dB) per DA attenuation step (2.5dB)
+#define MIX_GAIN_MIN            (4)     //!< Mixer gain gives best performance between 4 and 20
+#define MIX_GAIN_MAX            (20)
+#define DA_ATTN_MAX             (6)     //!< DA attenuation 7 turns the output off
+
+static struct dw1000_tempcomp_instance g_tempcomp_instances[MYNEWT_VAL(UWB_DEVICE_MAX)];
+
+/**
+ * API to get the temperature compensation instance of a device.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return struct dw1000_tempcomp_instance *
+ */
+struct dw1000_tempcomp_instance *
+dw1000_tempcomp_get(struct _dw1000_dev_instance_t * inst)
+{
+    assert(inst->uwb_dev.idx < MYNEWT_VAL(UWB_DEVICE_MAX));
+    return &g_tempcomp_instances[inst->uwb_dev.idx];
+}
+
+static void
+spi_rate(struct _dw1000_dev_instance_t * inst, uint32_t baudrate)
+{
+    int rc;
+
+    if (inst->spi_settings.baudrate == baudrate) {
+        return;
+    }
+    inst->spi_settings.baudrate = baudrate;
+    rc = hal_spi_disable(inst->spi_num);
+    assert(rc == 0);
+    rc = hal_spi_config(inst->spi_num, &inst->spi_settings);
+    assert(rc == 0);
+    rc = hal_spi_enable(inst->spi_num);
+    assert(rc == 0);
+}
+
+/*
+ * The PG calibration block runs from the PLL with sequencing disabled, save what is changed
+ * so that it can be restored after.
+ */
+struct pgcal_save {
+    uint8_t pmsc_ctrl0;
+    uint16_t pmsc_ctrl1;
+    uint32_t rf_conf;
+};
+
+static void
+pgcal_enter(struct _dw1000_dev_instance_t * inst, struct pgcal_save * save)
+{
+    save->pmsc_ctrl0 = (uint8_t) dw1000_read_reg(inst, PMSC_ID, PMSC_CTRL0_OFFSET, sizeof(uint8_t));
+    save->pmsc_ctrl1 = (uint16_t) dw1000_read_reg(inst, PMSC_ID, PMSC_CTRL1_OFFSET, sizeof(uint16_t));
+    save->rf_conf = (uint32_t) dw1000_read_reg(inst, RF_CONF_ID, 0, sizeof(uint32_t));
+
+    dw1000_write_reg(inst, PMSC_ID, PMSC_CTRL0_OFFSET, PMSC_CTRL0_SYSCLKS_19M, sizeof(uint8_t));
+    dw1000_write_reg(inst, PMSC_ID, PMSC_CTRL1_OFFSET, PMSC_CTRL1_PKTSEQ_DISABLE, sizeof(uint16_t));
+    dw1000_write_reg(inst, RF_CONF_ID, 0, RF_CONF_TXPOW_MASK | RF_CONF_PGMIXBIASEN_MASK, sizeof(uint32_t));
+    dw1000_write_reg(inst, PMSC_ID, PMSC_CTRL0_OFFSET, PMSC_CTRL0_SYSCLKS_125M | PMSC_CTRL0_TXCLKS_125M, sizeof(uint8_t));
+}
+
+static void
+pgcal_exit(struct _dw1000_dev_instance_t * inst, const struct pgcal_save * save)
+{
+    dw1000_write_reg(inst, PMSC_ID, PMSC_CTRL0_OFFSET, save->pmsc_ctrl0, sizeof(uint8_t));
+    dw1000_write_reg(inst, PMSC_ID, PMSC_CTRL1_OFFSET, save->pmsc_ctrl1, sizeof(uint16_t));
+    dw1000_write_reg(inst, RF_CONF_ID, 0, save->rf_conf, sizeof(uint32_t));
+}
+
+static uint16_t
+pgcal_measure(struct _dw1000_dev_instance_t * inst, uint8_t pgdly)
+{
+    dw1000_write_reg(inst, TX_CAL_ID, TC_PGDELAY_OFFSET, pgdly, sizeof(uint8_t));
+    dw1000_write_reg(inst, TX_CAL_ID, TC_PGCCTRL_OFFSET, TC_PGCCTRL_DIR_CONV | TC_PGCCTRL_TMEAS_MASK, sizeof(uint8_t));
+    dw1000_write_reg(inst, TX_CAL_ID, TC_PGCCTRL_OFFSET,
+                     TC_PGCCTRL_DIR_CONV | TC_PGCCTRL_TMEAS_MASK | TC_PGCCTRL_CALSTART, sizeof(uint8_t));
+    dpl_cputime_delay_usecs(PGCAL_SETTLE_USEC);
+    dw1000_tempcomp_get(inst)->stats.pg_meas++;
+    return (uint16_t) dw1000_read_reg(inst, TX_CAL_ID, TC_PGCAL_STATUS_OFFSET, sizeof(uint16_t)) & TC_PGCAL_STATUS_DELAY_MASK;
+}
+
+/**
+ * API to measure the PG calibration count for a given PG_DELAY, averaged to smooth out noise.
+ * This is the reference the bandwidth is held to over temperature.
+ * NOTE: the SPI freq has to be < 3MHz.
+ *
+ * @param inst   Pointer to _dw1000_dev_instance_t.
+ * @param pgdly  PG_DELAY to measure.
+ * @return uint16_t PG count.
+ */
+uint16_t
+dw1000_tempcomp_calc_pgcount(struct _dw1000_dev_instance_t * inst, uint8_t pgdly)
+{
+    struct pgcal_save save;
+    uint32_t sum = 0;
+    int i;
+
+    pgcal_enter(inst, &save);
+    for (i = 0; i < PGCAL_REF_SAMPLES; i++) {
+        sum += pgcal_measure(inst, pgdly);
+    }
+    dw1000_write_reg(inst, TX_CAL_ID, TC_PGDELAY_OFFSET, inst->uwb_dev.config.txrf.PGdly, sizeof(uint8_t));
+    pgcal_exit(inst, &save);
+
+    return (uint16_t)(sum / PGCAL_REF_SAMPLES);
+}
+
+/**
+ * API to get the TX power change expected for a temperature change, only channels 2 and 5 are
+ * characterised; 4 and 7 share their centre frequency.
+ *
+ * @param channel     Channel number.
+ * @param delta_temp  Temperature change in raw SAR units.
+ * @return int32_t Power change in 0.5dB mixer gain steps.
+ */
+int32_t
+dw1000_tempcomp_power_steps(uint8_t channel, int32_t delta_temp)
+{
+    int32_t factor;
+    int32_t steps;
+
+    switch (channel) {
+    case 2:
+    case 4: factor = 327; break;    // 0.0798 * 4096
+    case 5:
+    case 7: factor = 607; break;    // 0.1482 * 4096
+    default: return 0;
+    }
+    steps = (abs(delta_temp) * factor) >> 12;
+    return (delta_temp < 0) ? -steps : steps;
+}
+
+/**
+ * API to apply a power change to every octet of a TX_POWER register value. The change goes to the mixer
+ * gain, moving DA attenuation steps in or out when the mixer would leave its linear range.
+ *
+ * @param ref_power  TX_POWER register value to start from.
+ * @param adj        Power change in 0.5dB steps.
+ * @return uint32_t New TX_POWER register value.
+ */
+uint32_t
+dw1000_tempcomp_power_adj(uint32_t ref_power, int32_t adj)
+{
+    uint32_t reg = 0;
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        int32_t da = (ref_power >> (i * 8 + 5)) & 0x7;
+        int32_t mix = ((ref_power >> (i * 8)) & 0x1F) + adj;
+
+        // DA attenuation lowers gain as its value rises
+        while (mix > MIX_GAIN_MAX && da > 0) {
+            da--;
+            mix -= MIX_DA_FACTOR;
+        }
+        while (mix < MIX_GAIN_MIN && da < DA_ATTN_MAX) {
+            da++;
+            mix += MIX_DA_FACTOR;
+        }
+        if (mix < 0) mix = 0;
+        if (mix > 0x1F) mix = 0x1F;
+        reg |= (uint32_t)((da << 5) | mix) << (i * 8);
+    }
+    return reg;
+}
+
+/*
+ * Runs the service if the transceiver is idle: no frame in flight on tx_sem and the PMSC back in IDLE, so
+ * receive is off too. inst->mutex is held over the check and the service, start_tx and start_rx wait on it.
+ */
+static bool
+tempcomp_service_idle(struct dw1000_tempcomp_instance * tc)
+{
+    struct _dw1000_dev_instance_t * inst = tc->dev_inst;
+    bool idle;
+
+    if (dpl_mutex_pend(&inst->mutex, 0) != DPL_OK) {
+        return false;
+    }
+    idle = inst->uwb_dev.status.initialized && !inst->uwb_dev.status.sleeping &&
+           dpl_sem_get_count(&inst->tx_sem) != 0 &&
+           (uint8_t) dw1000_read_reg(inst, SYS_STATE_ID, PMSC_STATE_OFFSET, sizeof(uint8_t)) == PMSC_STATE_IDLE;
+    if (idle) {
+        dw1000_tempcomp_service(tc);
+    }
+    dpl_mutex_release(&inst->mutex);
+    return idle;
+}
+
+/* Runs from the default queue, a sample found the transceiver busy is retried shortly after */
+static void
+tempcomp_timer_cb(struct dpl_event * ev)
+{
+    struct dw1000_tempcomp_instance * tc = (struct dw1000_tempcomp_instance *) dpl_event_get_arg(ev);
+
+    tc->due = 1;
+    if (!tc->active) {
+        return;
+    }
+    if (tempcomp_service_idle(tc)) {
+        dpl_callout_reset(&tc->callout, dpl_time_ms_to_ticks32(MYNEWT_VAL(DW1000_TEMPCOMP_PERIOD_MS)));
+    } else {
+        tc->stats.busy++;
+        dpl_callout_reset(&tc->callout, dpl_time_ms_to_ticks32(MYNEWT_VAL(DW1000_TEMPCOMP_RETRY_MS)));
+    }
+}
+
+/**
+ * API to initialise temperature compensation. Without a reference one is taken now from the current
+ * txrf config, which costs a full PG count measurement.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @param ref   Reference from an earlier calibration, or NULL.
+ * @return struct dw1000_tempcomp_instance *
+ */
+struct dw1000_tempcomp_instance *
+dw1000_tempcomp_init(struct _dw1000_dev_instance_t * inst, const struct dw1000_tempcomp_ref * ref)
+{
+    struct dw1000_tempcomp_instance * tc = dw1000_tempcomp_get(inst);
+
+    if (tc->active) {
+        dw1000_tempcomp_stop(tc);
+    }
+    memset(tc, 0, sizeof(struct dw1000_tempcomp_instance));
+    tc->dev_inst = inst;
+    dpl_callout_init(&tc->callout, dpl_eventq_dflt_get(), tempcomp_timer_cb, (void *) tc);
+
+    if (ref) {
+        tc->ref = *ref;
+    } else {
+        uint32_t baudrate = inst->spi_settings.baudrate;
+        spi_rate(inst, inst->spi_baudrate_low);
+        tc->ref.temp_raw = dw1000_phy_read_tempvbat(inst) >> 8;
+        tc->ref.pgdly = inst->uwb_dev.config.txrf.PGdly;
+        tc->ref.power = inst->uwb_dev.config.txrf.power;
+        tc->ref.pg_count = dw1000_tempcomp_calc_pgcount(inst, tc->ref.pgdly);
+        spi_rate(inst, baudrate);
+    }
+    tc->temp_raw = tc->applied_temp_raw = tc->ref.temp_raw;
+    return tc;
+}
+
+/**
+ * API to start periodic sampling, the first sample is taken once the transceiver is next idle.
+ *
+ * @param tc  Pointer to struct dw1000_tempcomp_instance.
+ * @return void
+ */
+void
+dw1000_tempcomp_start(struct dw1000_tempcomp_instance * tc)
+{
+    tc->active = 1;
+    tc->due = 1;
+    dpl_callout_reset(&tc->callout, dpl_time_ms_to_ticks32(MYNEWT_VAL(DW1000_TEMPCOMP_RETRY_MS)));
+}
+
+/**
+ * API to stop periodic sampling, the registers are left as they are.
+ *
+ * @param tc  Pointer to struct dw1000_tempcomp_instance.
+ * @return void
+ */
+void
+dw1000_tempcomp_stop(struct dw1000_tempcomp_instance * tc)
+{
+    tc->active = 0;
+    tc->due = 0;
+    dpl_callout_stop(&tc->callout);
+}
+
+/*
+ * Walk PG_DELAY from its current value towards the reference count. A higher PG_DELAY gives
+ * a lower count. Stops when the count crosses the reference, keeping the closest code seen.
+ */
+static uint8_t
+pgdly_track(struct dw1000_tempcomp_instance * tc, uint8_t pgdly)
+{
+    struct _dw1000_dev_instance_t * inst = tc->dev_inst;
+    struct pgcal_save save;
+    int32_t delta, best_delta;
+    uint8_t best = pgdly;
+    int dir, i;
+
+    pgcal_enter(inst, &save);
+    delta = (int32_t) pgcal_measure(inst, pgdly) - tc->ref.pg_count;
+    best_delta = abs(delta);
+    dir = (delta > 0) ? 1 : -1;
+
+    for (i = 0; i < MYNEWT_VAL(DW1000_TEMPCOMP_PG_MAX_STEPS) && delta != 0; i++) {
+        if ((dir > 0 && pgdly == 0xFF) || (dir < 0 && pgdly == 0)) {
+            break;
+        }
+        pgdly += dir;
+        delta = (int32_t) pgcal_measure(inst, pgdly) - tc->ref.pg_count;
+        if (abs(delta) < best_delta) {
+            best_delta = abs(delta);
+            best = pgdly;
+        }
+        if ((delta > 0) != (dir > 0)) {
+            break;
+        }
+    }
+    dw1000_write_reg(inst, TX_CAL_ID, TC_PGDELAY_OFFSET, inst->uwb_dev.config.txrf.PGdly, sizeof(uint8_t));
+    pgcal_exit(inst, &save);
+
+    return best;
+}
+
+/**
+ * API to run any due compensation, to be called between ranging rounds with the transceiver idle.
+ * Only the registers that change are written and the txrf config is updated so that the values
+ * survive a wakeup.
+ *
+ * @param tc  Pointer to struct dw1000_tempcomp_instance.
+ * @return bool true if TX_POWER or PG_DELAY were changed.
+ */
+bool
+dw1000_tempcomp_service(struct dw1000_tempcomp_instance * tc)
+{
+    struct _dw1000_dev_instance_t * inst = tc->dev_inst;
+    struct uwb_dev_txrf_config * txrf = &inst->uwb_dev.config.txrf;
+    uint32_t baudrate = inst->spi_settings.baudrate;
+    uint32_t power;
+    uint8_t pgdly;
+    bool changed = false;
+
+    if (!tc->due) {
+        return false;
+    }
+    tc->due = 0;
+
+    spi_rate(inst, inst->spi_baudrate_low);
+    tc->temp_raw = dw1000_phy_read_tempvbat(inst) >> 8;
+    tc->stats.samples++;
+
+    if (abs((int32_t)tc->temp_raw - tc->applied_temp_raw) < MYNEWT_VAL(DW1000_TEMPCOMP_HYST_RAW)) {
+        spi_rate(inst, baudrate);
+        return false;
+    }
+    tc->applied_temp_raw = tc->temp_raw;
+
+    power = dw1000_tempcomp_power_adj(tc->ref.power,
+                dw1000_tempcomp_power_steps(inst->uwb_dev.config.channel, (int32_t)tc->temp_raw - tc->ref.temp_raw));
+    if (power != txrf->power) {
+        txrf->power = power;
+        dw1000_write_reg(inst, TX_POWER_ID, 0, txrf->power, sizeof(uint32_t));
+        tc->stats.power_updates++;
+        changed = true;
+    }
+
+    pgdly = pgdly_track(tc, txrf->PGdly);
+    if (pgdly != txrf->PGdly) {
+        txrf->PGdly = pgdly;
+        dw1000_write_reg(inst, TX_CAL_ID, TC_PGDELAY_OFFSET, txrf->PGdly, sizeof(uint8_t));
+        tc->stats.pg_updates++;
+        changed = true;
+    }
+
+    spi_rate(inst, baudrate);
+    return changed;
+}
+
+#endif
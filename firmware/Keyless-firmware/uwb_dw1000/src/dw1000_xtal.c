@@ -0,0 +1,265 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw1000_xtal.c
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief Crystal trim tracking
+ *
+ * @details Every good frame from the tracked source gives a clock offset sample, taken from the carrier
+ * integrator in single buffer mode or the time tracking offset in double buffer mode. Samples go through
+ * a first order IIR filter and once the filtered offset leaves the hysteresis band the trim is stepped
+ * by the number of whole steps it represents. The filter is then shifted by the expected correction and
+ * left to settle before it is trusted again.
+ *
+ * Everything runs in integer ppb so the tracker can be called from the interrupt task.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#if defined(DW1000_XTAL_KERNEL_ONLY)
+#include <dw1000/dw1000_xtal.h>
+#define DW1000_XTAL_BUILD 1
+#else
+#include <dpl/dpl.h>
+#include <dw1000/dw1000_regs.h>
+#include <dw1000/dw1000_dev.h>
+#include <dw1000/dw1000_phy.h>
+#include <dw1000/dw1000_mac.h>
+#include <dw1000/dw1000_xtal.h>
+#define DW1000_XTAL_BUILD MYNEWT_VAL(DW1000_XTAL_TRACK_ENABLED)
+#endif
+
+#if DW1000_XTAL_BUILD
+
+/**
+ * Carrier integrator to clock offset. The carrier frequency of every channel is a multiple k of 499.2MHz,
+ * which brings the conversion down to 2e9/(k*2^28) ppb per count, and 2^3 times less at 110kbps.
+ *
+ * @param channel         Channel, 1 to 7.
+ * @param rate_110k       The data rate is 110kbps.
+ * @param integrator_val  Carrier integrator value.
+ * @return int32_t offset in ppb, positive when the local clock is fast. 0 for a channel that does not exist.
+ */
+int32_t
+dw1000_xtal_ci_ppb(uint8_t channel, bool rate_110k, int32_t integrator_val)
+{
+    int64_t den;
+
+    switch (channel) {
+    case 1: den = 7; break;
+    case 2:
+    case 4: den = 8; break;
+    case 3: den = 9; break;
+    case 5:
+    case 7: den = 13; break;
+    default: return 0;
+    }
+    den <<= 28;
+    if (rate_110k) {
+        den <<= 3;
+    }
+    return (int32_t)(((int64_t)integrator_val * 2000000000LL) / den);
+}
+
+/**
+ * Time tracking offset to clock offset. The offset is negated the same way as in
+ * dw1000_calc_clock_offset_ratio_ttco, which keeps it the same sign as the carrier integrator path.
+ *
+ * @param prf_16m  The pulse repetition frequency is 16MHz.
+ * @param ttcko    Time tracking offset.
+ * @return int32_t offset in ppb, positive when the local clock is fast.
+ */
+int32_t
+dw1000_xtal_ttcko_ppb(bool prf_16m, int32_t ttcko)
+{
+    int64_t denom = prf_16m ? 0x01F00000 : 0x01FC0000;
+    return (int32_t)((-(int64_t)ttcko * 1000000000LL) / denom);
+}
+
+#ifndef DW1000_XTAL_KERNEL_ONLY
+
+#define XTAL_OUTLIER_PPB   (100000)     //!< Offsets beyond 100ppm are not a crystal, drop them
+
+static struct dw1000_xtal_instance g_xtal_instances[MYNEWT_VAL(UWB_DEVICE_MAX)];
+
+/**
+ * API to get the crystal trim tracking instance of a device.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return struct dw1000_xtal_instance *
+ */
+struct dw1000_xtal_instance *
+dw1000_xtal_get(struct _dw1000_dev_instance_t * inst)
+{
+    assert(inst->uwb_dev.idx < MYNEWT_VAL(UWB_DEVICE_MAX));
+    return &g_xtal_instances[inst->uwb_dev.idx];
+}
+
+/**
+ * API to initialise crystal trim tracking, tracking is left disabled.
+ *
+ * @param inst     Pointer to _dw1000_dev_instance_t.
+ * @param src_uid  Short address of the device to track, DW1000_XTAL_ANY_SRC for any.
+ * @return struct dw1000_xtal_instance *
+ */
+struct dw1000_xtal_instance *
+dw1000_xtal_track_init(struct _dw1000_dev_instance_t * inst, uint16_t src_uid)
+{
+    struct dw1000_xtal_instance * xtal = dw1000_xtal_get(inst);
+
+    memset(xtal, 0, sizeof(struct dw1000_xtal_instance));
+    xtal->dev_inst = inst;
+    xtal->src_uid = src_uid;
+    xtal->settle = MYNEWT_VAL(DW1000_XTAL_TRACK_SETTLE);
+    return xtal;
+}
+
+/**
+ * API to enable/disable crystal trim tracking.
+ *
+ * @param inst    Pointer to _dw1000_dev_instance_t.
+ * @param enable  true to follow received frames.
+ * @return void
+ */
+void
+dw1000_xtal_track_enable(struct _dw1000_dev_instance_t * inst, bool enable)
+{
+    inst->control.xtal_track_enabled = enable;
+}
+
+/**
+ * API to convert a carrier integrator value to a clock offset.
+ *
+ * @param inst            Pointer to _dw1000_dev_instance_t.
+ * @param integrator_val  Carrier integrator value, see dw1000_read_carrier_integrator.
+ * @return int32_t offset in ppb, positive when the local clock is fast.
+ */
+int32_t
+dw1000_xtal_ci_to_ppb(struct _dw1000_dev_instance_t * inst, int32_t integrator_val)
+{
+    assert(inst->uwb_dev.config.channel >= 1 && inst->uwb_dev.config.channel <= 7);
+    return dw1000_xtal_ci_ppb(inst->uwb_dev.config.channel, inst->uwb_dev.config.dataRate == DWT_BR_110K,
+                              integrator_val);
+}
+
+/**
+ * API to convert a time tracking offset to a clock offset.
+ *
+ * @param inst   Pointer to _dw1000_dev_instance_t.
+ * @param ttcko  Time tracking offset, see dw1000_read_time_tracking_offset.
+ * @return int32_t offset in ppb, positive when the local clock is fast.
+ */
+int32_t
+dw1000_xtal_ttcko_to_ppb(struct _dw1000_dev_instance_t * inst, int32_t ttcko)
+{
+    return dw1000_xtal_ttcko_ppb(inst->uwb_dev.config.prf == DWT_PRF_16M, ttcko);
+}
+
+/**
+ * API to feed one clock offset sample to the tracker. Steps the crystal trim once the
+ * filtered offset leaves the hysteresis band.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @param ppb   Clock offset in ppb, positive when the local clock is fast.
+ * @return void
+ */
+void
+dw1000_xtal_track_sample(struct _dw1000_dev_instance_t * inst, int32_t ppb)
+{
+    struct dw1000_xtal_instance * xtal = dw1000_xtal_get(inst);
+    int32_t steps;
+    int16_t trim;
+
+    if (ppb > XTAL_OUTLIER_PPB || ppb < -XTAL_OUTLIER_PPB) {
+        xtal->stats.rejected++;
+        return;
+    }
+    xtal->stats.last_ppb = ppb;
+    if (xtal->stats.samples++ == 0) {
+        xtal->filt_ppb = ppb;
+    } else {
+        xtal->filt_ppb += (ppb - xtal->filt_ppb) >> MYNEWT_VAL(DW1000_XTAL_TRACK_FILTER_SHIFT);
+    }
+
+    if (xtal->settle) {
+        xtal->settle--;
+        return;
+    }
+    if (xtal->filt_ppb < MYNEWT_VAL(DW1000_XTAL_TRACK_HYST_PPB) &&
+        xtal->filt_ppb > -MYNEWT_VAL(DW1000_XTAL_TRACK_HYST_PPB)) {
+        return;
+    }
+
+    /* A higher trim adds load capacitance and slows the crystal down */
+    steps = xtal->filt_ppb / MYNEWT_VAL(DW1000_XTAL_TRIM_PPB_PER_STEP);
+    if (steps == 0) {
+        steps = (xtal->filt_ppb > 0) ? 1 : -1;
+    }
+    trim = (int16_t)inst->uwb_dev.config.rx.xtalTrim + steps;
+    if (trim < 0) trim = 0;
+    if (trim > FS_XTALT_MASK) trim = FS_XTALT_MASK;
+    steps = trim - (int16_t)inst->uwb_dev.config.rx.xtalTrim;
+    if (steps == 0) {
+        return;
+    }
+
+    dw1000_phy_set_xtal_trim(inst, (uint8_t)trim);
+    xtal->filt_ppb -= steps * MYNEWT_VAL(DW1000_XTAL_TRIM_PPB_PER_STEP);
+    xtal->settle = MYNEWT_VAL(DW1000_XTAL_TRACK_SETTLE);
+    xtal->stats.adjustments++;
+}
+
+/**
+ * Called from the interrupt handler after a good frame. Takes the clock offset the handler already
+ * read for the frame if it came from the tracked source.
+ *
+ * @param inst  Pointer to _dw1000_dev_instance_t.
+ * @return void
+ */
+void
+dw1000_xtal_track_rx(struct _dw1000_dev_instance_t * inst)
+{
+    struct dw1000_xtal_instance * xtal = dw1000_xtal_get(inst);
+    uint16_t fctrl = inst->uwb_dev.fctrl;
+
+    if (xtal->src_uid != DW1000_XTAL_ANY_SRC) {
+        /* Short source address with PAN id compression sits right after the short destination */
+        if ((fctrl & 0xCC40) != 0x8840 || inst->uwb_dev.frame_len < 9) {
+            return;
+        }
+        if (((uint16_t)inst->uwb_dev.rxbuf[8] << 8 | inst->uwb_dev.rxbuf[7]) != xtal->src_uid) {
+            return;
+        }
+    }
+
+    if (inst->uwb_dev.config.dblbuffon_enabled) {
+        if (inst->uwb_dev.config.rxttcko_enable) {
+            dw1000_xtal_track_sample(inst, dw1000_xtal_ttcko_to_ppb(inst, inst->uwb_dev.rxttcko));
+        }
+    } else {
+        dw1000_xtal_track_sample(inst, dw1000_xtal_ci_to_ppb(inst, inst->uwb_dev.carrier_integrator));
+    }
+}
+
+#endif
+#endif
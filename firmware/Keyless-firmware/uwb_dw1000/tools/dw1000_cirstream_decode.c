@@ -0,0 +1,173 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw1000_cirstream_decode.c
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief Host decoder for the dw1000 CIR stream
+ *
+ * @details Reads a captured console/usb stream, finds the CIR frames among any other output by their
+ * magic and crc and prints one csv line per tap: seq,fp_idx,tap,real,imag. The frame layout is
+ * described in include/dw1000/dw1000_cirstream.h.
+ *
+ *   cc -O2 -o dw1000_cirstream_decode dw1000_cirstream_decode.c
+ *   dw1000_cirstream_decode < /dev/ttyACM0 > cir.csv
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#define CIRSTREAM_MAGIC     (0xC1D1)
+#define CIRSTREAM_VERSION   (1)
+#define CIRSTREAM_HDR_LEN   (12)
+#define CIRSTREAM_BLOCK     (8)
+#define CIRSTREAM_WBITS     (5)
+#define CIRSTREAM_MAX_TAPS  (255)
+#define CIRSTREAM_PAYLOAD_MAX ((CIRSTREAM_MAX_TAPS * 2 * 17 + \
+    (CIRSTREAM_MAX_TAPS + CIRSTREAM_BLOCK - 1) / CIRSTREAM_BLOCK * CIRSTREAM_WBITS + 7) / 8)
+#define CIRSTREAM_FRAME_MAX (CIRSTREAM_HDR_LEN + CIRSTREAM_PAYLOAD_MAX + 2)
+
+struct bitreader {
+    const uint8_t * p;
+    const uint8_t * end;
+    uint32_t acc;
+    uint8_t n;
+};
+
+static int
+get_bits(struct bitreader * br, uint8_t w, uint32_t * v)
+{
+    while (br->n < w) {
+        if (br->p == br->end) {
+            return -1;
+        }
+        br->acc |= (uint32_t)(*br->p++) << br->n;
+        br->n += 8;
+    }
+    *v = w ? br->acc & ((1UL << w) - 1) : 0;
+    br->acc = w < 32 ? br->acc >> w : 0;
+    br->n -= w;
+    return 0;
+}
+
+static uint16_t
+crc16(const uint8_t * p, uint16_t len)
+{
+    uint16_t crc = 0xffff;
+    uint8_t i;
+
+    while (len--) {
+        crc ^= (uint16_t)(*p++) << 8;
+        for (i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint16_t
+get16(const uint8_t * p)
+{
+    return (uint16_t) p[0] | ((uint16_t) p[1] << 8);
+}
+
+/* Decode the payload into real, imag pairs, 0 on success */
+static int
+decode(const uint8_t * payload, uint16_t plen, int16_t * taps, uint16_t ntaps)
+{
+    struct bitreader br = {.p = payload, .end = payload + plen, .acc = 0, .n = 0};
+    int32_t prev[2] = {0, 0};
+    uint16_t t, i, nb;
+    uint32_t w, z;
+
+    for (t = 0; t < ntaps; t += nb) {
+        nb = (ntaps - t < CIRSTREAM_BLOCK) ? ntaps - t : CIRSTREAM_BLOCK;
+        if (get_bits(&br, CIRSTREAM_WBITS, &w) || w > 17) {
+            return -1;
+        }
+        for (i = 0; i < 2 * nb; i++) {
+            if (get_bits(&br, w, &z)) {
+                return -1;
+            }
+            prev[i & 1] += (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+            taps[2 * t + i] = (int16_t) prev[i & 1];
+        }
+    }
+    return 0;
+}
+
+int
+main(int argc, char ** argv)
+{
+    static uint8_t buf[4 * CIRSTREAM_FRAME_MAX];
+    int16_t taps[2 * CIRSTREAM_MAX_TAPS];
+    size_t len = 0, pos, n;
+    unsigned long frames = 0, bad = 0;
+    FILE * in = stdin;
+
+    if (argc > 1 && (in = fopen(argv[1], "rb")) == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+    printf("seq,fp_idx,tap,real,imag\n");
+
+    while ((n = fread(buf + len, 1, sizeof(buf) - len, in)) > 0 || len >= CIRSTREAM_HDR_LEN) {
+        len += n;
+        pos = 0;
+        while (len - pos >= CIRSTREAM_HDR_LEN) {
+            const uint8_t * f = buf + pos;
+            uint16_t ntaps, plen, start, t;
+
+            if (get16(f) != CIRSTREAM_MAGIC || f[2] != CIRSTREAM_VERSION) {
+                pos++;
+                continue;
+            }
+            ntaps = f[3];
+            start = get16(f + 8);
+            plen = get16(f + 10);
+            if (plen > CIRSTREAM_PAYLOAD_MAX) {
+                pos++;
+                continue;
+            }
+            if (len - pos < (size_t) CIRSTREAM_HDR_LEN + plen + 2) {
+                break;      /* Wait for the rest */
+            }
+            if (crc16(f, CIRSTREAM_HDR_LEN + plen) != get16(f + CIRSTREAM_HDR_LEN + plen) ||
+                decode(f + CIRSTREAM_HDR_LEN, plen, taps, ntaps)) {
+                bad++;
+                pos++;
+                continue;
+            }
+            for (t = 0; t < ntaps; t++) {
+                printf("%u,%u,%u,%d,%d\n", get16(f + 4), get16(f + 6), start + t, taps[2 * t], taps[2 * t + 1]);
+            }
+            frames++;
+            pos += CIRSTREAM_HDR_LEN + plen + 2;
+        }
+        memmove(buf, buf + pos, len - pos);
+        len -= pos;
+        if (n == 0) {
+            break;
+        }
+    }
+    fprintf(stderr, "%lu frames, %lu bad\n", frames, bad);
+    return 0;
+}
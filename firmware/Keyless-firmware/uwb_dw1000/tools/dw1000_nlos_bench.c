@@ -0,0 +1,172 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @file dw1000_nlos_bench.c
+ * @author UWB Core <uwbcore@gmail.com>
+ * @date 2021
+ * @brief Host benchmark of the first path analysis
+ *
+ * @details Runs dw1000_nlos_analyse with the syscfg default thresholds over recorded captures, the csv
+ * written by dw1000_cirstream_decode. Prints the features and nlos probability of every capture followed
+ * by the time per analysis. The noise floor is estimated from the captured taps well ahead of the first path.
+ *
+ *   cc -O2 -DDW1000_NLOS_KERNEL_ONLY -I../include -o dw1000_nlos_bench dw1000_nlos_bench.c ../src/dw1000_nlos.c
+ *   dw1000_nlos_bench cir.csv [taps] [pre]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <dw1000/dw1000_nlos.h>
+
+#define MAX_CAPTURES    (4096)
+#define MAX_RECORDED    (256)
+#define ITERATIONS      (1000)
+#define NOISE_K         (6)
+
+struct capture {
+    unsigned seq;
+    uint16_t fp;                        /* Relative to cir[0] in 1/64 tap */
+    uint16_t ntaps;
+    uint32_t noise;
+    uint32_t cir[DW1000_NLOS_MAX_TAPS];
+};
+
+static const struct dw1000_nlos_params params = {
+    .rise_los = 64, .rise_nlos = 384,
+    .ratio_los = 128, .ratio_nlos = 16,
+    .excess_los = 192, .excess_nlos = 960,
+    .bias_gain = 64
+};
+
+static struct capture captures[MAX_CAPTURES];
+static uint16_t ncaptures;
+
+/* Cut the analysis window out of one recorded capture the way dw1000_nlos_update reads it */
+static void
+add_capture(unsigned seq, unsigned fp_idx, unsigned first, const int16_t (*taps)[2], unsigned n,
+            unsigned ntaps, unsigned pre)
+{
+    struct capture * c;
+    unsigned fp_tap = fp_idx >> 6, start, i, nnoise = 0;
+    uint64_t noise = 0;
+
+    if (ncaptures == MAX_CAPTURES || fp_tap < first) {
+        return;
+    }
+    start = (fp_tap > first + pre) ? fp_tap - pre : first;
+    if (start + ntaps > first + n) {
+        return;
+    }
+    c = &captures[ncaptures++];
+    c->seq = seq;
+    c->fp = fp_idx - start * 64;
+    c->ntaps = ntaps;
+    for (i = 0; i < ntaps; i++) {
+        c->cir[i] = (uint16_t) taps[start - first + i][0] | ((uint32_t)(uint16_t) taps[start - first + i][1] << 16);
+    }
+    for (i = 0; i + 2 < fp_tap - first; i++) {
+        noise += (int32_t) taps[i][0] * taps[i][0] + (int32_t) taps[i][1] * taps[i][1];
+        nnoise++;
+    }
+    c->noise = nnoise ? (uint32_t)(noise / nnoise * NOISE_K * NOISE_K) : 0;
+}
+
+int
+main(int argc, char ** argv)
+{
+    static int16_t taps[MAX_RECORDED][2];
+    struct dw1000_nlos_result r;
+    struct timespec t0, t1;
+    unsigned seq, fp_idx, tap, cur_seq = ~0u, cur_fp = 0, first = 0, n = 0;
+    unsigned ntaps = 24, pre = 4, i, it, nlos = 0;
+    int re, im;
+    char line[128];
+    volatile uint32_t sink = 0;
+    double ns;
+    FILE * in;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s cir.csv [taps] [pre]\n", argv[0]);
+        return 1;
+    }
+    if ((in = fopen(argv[1], "r")) == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+    if (argc > 2) {
+        ntaps = strtoul(argv[2], NULL, 0);
+    }
+    if (argc > 3) {
+        pre = strtoul(argv[3], NULL, 0);
+    }
+    if (ntaps < 2 || ntaps > DW1000_NLOS_MAX_TAPS) {
+        fprintf(stderr, "taps must be 2..%d\n", DW1000_NLOS_MAX_TAPS);
+        return 1;
+    }
+
+    while (fgets(line, sizeof(line), in)) {
+        if (sscanf(line, "%u,%u,%u,%d,%d", &seq, &fp_idx, &tap, &re, &im) != 5) {
+            continue;
+        }
+        if (seq != cur_seq) {
+            if (n) {
+                add_capture(cur_seq, cur_fp, first, taps, n, ntaps, pre);
+            }
+            cur_seq = seq;
+            cur_fp = fp_idx;
+            first = tap;
+            n = 0;
+        }
+        if (n < MAX_RECORDED) {
+            taps[n][0] = re;
+            taps[n][1] = im;
+            n++;
+        }
+    }
+    if (n) {
+        add_capture(cur_seq, cur_fp, first, taps, n, ntaps, pre);
+    }
+    if (ncaptures == 0) {
+        fprintf(stderr, "no captures with %u taps around the first path\n", ntaps);
+        return 1;
+    }
+
+    printf("seq,rise,ratio,excess,peak,p_nlos,bias\n");
+    for (i = 0; i < ncaptures; i++) {
+        dw1000_nlos_analyse(&params, captures[i].cir, captures[i].ntaps, captures[i].fp, captures[i].noise, &r);
+        printf("%u,%u,%u,%u,%u,%u,%d\n", captures[i].seq, r.rise, r.ratio, r.excess, r.peak, r.p_nlos, r.bias);
+        nlos += r.p_nlos > DW1000_NLOS_ONE / 2;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (it = 0; it < ITERATIONS; it++) {
+        for (i = 0; i < ncaptures; i++) {
+            dw1000_nlos_analyse(&params, captures[i].cir, captures[i].ntaps, captures[i].fp, captures[i].noise, &r);
+            sink += r.p_nlos;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    ns = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / ((double) ITERATIONS * ncaptures);
+    fprintf(stderr, "%u captures, %u nlos, %u taps, %.1f ns per analysis\n", ncaptures, nlos, ntaps, ns);
+    return 0;
+}
@@ -0,0 +1,120 @@
+//
+// Created by Jeremy King on 10/18/21.
+//
+
+#include "vmon.h"
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+
+//raw values are kept as 12 bit adc counts << 4 so the iir does not lose the low bits
+struct vmon_state {
+	uint32_t filt;
+	uint16_t min;
+	uint16_t max;
+	uint32_t sag;
+	uint32_t time_us;
+};
+
+#define VMON_HALF_BITS 7 //log2 of a half in bytes, the dma write ring
+static_assert(VMON_BLOCK * sizeof(uint16_t) == 1 << VMON_HALF_BITS, "a half has to be the write ring");
+static uint16_t vmon_buf[2][VMON_BLOCK] __attribute__((aligned(1 << VMON_HALF_BITS)));
+static int vmon_dma[2] = {-1, -1};
+static vmon_state state[VMON_NUM_INPUTS];
+static bool filt_ready;
+
+static uint16_t vmon_mv(uint32_t raw){
+	return (raw * VMON_FULL_SCALE_MV) >> 16; //counts << 4 over 4096 << 4
+}
+
+//samples alternate batt, ign, batt... because the block is even and round robin starts from adc0
+static void vmon_fold(const uint16_t *buf){
+	uint32_t now = time_us_32();
+
+	for (int in = 0; in < VMON_NUM_INPUTS; in++){
+		vmon_state &s = state[in];
+		uint32_t sum = 0;
+		uint16_t lo = 0xfff, hi = 0;
+		for (int i = in; i < VMON_BLOCK; i += VMON_NUM_INPUTS){
+			uint16_t v = buf[i] & 0xfff;
+			sum += v;
+			lo = v < lo ? v : lo;
+			hi = v > hi ? v : hi;
+		}
+		uint32_t mean = (sum << 4) / (VMON_BLOCK / VMON_NUM_INPUTS);
+		if (!filt_ready){
+			s.filt = mean;
+			s.sag = mean;
+		}
+		else {
+			s.filt += ((int32_t)mean - (int32_t)s.filt) >> VMON_IIR_SHIFT;
+		}
+		s.min = lo;
+		s.max = hi;
+		if (s.filt < s.sag){
+			s.sag = s.filt;
+		}
+		s.time_us = now;
+	}
+	filt_ready = true;
+}
+
+//dma irq 1, shared with the telemetry uart
+static void vmon_dma_irq(){
+	for (int h = 0; h < 2; h++){
+		if (dma_channel_get_irq1_status(vmon_dma[h])){
+			dma_channel_acknowledge_irq1(vmon_dma[h]); //the other channel is filling its half now
+			vmon_fold(vmon_buf[h]);
+		}
+	}
+}
+
+void vmon_init(){
+	adc_init();
+	adc_gpio_init(VMON_PIN_BATT);
+	adc_gpio_init(VMON_PIN_IGN);
+	adc_select_input(0);
+	adc_set_round_robin((1 << VMON_NUM_INPUTS) - 1);
+	adc_fifo_setup(true, true, 1, false, false); //dreq on every sample, 12 bits in a halfword
+	adc_set_clkdiv(48000000.0f / VMON_SAMPLE_HZ - 1); //a conversion is clkdiv + 1 adc clocks apart
+
+	vmon_dma[0] = dma_claim_unused_channel(true);
+	vmon_dma[1] = dma_claim_unused_channel(true);
+	for (int h = 0; h < 2; h++){
+		dma_channel_config c = dma_channel_get_default_config(vmon_dma[h]);
+		channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+		channel_config_set_read_increment(&c, false);
+		channel_config_set_write_increment(&c, true);
+		channel_config_set_ring(&c, true, VMON_HALF_BITS); //back to the start of the half for the next trigger
+		channel_config_set_dreq(&c, DREQ_ADC);
+		channel_config_set_chain_to(&c, vmon_dma[h ^ 1]); //ping pong, no gap for the interrupt to cover
+		dma_channel_configure(vmon_dma[h], &c, vmon_buf[h], &adc_hw->fifo, VMON_BLOCK, false);
+		dma_channel_set_irq1_enabled(vmon_dma[h], true);
+	}
+	irq_add_shared_handler(DMA_IRQ_1, vmon_dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+	irq_set_enabled(DMA_IRQ_1, true);
+
+	adc_fifo_drain();
+	dma_channel_start(vmon_dma[0]);
+	adc_run(true);
+}
+
+//the state is only written by the dma interrupt on this core, masking it is enough for a whole copy
+vmon_reading vmon_read(vmon_input in){
+	uint32_t irq = save_and_disable_interrupts();
+	vmon_state s = state[in];
+	restore_interrupts(irq);
+	return {vmon_mv(s.filt), vmon_mv(s.min << 4), vmon_mv(s.max << 4), vmon_mv(s.sag), s.time_us};
+}
+
+void vmon_sag_reset(vmon_input in){
+	uint32_t irq = save_and_disable_interrupts();
+	state[in].sag = state[in].filt;
+	restore_interrupts(irq);
+}
+
+bool vmon_valid(const vmon_reading &r){
+	return r.time_us && time_us_32() - r.time_us < VMON_STALE_US && r.mv >= VMON_ABSENT_MV;
+}
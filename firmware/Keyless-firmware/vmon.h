@@ -0,0 +1,44 @@
+//
+// Created by Jeremy King on 10/18/21.
+//
+
+#ifndef KEYLESS_FIRMWARE_VMON_H
+#define KEYLESS_FIRMWARE_VMON_H
+//battery and ignition voltage. the adc runs free in round robin over both inputs and two chained dma channels
+//fill the halves of a ping pong buffer, the dma interrupt folds each finished half into a per input iir and
+//min/max while the other half fills. reading is a copy of a few words, it never waits on the adc
+//each channel's write address wraps inside its own half, an interrupt held off by a flash erase costs samples
+//but the dma never leaves the buffer
+#include <stdint.h>
+
+#define VMON_PIN_BATT 26 //adc0, battery through 100k over 22k
+#define VMON_PIN_IGN 27 //adc1, ignition feed through the same divider
+#define VMON_FULL_SCALE_MV 18300 //3.3V at the pin
+#define VMON_SAMPLE_HZ 8000 //both inputs together
+#define VMON_BLOCK 64 //samples per half buffer, even so each input keeps its slot, 8ms at 8kHz
+#define VMON_IIR_SHIFT 2 //iir over the block means, 1/4 weight, about 30ms to settle
+#define VMON_STALE_US (100 * 1000) //a reading this old means the dma stopped
+//the board runs off the battery, below this the divider is not fitted and the readings are ignored
+#define VMON_ABSENT_MV 5000
+
+enum vmon_input : uint8_t {
+	VMON_BATT,
+	VMON_IGN,
+	VMON_NUM_INPUTS,
+};
+
+struct vmon_reading {
+	uint16_t mv; //filtered
+	uint16_t min_mv; //lowest and highest single sample in the last block
+	uint16_t max_mv;
+	uint16_t sag_mv; //lowest filtered value since vmon_sag_reset
+	uint32_t time_us; //when the last block was folded in
+};
+
+void vmon_init(); //core0, the dma interrupt is taken on the core that calls it
+vmon_reading vmon_read(vmon_input in);
+void vmon_sag_reset(vmon_input in);
+bool vmon_valid(const vmon_reading &r); //fresh and the divider is there
+
+
+#endif //KEYLESS_FIRMWARE_VMON_H